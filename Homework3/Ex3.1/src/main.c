@@ -1,9 +1,13 @@
 #include "S32K144.h"
 #include "../Core/Include/core_cm4.h"
 #include "clocks_and_modes.h"
+#include "driver_event.h"
 
-/* main loop idle counter */
-int idle_counter = 0;
+/* Event signals */
+#define SIG_LPIT0_CH0_TIMEOUT   0U
+
+/* Dispatch latency and idle time, refreshed on every timeout */
+Event_Stats_t event_stats;
 /* LPIT0 channel 0 timeout counter */
 int lpit0_ch0_flag_counter = 0;
 
@@ -57,6 +61,16 @@ void LPIT0_init(void) {
 
 }
 
+/* Runs in main, to completion, for each timeout posted by the ISR */
+void LPIT0_Timeout(uint32_t signal, uint32_t param)
+{
+    /* Increment LPIT0 timeout counter */
+    lpit0_ch0_flag_counter++;
+    /* Toggle output on port D0 */
+    IP_PTD->PTOR |= 1 << 0;
+    EVENT_GetStats(&event_stats);
+}
+
 int main(void) 
 {
     /* Configure GPIO */
@@ -67,14 +81,16 @@ int main(void)
     SPLL_init_160MHz();
     /* Init clocks: 80 MHz sysclk & core, 40 MHz bus, 20 MHz flash */
     NormalRUNmode_80MHz();
+    /* Event loop: timeouts are handled in main */
+    EVENT_Init();
+    EVENT_Subscribe(SIG_LPIT0_CH0_TIMEOUT, 0U, LPIT0_Timeout);
     /* Enable desired interrupts and priorities */
     NVIC_init();
     /* --- LPIT initialization --- */
     LPIT0_init();
 
-    while (1) {
-        idle_counter++;
-    }
+    /* Sleeps in WFI between timeouts */
+    EVENT_Run();
 }
 
 void LPIT0_Ch0_IRQHandler (void) 
@@ -82,8 +98,7 @@ void LPIT0_Ch0_IRQHandler (void)
     /* Clear LPIT0 Timer flag 0 */
     IP_LPIT0->MSR |= LPIT_MSR_TIF0_MASK;
     /* Perform read-after-write to ensure flag clears before ISR exit */
-    /* Increment LPIT0 timeout counter */
-    lpit0_ch0_flag_counter++;
-    /* Toggle output on port D0 */
-    IP_PTD->PTOR |= 1 << 0;
+    (void)IP_LPIT0->MSR;
+    /* The rest runs in main */
+    EVENT_Post(SIG_LPIT0_CH0_TIMEOUT, 0U);
 }
@@ -1,6 +1,28 @@
+#ifndef ADC_H_
+#define ADC_H_
+
 #include "S32K144.h"
 
+/* Reference on the EVB: VREFH = 5 V, 12-bit results */
+#define ADC_VREF_MV         5000U
+#define ADC_FULL_SCALE      0xFFFU
+#define ADC_VREFSH_CHANNEL  29U
+#define ADC_VREFSL_CHANNEL  30U
+
+extern uint32_t adc_scale_q16;
+
 void ADC_init(void);
+void ADC_calibrate(void);
+void ADC_set_reference(uint16_t vrefsh_raw);
 void convertADCchan(uint16_t);
 uint8_t adc_complete(void);
-uint32_t read_adc_chx(void);
\ No newline at end of file
+uint32_t read_ADC_chx(void);
+void ADC_to_mv_batch(const uint32_t *raw, uint32_t *mv, uint32_t count);
+
+/* Raw result to mV: Q16 multiply, rounded, no division */
+static inline uint32_t ADC_to_mv(uint32_t raw)
+{
+    return ((raw * adc_scale_q16) + 0x8000U) >> 16;
+}
+
+#endif /* ADC_H_ */
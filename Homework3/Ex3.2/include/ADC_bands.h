@@ -0,0 +1,47 @@
+#ifndef ADC_BANDS_H_
+#define ADC_BANDS_H_
+
+#include "S32K144.h"
+#ifdef HOST_SIM
+#include "host_sim.h"
+#else
+#include "../Core/Include/core_cm4.h"
+#endif
+#include <stdint.h>
+
+/*
+ * Threshold classifier on one ADC0 channel, woken only by band changes.
+ *
+ * The input range is split into bands by ascending thresholds. ADC0 converts
+ * the channel continuously while the SC2 compare function (ACFE + ACREN,
+ * outside-range) holds a window around the current band: the band plus the
+ * hysteresis on each side, in CV1/CV2. Readings inside the window are dropped
+ * by the ADC itself, without COCO or an interrupt. A reading outside it
+ * interrupts, is classified, moves the window to the new band and calls the
+ * callback once. Noise at a threshold smaller than the hysteresis never
+ * reaches the core.
+ *
+ * ADC0 runs in continuous software-triggered mode: not together with
+ * ADC_scan, which needs hardware triggers.
+ */
+
+#define ADC_BANDS_MAX   8U
+
+/* Called from the ADC0 interrupt on each band change, and once from ADC_bands_init */
+typedef void (*adc_bands_callback_t)(uint32_t band, uint32_t mv);
+
+typedef struct {
+    uint8_t                 channel;
+    const uint32_t          *thresholds_mv;     /* count - 1 ascending values; band i starts at thresholds_mv[i - 1] */
+    uint32_t                count;              /* bands, 2..ADC_BANDS_MAX */
+    uint32_t                hysteresis_mv;
+    adc_bands_callback_t    callback;
+} adc_bands_config_t;
+
+int32_t ADC_bands_init(const adc_bands_config_t *config);
+void ADC_bands_stop(void);
+uint32_t ADC_bands_current(void);
+/* Interrupts taken since ADC_bands_init */
+uint32_t ADC_bands_wakeups(void);
+
+#endif /* ADC_BANDS_H_ */
@@ -0,0 +1,78 @@
+#ifndef ADC_SCAN_H_
+#define ADC_SCAN_H_
+
+#include "S32K144.h"
+#ifdef HOST_SIM
+#include "host_sim.h"
+#else
+#include "../Core/Include/core_cm4.h"
+#endif
+#include <stdint.h>
+#include "driver_ring.h"
+
+/*
+ * ADC0 scan engine: conversions without the CPU.
+ *
+ *  - PDB0 runs continuously at the frame rate. Its channel 0 pre-trigger 0
+ *    starts SC1[0]; pre-triggers 1..n-1 are back-to-back, each one starts
+ *    SC1[k] when SC1[k-1] completes. One frame is one pass over SC1[0..n-1].
+ *  - SC3 AVGE/AVGS averages each result in hardware.
+ *  - SC2 DMAEN requests eDMA on every result. The DMA channel moves R[k] into
+ *    a ring of raw frames and loads the next frame's TCD by scatter/gather,
+ *    so it never stops. Its major-loop interrupt ends each frame.
+ *  - The DMA interrupt converts the finished frames to mV and hands them to
+ *    the callback. That is the only CPU work: one interrupt per frame, none
+ *    per sample. With VREFSH in the scan list, each frame also refreshes the
+ *    mV scale (ADC_set_reference).
+ * Timing: the samples are timed by the PDB, so their rate has no software
+ * jitter. ADC_scan_get_stats() reports the PDB count at each frame interrupt
+ * (spread = delivery jitter), sequence errors (a pre-trigger found the ADC
+ * still busy: frame period too short for the channels and averaging) and
+ * interrupts served so late that the ring was full.
+ * Frames can also be queued for main: with a queue ring (elem_size
+ * sizeof(adc_scan_frame_t)) the interrupt converts each frame straight into
+ * the ring's next free slot (SPSC) or copies it in (MPSC). A full queue drops
+ * the frame and counts it in queue_drops.
+ */
+
+/* PDB0 channel 0 has 8 pre-triggers, for SC1[0..7] */
+#define ADC_SCAN_MAX_CHANNELS   8U
+#define ADC_SCAN_RING_FRAMES    4U
+/* eDMA channel, serviced by DMA0_IRQHandler */
+#define ADC_SCAN_DMA_CHANNEL    0U
+
+typedef struct {
+    uint32_t sequence;                      /* frame number since ADC_scan_start */
+    uint32_t count;                         /* channels in the frame */
+    uint32_t mv[ADC_SCAN_MAX_CHANNELS];     /* in ADC_scan_config_t channel order */
+} adc_scan_frame_t;
+
+/* Called from the DMA interrupt; the frame is only valid during the call. Optional with a queue */
+typedef void (*adc_scan_callback_t)(const adc_scan_frame_t *frame);
+
+typedef struct {
+    const uint8_t       *channels;          /* ADCH values, converted in this order */
+    uint32_t            count;              /* 1..ADC_SCAN_MAX_CHANNELS */
+    uint32_t            rate_hz;            /* frames per second */
+    uint32_t            average;            /* samples per result: 0 (off), 4, 8, 16, 32 */
+    adc_scan_callback_t callback;
+    Ring_t              *queue;             /* frames for main, or 0 */
+} adc_scan_config_t;
+
+typedef struct {
+    uint32_t frames;                        /* frames delivered */
+    uint32_t overruns;                      /* interrupts that found the ring full */
+    uint32_t seq_errors;                    /* pre-triggers that found the ADC busy */
+    uint32_t queue_drops;                   /* frames that found the queue full */
+    uint32_t latency_min;                   /* PDB counts from frame start to its interrupt */
+    uint32_t latency_max;
+    uint32_t period;                        /* PDB counts per frame */
+    uint32_t pdb_clock_hz;
+} adc_scan_stats_t;
+
+int32_t ADC_scan_init(const adc_scan_config_t *config);
+void ADC_scan_start(void);
+void ADC_scan_stop(void);
+void ADC_scan_get_stats(adc_scan_stats_t *stats);
+
+#endif /* ADC_SCAN_H_ */
@@ -1,5 +1,12 @@
 #include "S32K144.h"
 
+/* Crystal fitted on the S32K144 EVB */
+#define SOSC_FREQ_HZ    8000000UL
+#define SIRC_FREQ_HZ    8000000UL
+#define FIRC_FREQ_HZ    48000000UL
+
 void SOSC_init_8MHz(void);
 void SPLL_init_160MHz(void);
 void NormalRUNmode_80MHz(void);
+
+uint32_t SCG_GetSysClockFreq(void);
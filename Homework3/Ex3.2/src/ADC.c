@@ -1,11 +1,32 @@
 #include "ADC.h"
 
+/* mV per count in Q16, from the VREFSH reading; nominal until ADC_init measures it */
+uint32_t adc_scale_q16 = ((ADC_VREF_MV << 16) + (ADC_FULL_SCALE / 2U)) / ADC_FULL_SCALE;
+
+/**
+ * @brief Blocking software-triggered conversion
+ * 
+ * @param adcChan channel
+ * @return uint16_t raw result
+ */
+static uint16_t convert_blocking(uint16_t adcChan)
+{
+    convertADCchan(adcChan);
+    while(adc_complete() == 0)
+    {
+        /* Do nothing */
+    }
+    return (uint16_t)IP_ADC0->R[0];
+}
+
 /**
  * @brief Initialize the ADC peripheral
  * 
  */
 void ADC_init(void)
 {
+    uint16_t offset;
+
     /* Disable clock to change PCS */
     IP_PCC->PCCn[PCC_ADC0_INDEX] &= ~PCC_PCCn_CGC_MASK;
     /* PCS = 1: Select SOSCDIV2 */
@@ -38,6 +59,82 @@ void ADC_init(void)
     /* AVGE, AVGS=0: HW average function disabled */
     IP_ADC0->SC3 = 0x00000000;
 
+    ADC_calibrate();
+    /* Offset from VREFSL, then the gain reference from VREFSH with the offset removed */
+    offset = convert_blocking(ADC_VREFSL_CHANNEL);
+    /* USR_OFS is 8-bit two's complement, subtracted from every result */
+    IP_ADC0->USR_OFS = ADC_USR_OFS_USR_OFS((offset > 127U) ? 127U : offset);
+    ADC_set_reference(convert_blocking(ADC_VREFSH_CHANNEL));
+}
+
+/**
+ * @brief Self-calibration: the ADC computes its offset (OFS) and gain (G)
+ * 
+ * Runs with 32-sample averaging and software trigger, as the reference manual
+ * recommends, then restores SC2/SC3. Takes a few thousand ADC clocks.
+ */
+void ADC_calibrate(void)
+{
+    uint32_t sc2 = IP_ADC0->SC2;
+    uint32_t sc3 = IP_ADC0->SC3;
+
+    /* Clear the previous calibration results */
+    IP_ADC0->CLPS = 0;
+    IP_ADC0->CLP3 = 0;
+    IP_ADC0->CLP2 = 0;
+    IP_ADC0->CLP1 = 0;
+    IP_ADC0->CLP0 = 0;
+    IP_ADC0->CLPX = 0;
+    IP_ADC0->CLP9 = 0;
+    IP_ADC0->USR_OFS = 0;
+
+    IP_ADC0->SC2 = sc2 & ~ADC_SC2_ADTRG_MASK;
+    IP_ADC0->SC3 = ADC_SC3_CAL_MASK | ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(3);
+    /* CAL clears itself when the sequence is done */
+    while(IP_ADC0->SC3 & ADC_SC3_CAL_MASK)
+    {
+        /* Do nothing */
+    }
+    IP_ADC0->SC2 = sc2;
+    IP_ADC0->SC3 = sc3;
+}
+
+/**
+ * @brief Derive the mV scale from a VREFSH reading
+ * 
+ * VREFSH is VREFH, so its reading is what the converter makes of full scale:
+ * scaling by it instead of 0xFFF takes out the residual gain error. The one
+ * division is here; every sample is then a multiply and a shift.
+ * 
+ * @param vrefsh_raw raw VREFSH result, ignored below half scale
+ */
+void ADC_set_reference(uint16_t vrefsh_raw)
+{
+    if (vrefsh_raw < (ADC_FULL_SCALE / 2U))
+    {
+        return;
+    }
+    adc_scale_q16 = ((ADC_VREF_MV << 16) + (vrefsh_raw / 2U)) / vrefsh_raw;
+}
+
+/**
+ * @brief Convert a batch of raw results to mV
+ * 
+ * One scale for the whole batch and no dependency between iterations, so the
+ * loop vectorizes where the target has SIMD.
+ * 
+ * @param raw raw results
+ * @param mv results in mV (may be the same array as raw)
+ * @param count number of results
+ */
+void ADC_to_mv_batch(const uint32_t *raw, uint32_t *mv, uint32_t count)
+{
+    const uint32_t scale = adc_scale_q16;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        mv[i] = ((raw[i] * scale) + 0x8000U) >> 16;
+    }
 }
 
 /**
@@ -75,5 +172,5 @@ uint32_t read_ADC_chx(void)
     /* For SW trigger mode, R[0] is used */
     adc_result = IP_ADC0->R[0];
     /* Convert result to mV for 0-5V range */
-    return (uint32_t) ((5000*adc_result)/0xFFF);
+    return ADC_to_mv(adc_result);
 }
@@ -0,0 +1,173 @@
+#include "ADC_bands.h"
+#include "ADC.h"
+
+#define ADC_BANDS_IRQ_PRIORITY  2U
+
+/* Thresholds and hysteresis in raw counts, at the scale of ADC_init */
+static uint32_t threshold[ADC_BANDS_MAX - 1U];
+static uint32_t hysteresis = 0;
+static uint32_t band_count = 0;
+static uint32_t band = 0;
+static uint32_t wakeups = 0;
+static adc_bands_callback_t callback = 0;
+
+/**
+ * @brief mV to raw counts, the inverse of ADC_to_mv (setup only: divides)
+ *
+ * @param mv millivolts
+ * @return uint32_t raw counts, at most full scale
+ */
+static uint32_t mv_to_raw(uint32_t mv)
+{
+    uint32_t raw = ((mv << 16) + (adc_scale_q16 / 2U)) / adc_scale_q16;
+
+    return (raw > ADC_FULL_SCALE) ? ADC_FULL_SCALE : raw;
+}
+
+/**
+ * @brief Band of a raw reading, thresholds without hysteresis
+ *
+ * @param raw raw result
+ * @return uint32_t band index
+ */
+static uint32_t classify(uint32_t raw)
+{
+    uint32_t b = 0U;
+
+    while ((b < (band_count - 1U)) && (raw >= threshold[b]))
+    {
+        b++;
+    }
+    return b;
+}
+
+/**
+ * @brief Compare window of a band: results strictly outside [CV1, CV2] pass
+ *
+ * @param b band index
+ */
+static void set_window(uint32_t b)
+{
+    uint32_t low = 0U;
+    uint32_t high = ADC_FULL_SCALE;
+
+    /* Bands at the ends are open on their outer side */
+    if (b > 0U)
+    {
+        low = (threshold[b - 1U] > hysteresis) ? (threshold[b - 1U] - hysteresis) : 0U;
+    }
+    if (b < (band_count - 1U))
+    {
+        high = threshold[b] + hysteresis;
+        if (high > ADC_FULL_SCALE)
+        {
+            high = ADC_FULL_SCALE;
+        }
+    }
+    IP_ADC0->CV[0] = low;
+    IP_ADC0->CV[1] = high;
+}
+
+/**
+ * @brief Calibrate ADC0, classify the channel once and start watching it
+ *
+ * @param config channel, thresholds, hysteresis and callback
+ * @return int32_t 0 on success, -1 for an invalid table
+ */
+int32_t ADC_bands_init(const adc_bands_config_t *config)
+{
+    uint32_t raw;
+
+    if ((config->count < 2U) || (config->count > ADC_BANDS_MAX) || (config->callback == 0))
+    {
+        return -1;
+    }
+    for (uint32_t i = 1U; i < (config->count - 1U); i++)
+    {
+        if (config->thresholds_mv[i] <= config->thresholds_mv[i - 1U])
+        {
+            return -1;
+        }
+    }
+
+    ADC_init();
+    for (uint32_t i = 0U; i < (config->count - 1U); i++)
+    {
+        threshold[i] = mv_to_raw(config->thresholds_mv[i]);
+    }
+    hysteresis = mv_to_raw(config->hysteresis_mv);
+    band_count = config->count;
+    callback = config->callback;
+    wakeups = 0U;
+
+    /* Starting band from one plain conversion */
+    convertADCchan(config->channel);
+    while(adc_complete() == 0)
+    {
+        /* Do nothing */
+    }
+    raw = IP_ADC0->R[0];
+    band = classify(raw);
+    callback(band, ADC_to_mv(raw));
+
+    /* ACFE + ACREN, ACFGT=0: only results outside the window complete */
+    set_window(band);
+    IP_ADC0->SC2 = ADC_SC2_ACFE_MASK | ADC_SC2_ACREN_MASK;
+    IP_ADC0->SC3 |= ADC_SC3_ADCO_MASK;
+    NVIC_SetPriority(ADC0_IRQn, ADC_BANDS_IRQ_PRIORITY);
+    NVIC_EnableIRQ(ADC0_IRQn);
+    /* Writing SC1[0] starts the continuous conversions */
+    IP_ADC0->SC1[0] = ADC_SC1_AIEN_MASK | ADC_SC1_ADCH(config->channel);
+    return 0;
+}
+
+/**
+ * @brief Stop the conversions and the compare function
+ *
+ */
+void ADC_bands_stop(void)
+{
+    NVIC_DisableIRQ(ADC0_IRQn);
+    IP_ADC0->SC3 &= ~ADC_SC3_ADCO_MASK;
+    IP_ADC0->SC1[0] = ADC_SC1_ADCH_MASK;
+    IP_ADC0->SC2 = 0U;
+}
+
+/**
+ * @brief Current band
+ *
+ * @return uint32_t band index
+ */
+uint32_t ADC_bands_current(void)
+{
+    return band;
+}
+
+/**
+ * @brief ADC0 interrupts taken, for idle-load checks
+ *
+ * @return uint32_t count since ADC_bands_init
+ */
+uint32_t ADC_bands_wakeups(void)
+{
+    return wakeups;
+}
+
+/**
+ * @brief A result left the window: new band
+ *
+ */
+void ADC0_IRQHandler(void)
+{
+    /* Reading R[0] clears COCO */
+    uint32_t raw = IP_ADC0->R[0];
+    uint32_t b = classify(raw);
+
+    wakeups++;
+    if (b != band)
+    {
+        band = b;
+        set_window(b);
+        callback(b, ADC_to_mv(raw));
+    }
+}
@@ -0,0 +1,329 @@
+#include "ADC_scan.h"
+#include "ADC.h"
+#include "S32K144_features.h"
+#include "clocks_and_modes.h"
+
+#define ADC_SCAN_IRQ_PRIORITY   2U
+#define ADC_SCAN_FRAME_BYTES    (ADC_SCAN_MAX_CHANNELS * 4U)
+/* PDB0 SC[TRGSEL] = 15: software trigger */
+#define ADC_SCAN_PDB_SWTRIG     15U
+
+/* eDMA TCD as laid out in memory, loaded by the engine on scatter/gather */
+typedef struct {
+    uint32_t SADDR;
+    int16_t  SOFF;
+    uint16_t ATTR;
+    uint32_t NBYTES;
+    int32_t  SLAST;
+    uint32_t DADDR;
+    int16_t  DOFF;
+    uint16_t CITER;
+    int32_t  DLASTSGA;
+    uint16_t CSR;
+    uint16_t BITER;
+} adc_scan_tcd_t;
+
+/* One TCD per ring frame, each one chaining to the next */
+static adc_scan_tcd_t tcd[ADC_SCAN_RING_FRAMES] __attribute__((aligned(32)));
+static volatile uint32_t ring[ADC_SCAN_RING_FRAMES][ADC_SCAN_MAX_CHANNELS];
+
+static adc_scan_callback_t callback = 0;
+static Ring_t *queue = 0;
+static uint32_t channel_count = 0;
+/* Position of VREFSH in the scan list, ADC_SCAN_MAX_CHANNELS if absent */
+static uint32_t vrefsh_slot = ADC_SCAN_MAX_CHANNELS;
+static uint32_t vrefsh_raw = 0;
+/* Next ring frame to deliver */
+static uint32_t read_frame = 0;
+static adc_scan_frame_t frame;
+static adc_scan_stats_t stats;
+
+/**
+ * @brief PDB0 divider for a frame rate: smallest PRESCALER x MULT with MOD in 16 bits
+ *
+ * @param clock PDB0 input clock (SYS_CLK)
+ * @param rate_hz frame rate
+ * @param sc returns the SC PRESCALER and MULT fields
+ * @param count_hz returns the PDB counter frequency
+ * @return uint32_t PDB counts per frame, 0 if the rate cannot be reached
+ */
+static uint32_t pdb_period(uint32_t clock, uint32_t rate_hz, uint32_t *sc, uint32_t *count_hz)
+{
+    static const uint32_t mult[4] = { 1U, 10U, 20U, 40U };
+    uint32_t best_div = 0U;
+
+    for (uint32_t m = 0U; m < 4U; m++)
+    {
+        for (uint32_t p = 0U; p < 8U; p++)
+        {
+            uint32_t div = mult[m] << p;
+            uint32_t counts = clock / div / rate_hz;
+
+            if ((counts >= 2U) && (counts <= 0x10000U) && ((best_div == 0U) || (div < best_div)))
+            {
+                best_div = div;
+                *sc = PDB_SC_PRESCALER(p) | PDB_SC_MULT(m);
+            }
+        }
+    }
+
+    if (best_div == 0U)
+    {
+        return 0U;
+    }
+    *count_hz = clock / best_div;
+    return *count_hz / rate_hz;
+}
+
+/**
+ * @brief Point the hardware TCD at ring frame 0
+ *
+ */
+static void dma_load_first(void)
+{
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].CSR           = 0U;
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].SADDR         = tcd[0].SADDR;
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].SOFF          = (uint16_t)tcd[0].SOFF;
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].ATTR          = tcd[0].ATTR;
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].NBYTES.MLNO   = tcd[0].NBYTES;
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].SLAST         = tcd[0].SLAST;
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].DADDR         = tcd[0].DADDR;
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].DOFF          = (uint16_t)tcd[0].DOFF;
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].CITER.ELINKNO = tcd[0].CITER;
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].DLASTSGA      = (uint32_t)tcd[0].DLASTSGA;
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].BITER.ELINKNO = tcd[0].BITER;
+    IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].CSR           = tcd[0].CSR;
+}
+
+/**
+ * @brief Set up ADC0, PDB0 and the DMA ring for a scan (not started)
+ *
+ * @param config channels, frame rate, averaging and callback
+ * @return int32_t 0 on success, -1 for an invalid configuration or clock
+ */
+int32_t ADC_scan_init(const adc_scan_config_t *config)
+{
+    uint32_t en = (1UL << config->count) - 1U;
+    uint32_t sc = 0U;
+    uint32_t count_hz = 0U;
+    uint32_t period;
+    uint32_t sc3 = 0U;
+
+    if ((config->count == 0U) || (config->count > ADC_SCAN_MAX_CHANNELS) ||
+        (config->rate_hz == 0U) || ((config->callback == 0) && (config->queue == 0)) ||
+        ((config->queue != 0) && (config->queue->elem_size != sizeof(adc_scan_frame_t))))
+    {
+        return -1;
+    }
+    switch (config->average)
+    {
+        case 0U:  sc3 = 0U; break;
+        case 4U:  sc3 = ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(0); break;
+        case 8U:  sc3 = ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(1); break;
+        case 16U: sc3 = ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(2); break;
+        case 32U: sc3 = ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(3); break;
+        default:  return -1;
+    }
+    period = pdb_period(SCG_GetSysClockFreq(), config->rate_hz, &sc, &count_hz);
+    if (period == 0U)
+    {
+        return -1;
+    }
+    callback = config->callback;
+    queue = config->queue;
+    channel_count = config->count;
+    vrefsh_slot = ADC_SCAN_MAX_CHANNELS;
+    for (uint32_t k = 0U; k < config->count; k++)
+    {
+        if (config->channels[k] == ADC_VREFSH_CHANNEL)
+        {
+            vrefsh_slot = k;
+        }
+    }
+
+    /* ADC0: hardware trigger, a DMA request per result, averaging */
+    ADC_init();
+    IP_ADC0->SC2 = ADC_SC2_ADTRG_MASK | ADC_SC2_DMAEN_MASK;
+    IP_ADC0->SC3 = sc3;
+    for (uint32_t k = 0U; k < ADC_SCAN_MAX_CHANNELS; k++)
+    {
+        IP_ADC0->SC1[k] = (k < config->count) ? ADC_SC1_ADCH(config->channels[k]) : ADC_SC1_ADCH_MASK;
+    }
+
+    /* PDB0: continuous; pre-trigger 0 at the start of the frame, the rest back-to-back */
+    IP_PCC->PCCn[PCC_PDB0_INDEX] |= PCC_PCCn_CGC_MASK;
+    IP_PDB0->SC = 0U;
+    IP_PDB0->SC = sc | PDB_SC_TRGSEL(ADC_SCAN_PDB_SWTRIG) | PDB_SC_CONT_MASK | PDB_SC_PDBEN_MASK;
+    IP_PDB0->MOD = period - 1U;
+    IP_PDB0->CH[0].DLY[0] = 0U;
+    IP_PDB0->CH[0].C1 = PDB_C1_EN(en) | PDB_C1_TOS(1U) | PDB_C1_BB(en & ~1UL);
+    IP_PDB0->SC |= PDB_SC_LDOK_MASK;
+
+    /* eDMA: R[0..n-1] into ring frame f, then load the TCD of frame f + 1 */
+    for (uint32_t f = 0U; f < ADC_SCAN_RING_FRAMES; f++)
+    {
+        tcd[f].SADDR    = (uint32_t)(uintptr_t)&IP_ADC0->R[0];
+        tcd[f].SOFF     = 4;
+        tcd[f].ATTR     = DMA_TCD_ATTR_SSIZE(2) | DMA_TCD_ATTR_DSIZE(2);
+        tcd[f].NBYTES   = 4U;
+        tcd[f].SLAST    = -(int32_t)(4U * config->count);
+        tcd[f].DADDR    = (uint32_t)(uintptr_t)&ring[f][0];
+        tcd[f].DOFF     = 4;
+        tcd[f].CITER    = (uint16_t)config->count;
+        tcd[f].BITER    = (uint16_t)config->count;
+        tcd[f].DLASTSGA = (int32_t)(uintptr_t)&tcd[(f + 1U) % ADC_SCAN_RING_FRAMES];
+        tcd[f].CSR      = DMA_TCD_CSR_INTMAJOR_MASK | DMA_TCD_CSR_ESG_MASK;
+    }
+    IP_PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;
+    IP_DMA->CERQ = ADC_SCAN_DMA_CHANNEL;
+    IP_DMAMUX->CHCFG[ADC_SCAN_DMA_CHANNEL] = 0U;
+    dma_load_first();
+    IP_DMAMUX->CHCFG[ADC_SCAN_DMA_CHANNEL] = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(EDMA_REQ_ADC0);
+
+    stats.period = period;
+    stats.pdb_clock_hz = count_hz;
+
+    NVIC_SetPriority((IRQn_Type)(DMA0_IRQn + ADC_SCAN_DMA_CHANNEL), ADC_SCAN_IRQ_PRIORITY);
+    NVIC_EnableIRQ((IRQn_Type)(DMA0_IRQn + ADC_SCAN_DMA_CHANNEL));
+    return 0;
+}
+
+/**
+ * @brief Start scanning from ring frame 0; statistics are cleared
+ *
+ */
+void ADC_scan_start(void)
+{
+    read_frame = 0U;
+    frame.sequence = 0U;
+    stats.frames = 0U;
+    stats.overruns = 0U;
+    stats.seq_errors = 0U;
+    stats.latency_min = 0xFFFFFFFFUL;
+    stats.latency_max = 0U;
+
+    /* Results left over from a previous run would hold COCO */
+    for (uint32_t k = 0U; k < channel_count; k++)
+    {
+        (void)IP_ADC0->R[k];
+    }
+    IP_PDB0->CH[0].S = 0U;
+    dma_load_first();
+    IP_DMA->SERQ = ADC_SCAN_DMA_CHANNEL;
+    IP_PDB0->SC |= PDB_SC_PDBEN_MASK;
+    IP_PDB0->SC |= PDB_SC_SWTRIG_MASK;
+}
+
+/**
+ * @brief Stop the frame trigger and the DMA channel
+ *
+ */
+void ADC_scan_stop(void)
+{
+    IP_PDB0->SC &= ~PDB_SC_PDBEN_MASK;
+    IP_DMA->CERQ = ADC_SCAN_DMA_CHANNEL;
+}
+
+/**
+ * @brief Copy of the scan statistics
+ *
+ * @param out frames, ring-full events, sequence errors and frame interrupt latency
+ */
+void ADC_scan_get_stats(adc_scan_stats_t *out)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *out = stats;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief End of one or more frames: convert them to mV and deliver them
+ *
+ */
+void DMA0_IRQHandler(void)
+{
+    /* Counts since the start of the current frame, read first */
+    uint32_t latency = IP_PDB0->CNT;
+    uint32_t err = IP_PDB0->CH[0].S & PDB_S_ERR_MASK;
+    uint32_t write;
+    uint32_t pending;
+    adc_scan_frame_t *out;
+    void *span;
+
+    IP_DMA->CINT = ADC_SCAN_DMA_CHANNEL;
+    if (err != 0U)
+    {
+        stats.seq_errors += (uint32_t)__builtin_popcount(err);
+        /* ERR is cleared by writing 0, CF kept by writing 1 */
+        IP_PDB0->CH[0].S = PDB_S_CF_MASK | (PDB_S_ERR_MASK & ~err);
+    }
+
+    /* Frame the DMA is filling now: every frame before it is complete */
+    write = (IP_DMA->TCD[ADC_SCAN_DMA_CHANNEL].DADDR - (uint32_t)(uintptr_t)&ring[0][0]) / ADC_SCAN_FRAME_BYTES;
+    pending = (write + ADC_SCAN_RING_FRAMES - read_frame) % ADC_SCAN_RING_FRAMES;
+    if (pending == 0U)
+    {
+        /* Frames that ended after CINT were delivered by the previous run */
+        return;
+    }
+    if (pending == (ADC_SCAN_RING_FRAMES - 1U))
+    {
+        /* The DMA is filling the last free frame: one more and it overwrites */
+        stats.overruns++;
+    }
+    else if (pending == 1U)
+    {
+        if (latency < stats.latency_min)
+        {
+            stats.latency_min = latency;
+        }
+        if (latency > stats.latency_max)
+        {
+            stats.latency_max = latency;
+        }
+    }
+
+    while (read_frame != write)
+    {
+        /* Complete frames are no longer written by the DMA */
+        const uint32_t *raw = (const uint32_t *)ring[read_frame];
+
+        /* A VREFSH sample in the frame keeps the mV scale live */
+        if ((vrefsh_slot < channel_count) && (raw[vrefsh_slot] != vrefsh_raw))
+        {
+            vrefsh_raw = raw[vrefsh_slot];
+            ADC_set_reference((uint16_t)vrefsh_raw);
+        }
+        /* An SPSC queue takes the conversion straight into its next slot */
+        out = &frame;
+        span = 0;
+        if ((queue != 0) && (RING_WriteSpan(queue, &span) != 0U))
+        {
+            out = (adc_scan_frame_t *)span;
+            out->sequence = frame.sequence;
+        }
+        else
+        {
+            span = 0;
+        }
+        out->count = channel_count;
+        ADC_to_mv_batch(raw, out->mv, channel_count);
+        if (callback != 0)
+        {
+            callback(out);
+        }
+        if (span != 0)
+        {
+            RING_WriteCommit(queue, 1U);
+        }
+        else if ((queue != 0) && (RING_Push(queue, out, 1U) == 0U))
+        {
+            stats.queue_drops++;
+        }
+        frame.sequence++;
+        stats.frames++;
+        read_frame = (read_frame + 1U) % ADC_SCAN_RING_FRAMES;
+    }
+}
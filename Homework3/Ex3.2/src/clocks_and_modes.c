@@ -1,5 +1,18 @@
 #include "clocks_and_modes.h"
 
+/* Polls of a status flag before giving up (> 5 ms on FIRC): a missing
+ * crystal leaves the core on FIRC instead of hanging the boot */
+#define SCG_POLL_LIMIT  100000UL
+
+/* Wait until (*reg & mask) == value, at most SCG_POLL_LIMIT reads */
+static void scg_wait(const volatile uint32_t *reg, uint32_t mask, uint32_t value)
+{
+    for (uint32_t n = 0U; (n < SCG_POLL_LIMIT) && ((*reg & mask) != value); n++)
+    {
+        /* Do nothing */
+    }
+}
+
 void SOSC_init_8MHz(void) 
 {
     /* SOSCDIV1 & SOSCDIV2 = 1: divide by 1 */
@@ -9,7 +22,7 @@ void SOSC_init_8MHz(void)
     /* EREFS=1: Input is external XTAL */
     IP_SCG->SOSCCFG = 0x00000024;
     /* Ensure SOSCCSR unlocked */
-    while(IP_SCG->SOSCCSR & SCG_SOSCCSR_LK_MASK);
+    scg_wait(&IP_SCG->SOSCCSR, SCG_SOSCCSR_LK_MASK, 0U);
     /* LK=0: SOSCCSR can be written */
     /* SOSCCMRE=0: OSC CLK monitor IRQ if enabled */
     /* SOSCCM=0: OSC CLK monitor disabled */
@@ -19,13 +32,13 @@ void SOSC_init_8MHz(void)
     /* SOSCEN=1: Enable oscillator */
     IP_SCG->SOSCCSR = 0x00000001;
     /* Wait for sys OSC clk valid */
-    while(!(IP_SCG->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK)); 
+    scg_wait(&IP_SCG->SOSCCSR, SCG_SOSCCSR_SOSCVLD_MASK, SCG_SOSCCSR_SOSCVLD_MASK);
 }
 
 void SPLL_init_160MHz(void)
 {
     /* Ensure SPLLCSR unlocked */
-    while(IP_SCG->SPLLCSR & SCG_SPLLCSR_LK_MASK);
+    scg_wait(&IP_SCG->SPLLCSR, SCG_SPLLCSR_LK_MASK, 0U);
     /* SPLLEN=0: SPLL is disabled (default) */
     IP_SCG->SPLLCSR = 0x00;
     /* SPLLDIV1 divide by 2; SPLLDIV2 divide by 4 */
@@ -35,7 +48,7 @@ void SPLL_init_160MHz(void)
     /* SPLL_CLK = 8MHz / 1 * 40 / 2 = 160 MHz */
     IP_SCG->SPLLCFG = 0x00180000;
     /*Ensure SPLLCSR unlocked */
-    while(IP_SCG->SPLLCSR & SCG_SPLLCSR_LK_MASK);
+    scg_wait(&IP_SCG->SPLLCSR, SCG_SPLLCSR_LK_MASK, 0U);
     /* LK=0: SPLLCSR can be written */
     /* SPLLCMRE=0: SPLL CLK monitor IRQ if enabled */
     /* SPLLCM=0: SPLL CLK monitor disabled */
@@ -43,7 +56,7 @@ void SPLL_init_160MHz(void)
     /* SPLLEN=1: Enable SPLL */
     IP_SCG->SPLLCSR = 0x00000001;
     /* Wait for SPLL valid */
-    while(!(IP_SCG->SPLLCSR & SCG_SPLLCSR_SPLLVLD_MASK)); 
+    scg_wait(&IP_SCG->SPLLCSR, SCG_SPLLCSR_SPLLVLD_MASK, SCG_SPLLCSR_SPLLVLD_MASK);
 }
 
 /* Change to normal RUN mode with 8MHz SOSC, 80 MHz PLL*/
@@ -53,6 +66,43 @@ void NormalRUNmode_80MHz (void) {
     |SCG_RCCR_DIVCORE(0b01) /* DIVCORE=1, div. by 2: Core clock = 160/2 MHz = 80 MHz*/
     |SCG_RCCR_DIVBUS(0b01) /* DIVBUS=1, div. by 2: bus clock = 40 MHz*/
     |SCG_RCCR_DIVSLOW(0b10); /* DIVSLOW=2, div. by 3: SCG slow, flash clock= 26 2/3 MHz*/
-while (((IP_SCG->CSR & SCG_CSR_SCS_MASK) >> SCG_CSR_SCS_SHIFT ) != 6) {}
-/* Wait for sys clk src = SPLL */
-}
\ No newline at end of file
+    /* Wait for sys clk src = SPLL; it stays FIRC if the SPLL is not valid */
+    scg_wait(&IP_SCG->CSR, SCG_CSR_SCS_MASK, SCG_CSR_SCS(6));
+}
+
+/**
+ * @brief Frequency of SYS_CLK (core clock), from the running system clock source
+ * 
+ * @return uint32_t frequency in Hz, 0 for an unknown source
+ */
+uint32_t SCG_GetSysClockFreq(void)
+{
+    uint32_t csr = IP_SCG->CSR;
+    uint32_t freq;
+
+    switch ((csr & SCG_CSR_SCS_MASK) >> SCG_CSR_SCS_SHIFT)
+    {
+        case 1U:
+            freq = SOSC_FREQ_HZ;
+            break;
+        case 2U:
+            freq = SIRC_FREQ_HZ;
+            break;
+        case 3U:
+            freq = FIRC_FREQ_HZ;
+            break;
+        case 6U:
+        {
+            /* SPLL_CLK = SOSC / (PREDIV + 1) * (MULT + 16) / 2 */
+            uint32_t prediv = ((IP_SCG->SPLLCFG & SCG_SPLLCFG_PREDIV_MASK) >> SCG_SPLLCFG_PREDIV_SHIFT) + 1U;
+            uint32_t mult   = ((IP_SCG->SPLLCFG & SCG_SPLLCFG_MULT_MASK) >> SCG_SPLLCFG_MULT_SHIFT) + 16U;
+
+            freq = ((SOSC_FREQ_HZ / prediv) * mult) / 2U;
+            break;
+        }
+        default:
+            return 0U;
+    }
+
+    return freq / (((csr & SCG_CSR_DIVCORE_MASK) >> SCG_CSR_DIVCORE_SHIFT) + 1U);
+}
@@ -8,13 +8,20 @@
 #include "S32K144.h"
 #include "clocks_and_modes.h"
 #include "ADC.h"
+#include "ADC_bands.h"
+#include "driver_event.h"
 
 #define PTD15 15 /* LED RED */
 #define PTD16 16 /* LED GREEN */
 #define PTD0 0   /* LED BLUE */
 
+/* Event signals */
+#define SIG_POT_BAND    0U
+
+/* Last pot reading seen by main */
 uint32_t adcResultInMv_pot = 0;
-uint32_t adcResultInMv_Vrefsh = 0;
+/* Dispatch latency and idle time, refreshed on every band change */
+Event_Stats_t event_stats;
 
 void GPIO_init(void) {
     /* Enable clock for PORTD */
@@ -33,54 +40,39 @@ void GPIO_init(void) {
     IP_PTD->PDDR |= 1 << PTD16;
 }
 
-int main(void) {
-    
-    GPIO_init();
-    ADC_init();
+/* Pot bands: off, blue above 1250 mV, green above 2500 mV, red above 3750 mV */
+static const uint32_t pot_thresholds_mv[3] = { 1250, 2500, 3750 };
+/* LED lit in each band (active low), 0 for none */
+static const uint32_t band_led[4] = { 0, 1<<PTD0, 1<<PTD16, 1<<PTD15 };
 
-    while (1) {
-        /* Convert channel AD12 to port on EVB */
-        convertADCchan(12);
-        /* Wait for conversion complete flag */
-        while(adc_complete() == 0)
-        {
-            /*Do nothing*/
-        }
-        /* Get channel's conversion results in mV */
-        adcResultInMv_pot = read_ADC_chx();
+/* ADC0 interrupt, only when the pot enters another band: band in the top half, mV below */
+void Pot_band(uint32_t band, uint32_t mv) {
+    EVENT_Post(SIG_POT_BAND, (band << 16) | mv);
+}
 
-        if(adcResultInMv_pot > 3750)        /* If result > 3750mV */
-        {
-            /* turn off blue, green LEDs */
-            IP_PTD->PSOR |= 1<<PTD0 | 1<<PTD16;
-            /* turn on red LED */
-            IP_PTD->PCOR |= 1<<PTD15; 
-        } else if(adcResultInMv_pot > 2500) /* If result > 2500mV */
-        {
-            /* turn off blue, red LEDs */
-            IP_PTD->PSOR |= 1<<PTD0 | 1<<PTD15;
-            /* turn on green LED */
-            IP_PTD->PCOR |= 1<<PTD16;
-        } else if(adcResultInMv_pot > 1250) /* If result > 1250mV */
-        {
-            /* turn off red, green LEDs */
-            IP_PTD->PSOR |= 1<<PTD15 | 1<<PTD16;
-            /* turn on blue LED */
-            IP_PTD->PCOR |= 1<<PTD0;
-        } else 
-        {
-            /* Turn off all LEDs */
-            IP_PTD->PSOR |= 1<<PTD0 | 1<<PTD15 | 1<<PTD16;
-        }
-        /* Convert channel 29, Vrefsh */
-        convertADCchan(29);
-        /* Wait for conversion complete flag */
-        while(adc_complete() == 0)
-        {
-            /* Do nothing */
-        }
-        /* Get channel's conversion results in mV */
-        adcResultInMv_Vrefsh = read_ADC_chx();
-    }
+/* Runs in main: two writes per change */
+void LED_band(uint32_t signal, uint32_t param) {
+    adcResultInMv_pot = param & 0xFFFFU;
+    /* turn off all LEDs, then turn on the one of the band */
+    IP_PTD->PSOR = 1<<PTD0 | 1<<PTD15 | 1<<PTD16;
+    IP_PTD->PCOR = band_led[param >> 16];
+    EVENT_GetStats(&event_stats);
+}
+
+int main(void) {
+    const adc_bands_config_t pot = {
+        12, pot_thresholds_mv, 4, 50, Pot_band
+    };
+
+    SOSC_init_8MHz();
+    SPLL_init_160MHz();
+    NormalRUNmode_80MHz();
+    GPIO_init();
+    EVENT_Init();
+    EVENT_Subscribe(SIG_POT_BAND, 0U, LED_band);
+    /* Calibrates ADC0 and measures VREFSH (AD29), then watches AD12 with 50 mV hysteresis */
+    ADC_bands_init(&pot);
 
+    /* The ADC compare function wakes the core only on a band change */
+    EVENT_Run();
 }
@@ -0,0 +1,157 @@
+/*
+ * Host test of the ADC compare-window band classifier on the simulated ADC0.
+ *
+ * Four bands at 1250, 2500 and 3750 mV, 50 mV of hysteresis; the pot input
+ * changes every 100 us.
+ *  - Steady inside a band: conversions run, the core is never interrupted.
+ *  - Noise on a threshold smaller than the hysteresis: at most the one
+ *    interrupt entering the band, then none.
+ *  - Noise beyond the hysteresis: interrupts, each one a band change.
+ *  - A sweep 0 -> 5000 -> 0 mV: one interrupt per threshold crossing.
+ *
+ *   gcc -O2 -Wall -Wextra -DHOST_SIM -Iinclude -I../../assignment_2/include \
+ *       tests/test_adc_bands.c ../../assignment_2/src/host_sim.c src/ADC.c src/ADC_bands.c \
+ *       src/clocks_and_modes.c -o test_adc_bands && ./test_adc_bands
+ */
+#include "ADC.h"
+#include "ADC_bands.h"
+#include "clocks_and_modes.h"
+#include <stdio.h>
+
+#define POT_CHANNEL         12U
+#define VREFSH_CHANNEL      29U
+#define STEP_NS             100000ULL
+
+static const uint32_t thresholds[3] = { 1250U, 2500U, 3750U };
+
+static uint32_t changes;
+static uint32_t last_band;
+static uint32_t seed = 1U;
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+typedef struct {
+    uint32_t conversions;
+    uint32_t wakeups;
+    uint32_t changes;
+} delta_t;
+
+static void on_band(uint32_t band, uint32_t mv)
+{
+    (void)mv;
+    changes++;
+    last_band = band;
+}
+
+static uint32_t rnd(void)
+{
+    seed = (seed * 1103515245U) + 12345U;
+    return (seed >> 16) & 0x7FFFU;
+}
+
+static void set_mv(int32_t mv)
+{
+    if (mv < 0)
+    {
+        mv = 0;
+    }
+    if (mv > (int32_t)ADC_VREF_MV)
+    {
+        mv = (int32_t)ADC_VREF_MV;
+    }
+    SIM_ADC_SetInput(POT_CHANNEL, (uint16_t)(((uint32_t)mv * ADC_FULL_SCALE) / ADC_VREF_MV));
+}
+
+static delta_t mark(void)
+{
+    return (delta_t){ SIM_ADC_GetConversionCount(), ADC_bands_wakeups(), changes };
+}
+
+static delta_t since(delta_t start)
+{
+    delta_t now = mark();
+
+    return (delta_t){ now.conversions - start.conversions, now.wakeups - start.wakeups,
+                      now.changes - start.changes };
+}
+
+/* center +- noise mV, a new value every 100 us */
+static delta_t run(const char *name, int32_t center, uint32_t noise, uint32_t ms)
+{
+    delta_t start = mark();
+    delta_t d;
+
+    for (uint32_t t = 0U; t < (ms * 10U); t++)
+    {
+        int32_t offset = (noise != 0U) ? ((int32_t)(rnd() % ((2U * noise) + 1U)) - (int32_t)noise) : 0;
+
+        set_mv(center + offset);
+        SIM_Advance(STEP_NS);
+    }
+    d = since(start);
+    printf("%-36s %6u conversions, %4u interrupts, %3u band changes, band %u\n",
+           name, d.conversions, d.wakeups, d.changes, last_band);
+    return d;
+}
+
+int main(void)
+{
+    adc_bands_config_t config = { POT_CHANNEL, thresholds, 4U, 50U, on_band };
+    delta_t start;
+    delta_t d;
+
+    SIM_Init();
+    SOSC_init_8MHz();
+    SPLL_init_160MHz();
+    NormalRUNmode_80MHz();
+    SIM_ADC_SetInput(VREFSH_CHANNEL, ADC_FULL_SCALE);
+    set_mv(1000);
+
+    CHECK(ADC_bands_init(&config) == 0);
+    CHECK((ADC_bands_current() == 0U) && (changes == 1U) && (last_band == 0U));
+
+    d = run("steady 1000 mV, 100 ms", 1000, 0U, 100U);
+    CHECK(d.conversions > 20000U);
+    CHECK((d.wakeups == 0U) && (d.changes == 0U));
+
+    d = run("2500 mV +-30 mV, inside hysteresis", 2500, 30U, 100U);
+    CHECK((d.wakeups <= 1U) && (d.changes == d.wakeups));
+
+    d = run("2500 mV +-120 mV, beyond hysteresis", 2500, 120U, 100U);
+    CHECK(d.wakeups > 10U);
+    CHECK(d.changes == d.wakeups);
+
+    start = mark();
+    for (int32_t mv = 0; mv <= (int32_t)ADC_VREF_MV; mv += 5)
+    {
+        set_mv(mv);
+        SIM_Advance(STEP_NS);
+    }
+    CHECK(ADC_bands_current() == 3U);
+    for (int32_t mv = (int32_t)ADC_VREF_MV; mv >= 0; mv -= 5)
+    {
+        set_mv(mv);
+        SIM_Advance(STEP_NS);
+    }
+    d = since(start);
+    printf("%-36s %6u conversions, %4u interrupts, %3u band changes, band %u\n",
+           "sweep 0 -> 5000 -> 0 mV", d.conversions, d.wakeups, d.changes, last_band);
+    /* Up to band 3 and back down to 0, from wherever the noise left it */
+    CHECK((d.wakeups >= 6U) && (d.wakeups <= 7U) && (d.changes == d.wakeups));
+    CHECK((ADC_bands_current() == 0U) && (last_band == 0U));
+
+    ADC_bands_stop();
+    start = mark();
+    SIM_Advance(10000000ULL);
+    CHECK(since(start).conversions == 0U);
+
+    printf("%s\n", (failures == 0) ? "PASS" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
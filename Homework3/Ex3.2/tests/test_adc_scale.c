@@ -0,0 +1,141 @@
+/*
+ * Host check of the ADC scaling: accuracy against a reference table and
+ * cycles per converted sample, before (divide by 0xFFF) and after (Q16).
+ *
+ *   gcc -O2 -Wall -Wextra -Iinclude tests/test_adc_scale.c src/ADC.c -o test_adc_scale && ./test_adc_scale
+ *
+ * Build with -O0 as well, the S32DS Debug setting: GCC -O2 turns the old
+ * constant division into a multiply, which the Debug build never does.
+ */
+#include "ADC.h"
+#include <stdio.h>
+
+#define BENCH_SAMPLES       4096U
+#define BENCH_ROUNDS        200U
+
+/* VREFSH readings: nominal, the model's, and the spread a real board shows */
+static const uint16_t vrefsh_table[] = { 2048U, 2500U, 3000U, 3500U, 3900U, 4000U, 4090U, 4095U };
+
+static uint32_t raw[BENCH_SAMPLES];
+static uint32_t mv[BENCH_SAMPLES];
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static inline uint64_t tsc(void)
+{
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/* The conversion before the Q16 scale */
+__attribute__((noinline)) static uint32_t old_to_mv(uint32_t r)
+{
+    return (5000U * r) / 0xFFFU;
+}
+
+/* Every raw value against the exact raw * 5000 / vrefsh */
+static void test_accuracy(void)
+{
+    double worst_old = 0.0;
+
+    for (uint32_t v = 0U; v < (sizeof(vrefsh_table) / sizeof(vrefsh_table[0])); v++)
+    {
+        uint16_t vrefsh = vrefsh_table[v];
+        double worst = 0.0;
+        uint32_t batch[ADC_FULL_SCALE + 1U];
+
+        ADC_set_reference(vrefsh);
+        for (uint32_t r = 0U; r <= ADC_FULL_SCALE; r++)
+        {
+            batch[r] = r;
+        }
+        ADC_to_mv_batch(batch, batch, ADC_FULL_SCALE + 1U);
+
+        for (uint32_t r = 0U; r <= ADC_FULL_SCALE; r++)
+        {
+            double exact = ((double)r * ADC_VREF_MV) / vrefsh;
+            double err = (double)ADC_to_mv(r) - exact;
+
+            err = (err < 0.0) ? -err : err;
+            if (err > worst)
+            {
+                worst = err;
+            }
+            CHECK(batch[r] == ADC_to_mv(r));
+            if ((vrefsh == ADC_FULL_SCALE) && ((((double)old_to_mv(r)) - exact) < -worst_old))
+            {
+                worst_old = exact - (double)old_to_mv(r);
+            }
+        }
+        /* Rounding to whole mV, plus what Q16 loses on the scale */
+        CHECK(worst < 0.53);
+        printf("VREFSH %4u: scale %6u Q16, max error %.3f mV\n", vrefsh, adc_scale_q16, worst);
+    }
+    printf("old 5000 * raw / 0xFFF: max error %.3f mV (truncates)\n", worst_old);
+
+    /* Below half scale the reading is taken as a fault and the scale is kept */
+    ADC_set_reference(4000U);
+    ADC_set_reference(1000U);
+    CHECK(adc_scale_q16 == (((ADC_VREF_MV << 16) + 2000U) / 4000U));
+}
+
+static void bench(void)
+{
+    uint64_t best[3] = { UINT64_MAX, UINT64_MAX, UINT64_MAX };
+    uint32_t sum = 0U;
+
+    ADC_set_reference(ADC_FULL_SCALE);
+    for (uint32_t i = 0U; i < BENCH_SAMPLES; i++)
+    {
+        raw[i] = (i * 2654435761U) >> 20;
+    }
+    for (uint32_t r = 0U; r < BENCH_ROUNDS; r++)
+    {
+        uint64_t t;
+
+        t = tsc();
+        for (uint32_t i = 0U; i < BENCH_SAMPLES; i++)
+        {
+            mv[i] = old_to_mv(raw[i]);
+        }
+        t = tsc() - t;
+        best[0] = (t < best[0]) ? t : best[0];
+        sum += mv[r];
+
+        t = tsc();
+        for (uint32_t i = 0U; i < BENCH_SAMPLES; i++)
+        {
+            mv[i] = ADC_to_mv(raw[i]);
+        }
+        t = tsc() - t;
+        best[1] = (t < best[1]) ? t : best[1];
+        sum += mv[r];
+
+        t = tsc();
+        ADC_to_mv_batch(raw, mv, BENCH_SAMPLES);
+        t = tsc() - t;
+        best[2] = (t < best[2]) ? t : best[2];
+        sum += mv[r];
+    }
+    printf("cycles/sample: old %.2f, Q16 %.2f, batch %.2f (%u)\n",
+           (double)best[0] / BENCH_SAMPLES, (double)best[1] / BENCH_SAMPLES,
+           (double)best[2] / BENCH_SAMPLES, sum & 1U);
+}
+
+int main(void)
+{
+    test_accuracy();
+    bench();
+    printf("%s\n", (failures == 0) ? "PASS" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
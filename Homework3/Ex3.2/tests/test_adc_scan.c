@@ -0,0 +1,163 @@
+/*
+ * Host test of the PDB/eDMA scan engine on the simulated ADC0, PDB0 and eDMA
+ * (assignment_2's host model).
+ *
+ *  - 1 kHz frames of AD12 and AD29, 4x averaged, for 1 s: every frame in
+ *    sequence, the same PDB count at each frame interrupt, no sequence errors.
+ *  - Interrupts masked for 2.5 ms: the frames wait in the ring and come out
+ *    together, one ring-full event, none lost.
+ *  - 5 kHz with 32x averaging (256 us of conversions per 200 us frame):
+ *    sequence errors; with 16x averaging none.
+ *  - Frames queued for main on an SPSC ring: all popped in order with the
+ *    input's mV; left unread, the queue drops and counts.
+ *
+ * DMA addresses are 32-bit in the model, so link without PIE:
+ *
+ *   gcc -O2 -Wall -Wextra -no-pie -DHOST_SIM -Iinclude -I../../assignment_2/include \
+ *       -I../../common/include tests/test_adc_scan.c ../../assignment_2/src/host_sim.c \
+ *       src/ADC.c src/ADC_scan.c src/clocks_and_modes.c ../../common/src/driver_ring.c \
+ *       -o test_adc_scan && ./test_adc_scan
+ */
+#include "ADC.h"
+#include "ADC_scan.h"
+#include "clocks_and_modes.h"
+#include <stdio.h>
+
+#define MS                  1000000ULL
+#define POT_RAW             2000U
+#define POT_MV              ((POT_RAW * ADC_VREF_MV) / ADC_FULL_SCALE)
+#define QUEUE_FRAMES        16U
+
+static const uint8_t channels[2] = { 12U, 29U };
+
+static uint32_t frames;
+static uint32_t out_of_order;
+static uint32_t last_mv[2];
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static void on_frame(const adc_scan_frame_t *frame)
+{
+    if (frame->sequence != frames)
+    {
+        out_of_order++;
+    }
+    frames++;
+    last_mv[0] = frame->mv[0];
+    last_mv[1] = frame->mv[1];
+}
+
+static void start(uint32_t rate_hz, uint32_t average, adc_scan_callback_t callback, Ring_t *queue)
+{
+    adc_scan_config_t config = { channels, 2U, rate_hz, average, callback, queue };
+
+    frames = 0U;
+    out_of_order = 0U;
+    CHECK(ADC_scan_init(&config) == 0);
+    ADC_scan_start();
+}
+
+static void test_scan(void)
+{
+    adc_scan_stats_t stats;
+
+    start(1000U, 4U, on_frame, NULL);
+    SIM_Advance(1000U * MS);
+    ADC_scan_get_stats(&stats);
+    printf("1 kHz, 2 channels, avg 4, 1 s: %u frames, latency %u..%u PDB counts, %u sequence errors\n",
+           frames, stats.latency_min, stats.latency_max, stats.seq_errors);
+    CHECK((frames == 1000U) && (stats.frames == 1000U) && (out_of_order == 0U));
+    CHECK(stats.latency_min == stats.latency_max);
+    CHECK((stats.seq_errors == 0U) && (stats.overruns == 0U));
+    CHECK((last_mv[0] >= (POT_MV - 1U)) && (last_mv[0] <= (POT_MV + 1U)));
+
+    /* Late service: the ring holds the frames until the interrupt runs */
+    __disable_irq();
+    SIM_Advance(2500000ULL);
+    CHECK(frames == 1000U);
+    __enable_irq();
+    SIM_Advance(1U * MS);
+    ADC_scan_get_stats(&stats);
+    printf("interrupts masked 2.5 ms: %u frames, %u ring-full, in order: %s\n",
+           frames, stats.overruns, (out_of_order == 0U) ? "yes" : "no");
+    CHECK((frames >= 1003U) && (frames == stats.frames) && (out_of_order == 0U));
+    CHECK(stats.overruns == 1U);
+    ADC_scan_stop();
+}
+
+static void test_too_fast(void)
+{
+    adc_scan_stats_t stats;
+
+    start(5000U, 32U, on_frame, NULL);
+    SIM_Advance(100U * MS);
+    ADC_scan_stop();
+    ADC_scan_get_stats(&stats);
+    printf("5 kHz, avg 32: %u frames, %u sequence errors\n", frames, stats.seq_errors);
+    CHECK(stats.seq_errors != 0U);
+
+    start(5000U, 16U, on_frame, NULL);
+    SIM_Advance(100U * MS);
+    ADC_scan_stop();
+    ADC_scan_get_stats(&stats);
+    printf("5 kHz, avg 16: %u frames, %u sequence errors\n", frames, stats.seq_errors);
+    CHECK((frames == 500U) && (stats.seq_errors == 0U) && (out_of_order == 0U));
+}
+
+static void test_queue(void)
+{
+    static adc_scan_frame_t storage[QUEUE_FRAMES];
+    static Ring_t queue;
+    adc_scan_frame_t frame;
+    adc_scan_stats_t stats;
+    uint32_t popped = 0U;
+    uint32_t gaps = 0U;
+    uint32_t bad = 0U;
+
+    CHECK(RING_Init(&queue, storage, QUEUE_FRAMES, sizeof(adc_scan_frame_t), RING_SPSC) == 0);
+    start(1000U, 0U, NULL, &queue);
+    for (uint32_t ms = 0U; ms < 100U; ms++)
+    {
+        SIM_Advance(1U * MS);
+        while (RING_Pop(&queue, &frame, 1U) != 0U)
+        {
+            gaps += (frame.sequence != popped) ? 1U : 0U;
+            bad += ((frame.count != 2U) || (frame.mv[0] < (POT_MV - 1U)) || (frame.mv[0] > (POT_MV + 1U))) ? 1U : 0U;
+            popped++;
+        }
+    }
+    /* Unread for 40 ms: 16 slots, the rest dropped */
+    SIM_Advance(40U * MS);
+    ADC_scan_stop();
+    ADC_scan_get_stats(&stats);
+    printf("queue: %u popped, %u gaps, %u bad, %u dropped with %u slots unread for 40 ms\n",
+           popped, gaps, bad, stats.queue_drops, QUEUE_FRAMES);
+    CHECK((popped == 100U) && (gaps == 0U) && (bad == 0U));
+    CHECK(RING_Count(&queue) == QUEUE_FRAMES);
+    CHECK(stats.queue_drops == (stats.frames - popped - QUEUE_FRAMES));
+    CHECK(stats.queue_drops != 0U);
+}
+
+int main(void)
+{
+    SIM_Init();
+    SOSC_init_8MHz();
+    SPLL_init_160MHz();
+    NormalRUNmode_80MHz();
+    SIM_ADC_SetInput(12U, POT_RAW);
+    SIM_ADC_SetInput(29U, ADC_FULL_SCALE);
+
+    test_scan();
+    test_too_fast();
+    test_queue();
+
+    printf("%s\n", (failures == 0) ? "PASS" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#ifndef SREC_CONVERT_H_
+#define SREC_CONVERT_H_
+
+#include "srec_parser.h"
+
+/*
+ * S-record text is split into chunks of about this size at line boundaries.
+ * The split does not depend on the thread count, so neither does the result.
+ */
+#define SREC_CONVERT_CHUNK      (256U * 1024U)
+
+/* Segmented image file, little endian:
+ *   "SRIM", segment count, entry address (0xFFFFFFFF if none),
+ *   then per segment: address, length, <length> bytes
+ */
+#define SREC_SEG_MAGIC          "SRIM"
+
+typedef struct {
+    srec_status_t   status;
+    uint32_t        line_no;        /* 0 if the error is not tied to one line */
+    uint32_t        col;
+    uint32_t        addr;           /* SREC_ERR_OVERLAP between chunks: first address written twice */
+} srec_convert_error_t;
+
+/**
+ * @brief   Decode S-record text into img using up to threads threads
+ * @return  SREC_OK or the first error in file order (details in *err)
+ */
+srec_status_t srec_convert_srec(const char *text, size_t len, srec_image_t *img, uint32_t threads,
+                                srec_convert_error_t *err);
+
+bool srec_is_elf(const uint8_t *data, size_t len);
+
+/**
+ * @brief   Load the PT_LOAD segments of a 32-bit little-endian ELF at their load (physical) address
+ * @return  SREC_OK, SREC_ERR_ELF or an srec_image_write error
+ */
+srec_status_t srec_convert_elf(const uint8_t *data, size_t len, srec_image_t *img);
+
+/**
+ * @brief   Write the image from its first to its last written byte, gaps filled
+ */
+bool srec_write_bin(FILE *fp, const srec_image_t *img);
+
+/**
+ * @brief   Write the whole image window, as a flash readback would show it
+ */
+bool srec_write_window(FILE *fp, const srec_image_t *img);
+
+/**
+ * @brief   Write only the written segments (SREC_SEG_MAGIC format)
+ */
+bool srec_write_segments(FILE *fp, const srec_image_t *img);
+
+#endif /* SREC_CONVERT_H_ */
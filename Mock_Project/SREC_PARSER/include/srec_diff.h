@@ -0,0 +1,66 @@
+#ifndef SREC_DIFF_H_
+#define SREC_DIFF_H_
+
+#include "srec_parser.h"
+
+/* S32K144 P-flash erase granularity */
+#define SREC_SECTOR_SIZE        0x1000U
+#define SREC_MAX_SECTORS        (SREC_FLASH_SIZE / SREC_SECTOR_SIZE)
+/* m_interrupts + m_flash_config in S32K144_64_flash.ld */
+#define SREC_VECTORS_END        0x00000410UL
+
+/* Binary patch, little endian:
+ *   "SRDP", sector size, sector count, CRC32 of the old and of the new image,
+ *   then per sector: address, CRC32 of the new contents, kind,
+ *   SREC_SECTOR_SIZE bytes (none for SREC_SECTOR_ERASED)
+ */
+#define SREC_PATCH_MAGIC        "SRDP"
+
+typedef enum {
+    SREC_SECTOR_CHANGED = 1,    /* program the new contents */
+    SREC_SECTOR_ERASED,         /* new contents are all SREC_FILL_BYTE: erase only */
+    SREC_SECTOR_VECTORS         /* only the vector table / flash configuration differ */
+} srec_sector_kind_t;
+
+typedef struct {
+    uint32_t            addr;
+    uint32_t            crc;
+    srec_sector_kind_t  kind;
+} srec_sector_t;
+
+typedef struct {
+    srec_sector_t   sector[SREC_MAX_SECTORS];
+    uint32_t        count;
+    uint32_t        crc_old;        /* whole image window */
+    uint32_t        crc_new;
+} srec_diff_t;
+
+uint32_t srec_crc32(uint32_t crc, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief   List the sectors of new_img that differ from old_img
+ * @return  false if the two images do not cover the same window
+ */
+bool srec_diff(const srec_image_t *old_img, const srec_image_t *new_img, srec_diff_t *diff);
+
+bool srec_write_patch_bin(FILE *fp, const srec_image_t *new_img, const srec_diff_t *diff);
+
+/**
+ * @brief   Write the changed sectors as S3 records (erased sectors as 0xFF data)
+ */
+bool srec_write_patch_srec(FILE *fp, const srec_image_t *new_img, const srec_diff_t *diff);
+
+/**
+ * @brief   Apply a binary patch to the image it was made against
+ *
+ * The whole patch is checked before the first sector is written: on any
+ * error but SREC_ERR_SEGMENTS, img is left as it was. SREC_ERR_SEGMENTS
+ * comes after the copy: mem holds the patched image, the segment list is short.
+ *
+ * @return  SREC_OK, SREC_ERR_LENGTH (malformed), SREC_ERR_RANGE,
+ *          SREC_ERR_OVERLAP (sector listed twice), SREC_ERR_CHECKSUM (wrong
+ *          base image, corrupt sector or result) or SREC_ERR_SEGMENTS
+ */
+srec_status_t srec_apply_patch(srec_image_t *img, const uint8_t *patch, size_t len);
+
+#endif /* SREC_DIFF_H_ */
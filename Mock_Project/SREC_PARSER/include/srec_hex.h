@@ -0,0 +1,35 @@
+#ifndef SREC_HEX_H_
+#define SREC_HEX_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Hex decoder implementations, fastest supported one is picked at startup */
+typedef enum {
+    SREC_HEX_SCALAR = 0,    /* one nibble at a time with branches (reference) */
+    SREC_HEX_TABLE,         /* 256-entry lookup table */
+    SREC_HEX_SSE2,          /* 32 characters per step */
+    SREC_HEX_AVX2,          /* 64 characters per step */
+    SREC_HEX_IMPL_COUNT
+} srec_hex_impl_t;
+
+/* srec_hex_lut[c] is the value of hex digit c, or 0xFF if c is not hex */
+extern const uint8_t srec_hex_lut[256];
+
+/**
+ * @brief   Decode 2 * n hex characters into n bytes and add them to *sum
+ * @param   bad     offset of the first invalid character when decoding fails
+ * @return  true if every character was a hex digit
+ */
+bool srec_hex_decode(const char *hex, uint8_t *out, uint32_t n, uint8_t *sum, uint32_t *bad);
+
+/**
+ * @brief   Force an implementation (benchmark), false if the CPU lacks it
+ */
+bool srec_hex_select(srec_hex_impl_t impl);
+
+srec_hex_impl_t srec_hex_selected(void);
+bool srec_hex_supported(srec_hex_impl_t impl);
+const char *srec_hex_impl_str(srec_hex_impl_t impl);
+
+#endif /* SREC_HEX_H_ */
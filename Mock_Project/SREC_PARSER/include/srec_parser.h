@@ -1,10 +1,105 @@
+#ifndef SREC_PARSER_H_
+#define SREC_PARSER_H_
+
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <ctype.h>
 
-bool parse_file(FILE*);
-bool parse_line(char*);
-static uint8_t hex_to_val(char );
-static uint8_t hex_to_byte(const char *);
+/* S32K144 P-flash as laid out by S32K144_64_flash.ld */
+#define SREC_FLASH_BASE         0x00000000UL
+#define SREC_FLASH_SIZE         0x00080000UL    /* m_interrupts + m_flash_config + m_text */
+#define SREC_FILL_BYTE          0xFFU           /* erased flash */
+
+/* "S" + type + 255 bytes of count/address/data/checksum as hex + CR/LF */
+#define SREC_MAX_LINE           (4U + (2U * 255U) + 2U)
+#define SREC_MAX_SEGMENTS       64U
+
+typedef enum {
+    SREC_OK = 0,
+    SREC_ERR_START,         /* record does not start with 'S' */
+    SREC_ERR_TYPE,          /* unknown record type */
+    SREC_ERR_LENGTH,        /* byte count does not match the record length */
+    SREC_ERR_HEX,           /* non-hex character */
+    SREC_ERR_CHECKSUM,      /* checksum mismatch */
+    SREC_ERR_RANGE,         /* data outside the image window */
+    SREC_ERR_OVERLAP,       /* data written twice to the same address */
+    SREC_ERR_SEGMENTS,      /* more than SREC_MAX_SEGMENTS disjoint ranges */
+    SREC_ERR_COUNT,         /* S5/S6 record count mismatch */
+    SREC_ERR_ELF            /* malformed ELF input */
+} srec_status_t;
+
+/* One contiguous range of the image */
+typedef struct {
+    uint32_t addr;
+    uint32_t len;
+} srec_segment_t;
+
+/*
+ * Sparse memory image: a caller-provided buffer covering [base, base + size)
+ * plus the sorted list of ranges that were actually written.
+ */
+typedef struct {
+    uint8_t        *mem;
+    uint32_t        base;
+    uint32_t        size;
+    srec_segment_t  seg[SREC_MAX_SEGMENTS];
+    uint32_t        seg_count;
+    uint32_t        last;           /* segment touched by the previous write */
+    uint32_t        entry;          /* S7/S8/S9 start address */
+    bool            has_entry;
+} srec_image_t;
+
+/*
+ * Streaming parser state. Input can be fed in chunks of any size; a record
+ * split across chunks is reassembled in line[].
+ */
+typedef struct {
+    srec_image_t   *image;
+    char            line[SREC_MAX_LINE];
+    uint32_t        line_len;
+    uint32_t        line_no;        /* line of the last record seen (1-based) */
+    uint32_t        col;            /* column of the offending character (1-based), 0 if none */
+    uint32_t        data_records;   /* S1/S2/S3 seen, checked against S5/S6 */
+    uint32_t        count_value;    /* last S5/S6 record count */
+    uint32_t        count_pos;      /* data_records when it was seen */
+    bool            has_count;
+    bool            defer_count;    /* chunked input: the caller checks S5/S6 for the whole file */
+    srec_status_t   status;         /* first error, parsing stops there */
+} srec_parser_t;
+
+/**
+ * @brief   Bind an image to a buffer and fill it with SREC_FILL_BYTE
+ */
+void srec_image_init(srec_image_t *img, uint8_t *mem, uint32_t base, uint32_t size);
+
+/**
+ * @brief   Copy data into the image and record its range
+ * @return  SREC_OK, SREC_ERR_RANGE, SREC_ERR_OVERLAP or SREC_ERR_SEGMENTS
+ */
+srec_status_t srec_image_write(srec_image_t *img, uint32_t addr, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief   Merge segments separated by at most gap bytes (gap stays filled)
+ */
+void srec_image_coalesce(srec_image_t *img, uint32_t gap);
+
+void srec_parser_init(srec_parser_t *p, srec_image_t *img);
+
+/**
+ * @brief   Parse the next chunk of S-record text
+ * @return  SREC_OK, or the first error (sticky, see p->line_no)
+ */
+srec_status_t srec_parser_feed(srec_parser_t *p, const char *buf, size_t len);
+
+/**
+ * @brief   Parse a last record without a line terminator
+ */
+srec_status_t srec_parser_finish(srec_parser_t *p);
+
+const char *srec_status_str(srec_status_t status);
+
+bool parse_file(FILE *fp, srec_image_t *img);
 
+#endif /* SREC_PARSER_H_ */
@@ -0,0 +1,543 @@
+#include "../include/srec_parser.h"
+#include "../include/srec_hex.h"
+#include "../include/srec_convert.h"
+#include "../include/srec_diff.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define READ_CHUNK_SIZE     4096U
+
+static uint8_t image_mem[SREC_FLASH_SIZE];
+static uint8_t old_mem[SREC_FLASH_SIZE];
+
+/* Output format selected with -f */
+typedef enum {
+    OUT_BIN,
+    OUT_SEG,
+    OUT_FULL,
+    OUT_SREC
+} out_format_t;
+
+static void print_error(const srec_parser_t *p)
+{
+    if (p->col != 0)
+    {
+        fprintf(stderr, "ERROR: line %u, column %u: %s\n", p->line_no, p->col, srec_status_str(p->status));
+    }
+    else
+    {
+        fprintf(stderr, "ERROR: line %u: %s\n", p->line_no, srec_status_str(p->status));
+    }
+}
+
+static void print_usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s <file.srec> [-b <repeat>]\n", prog);
+    fprintf(stderr, "       %s <file.srec|file.elf> -o <out> [-f bin|seg|full] [-j <threads>]\n", prog);
+    fprintf(stderr, "       %s <new> -d <old> -o <patch> [-f bin|srec]    (sector delta)\n", prog);
+    fprintf(stderr, "       %s <old> -a <patch> -o <out> [-f bin|seg|full]\n", prog);
+    fprintf(stderr, "       %s <file.srec> -s <max threads>    (conversion scaling report)\n", prog);
+    fprintf(stderr, "       %s -x <repeat>    (hex decoder benchmark)\n", prog);
+}
+
+static double elapsed(const struct timespec *t0, const struct timespec *t1)
+{
+    return (double)(t1->tv_sec - t0->tv_sec) + ((double)(t1->tv_nsec - t0->tv_nsec) * 1e-9);
+}
+
+/* Map a whole file read-only, NULL on error (an empty file maps to "") */
+static const uint8_t *map_file(const char *path, size_t *len)
+{
+    struct stat st;
+    void *data;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    *len = (size_t)st.st_size;
+    if (*len == 0)
+    {
+        close(fd);
+        return (const uint8_t *)"";
+    }
+    data = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return NULL;
+    }
+    (void)madvise(data, *len, MADV_SEQUENTIAL);
+    return data;
+}
+
+static void unmap_file(const uint8_t *data, size_t len)
+{
+    if (len > 0)
+    {
+        munmap((void *)data, len);
+    }
+}
+
+/* Decode an ELF or S-record file already in memory into a fresh image */
+static bool load_image(const uint8_t *data, size_t len, srec_image_t *img, uint8_t *mem, uint32_t threads)
+{
+    srec_convert_error_t err;
+    srec_status_t status;
+
+    srec_image_init(img, mem, SREC_FLASH_BASE, SREC_FLASH_SIZE);
+    if (srec_is_elf(data, len))
+    {
+        status = srec_convert_elf(data, len, img);
+        if (status != SREC_OK)
+        {
+            fprintf(stderr, "ERROR: %s\n", srec_status_str(status));
+        }
+        return status == SREC_OK;
+    }
+
+    status = srec_convert_srec((const char *)data, len, img, threads, &err);
+    if (status == SREC_OK)
+    {
+        return true;
+    }
+    if (err.line_no == 0)
+    {
+        if (status == SREC_ERR_OVERLAP)
+        {
+            fprintf(stderr, "ERROR: %s at 0x%08X\n", srec_status_str(status), err.addr);
+        }
+        else
+        {
+            fprintf(stderr, "ERROR: %s\n", srec_status_str(status));
+        }
+    }
+    else if (err.col != 0)
+    {
+        fprintf(stderr, "ERROR: line %u, column %u: %s\n", err.line_no, err.col, srec_status_str(status));
+    }
+    else
+    {
+        fprintf(stderr, "ERROR: line %u: %s\n", err.line_no, srec_status_str(status));
+    }
+    return false;
+}
+
+static bool load_file(const char *path, srec_image_t *img, uint8_t *mem, uint32_t threads)
+{
+    const uint8_t *data;
+    size_t len;
+    bool ok;
+
+    data = map_file(path, &len);
+    if (data == NULL)
+    {
+        fprintf(stderr, "ERROR: cannot open %s\n", path);
+        return false;
+    }
+    ok = load_image(data, len, img, mem, threads);
+    unmap_file(data, len);
+    return ok;
+}
+
+static bool write_image(const char *out, out_format_t format, const srec_image_t *img)
+{
+    FILE *fp = fopen(out, "wb");
+    bool ok;
+
+    if (fp == NULL)
+    {
+        fprintf(stderr, "ERROR: cannot create %s\n", out);
+        return false;
+    }
+    switch (format)
+    {
+        case OUT_SEG:   ok = srec_write_segments(fp, img);  break;
+        case OUT_FULL:  ok = srec_write_window(fp, img);    break;
+        default:        ok = srec_write_bin(fp, img);       break;
+    }
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok)
+    {
+        fprintf(stderr, "ERROR: cannot write %s\n", out);
+    }
+    return ok;
+}
+
+static bool run_convert(const char *in, const char *out, out_format_t format, uint32_t threads, srec_image_t *img)
+{
+    return load_file(in, img, image_mem, threads) && write_image(out, format, img);
+}
+
+/* Compare new against the previously flashed old image and write the changed sectors */
+static bool run_diff(const char *in, const char *old, const char *out, out_format_t format, uint32_t threads,
+                     srec_image_t *img)
+{
+    static srec_image_t old_image;
+    static srec_diff_t diff;
+    uint32_t changed = 0;
+    uint32_t vectors = 0;
+    FILE *fp;
+    bool ok;
+
+    if (!load_file(in, img, image_mem, threads) || !load_file(old, &old_image, old_mem, threads) ||
+        !srec_diff(&old_image, img, &diff))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < diff.count; i++)
+    {
+        const srec_sector_t *s = &diff.sector[i];
+
+        if (s->kind == SREC_SECTOR_VECTORS)
+        {
+            vectors++;
+            continue;
+        }
+        changed++;
+        printf("sector 0x%08X crc 0x%08X %s\n", s->addr, s->crc,
+               (s->kind == SREC_SECTOR_ERASED) ? "erase" : "program");
+    }
+    /* Reported apart: a moved vector table or a new FSEC/FOPT alone is not a code change */
+    for (uint32_t i = 0; i < diff.count; i++)
+    {
+        const srec_sector_t *s = &diff.sector[i];
+
+        if (s->kind == SREC_SECTOR_VECTORS)
+        {
+            printf("sector 0x%08X crc 0x%08X vector table / flash configuration only\n", s->addr, s->crc);
+        }
+    }
+    printf("%u of %u sectors changed (%u vector/config only), image crc 0x%08X -> 0x%08X\n",
+           changed + vectors, img->size / SREC_SECTOR_SIZE, vectors, diff.crc_old, diff.crc_new);
+
+    fp = fopen(out, "wb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "ERROR: cannot create %s\n", out);
+        return false;
+    }
+    ok = (format == OUT_SREC) ? srec_write_patch_srec(fp, img, &diff) : srec_write_patch_bin(fp, img, &diff);
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok)
+    {
+        fprintf(stderr, "ERROR: cannot write %s\n", out);
+    }
+    return ok;
+}
+
+static bool run_apply(const char *in, const char *patch, const char *out, out_format_t format, uint32_t threads,
+                      srec_image_t *img)
+{
+    const uint8_t *data;
+    size_t len;
+    srec_status_t status;
+
+    if (!load_file(in, img, image_mem, threads))
+    {
+        return false;
+    }
+    data = map_file(patch, &len);
+    if (data == NULL)
+    {
+        fprintf(stderr, "ERROR: cannot open %s\n", patch);
+        return false;
+    }
+    status = srec_apply_patch(img, data, len);
+    unmap_file(data, len);
+    if (status != SREC_OK)
+    {
+        fprintf(stderr, "ERROR: patch: %s\n", srec_status_str(status));
+        return false;
+    }
+    return write_image(out, format, img);
+}
+
+/* Convert the file in memory with 1..max_threads threads and report the speedup */
+static bool run_scaling(const char *in, uint32_t max_threads, srec_image_t *img)
+{
+    const long repeat = 10;
+    const uint8_t *data;
+    double base = 0.0;
+    size_t len;
+    bool ok = true;
+
+    data = map_file(in, &len);
+    if (data == NULL)
+    {
+        fprintf(stderr, "ERROR: cannot open %s\n", in);
+        return false;
+    }
+    /* Fault the pages in before timing */
+    ok = load_image(data, len, img, image_mem, 1U);
+
+    printf("threads   ms/convert   MB/s   speedup\n");
+    for (uint32_t t = 1; ok && (t <= max_threads); t++)
+    {
+        struct timespec t0, t1;
+        double sec;
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (long r = 0; ok && (r < repeat); r++)
+        {
+            ok = load_image(data, len, img, image_mem, t);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        sec = elapsed(&t0, &t1) / (double)repeat;
+        if (t == 1U)
+        {
+            base = sec;
+        }
+        printf("%7u   %10.3f   %4.0f   %7.2f\n", t, sec * 1e3, (double)len / (sec * 1e6), base / sec);
+    }
+    unmap_file(data, len);
+    return ok;
+}
+
+/*
+ * Decode a random 1 MB hex buffer <repeat> times in S3-sized pieces with
+ * every supported decoder, check it against the scalar one and report GB/s
+ */
+static bool run_hex_benchmark(long repeat)
+{
+    static const char digits[] = "0123456789ABCDEFabcdef";
+    const uint32_t piece = 255U;
+    const uint32_t n = 4096U * piece;
+    srec_hex_impl_t best = srec_hex_selected();
+    char *hex = malloc(2U * n);
+    uint8_t *ref = malloc(n);
+    uint8_t *out = malloc(n);
+    uint8_t ref_sum = 0;
+    bool ok = true;
+
+    if ((hex == NULL) || (ref == NULL) || (out == NULL))
+    {
+        fprintf(stderr, "ERROR: out of memory\n");
+        free(hex);
+        free(ref);
+        free(out);
+        return false;
+    }
+    srand(1);
+    for (uint32_t i = 0; i < (2U * n); i++)
+    {
+        hex[i] = digits[rand() % (int)(sizeof(digits) - 1U)];
+    }
+
+    for (int impl = SREC_HEX_SCALAR; ok && (impl < SREC_HEX_IMPL_COUNT); impl++)
+    {
+        struct timespec t0, t1;
+        uint8_t sum = 0;
+        uint32_t bad;
+        double sec;
+
+        if (!srec_hex_select((srec_hex_impl_t)impl))
+        {
+            printf("%-8s not supported\n", srec_hex_impl_str((srec_hex_impl_t)impl));
+            continue;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (long r = 0; r < repeat; r++)
+        {
+            sum = 0;
+            for (uint32_t off = 0; off < n; off += piece)
+            {
+                ok &= srec_hex_decode(&hex[2U * off], &out[off], piece, &sum, &bad);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        if (impl == SREC_HEX_SCALAR)
+        {
+            memcpy(ref, out, n);
+            ref_sum = sum;
+        }
+        else if ((memcmp(ref, out, n) != 0) || (sum != ref_sum))
+        {
+            fprintf(stderr, "ERROR: %s does not match scalar\n", srec_hex_impl_str((srec_hex_impl_t)impl));
+            ok = false;
+        }
+        sec = elapsed(&t0, &t1);
+        printf("%-8s %.2f GB/s of hex\n", srec_hex_impl_str((srec_hex_impl_t)impl),
+               (2.0 * (double)n * (double)repeat) / (sec * 1e9));
+    }
+    srec_hex_select(best);
+    free(hex);
+    free(ref);
+    free(out);
+    return ok;
+}
+
+/* Parse the whole file <repeat> times from memory and report the throughput */
+static bool run_benchmark(FILE *fp, srec_image_t *img, long repeat)
+{
+    struct timespec t0, t1;
+    srec_parser_t parser;
+    char *text;
+    long size;
+    double sec;
+
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    rewind(fp);
+    text = malloc((size_t)size);
+    if ((text == NULL) || (fread(text, 1, (size_t)size, fp) != (size_t)size))
+    {
+        fprintf(stderr, "ERROR: cannot read input\n");
+        free(text);
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (long i = 0; i < repeat; i++)
+    {
+        srec_image_init(img, image_mem, SREC_FLASH_BASE, SREC_FLASH_SIZE);
+        srec_parser_init(&parser, img);
+        for (long off = 0; off < size; off += READ_CHUNK_SIZE)
+        {
+            long n = ((size - off) < (long)READ_CHUNK_SIZE) ? (size - off) : (long)READ_CHUNK_SIZE;
+            srec_parser_feed(&parser, text + off, (size_t)n);
+        }
+        if (srec_parser_finish(&parser) != SREC_OK)
+        {
+            print_error(&parser);
+            free(text);
+            return false;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    free(text);
+
+    sec = elapsed(&t0, &t1);
+    printf("parsed %ld x %ld bytes in %.3f s: %.1f MB/s\n", repeat, size, sec,
+           ((double)size * (double)repeat) / (sec * 1e6));
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    static srec_image_t image;
+    const char *out = NULL;
+    const char *old = NULL;
+    const char *patch = NULL;
+    uint32_t threads = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t scaling = 0;
+    long repeat = 0;
+    out_format_t format = OUT_BIN;
+    FILE *fp;
+    bool status;
+
+    if (argc < 2)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (strcmp(argv[1], "-x") == 0)
+    {
+        return run_hex_benchmark((argc >= 3) ? strtol(argv[2], NULL, 0) : 100L) ? 0 : 1;
+    }
+    for (int i = 2; i < argc; i += 2)
+    {
+        if (i + 1 >= argc)
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-b") == 0)
+        {
+            repeat = strtol(argv[i + 1], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-o") == 0)
+        {
+            out = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "-f") == 0)
+        {
+            format = (strcmp(argv[i + 1], "seg") == 0)  ? OUT_SEG :
+                     (strcmp(argv[i + 1], "full") == 0) ? OUT_FULL :
+                     (strcmp(argv[i + 1], "srec") == 0) ? OUT_SREC : OUT_BIN;
+        }
+        else if (strcmp(argv[i], "-d") == 0)
+        {
+            old = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "-a") == 0)
+        {
+            patch = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "-j") == 0)
+        {
+            threads = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-s") == 0)
+        {
+            scaling = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+
+    if (scaling > 0)
+    {
+        return run_scaling(argv[1], scaling, &image) ? 0 : 1;
+    }
+    if ((old != NULL) || (patch != NULL))
+    {
+        if (out == NULL)
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return ((old != NULL) ? run_diff(argv[1], old, out, format, threads, &image) :
+                                run_apply(argv[1], patch, out, format, threads, &image)) ? 0 : 1;
+    }
+    if (out != NULL)
+    {
+        status = run_convert(argv[1], out, format, threads, &image);
+    }
+    else
+    {
+        fp = fopen(argv[1], "rb");
+        if (fp == NULL)
+        {
+            fprintf(stderr, "ERROR: cannot open %s\n", argv[1]);
+            return 1;
+        }
+        srec_image_init(&image, image_mem, SREC_FLASH_BASE, SREC_FLASH_SIZE);
+        status = (repeat > 0) ? run_benchmark(fp, &image, repeat) : parse_file(fp, &image);
+        fclose(fp);
+    }
+
+    if (status)
+    {
+        for (uint32_t i = 0; i < image.seg_count; i++)
+        {
+            printf("0x%08X - 0x%08X (%u bytes)\n", image.seg[i].addr,
+                   image.seg[i].addr + image.seg[i].len - 1U, image.seg[i].len);
+        }
+        if (image.has_entry)
+        {
+            printf("entry 0x%08X\n", image.entry);
+        }
+    }
+    return status ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+#include "../include/srec_convert.h"
+#include "../include/srec_hex.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* One slice of the input, parsed into its own segment list over the shared buffer */
+typedef struct {
+    const char     *text;
+    size_t          len;
+    srec_image_t    image;
+    srec_parser_t   parser;
+} chunk_t;
+
+typedef struct {
+    chunk_t        *chunk;
+    uint32_t        count;
+    atomic_uint     next;
+} pool_t;
+
+/* Segment tagged with the chunk it came from, for a stable merge order */
+typedef struct {
+    uint32_t        addr;
+    uint32_t        len;
+    uint32_t        chunk;
+} tagged_segment_t;
+
+/* ============================ S-record ============================ */
+static void *worker(void *arg)
+{
+    pool_t *pool = arg;
+    uint32_t k;
+
+    while ((k = atomic_fetch_add(&pool->next, 1U)) < pool->count)
+    {
+        chunk_t *c = &pool->chunk[k];
+
+        srec_parser_feed(&c->parser, c->text, c->len);
+        srec_parser_finish(&c->parser);
+    }
+    return NULL;
+}
+
+static int compare_segment(const void *a, const void *b)
+{
+    const tagged_segment_t *x = a;
+    const tagged_segment_t *y = b;
+
+    if (x->addr != y->addr)
+    {
+        return (x->addr < y->addr) ? -1 : 1;
+    }
+    return (x->chunk < y->chunk) ? -1 : ((x->chunk > y->chunk) ? 1 : 0);
+}
+
+static uint32_t count_lines(const char *text, const char *end)
+{
+    uint32_t lines = 0;
+
+    while ((text = memchr(text, '\n', (size_t)(end - text))) != NULL)
+    {
+        lines++;
+        text++;
+    }
+    return lines;
+}
+
+/* Sort all chunk segments by address, reject overlaps and join touching ones */
+static srec_status_t merge_segments(chunk_t *chunk, uint32_t count, srec_image_t *img, srec_convert_error_t *err)
+{
+    tagged_segment_t *all;
+    uint32_t total = 0;
+    uint32_t out = 0;
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        total += chunk[k].image.seg_count;
+    }
+    all = malloc(((size_t)total + 1U) * sizeof(*all));
+    if (all == NULL)
+    {
+        return SREC_ERR_SEGMENTS;
+    }
+    for (uint32_t k = 0, n = 0; k < count; k++)
+    {
+        for (uint32_t i = 0; i < chunk[k].image.seg_count; i++, n++)
+        {
+            all[n].addr = chunk[k].image.seg[i].addr;
+            all[n].len = chunk[k].image.seg[i].len;
+            all[n].chunk = k;
+        }
+    }
+    qsort(all, total, sizeof(*all), compare_segment);
+
+    for (uint32_t i = 0; i < total; i++)
+    {
+        uint64_t end = (out > 0) ? ((uint64_t)img->seg[out - 1U].addr + img->seg[out - 1U].len) : 0;
+
+        if ((out > 0) && (all[i].addr < end))
+        {
+            err->addr = all[i].addr;
+            free(all);
+            return SREC_ERR_OVERLAP;
+        }
+        if ((out > 0) && (all[i].addr == end))
+        {
+            img->seg[out - 1U].len += all[i].len;
+        }
+        else if (out == SREC_MAX_SEGMENTS)
+        {
+            free(all);
+            return SREC_ERR_SEGMENTS;
+        }
+        else
+        {
+            img->seg[out].addr = all[i].addr;
+            img->seg[out].len = all[i].len;
+            out++;
+        }
+    }
+    img->seg_count = out;
+    img->last = 0;
+    free(all);
+    return SREC_OK;
+}
+
+srec_status_t srec_convert_srec(const char *text, size_t len, srec_image_t *img, uint32_t threads,
+                                srec_convert_error_t *err)
+{
+    const char *end = text + len;
+    pthread_t *tid;
+    uint32_t started = 0;
+    uint32_t records = 0;
+    uint32_t count = (uint32_t)(len / SREC_CONVERT_CHUNK) + 1U;
+    chunk_t *chunk;
+    pool_t pool;
+    srec_status_t status = SREC_OK;
+
+    memset(err, 0, sizeof(*err));
+    chunk = malloc(count * sizeof(*chunk));
+    tid = malloc(count * sizeof(*tid));
+    if ((chunk == NULL) || (tid == NULL))
+    {
+        free(chunk);
+        free(tid);
+        return err->status = SREC_ERR_SEGMENTS;
+    }
+
+    /* Chunk k starts after the first line end at or past k * SREC_CONVERT_CHUNK */
+    for (uint32_t k = 0; k < count; k++)
+    {
+        const char *start = text;
+
+        if (k > 0)
+        {
+            const char *nominal = text + ((size_t)k * SREC_CONVERT_CHUNK);
+            const char *nl = (nominal < end) ? memchr(nominal, '\n', (size_t)(end - nominal)) : NULL;
+
+            start = (nl != NULL) ? (nl + 1) : end;
+            if (start < chunk[k - 1U].text)
+            {
+                /* The previous chunk already starts past a line longer than a chunk */
+                start = chunk[k - 1U].text;
+            }
+            chunk[k - 1U].len = (size_t)(start - chunk[k - 1U].text);
+        }
+        chunk[k].text = start;
+        chunk[k].len = (size_t)(end - start);
+        chunk[k].image = *img;
+        chunk[k].image.seg_count = 0;
+        chunk[k].image.last = 0;
+        chunk[k].image.has_entry = false;
+        srec_parser_init(&chunk[k].parser, &chunk[k].image);
+        chunk[k].parser.defer_count = true;
+    }
+
+    /*
+     * Chunks write straight into the shared buffer. Data written by two chunks
+     * is only found when the segments are merged; the image is then rejected,
+     * so whatever landed in the buffer does not matter.
+     */
+    pool.chunk = chunk;
+    pool.count = count;
+    atomic_init(&pool.next, 0U);
+    (void)srec_hex_selected();
+    for (uint32_t t = 1; (t < threads) && (t < count); t++)
+    {
+        if (pthread_create(&tid[started], NULL, worker, &pool) == 0)
+        {
+            started++;
+        }
+    }
+    worker(&pool);
+    for (uint32_t t = 0; t < started; t++)
+    {
+        pthread_join(tid[t], NULL);
+    }
+
+    /* First error in file order, then the S5/S6 counts against the running total */
+    for (uint32_t k = 0; (k < count) && (status == SREC_OK); k++)
+    {
+        const srec_parser_t *p = &chunk[k].parser;
+
+        if (p->status != SREC_OK)
+        {
+            status = p->status;
+            err->line_no = count_lines(text, chunk[k].text) + p->line_no;
+            err->col = p->col;
+        }
+        else if (p->has_count && (p->count_value != (records + p->count_pos)))
+        {
+            status = SREC_ERR_COUNT;
+        }
+        else
+        {
+            records += p->data_records;
+            if (chunk[k].image.has_entry)
+            {
+                img->entry = chunk[k].image.entry;
+                img->has_entry = true;
+            }
+        }
+    }
+    if (status == SREC_OK)
+    {
+        status = merge_segments(chunk, count, img, err);
+    }
+
+    free(chunk);
+    free(tid);
+    return err->status = status;
+}
+
+/* ============================ ELF ============================ */
+#define ELF_PT_LOAD     1U
+
+static uint16_t rd16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t rd32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wr32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+bool srec_is_elf(const uint8_t *data, size_t len)
+{
+    return (len >= 4U) && (memcmp(data, "\177ELF", 4) == 0);
+}
+
+srec_status_t srec_convert_elf(const uint8_t *data, size_t len, srec_image_t *img)
+{
+    uint32_t phoff, phentsize, phnum;
+
+    /* ELFCLASS32, ELFDATA2LSB */
+    if ((len < 52U) || !srec_is_elf(data, len) || (data[4] != 1U) || (data[5] != 1U))
+    {
+        return SREC_ERR_ELF;
+    }
+    phoff = rd32(&data[28]);
+    phentsize = rd16(&data[42]);
+    phnum = rd16(&data[44]);
+    if ((phentsize < 32U) || (((uint64_t)phoff + ((uint64_t)phnum * phentsize)) > len))
+    {
+        return SREC_ERR_ELF;
+    }
+
+    for (uint32_t i = 0; i < phnum; i++)
+    {
+        const uint8_t *ph = &data[phoff + (i * phentsize)];
+        uint32_t offset = rd32(&ph[4]);
+        uint32_t paddr = rd32(&ph[12]);
+        uint32_t filesz = rd32(&ph[16]);
+        srec_status_t status;
+
+        /* .bss, stack and heap have no file contents: nothing to program */
+        if ((rd32(&ph[0]) != ELF_PT_LOAD) || (filesz == 0U))
+        {
+            continue;
+        }
+        if (((uint64_t)offset + filesz) > len)
+        {
+            return SREC_ERR_ELF;
+        }
+        /* Initialised data runs from RAM but is stored at its LMA in flash */
+        status = srec_image_write(img, paddr, &data[offset], filesz);
+        if (status != SREC_OK)
+        {
+            return status;
+        }
+    }
+    img->entry = rd32(&data[24]);
+    img->has_entry = true;
+    return SREC_OK;
+}
+
+/* ============================ Output ============================ */
+bool srec_write_bin(FILE *fp, const srec_image_t *img)
+{
+    uint32_t first, last;
+
+    if (img->seg_count == 0)
+    {
+        return true;
+    }
+    first = img->seg[0].addr;
+    last = img->seg[img->seg_count - 1U].addr + img->seg[img->seg_count - 1U].len;
+    return fwrite(&img->mem[first - img->base], 1, last - first, fp) == (last - first);
+}
+
+bool srec_write_window(FILE *fp, const srec_image_t *img)
+{
+    return fwrite(img->mem, 1, img->size, fp) == img->size;
+}
+
+bool srec_write_segments(FILE *fp, const srec_image_t *img)
+{
+    uint8_t hdr[12];
+    bool ok;
+
+    memcpy(hdr, SREC_SEG_MAGIC, 4);
+    wr32(&hdr[4], img->seg_count);
+    wr32(&hdr[8], img->has_entry ? img->entry : 0xFFFFFFFFUL);
+    ok = fwrite(hdr, 1, sizeof(hdr), fp) == sizeof(hdr);
+    for (uint32_t i = 0; ok && (i < img->seg_count); i++)
+    {
+        const srec_segment_t *s = &img->seg[i];
+
+        wr32(&hdr[0], s->addr);
+        wr32(&hdr[4], s->len);
+        ok = (fwrite(hdr, 1, 8, fp) == 8U) && (fwrite(&img->mem[s->addr - img->base], 1, s->len, fp) == s->len);
+    }
+    return ok;
+}
@@ -0,0 +1,311 @@
+#include "../include/srec_diff.h"
+#include <string.h>
+
+#define SREC_PATCH_HDR_SIZE     20U
+#define SREC_PATCH_SEC_HDR_SIZE 12U
+#define SREC_PATCH_RECORD_LEN   32U
+#define SREC_PATCH_ERASE        SIZE_MAX
+
+static uint32_t crc_table[256];
+
+static uint32_t rd32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wr32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/* CRC-32 (IEEE 802.3, reflected 0xEDB88320), crc = 0 to start */
+uint32_t srec_crc32(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    if (crc_table[1] == 0U)
+    {
+        for (uint32_t i = 0; i < 256U; i++)
+        {
+            uint32_t c = i;
+
+            for (uint32_t b = 0; b < 8U; b++)
+            {
+                c = (c & 1U) ? (0xEDB88320UL ^ (c >> 1)) : (c >> 1);
+            }
+            crc_table[i] = c;
+        }
+    }
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc = crc_table[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static bool is_erased(const uint8_t *p, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if (p[i] != SREC_FILL_BYTE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool srec_diff(const srec_image_t *old_img, const srec_image_t *new_img, srec_diff_t *diff)
+{
+    if ((old_img->base != new_img->base) || (old_img->size != new_img->size) ||
+        ((new_img->size % SREC_SECTOR_SIZE) != 0U) || ((new_img->size / SREC_SECTOR_SIZE) > SREC_MAX_SECTORS))
+    {
+        return false;
+    }
+    diff->count = 0;
+    diff->crc_old = srec_crc32(0, old_img->mem, old_img->size);
+    diff->crc_new = srec_crc32(0, new_img->mem, new_img->size);
+
+    for (uint32_t off = 0; off < new_img->size; off += SREC_SECTOR_SIZE)
+    {
+        const uint8_t *o = &old_img->mem[off];
+        const uint8_t *n = &new_img->mem[off];
+        uint32_t addr = new_img->base + off;
+        srec_sector_t *s;
+
+        if (memcmp(o, n, SREC_SECTOR_SIZE) == 0)
+        {
+            continue;
+        }
+        s = &diff->sector[diff->count++];
+        s->addr = addr;
+        s->crc = srec_crc32(0, n, SREC_SECTOR_SIZE);
+        if ((addr < SREC_VECTORS_END) &&
+            (memcmp(&o[SREC_VECTORS_END - addr], &n[SREC_VECTORS_END - addr], SREC_SECTOR_SIZE - (SREC_VECTORS_END - addr)) == 0))
+        {
+            s->kind = SREC_SECTOR_VECTORS;
+        }
+        else if (is_erased(n, SREC_SECTOR_SIZE))
+        {
+            s->kind = SREC_SECTOR_ERASED;
+        }
+        else
+        {
+            s->kind = SREC_SECTOR_CHANGED;
+        }
+    }
+    return true;
+}
+
+bool srec_write_patch_bin(FILE *fp, const srec_image_t *new_img, const srec_diff_t *diff)
+{
+    uint8_t hdr[SREC_PATCH_HDR_SIZE];
+    bool ok;
+
+    memcpy(hdr, SREC_PATCH_MAGIC, 4);
+    wr32(&hdr[4], SREC_SECTOR_SIZE);
+    wr32(&hdr[8], diff->count);
+    wr32(&hdr[12], diff->crc_old);
+    wr32(&hdr[16], diff->crc_new);
+    ok = fwrite(hdr, 1, sizeof(hdr), fp) == sizeof(hdr);
+    for (uint32_t i = 0; ok && (i < diff->count); i++)
+    {
+        const srec_sector_t *s = &diff->sector[i];
+
+        wr32(&hdr[0], s->addr);
+        wr32(&hdr[4], s->crc);
+        wr32(&hdr[8], (uint32_t)s->kind);
+        ok = fwrite(hdr, 1, SREC_PATCH_SEC_HDR_SIZE, fp) == SREC_PATCH_SEC_HDR_SIZE;
+        if (ok && (s->kind != SREC_SECTOR_ERASED))
+        {
+            ok = fwrite(&new_img->mem[s->addr - new_img->base], 1, SREC_SECTOR_SIZE, fp) == SREC_SECTOR_SIZE;
+        }
+    }
+    return ok;
+}
+
+static bool write_record(FILE *fp, char type, uint32_t addr, uint32_t addr_len, const uint8_t *data, uint32_t len)
+{
+    uint8_t sum = (uint8_t)(addr_len + len + 1U);
+    int ok;
+
+    ok = fprintf(fp, "S%c%02X", type, addr_len + len + 1U);
+    for (uint32_t i = addr_len; (ok > 0) && (i > 0); i--)
+    {
+        uint8_t b = (uint8_t)(addr >> (8U * (i - 1U)));
+
+        sum += b;
+        ok = fprintf(fp, "%02X", b);
+    }
+    for (uint32_t i = 0; (ok > 0) && (i < len); i++)
+    {
+        sum += data[i];
+        ok = fprintf(fp, "%02X", data[i]);
+    }
+    return (ok > 0) && (fprintf(fp, "%02X\n", (uint8_t)~sum) > 0);
+}
+
+bool srec_write_patch_srec(FILE *fp, const srec_image_t *new_img, const srec_diff_t *diff)
+{
+    static const uint8_t header[] = "PATCH";
+    uint32_t records = 0;
+    bool ok = write_record(fp, '0', 0, 2, header, sizeof(header) - 1U);
+
+    for (uint32_t i = 0; ok && (i < diff->count); i++)
+    {
+        const uint8_t *p = &new_img->mem[diff->sector[i].addr - new_img->base];
+
+        for (uint32_t off = 0; ok && (off < SREC_SECTOR_SIZE); off += SREC_PATCH_RECORD_LEN)
+        {
+            ok = write_record(fp, '3', diff->sector[i].addr + off, 4, &p[off], SREC_PATCH_RECORD_LEN);
+            records++;
+        }
+    }
+    if (ok && (records <= 0xFFFFU))
+    {
+        ok = write_record(fp, '5', records, 2, NULL, 0);
+    }
+    if (ok && new_img->has_entry)
+    {
+        ok = write_record(fp, '7', new_img->entry, 4, NULL, 0);
+    }
+    return ok;
+}
+
+/* After patching, the image is known at sector granularity: non-erased sectors */
+static srec_status_t rebuild_segments(srec_image_t *img)
+{
+    img->seg_count = 0;
+    img->last = 0;
+    for (uint32_t off = 0; off < img->size; off += SREC_SECTOR_SIZE)
+    {
+        srec_segment_t *last = &img->seg[(img->seg_count > 0) ? (img->seg_count - 1U) : 0U];
+
+        if (is_erased(&img->mem[off], SREC_SECTOR_SIZE))
+        {
+            continue;
+        }
+        if ((img->seg_count > 0) && ((last->addr + last->len) == (img->base + off)))
+        {
+            last->len += SREC_SECTOR_SIZE;
+        }
+        else if (img->seg_count == SREC_MAX_SEGMENTS)
+        {
+            return SREC_ERR_SEGMENTS;
+        }
+        else
+        {
+            img->seg[img->seg_count].addr = img->base + off;
+            img->seg[img->seg_count].len = SREC_SECTOR_SIZE;
+            img->seg_count++;
+        }
+    }
+    return SREC_OK;
+}
+
+/*
+ * Two passes: the first checks the whole patch, the CRC of every sector and
+ * the CRC of the result (streamed sector by sector from the patch or the
+ * image) without writing; only then are the sectors copied.
+ */
+srec_status_t srec_apply_patch(srec_image_t *img, const uint8_t *patch, size_t len)
+{
+    /* Per image sector: payload offset in patch, SREC_PATCH_ERASE, or 0 (unchanged) */
+    static size_t src[SREC_MAX_SECTORS];
+    static uint8_t fill[SREC_SECTOR_SIZE];
+    size_t pos = SREC_PATCH_HDR_SIZE;
+    uint32_t crc_fill;
+    uint32_t crc = 0;
+    uint32_t count;
+
+    if ((len < SREC_PATCH_HDR_SIZE) || (memcmp(patch, SREC_PATCH_MAGIC, 4) != 0) ||
+        (rd32(&patch[4]) != SREC_SECTOR_SIZE))
+    {
+        return SREC_ERR_LENGTH;
+    }
+    if ((img->size < SREC_SECTOR_SIZE) || (img->size > (SREC_MAX_SECTORS * SREC_SECTOR_SIZE)))
+    {
+        return SREC_ERR_RANGE;
+    }
+    if (srec_crc32(0, img->mem, img->size) != rd32(&patch[12]))
+    {
+        return SREC_ERR_CHECKSUM;
+    }
+    memset(src, 0, sizeof(src));
+    memset(fill, SREC_FILL_BYTE, sizeof(fill));
+    crc_fill = srec_crc32(0, fill, SREC_SECTOR_SIZE);
+
+    count = rd32(&patch[8]);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t addr, sec_crc, kind, idx;
+
+        if ((len - pos) < SREC_PATCH_SEC_HDR_SIZE)
+        {
+            return SREC_ERR_LENGTH;
+        }
+        addr = rd32(&patch[pos]);
+        sec_crc = rd32(&patch[pos + 4U]);
+        kind = rd32(&patch[pos + 8U]);
+        pos += SREC_PATCH_SEC_HDR_SIZE;
+        if ((addr < img->base) || ((addr - img->base) > (img->size - SREC_SECTOR_SIZE)) ||
+            (((addr - img->base) % SREC_SECTOR_SIZE) != 0U))
+        {
+            return SREC_ERR_RANGE;
+        }
+        idx = (addr - img->base) / SREC_SECTOR_SIZE;
+        if (src[idx] != 0U)
+        {
+            return SREC_ERR_OVERLAP;
+        }
+
+        if (kind == (uint32_t)SREC_SECTOR_ERASED)
+        {
+            if (sec_crc != crc_fill)
+            {
+                return SREC_ERR_CHECKSUM;
+            }
+            src[idx] = SREC_PATCH_ERASE;
+        }
+        else if ((len - pos) < SREC_SECTOR_SIZE)
+        {
+            return SREC_ERR_LENGTH;
+        }
+        else
+        {
+            if (srec_crc32(0, &patch[pos], SREC_SECTOR_SIZE) != sec_crc)
+            {
+                return SREC_ERR_CHECKSUM;
+            }
+            src[idx] = pos;
+            pos += SREC_SECTOR_SIZE;
+        }
+    }
+
+    for (uint32_t off = 0; off < img->size; off += SREC_SECTOR_SIZE)
+    {
+        size_t from = src[off / SREC_SECTOR_SIZE];
+        uint32_t n = ((img->size - off) < SREC_SECTOR_SIZE) ? (img->size - off) : SREC_SECTOR_SIZE;
+
+        crc = srec_crc32(crc, (from == 0U) ? &img->mem[off] : ((from == SREC_PATCH_ERASE) ? fill : &patch[from]), n);
+    }
+    if (crc != rd32(&patch[16]))
+    {
+        return SREC_ERR_CHECKSUM;
+    }
+
+    for (uint32_t idx = 0; idx < (img->size / SREC_SECTOR_SIZE); idx++)
+    {
+        if (src[idx] == SREC_PATCH_ERASE)
+        {
+            memset(&img->mem[idx * SREC_SECTOR_SIZE], SREC_FILL_BYTE, SREC_SECTOR_SIZE);
+        }
+        else if (src[idx] != 0U)
+        {
+            memcpy(&img->mem[idx * SREC_SECTOR_SIZE], &patch[src[idx]], SREC_SECTOR_SIZE);
+        }
+    }
+    return rebuild_segments(img);
+}
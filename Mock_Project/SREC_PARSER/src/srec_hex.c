@@ -0,0 +1,312 @@
+#include "../include/srec_hex.h"
+#include <stddef.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SREC_HEX_X86    1
+#include <immintrin.h>
+#else
+#define SREC_HEX_X86    0
+#endif
+
+typedef bool (*decode_fn_t)(const char *hex, uint8_t *out, uint32_t n, uint8_t *sum, uint32_t *bad);
+
+#define XX  0xFFU
+const uint8_t srec_hex_lut[256] = {
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0x00 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0x10 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0x20 */
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, XX, XX, XX, XX, XX, XX,     /* 0x30 '0'..'9' */
+    XX, 10, 11, 12, 13, 14, 15, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0x40 'A'..'F' */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0x50 */
+    XX, 10, 11, 12, 13, 14, 15, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0x60 'a'..'f' */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0x70 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0x80 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0x90 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0xA0 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0xB0 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0xC0 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0xD0 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,     /* 0xE0 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX      /* 0xF0 */
+};
+#undef XX
+
+static bool decode_resolve(const char *hex, uint8_t *out, uint32_t n, uint8_t *sum, uint32_t *bad);
+
+static decode_fn_t decode = decode_resolve;
+static srec_hex_impl_t selected = SREC_HEX_IMPL_COUNT;
+
+/* ============================ Scalar ============================ */
+// Convert one ASCII hex digit to its integer value, 0xFF if it is not hex
+static uint8_t hex_to_val(char c) {
+    if ('0' <= c && c <= '9') return c - '0';
+    if ('A' <= c && c <= 'F') return c - 'A' + 10;
+    if ('a' <= c && c <= 'f') return c - 'a' + 10;
+    return 0xFF;
+}
+
+static bool decode_scalar(const char *hex, uint8_t *out, uint32_t n, uint8_t *sum, uint32_t *bad)
+{
+    uint8_t s = *sum;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint8_t hi = hex_to_val(hex[2U * i]);
+        uint8_t lo = hex_to_val(hex[(2U * i) + 1U]);
+
+        if ((hi | lo) & 0xF0)
+        {
+            *bad = (2U * i) + ((hi == 0xFF) ? 0U : 1U);
+            return false;
+        }
+        out[i] = (uint8_t)((hi << 4) | lo);
+        s += out[i];
+    }
+    *sum = s;
+    return true;
+}
+
+/* ============================ Lookup table ============================ */
+static bool decode_table(const char *hex, uint8_t *out, uint32_t n, uint8_t *sum, uint32_t *bad)
+{
+    const unsigned char *h = (const unsigned char *)hex;
+    uint8_t s = *sum;
+    uint8_t err = 0;
+
+    /* Branch-free inner loop, any invalid digit sets the high nibble of err */
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint8_t hi = srec_hex_lut[h[2U * i]];
+        uint8_t lo = srec_hex_lut[h[(2U * i) + 1U]];
+
+        err |= hi | lo;
+        out[i] = (uint8_t)((hi << 4) | lo);
+        s += out[i];
+    }
+    if (err & 0xF0)
+    {
+        /* Slow path only on error: find the exact character */
+        for (uint32_t i = 0; i < (2U * n); i++)
+        {
+            if (srec_hex_lut[h[i]] == 0xFF)
+            {
+                *bad = i;
+                break;
+            }
+        }
+        return false;
+    }
+    *sum = s;
+    return true;
+}
+
+#if SREC_HEX_X86
+/* ============================ SSE2 ============================ */
+/*
+ * Nibble values of 16 characters. Bit i of *invalid is set when character i
+ * is neither 0-9 nor A-F/a-f.
+ */
+__attribute__((target("sse2")))
+static inline __m128i nibbles_sse2(__m128i c, uint32_t *invalid)
+{
+    __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    /* Unsigned x <= max  <=>  min(x, max) == x */
+    __m128i is_d = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+    __m128i is_l = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+
+    *invalid = (uint32_t)_mm_movemask_epi8(_mm_or_si128(is_d, is_l)) ^ 0xFFFFU;
+    return _mm_or_si128(_mm_and_si128(is_d, d), _mm_and_si128(is_l, _mm_add_epi8(l, _mm_set1_epi8(10))));
+}
+
+/* Pair up nibbles: 16-bit lane = (first << 4) | second */
+__attribute__((target("sse2")))
+static inline __m128i pairs_sse2(__m128i nib)
+{
+    return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nib, _mm_set1_epi16(0x00FF)), 4), _mm_srli_epi16(nib, 8));
+}
+
+__attribute__((target("sse2")))
+static bool decode_sse2(const char *hex, uint8_t *out, uint32_t n, uint8_t *sum, uint32_t *bad)
+{
+    const __m128i lane = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i acc = _mm_setzero_si128();
+    __m128i keep = _mm_set1_epi8(-1);
+    uint32_t i = 0;
+
+    if (n < 16U)
+    {
+        return decode_table(hex, out, n, sum, bad);
+    }
+
+    /*
+     * 32 characters -> 16 bytes per step. The last step is moved back to end
+     * at n and only sums the bytes the previous steps did not cover.
+     */
+    while (i < n)
+    {
+        uint32_t inv0, inv1;
+        __m128i n0, n1, bytes;
+
+        if ((i + 16U) > n)
+        {
+            keep = _mm_cmpgt_epi8(lane, _mm_set1_epi8((char)(15 - (int)(n - i))));
+            i = n - 16U;
+        }
+        n0 = nibbles_sse2(_mm_loadu_si128((const __m128i *)&hex[2U * i]), &inv0);
+        n1 = nibbles_sse2(_mm_loadu_si128((const __m128i *)&hex[(2U * i) + 16U]), &inv1);
+        if ((inv0 | inv1) != 0U)
+        {
+            *bad = (2U * i) + (uint32_t)__builtin_ctz(inv0 | (inv1 << 16));
+            return false;
+        }
+        bytes = _mm_packus_epi16(pairs_sse2(n0), pairs_sse2(n1));
+        _mm_storeu_si128((__m128i *)&out[i], bytes);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_and_si128(bytes, keep), _mm_setzero_si128()));
+        i += 16U;
+    }
+    *sum = (uint8_t)(*sum + (uint8_t)_mm_cvtsi128_si32(acc) + (uint8_t)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+    return true;
+}
+
+/* ============================ AVX2 ============================ */
+__attribute__((target("avx2")))
+static inline __m256i nibbles_avx2(__m256i c, uint32_t *invalid)
+{
+    __m256i d = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    __m256i l = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i is_d = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+    __m256i is_l = _mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8(5)), l);
+
+    *invalid = ~(uint32_t)_mm256_movemask_epi8(_mm256_or_si256(is_d, is_l));
+    return _mm256_or_si256(_mm256_and_si256(is_d, d), _mm256_and_si256(is_l, _mm256_add_epi8(l, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i pairs_avx2(__m256i nib)
+{
+    return _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(nib, _mm256_set1_epi16(0x00FF)), 4),
+                           _mm256_srli_epi16(nib, 8));
+}
+
+__attribute__((target("avx2")))
+static bool decode_avx2(const char *hex, uint8_t *out, uint32_t n, uint8_t *sum, uint32_t *bad)
+{
+    const __m256i lane = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                          16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+    __m256i acc = _mm256_setzero_si256();
+    __m256i keep = _mm256_set1_epi8(-1);
+    __m128i acc128;
+    uint32_t i = 0;
+
+    if (n < 32U)
+    {
+        return decode_sse2(hex, out, n, sum, bad);
+    }
+
+    /* 64 characters -> 32 bytes per step, overlapping last step as for SSE2 */
+    while (i < n)
+    {
+        uint32_t inv0, inv1;
+        __m256i n0, n1, bytes;
+
+        if ((i + 32U) > n)
+        {
+            keep = _mm256_cmpgt_epi8(lane, _mm256_set1_epi8((char)(31 - (int)(n - i))));
+            i = n - 32U;
+        }
+        n0 = nibbles_avx2(_mm256_loadu_si256((const __m256i *)&hex[2U * i]), &inv0);
+        n1 = nibbles_avx2(_mm256_loadu_si256((const __m256i *)&hex[(2U * i) + 32U]), &inv1);
+        if ((inv0 | inv1) != 0U)
+        {
+            *bad = (2U * i) + ((inv0 != 0U) ? (uint32_t)__builtin_ctz(inv0) : (32U + (uint32_t)__builtin_ctz(inv1)));
+            return false;
+        }
+        /* packus works per 128-bit lane: restore the byte order afterwards */
+        bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(pairs_avx2(n0), pairs_avx2(n1)), 0xD8);
+        _mm256_storeu_si256((__m256i *)&out[i], bytes);
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_and_si256(bytes, keep), _mm256_setzero_si256()));
+        i += 32U;
+    }
+    acc128 = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    *sum = (uint8_t)(*sum + (uint8_t)_mm_cvtsi128_si32(acc128) + (uint8_t)_mm_cvtsi128_si32(_mm_srli_si128(acc128, 8)));
+    return true;
+}
+#endif /* SREC_HEX_X86 */
+
+/* ============================ Dispatch ============================ */
+static const decode_fn_t impl_fn[SREC_HEX_IMPL_COUNT] = {
+    decode_scalar,
+    decode_table,
+#if SREC_HEX_X86
+    decode_sse2,
+    decode_avx2,
+#else
+    NULL,
+    NULL,
+#endif
+};
+
+bool srec_hex_supported(srec_hex_impl_t impl)
+{
+    switch (impl)
+    {
+        case SREC_HEX_SCALAR:
+        case SREC_HEX_TABLE:
+            return true;
+#if SREC_HEX_X86
+        case SREC_HEX_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case SREC_HEX_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+bool srec_hex_select(srec_hex_impl_t impl)
+{
+    if ((impl >= SREC_HEX_IMPL_COUNT) || !srec_hex_supported(impl))
+    {
+        return false;
+    }
+    selected = impl;
+    decode = impl_fn[impl];
+    return true;
+}
+
+srec_hex_impl_t srec_hex_selected(void)
+{
+    if (selected == SREC_HEX_IMPL_COUNT)
+    {
+        /* Fastest first */
+        for (int impl = SREC_HEX_IMPL_COUNT - 1; !srec_hex_select((srec_hex_impl_t)impl); impl--)
+        {
+        }
+    }
+    return selected;
+}
+
+static bool decode_resolve(const char *hex, uint8_t *out, uint32_t n, uint8_t *sum, uint32_t *bad)
+{
+    (void)srec_hex_selected();
+    return decode(hex, out, n, sum, bad);
+}
+
+bool srec_hex_decode(const char *hex, uint8_t *out, uint32_t n, uint8_t *sum, uint32_t *bad)
+{
+    return decode(hex, out, n, sum, bad);
+}
+
+const char *srec_hex_impl_str(srec_hex_impl_t impl)
+{
+    switch (impl)
+    {
+        case SREC_HEX_SCALAR:   return "scalar";
+        case SREC_HEX_TABLE:    return "table";
+        case SREC_HEX_SSE2:     return "sse2";
+        case SREC_HEX_AVX2:     return "avx2";
+        default:                return "unknown";
+    }
+}
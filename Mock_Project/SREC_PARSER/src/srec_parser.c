@@ -1,113 +1,328 @@
 #include "../include/srec_parser.h"
+#include "../include/srec_hex.h"
+#include <string.h>
 
-int main(int argc, char *argv[])
-{
-    FILE *fp = fopen(argv[1], "r");
+#define READ_CHUNK_SIZE     4096U
 
-    bool status = parse_file(fp);
-    fclose(fp);
-    return status;
-}
+bool parse_file(FILE* fp, srec_image_t *img){
+    srec_parser_t parser;
+    char chunk[READ_CHUNK_SIZE];
+    size_t n;
 
-bool parse_file(FILE* fp){
-    bool ret = true;
-    char line[256];
-    while (fgets(line, sizeof(line), fp) != NULL)
+    srec_parser_init(&parser, img);
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
     {
-        if(!parse_line(line))
+        if (srec_parser_feed(&parser, chunk, n) != SREC_OK)
         {
-            fprintf(stderr, "ERROR: parse line error");
-            ret = false;
             break;
         }
     }
-    return ret;
+    if (srec_parser_finish(&parser) != SREC_OK)
+    {
+        if (parser.col != 0)
+        {
+            fprintf(stderr, "ERROR: line %u, column %u: %s\n", parser.line_no, parser.col, srec_status_str(parser.status));
+        }
+        else
+        {
+            fprintf(stderr, "ERROR: line %u: %s\n", parser.line_no, srec_status_str(parser.status));
+        }
+        return false;
+    }
+    return true;
 }
 
-bool parse_line(char* line){
-    bool ret = true;
-    int addr_len = 0; //address length 
-    char addr[100]; //adress field 
-    char data[100]; //data field 
-    int byte_count = 0;
-    int checksum = 0;
-    /* If the first character is S, it's the start of Motorola S-rec format */
-    if(line[0] == 'S') 
+/* ============================ Memory image ============================ */
+void srec_image_init(srec_image_t *img, uint8_t *mem, uint32_t base, uint32_t size)
+{
+    img->mem = mem;
+    img->base = base;
+    img->size = size;
+    img->seg_count = 0;
+    img->last = 0;
+    img->entry = 0;
+    img->has_entry = false;
+    memset(mem, SREC_FILL_BYTE, size);
+}
+
+srec_status_t srec_image_write(srec_image_t *img, uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    uint64_t end = (uint64_t)addr + len;
+    uint32_t i;
+
+    if ((addr < img->base) || (end > ((uint64_t)img->base + img->size)))
+    {
+        return SREC_ERR_RANGE;
+    }
+    if (len == 0)
     {
-        /* Check if the second character is a digit */
-        if(isdigit(line[1])) 
+        return SREC_OK;
+    }
+
+    /* Records are normally in ascending order: extend the segment hit last time */
+    if (img->seg_count > 0)
+    {
+        srec_segment_t *s = &img->seg[img->last];
+        bool next_clear = ((img->last + 1U) == img->seg_count) || (end <= img->seg[img->last + 1U].addr);
+
+        if (((s->addr + s->len) == addr) && next_clear)
         {
-        /* Check if the length of a packet having minimum length >= 0x03*/
-            if((hex_to_val(line[2]) >= 0) && (hex_to_val(line[3]) >=3))
+            memcpy(&img->mem[addr - img->base], data, len);
+            s->len += len;
+            /* Closed the hole to the next segment: merge it in */
+            if (((img->last + 1U) < img->seg_count) && (end == img->seg[img->last + 1U].addr))
             {
-                /* Calculate the length of address + data + checksum */
-                byte_count = (hex_to_val(line[2]))*16 + (hex_to_val(line[3]));
-                /* Check if the checksum has an error or something */
-                checksum = ascii_hex_to_byte(line[strlen(line)-2]);
-                if(checksum == (0xFF - ((sum_of_bytes(line[4], strlen(byte_count - 2))) & 0xFF))) 
-                {
-                    switch(line[1])
-                    {
-                        case '0':
-                            //Do something
-                        case '1':
-                            addr_len = 2;
-                            strcnp(addr, line[4],2); 
-            
-                        case '2':
-                            addr_len = 3;
-                            strcnp(addr, line[4], 3);
-                        case '3':
-                            addr_len = 4;
-                            strcnp(addr, line[4], 4);
-                        case '7':
-                        case '8':
-                        case '9':
-                        default:
-                            printf("Doesn't support this kind of format!"); 
-                            ret = false;
-                    }
-                }
-                else 
-                {
-                    fprintf(stderr, "ERROR: Checksum not matched, error happens!");
-                    ret = false;
-                }
-            } 
-            else 
-            {
-                fprintf(stderr, "ERROR: The length of a packer should be >= 0x03");   
-                ret = false;
+                s->len += img->seg[img->last + 1U].len;
+                memmove(&img->seg[img->last + 1U], &img->seg[img->last + 2U],
+                        (img->seg_count - img->last - 2U) * sizeof(srec_segment_t));
+                img->seg_count--;
             }
+            return SREC_OK;
+        }
+    }
+
+    /* General case: first segment ending at or after addr */
+    for (i = 0; (i < img->seg_count) && ((img->seg[i].addr + img->seg[i].len) < addr); i++)
+    {
+    }
+    if ((i < img->seg_count) && (img->seg[i].addr < end) && (addr < (img->seg[i].addr + img->seg[i].len)))
+    {
+        return SREC_ERR_OVERLAP;
+    }
+    if (((i + 1U) < img->seg_count) && (img->seg[i + 1U].addr < end))
+    {
+        return SREC_ERR_OVERLAP;
+    }
+
+    memcpy(&img->mem[addr - img->base], data, len);
+
+    if ((i < img->seg_count) && ((img->seg[i].addr + img->seg[i].len) == addr))
+    {
+        /* Appends to segment i, possibly reaching segment i + 1 */
+        img->seg[i].len += len;
+        if (((i + 1U) < img->seg_count) && (img->seg[i + 1U].addr == end))
+        {
+            img->seg[i].len += img->seg[i + 1U].len;
+            memmove(&img->seg[i + 1U], &img->seg[i + 2U], (img->seg_count - i - 2U) * sizeof(srec_segment_t));
+            img->seg_count--;
+        }
+    }
+    else if ((i < img->seg_count) && (img->seg[i].addr == end))
+    {
+        /* Prepends to segment i */
+        img->seg[i].addr = addr;
+        img->seg[i].len += len;
+    }
+    else
+    {
+        if (img->seg_count == SREC_MAX_SEGMENTS)
+        {
+            return SREC_ERR_SEGMENTS;
         }
-        else 
+        memmove(&img->seg[i + 1U], &img->seg[i], (img->seg_count - i) * sizeof(srec_segment_t));
+        img->seg[i].addr = addr;
+        img->seg[i].len = len;
+        img->seg_count++;
+    }
+    img->last = i;
+    return SREC_OK;
+}
+
+void srec_image_coalesce(srec_image_t *img, uint32_t gap)
+{
+    uint32_t out = 0;
+
+    for (uint32_t i = 1; i < img->seg_count; i++)
+    {
+        srec_segment_t *prev = &img->seg[out];
+
+        if ((img->seg[i].addr - (prev->addr + prev->len)) <= gap)
+        {
+            prev->len = (img->seg[i].addr + img->seg[i].len) - prev->addr;
+        }
+        else
         {
-            fprintf(stderr, "ERROR: The second character should be a digit");
-            ret = false; 
+            img->seg[++out] = img->seg[i];
         }
-    } 
-    else 
+    }
+    if (img->seg_count > 0)
+    {
+        img->seg_count = out + 1U;
+    }
+    img->last = 0;
+}
+
+/* ============================ Record parser ============================ */
+void srec_parser_init(srec_parser_t *p, srec_image_t *img)
+{
+    p->image = img;
+    p->line_len = 0;
+    p->line_no = 0;
+    p->col = 0;
+    p->data_records = 0;
+    p->count_value = 0;
+    p->count_pos = 0;
+    p->has_count = false;
+    p->defer_count = false;
+    p->status = SREC_OK;
+}
+
+/* Decode and apply one record (no line terminator) */
+static srec_status_t parse_record(srec_parser_t *p, const char *line, uint32_t len)
+{
+    /* Address length per record type, 0 = not a valid type */
+    static const uint8_t addr_len_of[10] = { 2, 2, 3, 4, 0, 2, 3, 4, 3, 2 };
+    uint8_t bytes[255];
+    uint32_t addr_len;
+    uint32_t count;
+    uint32_t addr = 0;
+    uint8_t sum = 0;
+    uint32_t bad;
+
+    /* Tolerate trailing whitespace such as the CR of a CR/LF file */
+    while ((len > 0) && isspace((unsigned char)line[len - 1]))
+    {
+        len--;
+    }
+    if (len == 0)
+    {
+        return SREC_OK;
+    }
+
+    /* If the first character is S, it's the start of Motorola S-rec format */
+    if (line[0] != 'S')
+    {
+        p->col = 1;
+        return SREC_ERR_START;
+    }
+    if ((len < 2) || !isdigit((unsigned char)line[1]) || (addr_len_of[line[1] - '0'] == 0))
+    {
+        p->col = 2;
+        return SREC_ERR_TYPE;
+    }
+    addr_len = addr_len_of[line[1] - '0'];
+
+    if (len < 4)
+    {
+        return SREC_ERR_LENGTH;
+    }
+    if (!srec_hex_decode(&line[2], bytes, 1, &sum, &bad))
+    {
+        p->col = 3U + bad;
+        return SREC_ERR_HEX;
+    }
+    /* Count covers address + data + checksum */
+    count = bytes[0];
+    if ((count < (addr_len + 1U)) || (len != (4U + (2U * count))))
+    {
+        return SREC_ERR_LENGTH;
+    }
+
+    /* Decode and sum the rest of the record in one pass */
+    if (!srec_hex_decode(&line[4], bytes, count, &sum, &bad))
+    {
+        p->col = 5U + bad;
+        return SREC_ERR_HEX;
+    }
+    /* One's complement: count + address + data + checksum sums to 0xFF */
+    if (sum != 0xFF)
+    {
+        p->col = len - 1U;
+        return SREC_ERR_CHECKSUM;
+    }
+
+    for (uint32_t i = 0; i < addr_len; i++)
+    {
+        addr = (addr << 8) | bytes[i];
+    }
+
+    switch (line[1])
     {
-        fprintf(stderr, "ERROR: The first character is not S");
-        ret = false;
+        case '0':
+            /* Header, nothing to program */
+            return SREC_OK;
+        case '1':
+        case '2':
+        case '3':
+            p->data_records++;
+            return srec_image_write(p->image, addr, &bytes[addr_len], count - addr_len - 1U);
+        case '5':
+        case '6':
+            p->count_value = addr;
+            p->count_pos = p->data_records;
+            p->has_count = true;
+            return (p->defer_count || (addr == p->data_records)) ? SREC_OK : SREC_ERR_COUNT;
+        default:
+            /* S7/S8/S9 */
+            p->image->entry = addr;
+            p->image->has_entry = true;
+            return SREC_OK;
     }
-    return ret;
 }
 
-// Convert one ASCII hex digit to its integer value
-static uint8_t hex_to_val(char c) {
-    if ('0' <= c && c <= '9') return c - '0';
-    if ('A' <= c && c <= 'F') return c - 'A' + 10;
-    if ('a' <= c && c <= 'f') return c - 'a' + 10;
-    return 0; // Invalid, handle error in real code
+srec_status_t srec_parser_feed(srec_parser_t *p, const char *buf, size_t len)
+{
+    const char *end = buf + len;
+
+    while ((p->status == SREC_OK) && (buf < end))
+    {
+        const char *nl = memchr(buf, '\n', (size_t)(end - buf));
+        size_t n = (nl != NULL) ? (size_t)(nl - buf) : (size_t)(end - buf);
+
+        if ((nl != NULL) && (p->line_len == 0))
+        {
+            /* Whole record inside this chunk: parse in place, no copy */
+            p->line_no++;
+            p->status = (n > SREC_MAX_LINE) ? SREC_ERR_LENGTH : parse_record(p, buf, (uint32_t)n);
+        }
+        else
+        {
+            if ((p->line_len + n) > SREC_MAX_LINE)
+            {
+                p->line_no++;
+                p->status = SREC_ERR_LENGTH;
+                break;
+            }
+            memcpy(&p->line[p->line_len], buf, n);
+            p->line_len += (uint32_t)n;
+            if (nl != NULL)
+            {
+                p->line_no++;
+                p->status = parse_record(p, p->line, p->line_len);
+                p->line_len = 0;
+            }
+        }
+        buf += n + ((nl != NULL) ? 1U : 0U);
+    }
+    return p->status;
 }
 
-uint8_t ascii_hex_to_byte(const char *s)
+srec_status_t srec_parser_finish(srec_parser_t *p)
 {
-    return (ascii_to_nibble(s[0]) << 4) | ascii_to_nibble(s[1]);
+    if ((p->status == SREC_OK) && (p->line_len > 0))
+    {
+        p->line_no++;
+        p->status = parse_record(p, p->line, p->line_len);
+        p->line_len = 0;
+    }
+    return p->status;
 }
 
-// Convert two ASCII hex digits into one byte
-static uint8_t hex_to_byte(const char *s) {
-    return (hex_to_val(s[0]) << 4) | hex_to_val(s[1]);
-}
\ No newline at end of file
+const char *srec_status_str(srec_status_t status)
+{
+    switch (status)
+    {
+        case SREC_OK:               return "ok";
+        case SREC_ERR_START:        return "the first character is not S";
+        case SREC_ERR_TYPE:         return "unsupported record type";
+        case SREC_ERR_LENGTH:       return "byte count does not match the record length";
+        case SREC_ERR_HEX:          return "invalid hex character";
+        case SREC_ERR_CHECKSUM:     return "checksum not matched";
+        case SREC_ERR_RANGE:        return "address outside the flash image";
+        case SREC_ERR_OVERLAP:      return "address written twice";
+        case SREC_ERR_SEGMENTS:     return "too many segments";
+        case SREC_ERR_COUNT:        return "record count not matched";
+        case SREC_ERR_ELF:          return "malformed ELF file";
+        default:                    return "unknown error";
+    }
+}
@@ -0,0 +1,144 @@
+/*
+ * Host test of the sector delta: diff -> patch -> apply -> compare, and the
+ * patches that must be refused without touching the image.
+ *
+ *   gcc -O2 -Wall -Wextra -Iinclude tests/test_srec_diff.c src/srec_diff.c \
+ *       src/srec_parser.c src/srec_hex.c -o test_srec_diff && ./test_srec_diff
+ */
+#include "../include/srec_parser.h"
+#include "../include/srec_diff.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_SIZE       (16U * SREC_SECTOR_SIZE)
+
+static uint8_t old_mem[TEST_SIZE];
+static uint8_t new_mem[TEST_SIZE];
+static uint8_t work_mem[TEST_SIZE];
+static uint8_t before[TEST_SIZE];
+static srec_image_t old_img, new_img, work;
+static srec_diff_t diff;
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static void fill_random(uint8_t *p, uint32_t len, uint32_t seed)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        seed = (seed * 1103515245U) + 12345U;
+        p[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+/* Write a sector range of buf into img so it shows up as a segment */
+static void put(srec_image_t *img, uint32_t sector, uint32_t count, const uint8_t *buf)
+{
+    srec_status_t s = srec_image_write(img, sector * SREC_SECTOR_SIZE, buf, count * SREC_SECTOR_SIZE);
+
+    CHECK(s == SREC_OK);
+}
+
+static uint8_t *make_patch(size_t *len)
+{
+    char *buf = NULL;
+    FILE *fp = open_memstream(&buf, len);
+
+    CHECK(fp != NULL);
+    CHECK(srec_write_patch_bin(fp, &new_img, &diff));
+    fclose(fp);
+    return (uint8_t *)buf;
+}
+
+/* work = old image with its segments */
+static void load_old(void)
+{
+    srec_image_init(&work, work_mem, 0, TEST_SIZE);
+    put(&work, 0, 8, old_mem);
+    memcpy(before, work_mem, TEST_SIZE);
+}
+
+/* A refused patch leaves the image as it was */
+static void expect_refused(const uint8_t *patch, size_t len, srec_status_t status)
+{
+    load_old();
+    CHECK(srec_apply_patch(&work, patch, len) == status);
+    CHECK(memcmp(work_mem, before, TEST_SIZE) == 0);
+}
+
+int main(void)
+{
+    static uint8_t data[8U * SREC_SECTOR_SIZE];
+    uint32_t kinds[4] = { 0 };
+    uint8_t *patch;
+    uint8_t *bad;
+    size_t len;
+
+    /* Old: sectors 0..7. New: vectors edited, sector 3 changed, 5 erased, 10 added */
+    fill_random(data, sizeof(data), 1U);
+    srec_image_init(&old_img, old_mem, 0, TEST_SIZE);
+    put(&old_img, 0, 8, data);
+
+    data[0x10] ^= 0x5AU;
+    data[(3U * SREC_SECTOR_SIZE) + 7U] ^= 0x01U;
+    srec_image_init(&new_img, new_mem, 0, TEST_SIZE);
+    put(&new_img, 0, 5, data);
+    put(&new_img, 6, 2, &data[6U * SREC_SECTOR_SIZE]);
+    put(&new_img, 10, 1, &data[2U * SREC_SECTOR_SIZE]);
+
+    CHECK(srec_diff(&old_img, &new_img, &diff));
+    CHECK(diff.count == 4U);
+    for (uint32_t i = 0; i < diff.count; i++)
+    {
+        kinds[diff.sector[i].kind]++;
+    }
+    CHECK(kinds[SREC_SECTOR_VECTORS] == 1U);
+    CHECK(kinds[SREC_SECTOR_ERASED] == 1U);
+    CHECK(kinds[SREC_SECTOR_CHANGED] == 2U);
+
+    /* diff -> apply -> compare */
+    patch = make_patch(&len);
+    CHECK(len == (20U + (4U * 12U) + (3U * SREC_SECTOR_SIZE)));
+    load_old();
+    CHECK(srec_apply_patch(&work, patch, len) == SREC_OK);
+    CHECK(memcmp(work_mem, new_mem, TEST_SIZE) == 0);
+    CHECK(work.seg_count == 3U);
+    CHECK((work.seg[0].addr == 0U) && (work.seg[0].len == (5U * SREC_SECTOR_SIZE)));
+
+    /* Patched twice: the image is no longer the base */
+    CHECK(srec_apply_patch(&work, patch, len) == SREC_ERR_CHECKSUM);
+    CHECK(memcmp(work_mem, new_mem, TEST_SIZE) == 0);
+
+    /* Wrong base: another old image */
+    bad = malloc(len);
+    memcpy(bad, patch, len);
+    old_mem[SREC_SECTOR_SIZE * 7U] ^= 0x80U;
+    expect_refused(bad, len, SREC_ERR_CHECKSUM);
+    old_mem[SREC_SECTOR_SIZE * 7U] ^= 0x80U;
+
+    /* Corrupt last sector: nothing written, not even the sectors before it */
+    bad[len - 1U] ^= 0x01U;
+    expect_refused(bad, len, SREC_ERR_CHECKSUM);
+    memcpy(bad, patch, len);
+
+    /* Result CRC does not match, every sector does */
+    bad[16] ^= 0x01U;
+    expect_refused(bad, len, SREC_ERR_CHECKSUM);
+    memcpy(bad, patch, len);
+
+    /* Truncated, and a sector outside the window */
+    expect_refused(bad, len - 1U, SREC_ERR_LENGTH);
+    bad[20 + 3] = 0x10U;
+    expect_refused(bad, len, SREC_ERR_RANGE);
+
+    free(bad);
+    free(patch);
+    printf("%s\n", (failures == 0) ? "PASS" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
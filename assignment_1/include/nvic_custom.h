@@ -4,6 +4,88 @@
 #include "S32K144.h"
 #include <stdint.h>
 
+/*
+ * Custom NVIC layer: enable/disable, priorities, critical sections.
+ *
+ *  - Priorities are the 4-bit values the S32K144 implements (0 = most
+ *    urgent), as taken by NVIC_SetPriority() of CMSIS; this file stores them
+ *    shifted into IP[] itself. NVIC_SetGrouping() splits the 4 bits into
+ *    preemption bits and subpriority bits (AIRCR PRIGROUP); only the
+ *    preemption part decides who interrupts whom.
+ *  - NVIC_EnterCritical(ceiling) raises BASEPRI to ceiling with BASEPRI_MAX,
+ *    which never lowers it, and returns the previous value for
+ *    NVIC_ExitCritical(). Sections nest. Interrupts more urgent than the
+ *    ceiling keep running; the ceiling is the priority of the most urgent
+ *    ISR sharing the data. Ceiling 0 cannot be expressed in BASEPRI (0 turns
+ *    masking off): priority 0 ISRs are never masked, share nothing with them.
+ *  - NVIC_EnableMask()/NVIC_DisableMask() write a whole ISER/ICER word set
+ *    at once, with one barrier at the end.
+ *  - NVIC_GetDriverPriority() is the priority table of the drivers: each
+ *    one sets its IRQ priority and takes its critical section ceiling from
+ *    there. Override the defaults with -DNVIC_PRIO_PORT=1 and so on.
+ *  - Every section that raises BASEPRI is timed with the DWT cycle counter
+ *    (started by NVIC_ResetCriticalStats()). NVIC_GetCriticalStats()
+ *    reports the longest section per ceiling, and from it the worst latency
+ *    added to an ISR of each priority: the longest section with a ceiling at
+ *    or above it. Build with -DNVIC_CRITICAL_STATS_DISABLE to drop the timing.
+ *
+ * nvic_custom.c keeps its own register layout. Other files see only the
+ * declarations that do not collide with CMSIS: include core_cm4.h first.
+ */
+
+#define NVIC_PRIO_BITS          4U
+#define NVIC_PRIO_LEVELS        (1U << NVIC_PRIO_BITS)
+/* 32 IRQs per ISER/ICER word */
+#define NVIC_MASK_WORDS         ((NUMBER_OF_INT_VECTORS - 16U + 31U) / 32U)
+#define NVIC_MASK_SET(mask, irq)    ((mask)[(uint32_t)(irq) >> 5U] |= 1UL << ((uint32_t)(irq) & 0x1FUL))
+
+/* Driver priorities, 0 = most urgent */
+#ifndef NVIC_PRIO_DMA
+#define NVIC_PRIO_DMA           1U
+#endif
+#ifndef NVIC_PRIO_LPUART
+#define NVIC_PRIO_LPUART        2U
+#endif
+#ifndef NVIC_PRIO_PORT
+#define NVIC_PRIO_PORT          2U
+#endif
+#ifndef NVIC_PRIO_ADC
+#define NVIC_PRIO_ADC           3U
+#endif
+#ifndef NVIC_PRIO_LPIT
+#define NVIC_PRIO_LPIT          4U
+#endif
+
+typedef enum
+{
+	NVIC_DRIVER_DMA = 0,
+	NVIC_DRIVER_LPUART,
+	NVIC_DRIVER_PORT,
+	NVIC_DRIVER_ADC,
+	NVIC_DRIVER_LPIT,
+	NVIC_DRIVER_COUNT
+} NVIC_Driver_t;
+
+/* Critical section timing since NVIC_ResetCriticalStats(), core cycles */
+typedef struct
+{
+	uint32_t sections;                          /*!< Sections that raised BASEPRI */
+	uint32_t longest[NVIC_PRIO_LEVELS];         /*!< Longest section, per ceiling */
+	uint32_t worst_latency[NVIC_PRIO_LEVELS];   /*!< Worst added latency, per ISR priority */
+} NVIC_CriticalStats_t;
+
+void     NVIC_SetGrouping(uint32_t preempt_bits);
+uint32_t NVIC_GetGrouping(void);
+uint8_t  NVIC_GetDriverPriority(NVIC_Driver_t driver);
+void     NVIC_SetDriverPriority(NVIC_Driver_t driver, uint8_t priority);
+uint32_t NVIC_EnterCritical(uint8_t ceiling);
+void     NVIC_ExitCritical(uint32_t saved);
+void     NVIC_EnableMask(const uint32_t mask[NVIC_MASK_WORDS]);
+void     NVIC_DisableMask(const uint32_t mask[NVIC_MASK_WORDS]);
+void     NVIC_GetCriticalStats(NVIC_CriticalStats_t *stats);
+void     NVIC_ResetCriticalStats(void);
+
+#ifndef __CORE_CM4_H_DEPENDANT
 
 /* ----------------------------------------------------------------------------
    -- NVIC Register Access Layer
@@ -40,4 +122,6 @@ void NVIC_EnableIRQ(IRQn_Type IRQn);
 void NVIC_DisableIRQ(IRQn_Type IRQn);
 void NVIC_SetPriority(IRQn_Type IRQn, uint8_t priority);
 
+#endif /* __CORE_CM4_H_DEPENDANT */
+
 #endif
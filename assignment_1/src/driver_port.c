@@ -6,6 +6,7 @@
  */
 #include "driver_port.h"
 #include "../Core/Include/core_cm4.h"
+#include "nvic_custom.h"
 
 /* Lookup helpers */
 static inline uint32_t get_pcc_index(Driver_PortInstance port)
@@ -89,10 +90,15 @@ void DRIVER_PORT_PinInterruptConfig(Driver_PortInstance port,
 									Driver_PortIrqConfig irqMode)
 {
 	PORT_Type* p = get_port_base(port);
+	uint8_t priority = NVIC_GetDriverPriority(NVIC_DRIVER_PORT);
+
+	/* The port ISR must not run between the mode change and the flag clear */
+	uint32_t saved = NVIC_EnterCritical(priority);
 	p->PCR[pin] = (p->PCR[pin] & ~PORT_PCR_IRQC_MASK) | PORT_PCR_IRQC(irqMode);
 
 	/*Clear interrupt flag if there is a flag set before */
 	DRIVER_PORT_ClearInterruptFlag(port, pin);
+	NVIC_ExitCritical(saved);
 
 	/*Enabling corresponding NVIC interrupt */
 	IRQn_Type irq;
@@ -106,7 +112,7 @@ void DRIVER_PORT_PinInterruptConfig(Driver_PortInstance port,
 		default: return;
 	}
 	NVIC_ClearPendingIRQ(irq);
-	NVIC_SetPriority(irq, 2);
+	NVIC_SetPriority(irq, priority);
 	NVIC_EnableIRQ(irq);
 }
 
@@ -6,9 +6,41 @@
  */
 
 #include "driver_gpio.h"
+#include "driver_event.h"
+#include "nvic_custom.h"
 extern ARM_DRIVER_GPIO Driver_GPIO0;
 
+/* Event signals */
+#define SIG_BUTTON      0U
+
+/* Dispatch latency and idle time, refreshed on every press */
+Event_Stats_t event_stats;
+/* Longest BASEPRI critical sections, refreshed with it */
+NVIC_CriticalStats_t critical_stats;
+
+/* PORTC interrupt: pin in the top half of the parameter, trigger below */
+static void Button_Post(ARM_GPIO_Pin_t pin, uint32_t event)
+{
+	EVENT_Post(SIG_BUTTON, ((uint32_t)pin << 16) | (event & 0xFFFFU));
+}
+
+/* Runs in main, to completion */
+static void Button_Handler(uint32_t signal, uint32_t param)
+{
+	Button_Event((ARM_GPIO_Pin_t)(param >> 16), param & 0xFFFFU);
+	EVENT_GetStats(&event_stats);
+	NVIC_GetCriticalStats(&critical_stats);
+}
+
 int main(void) {
+	/* All 4 priority bits preempt; time the critical sections from here */
+	NVIC_SetGrouping(4U);
+	NVIC_ResetCriticalStats();
+
+	/* Button presses are handled in main, through the event loop */
+	EVENT_Init();
+	EVENT_Subscribe(SIG_BUTTON, 0U, Button_Handler);
+
 	/* LED Setup */
     Driver_GPIO0.Setup(LED_RED, NULL);
     Driver_GPIO0.SetDirection(LED_RED, ARM_GPIO_OUTPUT);
@@ -21,21 +53,19 @@ int main(void) {
     Driver_GPIO0.SetOutput(LED_GREEN, 1);
 
     /* Button Setup */
-    Driver_GPIO0.Setup(BUTTON1, Button_Event);
+    Driver_GPIO0.Setup(BUTTON1, Button_Post);
     Driver_GPIO0.SetDirection(BUTTON1, ARM_GPIO_INPUT);
     Driver_GPIO0.SetPullResistor(BUTTON1, ARM_GPIO_PULL_UP);
     Driver_GPIO0.SetEventTrigger(BUTTON1, ARM_GPIO_TRIGGER_FALLING_EDGE);
 
 
-    Driver_GPIO0.Setup(BUTTON2, Button_Event);
+    Driver_GPIO0.Setup(BUTTON2, Button_Post);
     Driver_GPIO0.SetDirection(BUTTON2, ARM_GPIO_INPUT);
     Driver_GPIO0.SetPullResistor(BUTTON2, ARM_GPIO_PULL_UP);
     Driver_GPIO0.SetEventTrigger(BUTTON2, ARM_GPIO_TRIGGER_FALLING_EDGE);
 
-    while(1)
-    {
-    	/* Do nothing */
-    }
+    /* Sleeps in WFI between presses */
+    EVENT_Run();
     return 0;
 }
 
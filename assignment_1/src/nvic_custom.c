@@ -1,5 +1,7 @@
 #include "nvic_custom.h"
 
+#define NVIC_PRIO_SHIFT         (8U - NVIC_PRIO_BITS)
+
 void NVIC_EnableIRQ(IRQn_Type IRQn)
 {
 	if(IRQn >= 0)
@@ -23,9 +25,190 @@ void NVIC_DisableIRQ(IRQn_Type IRQn)
     }
 }
 
+/* priority is the 4-bit level: the S32K144 implements the top bits of IP[] */
 void NVIC_SetPriority(IRQn_Type IRQn, uint8_t priority)
 {
     if (IRQn >= 0) {
-        NVIC->IP[(uint32_t)IRQn] = priority & 0xFFU;
+        NVIC->IP[(uint32_t)IRQn] = (uint8_t)((priority & (NVIC_PRIO_LEVELS - 1U)) << NVIC_PRIO_SHIFT);
     }
 }
+
+/* System control and debug registers used below (core_cm4.h is not included here) */
+#define NVIC_SCB_AIRCR          (*(volatile uint32_t *)0xE000ED0CUL)
+#define NVIC_AIRCR_VECTKEY      (0x05FAUL << 16U)
+#define NVIC_AIRCR_PRIGROUP_POS 8U
+#define NVIC_AIRCR_PRIGROUP_MSK (7UL << NVIC_AIRCR_PRIGROUP_POS)
+#define NVIC_DEMCR              (*(volatile uint32_t *)0xE000EDFCUL)
+#define NVIC_DEMCR_TRCENA       (1UL << 24U)
+#define NVIC_DWT_CTRL           (*(volatile uint32_t *)0xE0001000UL)
+#define NVIC_DWT_CTRL_CYCCNTENA (1UL << 0U)
+#define NVIC_DWT_CYCCNT         (*(volatile uint32_t *)0xE0001004UL)
+
+/* Priority table of the drivers, indexed by NVIC_Driver_t */
+static uint8_t driver_prio[NVIC_DRIVER_COUNT] =
+{
+	NVIC_PRIO_DMA,
+	NVIC_PRIO_LPUART,
+	NVIC_PRIO_PORT,
+	NVIC_PRIO_ADC,
+	NVIC_PRIO_LPIT
+};
+
+/* Per ceiling: one section at most is open at each BASEPRI level */
+static uint32_t crit_start[NVIC_PRIO_LEVELS];
+static uint32_t crit_longest[NVIC_PRIO_LEVELS];
+static uint32_t crit_sections = 0;
+
+static inline uint32_t get_basepri(void)
+{
+	uint32_t value;
+
+	__asm volatile ("mrs %0, basepri" : "=r" (value));
+	return value;
+}
+
+static inline void set_basepri(uint32_t value)
+{
+	__asm volatile ("msr basepri, %0" : : "r" (value) : "memory");
+}
+
+/* Raises only: a lower value than the current one is ignored */
+static inline void set_basepri_max(uint32_t value)
+{
+	__asm volatile ("msr basepri_max, %0" : : "r" (value) : "memory");
+}
+
+/* Split the 4 priority bits: preempt_bits for preemption, the rest subpriority */
+void NVIC_SetGrouping(uint32_t preempt_bits)
+{
+	uint32_t aircr;
+
+	if (preempt_bits > NVIC_PRIO_BITS)
+	{
+		preempt_bits = NVIC_PRIO_BITS;
+	}
+	aircr = NVIC_SCB_AIRCR & ~(0xFFFFUL << 16U) & ~NVIC_AIRCR_PRIGROUP_MSK;
+	NVIC_SCB_AIRCR = aircr | NVIC_AIRCR_VECTKEY |
+	                 ((7UL - preempt_bits) << NVIC_AIRCR_PRIGROUP_POS);
+	__asm volatile ("dsb");
+}
+
+/* Preemption bits of the current grouping */
+uint32_t NVIC_GetGrouping(void)
+{
+	uint32_t prigroup = (NVIC_SCB_AIRCR & NVIC_AIRCR_PRIGROUP_MSK) >> NVIC_AIRCR_PRIGROUP_POS;
+
+	return (prigroup < (8U - NVIC_PRIO_BITS)) ? NVIC_PRIO_BITS : (7U - prigroup);
+}
+
+uint8_t NVIC_GetDriverPriority(NVIC_Driver_t driver)
+{
+	return (driver < NVIC_DRIVER_COUNT) ? driver_prio[driver] : (uint8_t)(NVIC_PRIO_LEVELS - 1U);
+}
+
+/* Takes effect for the IRQs and sections the driver sets up afterwards */
+void NVIC_SetDriverPriority(NVIC_Driver_t driver, uint8_t priority)
+{
+	if (driver < NVIC_DRIVER_COUNT)
+	{
+		driver_prio[driver] = priority & (NVIC_PRIO_LEVELS - 1U);
+	}
+}
+
+/* Mask interrupts of priority ceiling and below; returns the value for NVIC_ExitCritical() */
+uint32_t NVIC_EnterCritical(uint8_t ceiling)
+{
+	uint32_t saved = get_basepri();
+
+	set_basepri_max(((uint32_t)ceiling & (NVIC_PRIO_LEVELS - 1U)) << NVIC_PRIO_SHIFT);
+#ifndef NVIC_CRITICAL_STATS_DISABLE
+	if (get_basepri() != saved)
+	{
+		crit_start[ceiling & (NVIC_PRIO_LEVELS - 1U)] = NVIC_DWT_CYCCNT;
+	}
+#endif
+	return saved;
+}
+
+void NVIC_ExitCritical(uint32_t saved)
+{
+#ifndef NVIC_CRITICAL_STATS_DISABLE
+	uint32_t current = get_basepri();
+
+	if (current != saved)
+	{
+		uint32_t ceiling = current >> NVIC_PRIO_SHIFT;
+		uint32_t cycles = NVIC_DWT_CYCCNT - crit_start[ceiling];
+
+		/* More urgent sections may preempt this count: it is a statistic */
+		crit_sections++;
+		if (cycles > crit_longest[ceiling])
+		{
+			crit_longest[ceiling] = cycles;
+		}
+	}
+#endif
+	set_basepri(saved);
+}
+
+/* Enable every IRQ set in mask, a word of ISER at a time */
+void NVIC_EnableMask(const uint32_t mask[NVIC_MASK_WORDS])
+{
+	for (uint32_t i = 0U; i < NVIC_MASK_WORDS; i++)
+	{
+		if (mask[i] != 0U)
+		{
+			NVIC->ISER[i] = mask[i];
+		}
+	}
+	__asm volatile ("dsb");
+	__asm volatile ("isb");
+}
+
+void NVIC_DisableMask(const uint32_t mask[NVIC_MASK_WORDS])
+{
+	for (uint32_t i = 0U; i < NVIC_MASK_WORDS; i++)
+	{
+		if (mask[i] != 0U)
+		{
+			NVIC->ICER[i] = mask[i];
+		}
+	}
+	__asm volatile ("dsb");
+	__asm volatile ("isb");
+}
+
+/* An ISR of priority p waits for sections whose ceiling has a group priority at or above its own */
+void NVIC_GetCriticalStats(NVIC_CriticalStats_t *stats)
+{
+	uint32_t sub_bits = NVIC_PRIO_BITS - NVIC_GetGrouping();
+
+	stats->sections = crit_sections;
+	for (uint32_t c = 0U; c < NVIC_PRIO_LEVELS; c++)
+	{
+		stats->longest[c] = crit_longest[c];
+	}
+	for (uint32_t p = 0U; p < NVIC_PRIO_LEVELS; p++)
+	{
+		stats->worst_latency[p] = 0U;
+		for (uint32_t c = 1U; c < NVIC_PRIO_LEVELS; c++)
+		{
+			if (((p >> sub_bits) >= (c >> sub_bits)) && (stats->longest[c] > stats->worst_latency[p]))
+			{
+				stats->worst_latency[p] = stats->longest[c];
+			}
+		}
+	}
+}
+
+/* Start the cycle counter and a new statistics window */
+void NVIC_ResetCriticalStats(void)
+{
+	NVIC_DEMCR |= NVIC_DEMCR_TRCENA;
+	NVIC_DWT_CTRL |= NVIC_DWT_CTRL_CYCCNTENA;
+	for (uint32_t c = 0U; c < NVIC_PRIO_LEVELS; c++)
+	{
+		crit_longest[c] = 0U;
+	}
+	crit_sections = 0U;
+}
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""Pack a raw .data image for init_unpack() (format in include/startup.h).
+
+Flow, on the ELF linked normally:
+
+    arm-none-eabi-objcopy -O binary -j .data app.elf data.bin
+    python3 pack_data.py data.bin data.pk
+    arm-none-eabi-objcopy -I binary -O elf32-littlearm -B arm \
+        --rename-section .data=.data_packed,alloc,load,readonly,data,contents \
+        data.pk data_pk.o
+
+then relink with data_pk.o, -DSTARTUP_PACKED_DATA on startup.c and
+-Wl,--defsym=__packed_data__=1. With that symbol S32K144_64_flash.ld gives
+.data no flash: its load address is its RAM address and .code and
+.customSectionBlock are loaded straight after .data_packed, so the image
+shrinks by the difference. Drop the RAM-addressed .data load image when
+producing the flash file:
+
+    arm-none-eabi-objcopy -O ihex -R .data app.elf app.hex
+
+The .data RAM layout must not change between the two links (same objects,
+same flags), or the packed image no longer matches it. Flash addresses in
+.data stay valid: .data_packed sits after everything else in m_text.
+"""
+
+import sys
+
+LITERAL, ZERO, FILL, END = 0, 1, 2, 3
+LEN_MASK = 0x3F
+MIN_RUN = 4     # shorter runs stay in literals
+
+
+def token(kind, length):
+    """Token byte and LZ4-style extension bytes for a run of length bytes."""
+    n = length - 1
+    if n < LEN_MASK:
+        return bytes([(kind << 6) | n])
+    out = bytearray([(kind << 6) | LEN_MASK])
+    n = length - 1 - LEN_MASK
+    while n >= 0xFF:
+        out.append(0xFF)
+        n -= 0xFF
+    out.append(n)
+    return bytes(out)
+
+
+def pack(data):
+    out = bytearray()
+    lit = bytearray()
+    i = 0
+
+    def flush():
+        if lit:
+            out.extend(token(LITERAL, len(lit)))
+            out.extend(lit)
+            lit.clear()
+
+    while i < len(data):
+        j = i
+        while j < len(data) and data[j] == data[i]:
+            j += 1
+        if j - i >= MIN_RUN:
+            flush()
+            if data[i] == 0:
+                out.extend(token(ZERO, j - i))
+            else:
+                out.extend(token(FILL, j - i))
+                out.append(data[i])
+        else:
+            lit.extend(data[i:j])
+        i = j
+    flush()
+    out.append(END << 6)
+    while len(out) % 4:
+        out.append(0)
+    return bytes(out)
+
+
+def unpack(packed):
+    """Reference decoder, same walk as init_unpack()."""
+    out = bytearray()
+    i = 0
+    while True:
+        t = packed[i]
+        i += 1
+        kind, length = t >> 6, (t & LEN_MASK) + 1
+        if kind == END:
+            return bytes(out)
+        if (t & LEN_MASK) == LEN_MASK:
+            while True:
+                ext = packed[i]
+                i += 1
+                length += ext
+                if ext != 0xFF:
+                    break
+        if kind == LITERAL:
+            out.extend(packed[i:i + length])
+            i += length
+        elif kind == ZERO:
+            out.extend(bytes(length))
+        else:
+            out.extend(bytes([packed[i]]) * length)
+            i += 1
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write("usage: pack_data.py data.bin data.pk\n")
+        return 2
+    with open(argv[1], "rb") as f:
+        data = f.read()
+    packed = pack(data)
+    assert unpack(packed) == data
+    with open(argv[2], "wb") as f:
+        f.write(packed)
+    print("%s: %d -> %d bytes" % (argv[1], len(data), len(packed)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
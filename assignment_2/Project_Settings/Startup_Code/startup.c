@@ -60,6 +60,171 @@ static volatile uint32_t * const s_vectors[NUMBER_OF_CORES] = FEATURE_INTERRUPT_
  * Code
  ******************************************************************************/
 
+/*FUNCTION**********************************************************************
+ *
+ * Function Name : init_copy
+ * Description   : Copy [src, src_end) to dst.
+ * When source and destination share their alignment, the bytes up to a word
+ * boundary are copied one by one, then 16 bytes per LDM/STM pair, then the
+ * remaining words and bytes. Otherwise the copy is bytewise.
+ *
+ * Implements    : init_copy_Activity
+ *END**************************************************************************/
+void init_copy(uint8_t * dst, const uint8_t * src, const uint8_t * src_end)
+{
+    uint32_t len = (uint32_t)(src_end - src);
+
+    if ((((uintptr_t)dst ^ (uintptr_t)src) & 3U) == 0U)
+    {
+        while ((len != 0U) && (((uintptr_t)dst & 3U) != 0U))
+        {
+            *dst = *src;
+            dst++;
+            src++;
+            len--;
+        }
+#if defined(__GNUC__) && defined(__thumb2__)
+        if (len >= 16U)
+        {
+            uint32_t blocks = len >> 4;
+
+            __asm volatile (
+                "1: ldmia %[s]!, {r3-r6}    \n"
+                "   stmia %[d]!, {r3-r6}    \n"
+                "   subs  %[n], %[n], #1    \n"
+                "   bne   1b                \n"
+                : [s] "+r" (src), [d] "+r" (dst), [n] "+r" (blocks)
+                :
+                : "r3", "r4", "r5", "r6", "cc", "memory");
+            len &= 15U;
+        }
+#endif
+        while (len >= 4U)
+        {
+            *(uint32_t *)dst = *(const uint32_t *)src;
+            dst += 4U;
+            src += 4U;
+            len -= 4U;
+        }
+    }
+    while (len != 0U)
+    {
+        *dst = *src;
+        dst++;
+        src++;
+        len--;
+    }
+}
+
+/*FUNCTION**********************************************************************
+ *
+ * Function Name : init_zero
+ * Description   : Clear [dst, dst_end): bytes up to a word boundary, then
+ * 16 bytes per STM, then the remaining words and bytes.
+ *
+ * Implements    : init_zero_Activity
+ *END**************************************************************************/
+void init_zero(uint8_t * dst, const uint8_t * dst_end)
+{
+    uint32_t len = (uint32_t)(dst_end - dst);
+
+    while ((len != 0U) && (((uintptr_t)dst & 3U) != 0U))
+    {
+        *dst = 0U;
+        dst++;
+        len--;
+    }
+#if defined(__GNUC__) && defined(__thumb2__)
+    if (len >= 16U)
+    {
+        uint32_t blocks = len >> 4;
+
+        __asm volatile (
+            "   movs  r3, #0             \n"
+            "   movs  r4, #0             \n"
+            "   movs  r5, #0             \n"
+            "   movs  r6, #0             \n"
+            "1: stmia %[d]!, {r3-r6}     \n"
+            "   subs  %[n], %[n], #1     \n"
+            "   bne   1b                 \n"
+            : [d] "+r" (dst), [n] "+r" (blocks)
+            :
+            : "r3", "r4", "r5", "r6", "cc", "memory");
+        len &= 15U;
+    }
+#endif
+    while (len >= 4U)
+    {
+        *(uint32_t *)dst = 0U;
+        dst += 4U;
+        len -= 4U;
+    }
+    while (len != 0U)
+    {
+        *dst = 0U;
+        dst++;
+        len--;
+    }
+}
+
+/*FUNCTION**********************************************************************
+ *
+ * Function Name : init_unpack
+ * Description   : Expand a packed init image (format in startup.h) to dst.
+ * Literal runs go through init_copy, zero runs through init_zero.
+ *
+ * Implements    : init_unpack_Activity
+ *END**************************************************************************/
+uint8_t * init_unpack(uint8_t * dst, const uint8_t * src)
+{
+    for (;;)
+    {
+        uint32_t token = *src;
+        uint32_t kind = token >> 6;
+        uint32_t len = (token & INIT_PACK_LEN_MASK) + 1U;
+
+        src++;
+        if (kind == INIT_PACK_END)
+        {
+            break;
+        }
+        /* LZ4-style length extension: bytes added until one is below 0xFF */
+        if ((token & INIT_PACK_LEN_MASK) == INIT_PACK_LEN_MASK)
+        {
+            uint32_t ext;
+
+            do
+            {
+                ext = *src;
+                src++;
+                len += ext;
+            } while (ext == 0xFFU);
+        }
+        if (kind == INIT_PACK_LITERAL)
+        {
+            init_copy(dst, src, src + len);
+            src += len;
+        }
+        else if (kind == INIT_PACK_ZERO)
+        {
+            init_zero(dst, dst + len);
+        }
+        else
+        {
+            uint8_t value = *src;
+            uint32_t i;
+
+            src++;
+            for (i = 0U; i < len; i++)
+            {
+                dst[i] = value;
+            }
+        }
+        dst += len;
+    }
+    return dst;
+}
+
 /*FUNCTION**********************************************************************
  *
  * Function Name : init_data_bss
@@ -148,6 +313,9 @@ void init_data_bss(void)
 
     extern uint32_t __CUSTOM_ROM[];
     extern uint32_t __CUSTOM_END[];
+#if defined(STARTUP_PACKED_DATA)
+    extern uint32_t __DATA_PACKED[];
+#endif
 
     /* Data */
     data_ram        = (uint8_t *)__DATA_RAM;
@@ -170,35 +338,23 @@ void init_data_bss(void)
 
 #if !defined(__ARMCC_VERSION)
     /* Copy initialized data from ROM to RAM */
-    while (data_rom_end != data_rom)
-    {
-        *data_ram = *data_rom;
-        data_ram++;
-        data_rom++;
-    }
+#if defined(STARTUP_PACKED_DATA) && defined(__GNUC__) && !defined(__ICCARM__)
+    /* .data comes from the packed image; data_rom..data_rom_end is not used */
+    (void)data_rom;
+    (void)data_rom_end;
+    (void)init_unpack(data_ram, (const uint8_t *)__DATA_PACKED);
+#else
+    init_copy(data_ram, data_rom, data_rom_end);
+#endif
 
     /* Copy functions from ROM to RAM */
-    while (code_rom_end != code_rom)
-    {
-        *code_ram = *code_rom;
-        code_ram++;
-        code_rom++;
-    }
+    init_copy(code_ram, code_rom, code_rom_end);
 
     /* Clear the zero-initialized data section */
-    while(bss_end != bss_start)
-    {
-        *bss_start = 0;
-        bss_start++;
-    }
+    init_zero(bss_start, bss_end);
 
     /* Copy customsection rom to ram */
-    while(custom_rom_end != custom_rom)
-    {
-        *custom_ram = *custom_rom;
-        custom_rom++;
-        custom_ram++;
-    }
+    init_copy(custom_ram, custom_rom, custom_rom_end);
 #endif
     coreId = (uint8_t)GET_CORE_ID();
 #if defined (__ARMCC_VERSION)
@@ -0,0 +1,184 @@
+#ifndef DRIVER_CLOCK_H_
+#define DRIVER_CLOCK_H_
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#include "S32K144.h"
+#ifdef HOST_SIM
+#include "host_sim.h"
+#else
+#include "../Core/Include/core_cm4.h"
+#endif
+#include <stdint.h>
+#include "driver_common.h"
+
+/*
+ * Clock tree engine: frequencies in, register settings out.
+ *
+ *  - CLOCK_Solve() takes the wanted core, bus, slow and asynchronous
+ *    peripheral frequencies for a run mode and searches the SCG settings
+ *    (SPLL PREDIV/MULT, DIVCORE/DIVBUS/DIVSLOW, async DIV1/DIV2) that give
+ *    the highest frequencies at or below the wanted ones, within the S32K144
+ *    limits of that mode. It touches no registers, so it runs on the host.
+ *  - CLOCK_Apply() moves the chip to a solved configuration: it parks the core
+ *    on FIRC in RUN, restarts the SPLL with the new settings, waits for lock
+ *    and valid flags, then enters the target mode and updates SystemCoreClock.
+ *  - Drivers whose timing depends on a clock register a notifier. They are
+ *    called with CLOCK_EVENT_PRE_CHANGE before anything is touched and with
+ *    CLOCK_EVENT_POST_CHANGE once the new clocks run, to recompute their
+ *    dividers (baud rate, timer reloads, ...).
+ *
+ * Mode limits (Hz)       core       bus        slow       DIV1      DIV2
+ *   RUN   (SPLL)         80 M       40 M       26.67 M    80 M      40 M
+ *   HSRUN (SPLL)         112 M      56 M       28 M       80 M      40 M
+ *   VLPR  (SIRC)         4 M        4 M        1 M        4 M       4 M
+ * RUN and HSRUN always run from the SPLL (8 MHz SOSC), VLPR from SIRC. The
+ * async dividers of every enabled source get the same DIV1/DIV2 targets.
+ * For VLPR, peripherals clocked from FIRC or SPLL are moved to SIRC (the
+ * other sources must be off), and moved back on the next change.
+ *
+ * Boot bring-up does not block: CLOCK_BootStart() enables the crystal and
+ * returns, each CLOCK_BootPoll() moves on by at most one stage (SOSC valid,
+ * SPLL locked, system clock switched), so GPIO/PORT set-up can run while the
+ * oscillator starts and the SPLL locks. Every stage has a timeout; on the
+ * first failure the core stays on FIRC (48 MHz) and the report names the
+ * stage. Every wait in CLOCK_Apply() is bounded the same way.
+ */
+
+typedef enum {
+    CLOCK_MODE_RUN = 0,
+    CLOCK_MODE_HSRUN,
+    CLOCK_MODE_VLPR
+} Clock_Mode_t;
+
+/**
+\brief Wanted frequencies, each one an upper bound. 0 for div1_hz/div2_hz turns the dividers off.
+*/
+typedef struct {
+    Clock_Mode_t    mode;
+    uint32_t        core_hz;
+    uint32_t        bus_hz;
+    uint32_t        slow_hz;
+    uint32_t        div1_hz;    ///< Async DIV1 outputs
+    uint32_t        div2_hz;    ///< Async DIV2 outputs (PCC functional clocks)
+} Clock_Target_t;
+
+/**
+\brief Solved configuration: register fields and the frequencies they give
+*/
+typedef struct {
+    Clock_Mode_t    mode;
+    uint8_t         scs;        ///< System clock source: 2 = SIRC, 6 = SPLL
+    uint8_t         prediv;     ///< SPLLCFG[PREDIV]
+    uint8_t         mult;       ///< SPLLCFG[MULT]
+    uint8_t         divcore;    ///< xCCR fields, divide by value + 1
+    uint8_t         divbus;
+    uint8_t         divslow;
+    uint8_t         div1;       ///< Async divider fields, 0 = off, n = divide by 2^(n-1)
+    uint8_t         div2;
+    uint32_t        core_hz;
+    uint32_t        bus_hz;
+    uint32_t        slow_hz;
+    uint32_t        div1_hz;    ///< Async outputs of the system clock source
+    uint32_t        div2_hz;
+} Clock_Config_t;
+
+/* Notifier events */
+#define CLOCK_EVENT_PRE_CHANGE      (1UL << 0)
+#define CLOCK_EVENT_POST_CHANGE     (1UL << 1)
+
+/**
+\brief Boot bring-up stages
+*/
+typedef enum {
+    CLOCK_BOOT_IDLE = 0,        ///< CLOCK_BootStart() not called yet
+    CLOCK_BOOT_SOSC,            ///< Waiting for the crystal (SOSCVLD)
+    CLOCK_BOOT_SPLL,            ///< Waiting for SPLL lock (SPLLVLD)
+    CLOCK_BOOT_SWITCH,          ///< Waiting for CSR[SCS] = SPLL
+    CLOCK_BOOT_DONE,            ///< Running the requested configuration
+    CLOCK_BOOT_FALLBACK         ///< A stage failed: running from FIRC, 48 MHz
+} Clock_BootState_t;
+
+/**
+\brief Outcome and timing of the boot bring-up
+*/
+typedef struct {
+    Clock_BootState_t   state;
+    Clock_BootState_t   failed_stage;   ///< Stage that timed out or found its CSR locked, IDLE if none
+    uint32_t            sosc_us;        ///< Time spent in each stage
+    uint32_t            spll_us;
+    uint32_t            switch_us;
+    uint32_t            total_us;       ///< From CLOCK_BootStart() to DONE or FALLBACK
+} Clock_BootReport_t;
+
+typedef void (*Clock_Notify_t)(uint32_t event, const Clock_Config_t *cfg);
+
+/**
+\brief Notifier, owned by the caller. Fields are private to the driver.
+*/
+typedef struct Clock_Notifier_s {
+    Clock_Notify_t              cb;
+    struct Clock_Notifier_s    *next;
+} Clock_Notifier_t;
+
+/**
+  \fn          int32_t CLOCK_Init (void)
+  \brief       Allow HSRUN and VLPR (SMC PMPROT, write-once after reset).
+  \return      \ref execution_status
+
+  \fn          int32_t CLOCK_Solve (const Clock_Target_t *target, Clock_Config_t *cfg)
+  \brief       Find the settings closest to the target from below. Targets above
+               the mode limits are clamped to them. Touches no registers.
+  \param[in]   target  Wanted frequencies
+  \param[out]  cfg     Settings and achieved frequencies
+  \return      \ref execution_status (ARM_DRIVER_ERROR_PARAMETER if a target is
+               below the slowest setting)
+
+  \fn          int32_t CLOCK_Apply (const Clock_Config_t *cfg)
+  \brief       Switch to a configuration from CLOCK_Solve(), notifying the
+               registered drivers around the change. Blocks until the clocks
+               are valid.
+  \return      \ref execution_status (ARM_DRIVER_ERROR_TIMEOUT if a source did
+               not become valid: the core is then left on FIRC, in RUN)
+
+  \fn          int32_t CLOCK_BootStart (const Clock_Config_t *cfg)
+  \brief       Begin the bring-up to a RUN configuration on the SPLL, from the
+               reset state (core on FIRC). Returns at once.
+  \return      \ref execution_status
+
+  \fn          Clock_BootState_t CLOCK_BootPoll (void)
+  \brief       Advance the bring-up when its current stage is complete or has
+               timed out. Never waits.
+  \return      Stage now in progress, CLOCK_BOOT_DONE or CLOCK_BOOT_FALLBACK
+
+  \fn          const Clock_BootReport_t *CLOCK_GetBootReport (void)
+  \return      State, failed stage and stage times of the bring-up
+
+  \fn          int32_t CLOCK_SetTarget (const Clock_Target_t *target)
+  \brief       CLOCK_Solve() then CLOCK_Apply().
+
+  \fn          const Clock_Config_t *CLOCK_GetConfig (void)
+  \return      Configuration running, NULL before the first CLOCK_Apply() or
+               the end of the boot bring-up
+
+  \fn          void CLOCK_RegisterNotifier (Clock_Notifier_t *notifier, Clock_Notify_t cb)
+  \brief       Call cb around every clock change. Registering twice is harmless.
+*/
+int32_t CLOCK_Init(void);
+int32_t CLOCK_Solve(const Clock_Target_t *target, Clock_Config_t *cfg);
+int32_t CLOCK_Apply(const Clock_Config_t *cfg);
+int32_t CLOCK_BootStart(const Clock_Config_t *cfg);
+Clock_BootState_t CLOCK_BootPoll(void);
+const Clock_BootReport_t *CLOCK_GetBootReport(void);
+int32_t CLOCK_SetTarget(const Clock_Target_t *target);
+const Clock_Config_t *CLOCK_GetConfig(void);
+void    CLOCK_RegisterNotifier(Clock_Notifier_t *notifier, Clock_Notify_t cb);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_CLOCK_H_ */
@@ -0,0 +1,77 @@
+#ifndef DRIVER_DEBOUNCE_H_
+#define DRIVER_DEBOUNCE_H_
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#include "driver_gpio.h"
+
+/*
+ * Button debouncing for many inputs at once.
+ *
+ * Each pin is debounced in one of two ways:
+ *  - PORT digital filter (DFER/DFCR/DFWR), when the requested stable time fits
+ *    in the filter: the filtered edge interrupt is the event.
+ *  - Time sampling otherwise: the first edge disables the pin interrupt and
+ *    starts one LPIT0 channel. Each tick reads PDIR once per port for all pins
+ *    being debounced; a level is accepted after it held for the stable time.
+ *    The pin interrupt is armed again, on the opposite level, once the pin is
+ *    stable and no long press is being timed; the channel stops when no pin
+ *    needs it.
+ * A bounce storm therefore costs one pin interrupt and a few ticks, and yields
+ * one DEBOUNCE_EVENT_PRESS and one DEBOUNCE_EVENT_RELEASE.
+ */
+
+/* LPIT0 channel used for sampling (channels 0, 2 and 3 belong to driver_swtimer) */
+#define DEBOUNCE_LPIT_CHANNEL       1U
+#define DEBOUNCE_TICK_US            1000U
+#define DEBOUNCE_MAX_PINS           8U
+
+/* Filter clocked by LPO_CLK (128 kHz): 31 clocks, about 242 us */
+#define DEBOUNCE_FILTER_WIDTH       31U
+#define DEBOUNCE_FILTER_MAX_US      ((DEBOUNCE_FILTER_WIDTH * 1000000U) / 128000U)
+
+/* Event bits, distinct from ARM_GPIO_EVENT_xxx so one handler can take both */
+#define DEBOUNCE_EVENT_PRESS        (1UL << 3)
+#define DEBOUNCE_EVENT_RELEASE      (1UL << 4)
+#define DEBOUNCE_EVENT_LONG_PRESS   (1UL << 5)  ///< Held for long_press_ms, sent once per press
+
+/**
+\brief Debounced input configuration
+*/
+typedef struct {
+    ARM_GPIO_Pin_t  pin;
+    uint8_t         active_low;     ///< 1: pressed reads 0
+    uint32_t        stable_us;      ///< Level must hold this long to be accepted
+    uint32_t        long_press_ms;  ///< 0: no DEBOUNCE_EVENT_LONG_PRESS
+} Debounce_PinConfig_t;
+
+/**
+  \fn          int32_t DEBOUNCE_Init (ARM_GPIO_SignalEvent_t cb_event)
+  \brief       Set up the sampling LPIT0 channel (stopped) and the event callback.
+               The LPIT0 functional clock must be running or selectable (SPLL_DIV2).
+  \param[in]   cb_event  Called from interrupt context with DEBOUNCE_EVENT_xxx
+  \return      \ref execution_status
+
+  \fn          int32_t DEBOUNCE_AddPin (const Debounce_PinConfig_t *cfg)
+  \brief       Configure a pin as debounced input. The current level is taken as
+               the initial state, so no event is sent for it.
+  \param[in]   cfg  Pin configuration
+  \return      \ref execution_status
+
+  \fn          uint32_t DEBOUNCE_IsPressed (ARM_GPIO_Pin_t pin)
+  \brief       Debounced state of a pin.
+  \param[in]   pin  GPIO Pin
+  \return      1 if pressed, 0 if released or not debounced
+*/
+int32_t  DEBOUNCE_Init(ARM_GPIO_SignalEvent_t cb_event);
+int32_t  DEBOUNCE_AddPin(const Debounce_PinConfig_t *cfg);
+uint32_t DEBOUNCE_IsPressed(ARM_GPIO_Pin_t pin);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_DEBOUNCE_H_ */
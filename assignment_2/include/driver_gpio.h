@@ -18,6 +18,8 @@ extern "C"
 #define LED_BLUE    0
 #define LED_RED     1
 #define LED_GREEN   2
+#define BUTTON1     3
+#define BUTTON2     4
 
 
 typedef uint32_t ARM_GPIO_Pin_t;
@@ -31,8 +33,28 @@ typedef struct {
     uint8_t             pin;
 } pin_desp_t;
 
+/* Board wiring, expanded into pin_table and into the inline fast path below */
+#define GPIO_PIN_LIST(X)                    \
+    X(LED_BLUE,  DRIVER_PORTD, 0U)          \
+    X(LED_RED,   DRIVER_PORTD, 15U)         \
+    X(LED_GREEN, DRIVER_PORTD, 16U)         \
+    X(BUTTON1,   DRIVER_PORTC, 12U)         \
+    X(BUTTON2,   DRIVER_PORTC, 13U)
+
+#define GPIO_PIN_DESC(name, port, bit)      [name] = {port, bit},
+#define GPIO_PIN_TABLE_INIT                 { GPIO_PIN_LIST(GPIO_PIN_DESC) }
+
 extern const pin_desp_t pin_table[];
 
+#define GPIO_PORT_COUNT     5U
+
+/**
+\brief GPIO pin set: one bit mask per port (PORTA..PORTE)
+*/
+typedef struct {
+    uint32_t mask[GPIO_PORT_COUNT];
+} GPIO_PinSet_t;
+
 typedef enum {
   ARM_GPIO_INPUT,                       ///< Input (default)
   ARM_GPIO_OUTPUT                       ///< Output
@@ -125,6 +147,96 @@ typedef enum {
 */
 
 typedef void (*ARM_GPIO_SignalEvent_t) (ARM_GPIO_Pin_t pin, uint32_t event);  /* Pointer to \ref ARM_GPIO_SignalEvent : Signal GPIO Event */
+
+/**
+  \fn          int32_t GPIO_PinSetInit (GPIO_PinSet_t *set, const ARM_GPIO_Pin_t *pins, uint32_t count)
+  \brief       Build a pin set from entries of pin_table.
+  \param[out]  set    Per-port masks of the pins
+  \param[in]   pins   GPIO Pins
+  \param[in]   count  Number of pins
+  \return      \ref execution_status, ARM_GPIO_ERROR_PIN for a pin outside pin_table
+
+  \fn          void GPIO_SetOutputs (const GPIO_PinSet_t *set, const GPIO_PinSet_t *values)
+  \brief       Drive every pin of set with one PDOR write per port: the pins of a port
+               change at the same time. Read-modify-write with interrupts masked.
+  \param[in]   set     Pins to update
+  \param[in]   values  Pins of set to drive high, the others of set are driven low
+
+  \fn          void GPIO_GetInputs (const GPIO_PinSet_t *set, GPIO_PinSet_t *values)
+  \brief       Read every pin of set with one PDIR read per port.
+  \param[in]   set     Pins to read
+  \param[out]  values  Pins of set that are high
+*/
+int32_t GPIO_PinSetInit(GPIO_PinSet_t *set, const ARM_GPIO_Pin_t *pins, uint32_t count);
+void    GPIO_SetOutputs(const GPIO_PinSet_t *set, const GPIO_PinSet_t *values);
+void    GPIO_GetInputs(const GPIO_PinSet_t *set, GPIO_PinSet_t *values);
+
+/*
+ * Inline fast path. With a constant pin the descriptor and the GPIO base are
+ * folded at compile time, so GPIO_FastSetOutput(LED_RED, 1) is one store to
+ * PTD->PSOR. There is no pin check: only use pins listed in pin_table.
+ * Driver_GPIO0 stays the interface for pins chosen at run time.
+ */
+#define GPIO_FAST_PORT(name, port, bit)     case name: return port;
+#define GPIO_FAST_BIT(name, port, bit)      case name: return bit;
+
+/* Switches over GPIO_PIN_LIST, not a table: no copy of the wiring per file */
+static inline Driver_PortInstance GPIO_FastPort(ARM_GPIO_Pin_t pin)
+{
+    switch (pin)
+    {
+        GPIO_PIN_LIST(GPIO_FAST_PORT)
+        default:            return DRIVER_PORTE;
+    }
+}
+
+static inline uint32_t GPIO_FastBit(ARM_GPIO_Pin_t pin)
+{
+    switch (pin)
+    {
+        GPIO_PIN_LIST(GPIO_FAST_BIT)
+        default:            return 0U;
+    }
+}
+
+static inline GPIO_Type *GPIO_FastBase(ARM_GPIO_Pin_t pin)
+{
+    switch (GPIO_FastPort(pin))
+    {
+        case DRIVER_PORTA:  return IP_PTA;
+        case DRIVER_PORTB:  return IP_PTB;
+        case DRIVER_PORTC:  return IP_PTC;
+        case DRIVER_PORTD:  return IP_PTD;
+        default:            return IP_PTE;
+    }
+}
+
+static inline uint32_t GPIO_FastMask(ARM_GPIO_Pin_t pin)
+{
+    return 1UL << GPIO_FastBit(pin);
+}
+
+static inline void GPIO_FastSetOutput(ARM_GPIO_Pin_t pin, uint32_t val)
+{
+    if (val)
+    {
+        GPIO_FastBase(pin)->PSOR = GPIO_FastMask(pin);
+    }
+    else
+    {
+        GPIO_FastBase(pin)->PCOR = GPIO_FastMask(pin);
+    }
+}
+
+static inline void GPIO_FastToggle(ARM_GPIO_Pin_t pin)
+{
+    GPIO_FastBase(pin)->PTOR = GPIO_FastMask(pin);
+}
+
+static inline uint32_t GPIO_FastGetInput(ARM_GPIO_Pin_t pin)
+{
+    return (GPIO_FastBase(pin)->PDIR >> GPIO_FastBit(pin)) & 1UL;
+}
 void Button_Event (ARM_GPIO_Pin_t pin, uint32_t event);
 
 /**
@@ -0,0 +1,61 @@
+#ifndef DRIVER_IRQ_H_
+#define DRIVER_IRQ_H_
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#include "S32K144.h"
+#ifdef HOST_SIM
+#include "host_sim.h"
+#else
+#include "../Core/Include/core_cm4.h"
+#endif
+#include <stdint.h>
+#include "driver_common.h"
+
+/*
+ * Interrupt handlers installed straight into the RAM vector table.
+ *
+ *  - With the flash linker file, startup copies the vector table to
+ *    __VECTOR_RAM and points VTOR at it (unless __flash_vector_table__ is
+ *    defined). With the RAM linker file the table is linked in RAM already.
+ *  - IRQ_Install() writes the handler into the slot of irq, so the core
+ *    fetches it on exception entry. A driver can install one ISR per
+ *    instance, with the instance bound at compile time, instead of going
+ *    through the fixed xxx_IRQHandler symbol that finds the instance and
+ *    calls on.
+ *  - The slot is one word: installing is safe from any context, and the
+ *    next exception entry takes the new handler (DSB after the write).
+ *  - IRQ_Restore() puts the flash entry back (the xxx_IRQHandler symbol).
+ *    With the RAM linker file there is no other copy to restore from.
+ *
+ * Host builds install into the vector table of the model (SIM_SetVector()).
+ */
+
+typedef void (*IRQ_Handler_t)(void);
+
+/**
+  \fn          int32_t IRQ_Install (IRQn_Type irq, IRQ_Handler_t handler)
+  \brief       Make handler the vector of irq.
+  \return      \ref execution_status (ARM_DRIVER_ERROR_UNSUPPORTED when VTOR
+               points at the flash table)
+
+  \fn          int32_t IRQ_Restore (IRQn_Type irq)
+  \brief       Put the linked vector of irq back.
+  \return      \ref execution_status (ARM_DRIVER_ERROR_UNSUPPORTED without a
+               flash copy of the table)
+
+  \fn          IRQ_Handler_t IRQ_GetHandler (IRQn_Type irq)
+  \return      Current vector of irq, NULL if out of range
+*/
+int32_t       IRQ_Install(IRQn_Type irq, IRQ_Handler_t handler);
+int32_t       IRQ_Restore(IRQn_Type irq);
+IRQ_Handler_t IRQ_GetHandler(IRQn_Type irq);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_IRQ_H_ */
@@ -0,0 +1,92 @@
+#ifndef DRIVER_LOG_H_
+#define DRIVER_LOG_H_
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#include "S32K144.h"
+#ifdef HOST_SIM
+#include "host_sim.h"
+#else
+#include "../Core/Include/core_cm4.h"
+#endif
+#include <stdint.h>
+#include "driver_common.h"
+
+/*
+ * Deferred logging: the log site stores words, the host does the formatting.
+ *
+ *  - LOG("adc %u mV on ch %u", mv, ch) places the format string in the
+ *    .log_str section, which the linker scripts keep in the ELF as a
+ *    non-loaded INFO section: the strings never reach flash. The string's
+ *    offset in that section is its ID, a link-time constant.
+ *  - The call copies a record into a RAM buffer under PRIMASK: a header
+ *    word (ID, argument count, sync nibble), the cycle counter
+ *    (PROFILE_Cycles32(), started by PROFILE_Init()) and up to LOG_MAX_ARGS
+ *    argument words. Arguments are integers, converted to uint32_t (cast
+ *    pointers); %s and floating point are not supported. A full buffer drops
+ *    the record and counts it. Safe from any context.
+ *  - LOG_Drain(), from the main loop, moves whole buffer runs to the USART
+ *    tx ring (USART_SetRings()) and reports drops as a LOG_ID_DROPS record.
+ *  - tools/log_decode.py reads the strings back from the ELF (Assignment2.elf)
+ *    and renders the byte stream captured from the UART.
+ *
+ * Record, little-endian words:
+ *   [ID << 8 | nargs << 4 | LOG_SYNC] [cycles] [arg 0] ... [arg nargs-1]
+ *
+ * Build with -DLOG_DISABLE to compile every log site out.
+ */
+
+/* Words, a power of two */
+#ifndef LOG_BUFFER_WORDS
+#define LOG_BUFFER_WORDS    256U
+#endif
+#define LOG_MAX_ARGS        8U
+#define LOG_SYNC            0x5UL
+/* Reserved ID: one argument, the records lost since the last report */
+#define LOG_ID_DROPS        0xFFFFFFUL
+
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...)  n
+#define LOG_NARGS(...)      LOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+
+/* Offset of fmt in .log_str (its address: the section is linked at 0) */
+#define LOG_ID(fmt)                                                                     \
+    __extension__({                                                                     \
+        static const char log_str_[] __attribute__((section(".log_str"), used)) = fmt; \
+        (uint32_t)(uintptr_t)log_str_;                                                  \
+    })
+
+#define LOG_HEADER(fmt, nargs)  ((LOG_ID(fmt) << 8) | ((uint32_t)(nargs) << 4) | LOG_SYNC)
+
+#ifdef LOG_DISABLE
+#define LOG(fmt, ...)       ((void)0)
+#else
+/* The leading 0 keeps the argument array non-empty */
+#define LOG(fmt, ...)                                                           \
+    LOG_Write(LOG_HEADER(fmt, LOG_NARGS(__VA_ARGS__)),                          \
+              &((const uint32_t[]){ 0U, ##__VA_ARGS__ })[1])
+#endif
+
+/**
+  \fn          void LOG_Init (void)
+  \brief       Empty the buffer and clear the drop count.
+
+  \fn          void LOG_Write (uint32_t header, const uint32_t *args)
+  \brief       Store one record. Called through LOG().
+
+  \fn          uint32_t LOG_Drain (void)
+  \brief       Hand buffered records to USART_Write() until the buffer is empty
+               or the tx ring is full. Main loop only.
+  \return      Words still buffered
+*/
+void     LOG_Init(void);
+void     LOG_Write(uint32_t header, const uint32_t *args);
+uint32_t LOG_Drain(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_LOG_H_ */
@@ -1,9 +1,14 @@
 #ifndef DRIVER_PORT_H_
-#define DRIVER_PORT_H
+#define DRIVER_PORT_H_
 
 #include "S32K144.h"
+#ifdef HOST_SIM
+#include "host_sim.h"
+#else
 #include "../Core/Include/core_cm4.h"
+#endif
 #include <stdint.h>
+#include "driver_ring.h"
 /*
  * PORT Driver for S32K144 (CMSIS)
  * Provides basic pin multiplexing and interrupt configuration
@@ -74,6 +79,30 @@ void DRIVER_PORT_ClearInterruptFlag(Driver_PortInstance port, uint8_t pin);
 typedef void (*Driver_PortCallback)(uint8_t pin);
 void DRIVER_PORT_RegisterCallback(Driver_PortInstance port, Driver_PortCallback cb);
 
+/* Per-pin callback: ref as registered, level = pin input level (PDIR) when the ISR ran.
+ * Takes precedence over the per-port callback for that pin; NULL removes it. */
+typedef void (*Driver_PortPinCallback)(uint32_t ref, uint32_t level);
+void DRIVER_PORT_RegisterPinCallback(Driver_PortInstance port,
+									 uint8_t pin,
+									 Driver_PortPinCallback cb,
+									 uint32_t ref);
+
+/* Pin event queued by the ISR, elem_size of the event ring */
+typedef struct
+{
+	uint8_t port;	/* Driver_PortInstance */
+	uint8_t pin;
+	uint8_t level;	/* PDIR when the ISR ran */
+	uint8_t reserved;
+} Driver_PortEvent;
+
+/* Queue events of pins without a per-pin callback on ring instead of calling
+ * the per-port callback; NULL goes back to the callbacks. The five PORT ISRs
+ * are producers: use an MPSC ring if their priorities differ or other
+ * contexts push too. Events that find the ring full are counted and dropped. */
+void DRIVER_PORT_SetEventRing(Ring_t *ring);
+uint32_t DRIVER_PORT_GetEventDrops(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,132 @@
+#ifndef DRIVER_PROFILE_H_
+#define DRIVER_PROFILE_H_
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#include "S32K144.h"
+#ifdef HOST_SIM
+#include "host_sim.h"
+#else
+#include "../Core/Include/core_cm4.h"
+#endif
+#include <stdint.h>
+#include "driver_usart.h"
+
+/*
+ * Cycle timebase and profiling probes.
+ *
+ * The timebase is the Cortex-M4 DWT cycle counter, extended to 64 bits in
+ * software: PROFILE_NowCycles() must run at least once per 2^32 cycles
+ * (53 s at 80 MHz) for the wrap to be seen. Conversions to microseconds use
+ * the live SystemCoreClock. On the host build the counter is CLOCK_MONOTONIC
+ * and one cycle is one nanosecond.
+ *
+ * A probe accumulates count, min, max, mean and a log2 histogram of the cycles
+ * spent in a scope, with the cost of the probe itself subtracted:
+ *
+ *     void work(void)
+ *     {
+ *         PROFILE_SCOPE("work");
+ *         ...
+ *     }                                   <- measured up to here, also on return
+ *
+ * Probes register themselves on first use; PROFILE_Dump() prints them all.
+ * Driver entry points carry PROFILE_DRIVER_SCOPE(), active when built with
+ * -DPROFILE_DRIVERS and empty otherwise.
+ */
+
+/* Bin i counts durations of [2^i, 2^(i+1)) cycles, the last bin everything above */
+#define PROFILE_HIST_BINS       16U
+
+/**
+\brief Probe statistics, one static instance per PROFILE_SCOPE
+*/
+typedef struct Profile_Probe_s {
+    const char              *name;
+    uint32_t                count;
+    uint32_t                min;        ///< cycles
+    uint32_t                max;        ///< cycles
+    uint64_t                total;      ///< cycles
+    uint32_t                hist[PROFILE_HIST_BINS];
+    struct Profile_Probe_s  *next;      ///< Registered probes
+    uint8_t                 registered;
+} Profile_Probe_t;
+
+#define PROFILE_PROBE_INIT(name_)   { (name_), 0U, 0xFFFFFFFFUL, 0U, 0U, {0U}, NULL, 0U }
+
+typedef struct {
+    Profile_Probe_t *probe;
+    uint32_t        start;
+} Profile_Scope_t;
+
+#ifdef HOST_SIM
+uint32_t PROFILE_Cycles32(void);
+#else
+/* Low half of the timebase, enough for durations below 2^32 cycles */
+static inline uint32_t PROFILE_Cycles32(void)
+{
+    return DWT->CYCCNT;
+}
+#endif
+
+#define PROFILE_CONCAT_(a, b)   a##b
+#define PROFILE_CONCAT(a, b)    PROFILE_CONCAT_(a, b)
+
+/* Measure from here to the end of the enclosing block (GCC cleanup attribute) */
+#define PROFILE_SCOPE(name)                                                                     \
+    static Profile_Probe_t PROFILE_CONCAT(profile_probe_, __LINE__) = PROFILE_PROBE_INIT(name); \
+    Profile_Scope_t PROFILE_CONCAT(profile_scope_, __LINE__)                                    \
+        __attribute__((cleanup(PROFILE_ScopeEnd))) =                                            \
+        { &PROFILE_CONCAT(profile_probe_, __LINE__), PROFILE_Cycles32() }
+
+#ifdef PROFILE_DRIVERS
+#define PROFILE_DRIVER_SCOPE(name)  PROFILE_SCOPE(name)
+#else
+#define PROFILE_DRIVER_SCOPE(name)
+#endif
+
+/**
+  \fn          void PROFILE_Init (void)
+  \brief       Enable and clear the DWT cycle counter, measure the probe overhead.
+
+  \fn          uint64_t PROFILE_NowCycles (void)
+  \return      Core cycles since PROFILE_Init
+
+  \fn          uint64_t PROFILE_NowUs (void)
+  \return      Microseconds since PROFILE_Init, at the current SystemCoreClock
+
+  \fn          uint32_t PROFILE_CyclesToUs (uint32_t cycles)
+  \return      cycles in microseconds at the current SystemCoreClock
+
+  \fn          void PROFILE_Record (Profile_Probe_t *probe, uint32_t cycles)
+  \brief       Add one duration to a probe (registers it on first use).
+
+  \fn          void PROFILE_ScopeEnd (Profile_Scope_t *scope)
+  \brief       End of a PROFILE_SCOPE, called by the compiler.
+
+  \fn          void PROFILE_Reset (void)
+  \brief       Clear the statistics of every registered probe.
+
+  \fn          int32_t PROFILE_Dump (ARM_DRIVER_USART *usart)
+  \brief       Print one line per probe, blocking until each line is sent.
+               Call from the main loop, with the USART initialised.
+  \param[in]   usart  Driver to print on
+  \return      \ref execution_status
+*/
+void     PROFILE_Init(void);
+uint64_t PROFILE_NowCycles(void);
+uint64_t PROFILE_NowUs(void);
+uint32_t PROFILE_CyclesToUs(uint32_t cycles);
+void     PROFILE_Record(Profile_Probe_t *probe, uint32_t cycles);
+void     PROFILE_ScopeEnd(Profile_Scope_t *scope);
+void     PROFILE_Reset(void);
+int32_t  PROFILE_Dump(ARM_DRIVER_USART *usart);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_PROFILE_H_ */
@@ -0,0 +1,110 @@
+#ifndef DRIVER_SWTIMER_H_
+#define DRIVER_SWTIMER_H_
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#include "S32K144.h"
+#ifdef HOST_SIM
+#include "host_sim.h"
+#else
+#include "../Core/Include/core_cm4.h"
+#endif
+#include <stdint.h>
+#include "driver_common.h"
+
+/*
+ * Software timers multiplexed onto LPIT0, tickless.
+ *
+ *  - Timebase: channel 2 free-runs over 2^32 LPIT clocks, channel 3 is chained
+ *    to it and counts its wraps, giving a 64-bit tick count.
+ *  - Deadline: channel 0 is loaded with the time left to the earliest timer
+ *    only, and is stopped when no timer runs. There is no periodic tick.
+ *  - Running timers are kept in a binary min-heap on their deadline: start,
+ *    stop and expiry are O(log n), reading the next deadline is O(1).
+ * Callbacks run from the channel 0 ISR, or, with SWTIMER_FLAG_DEFERRED, from
+ * SWTIMER_Process() in the main loop.
+ * On a clock change (driver_clock) running timers keep their time left and
+ * period in microseconds; timers must not be started or stopped from another
+ * clock notifier.
+ */
+
+#define SWTIMER_DEADLINE_CHANNEL    0U
+#define SWTIMER_TIMEBASE_CHANNEL    2U      /* and SWTIMER_TIMEBASE_CHANNEL + 1, chained */
+
+#ifndef SWTIMER_MAX_TIMERS
+#define SWTIMER_MAX_TIMERS          256U
+#endif
+
+/* Timer flags */
+#define SWTIMER_FLAG_DEFERRED       (1UL << 0)  ///< Callback runs from SWTIMER_Process()
+
+typedef void (*SWTimer_Callback_t)(void *arg);
+
+/**
+\brief Software timer, owned by the caller. Fields are private to the driver.
+*/
+typedef struct SWTimer_s {
+    uint64_t            deadline;   ///< LPIT ticks
+    uint64_t            period;     ///< LPIT ticks, 0 for one-shot
+    SWTimer_Callback_t  cb;
+    void               *arg;
+    uint32_t            index;      ///< Position in the heap, SWTIMER_IDLE if not running
+    uint32_t            flags;
+    struct SWTimer_s   *next;       ///< Deferred queue link
+} SWTimer_t;
+
+#define SWTIMER_IDLE                0xFFFFFFFFUL
+
+/**
+  \fn          int32_t SWTIMER_Init (void)
+  \brief       Start the 64-bit timebase and set up the deadline channel.
+               Selects SPLL_DIV2 for LPIT0 unless its clock is already on.
+  \return      \ref execution_status
+
+  \fn          void SWTIMER_Setup (SWTimer_t *timer, SWTimer_Callback_t cb, void *arg, uint32_t flags)
+  \brief       Initialise a timer (not running).
+  \param[out]  timer  Timer
+  \param[in]   cb     Called on expiry with arg
+  \param[in]   flags  SWTIMER_FLAG_xxx
+
+  \fn          int32_t SWTIMER_Start (SWTimer_t *timer, uint32_t delay_us, uint32_t period_us)
+  \brief       (Re)start a timer. Periodic timers are rescheduled from their
+               deadline, not from the time the callback ran, so they do not drift.
+  \param[in]   delay_us   Time to the first expiry
+  \param[in]   period_us  Period, 0 for one-shot
+  \return      \ref execution_status (ARM_DRIVER_ERROR if SWTIMER_MAX_TIMERS run)
+
+  \fn          void SWTIMER_Stop (SWTimer_t *timer)
+  \brief       Stop a timer; a deferred callback not yet run is dropped.
+
+  \fn          uint32_t SWTIMER_IsRunning (const SWTimer_t *timer)
+  \return      1 if the timer is running
+
+  \fn          uint64_t SWTIMER_Now (void)
+  \return      LPIT ticks since SWTIMER_Init, at the rate of the LPIT clock
+               of the moment: not comparable across clock changes
+
+  \fn          uint64_t SWTIMER_NowUs (void)
+  \return      Microseconds since SWTIMER_Init
+
+  \fn          uint32_t SWTIMER_Process (void)
+  \brief       Run the deferred callbacks that are due, from the main loop.
+  \return      Number of callbacks run
+*/
+int32_t  SWTIMER_Init(void);
+void     SWTIMER_Setup(SWTimer_t *timer, SWTimer_Callback_t cb, void *arg, uint32_t flags);
+int32_t  SWTIMER_Start(SWTimer_t *timer, uint32_t delay_us, uint32_t period_us);
+void     SWTIMER_Stop(SWTimer_t *timer);
+uint32_t SWTIMER_IsRunning(const SWTimer_t *timer);
+uint64_t SWTIMER_Now(void);
+uint64_t SWTIMER_NowUs(void);
+uint32_t SWTIMER_Process(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_SWTIMER_H_ */
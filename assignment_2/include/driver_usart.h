@@ -7,6 +7,7 @@ extern "C"
 #endif
 
 #include "driver_common.h"
+#include "driver_ring.h"
 
 #define ARM_USART_API_VERSION ARM_DRIVER_VERSION_MAJOR_MINOR(2,4)  /* API version */
 
@@ -86,6 +87,17 @@ extern "C"
 #define ARM_USART_ABORT_RECEIVE             (0x19UL << ARM_USART_CONTROL_Pos)   ///< Abort \ref ARM_USART_Receive
 #define ARM_USART_ABORT_TRANSFER            (0x1AUL << ARM_USART_CONTROL_Pos)   ///< Abort \ref ARM_USART_Transfer
 
+/*----- USART Control Codes: S32K144 specific -----*/
+#define ARM_USART_CONTROL_RX_DMA            (0x80UL << ARM_USART_CONTROL_Pos)   ///< Receive through eDMA; arg = \ref ARM_USART_RX_DMA_DISABLED, \ref ARM_USART_RX_DMA_SINGLE or \ref ARM_USART_RX_DMA_PINGPONG
+
+/*----- USART Receive DMA modes (arg of ARM_USART_CONTROL_RX_DMA) -----*/
+#define ARM_USART_RX_DMA_DISABLED           0U  ///< Polled receive (default)
+#define ARM_USART_RX_DMA_SINGLE             1U  ///< eDMA fills the Receive buffer once, then stops
+#define ARM_USART_RX_DMA_PINGPONG           2U  ///< eDMA loops over the Receive buffer; RECEIVE_COMPLETE on each half
+
+/*----- USART Baud rate -----*/
+#define ARM_USART_BAUD_TOLERANCE_PERMILLE   30U ///< Largest accepted baud rate error (3 %)
+
 
 
 /****** USART specific error codes *****/
@@ -204,6 +216,10 @@ typedef struct _ARM_USART_MODEM_STATUS {
   \fn          uint32_t ARM_USART_GetRxCount (void)
   \brief       Get received data count.
   \return      number of data items received
+  \note        With \ref ARM_USART_RX_DMA_PINGPONG, RECEIVE_COMPLETE does not say which
+               half is ready. Read the count in the callback: num / 2 or more means
+               the first half, less means the second half (the count restarts
+               with the next lap).
 
   \fn          int32_t ARM_USART_Control (uint32_t control, uint32_t arg)
   \brief       Control USART Interface.
@@ -261,6 +277,31 @@ typedef struct _ARM_USART_CAPABILITIES {
 } ARM_USART_CAPABILITIES;
 
 
+/**
+  \fn          int32_t USART_CalcBaudReg (uint32_t clk_hz, uint32_t baudrate, uint32_t *baud_reg)
+  \brief       Compute the LPUART BAUD[OSR, SBR, BOTHEDGE] fields for a baud rate.
+  \param[in]   clk_hz    LPUART functional clock in Hz
+  \param[in]   baudrate  Requested baud rate
+  \param[out]  baud_reg  OSR, SBR and BOTHEDGE fields, ready to merge into BAUD
+  \return      ARM_DRIVER_OK, or \ref ARM_USART_ERROR_BAUDRATE if no divisor is within
+               \ref ARM_USART_BAUD_TOLERANCE_PERMILLE
+*/
+int32_t USART_CalcBaudReg(uint32_t clk_hz, uint32_t baudrate, uint32_t *baud_reg);
+
+/**
+  \fn          int32_t USART_SetRings (Ring_t *rx, Ring_t *tx)
+  \brief       Attach byte rings (elem_size 1) for interrupt-driven receive and
+               queued transmit; NULL detaches. Receive is refused while an rx
+               ring is attached, and DMA receive cannot be combined with it.
+  \return      \ref execution_status
+
+  \fn          uint32_t USART_Write (const void *data, uint32_t num)
+  \brief       Copy bytes to the tx ring and start the transmitter. Returns at once.
+  \return      Bytes queued, less than num when the ring is full
+*/
+int32_t  USART_SetRings(Ring_t *rx, Ring_t *tx);
+uint32_t USART_Write(const void *data, uint32_t num);
+
 /**
 \brief Access structure of the USART Driver.
 */
@@ -0,0 +1,111 @@
+#ifndef HOST_SIM_H_
+#define HOST_SIM_H_
+
+/*
+ * Host-side S32K144 peripheral model (HOST_SIM builds only)
+ *
+ * The peripheral window 0x40000000..0x400FFFFF is mapped at its real address
+ * in the host process, so the IP_xxx pointers from S32K144.h work unchanged
+ * and the drivers compile without any source change. Pages holding registers
+ * with side effects (PORTx, PTx, LPUARTx, ADC0, PDB0, LPIT0, SCG, SMC, DMA) are kept
+ * inaccessible: every access faults, is single-stepped, and the model applies
+ * the register semantics behind it:
+ *  - W1C for PORT ISFR / PCR[ISF], LPIT MSR, LPUART STAT flags, DMA INT/ERR
+ *  - set/clear/toggle for PSOR/PCOR/PTOR, read-only PDIR
+ *  - LPUART TDRE/TC/RDRF/IDLE/OR driven by virtual time and the BAUD setting
+ *  - ADC COCO after the conversion time, R[n] read clears COCO; with ADTRG,
+ *    PDB0 channel 0 pre-triggers convert SC1[n] (pre-trigger 0 timed by
+ *    DLY[0], the others back-to-back), DMAEN requests eDMA on each result,
+ *    SC2 compare function (CV1/CV2) drops results that fail it
+ *  - PDB0 software trigger, one-shot or continuous over MOD, CNT, ERR on a
+ *    pre-trigger that finds the ADC busy
+ *  - LPIT countdown/expiry (including chaining), SCG clock valid flags, the
+ *    system clock taken from RCCR/HCCR/VCCR by the SMC run mode (RUN, HSRUN,
+ *    VLPR with its entry conditions), SPLL lock only for a 180-320 MHz VCO,
+ *    and the running system clock source cannot be disabled
+ *  - eDMA minor/major loops on LPUART and ADC0 requests routed through DMAMUX
+ * Interrupt lines are level-evaluated after each access and delivered to the
+ * regular xxx_IRQHandler symbols from SIM_Advance().
+ *
+ * Time is virtual (ns). It advances by SIM_SetAccessTime() per trapped access
+ * so polling loops terminate, and explicitly through SIM_Advance().
+ * SIM_SetHooks(false) turns the window into plain memory, for timing driver
+ * hot paths with no trap overhead.
+ *
+ * Requires Linux on x86-64. DMA addresses are 32-bit, so DMA buffers must come
+ * from SIM_SramAlloc().
+ *
+ * Build example (from assignment_2):
+ *   gcc -DHOST_SIM -Iinclude -I../common/include src/host_sim.c src/driver_gpio.c src/driver_port.c \
+ *       src/driver_usart.c src/driver_debounce.c src/driver_swtimer.c \
+ *       src/driver_profile.c src/driver_clock.c ../common/src/driver_ring.c src/driver_log.c \
+ *       src/driver_irq.c src/clocks_and_modes.c app.c
+ */
+
+#include "S32K144.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+/* === CMSIS-Core subset normally provided by core_cm4.h === */
+void     NVIC_EnableIRQ(IRQn_Type IRQn);
+void     NVIC_DisableIRQ(IRQn_Type IRQn);
+uint32_t NVIC_GetEnableIRQ(IRQn_Type IRQn);
+void     NVIC_SetPendingIRQ(IRQn_Type IRQn);
+void     NVIC_ClearPendingIRQ(IRQn_Type IRQn);
+uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn);
+void     NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority);
+uint32_t NVIC_GetPriority(IRQn_Type IRQn);
+
+void     __enable_irq(void);
+void     __disable_irq(void);
+uint32_t __get_PRIMASK(void);
+void     __set_PRIMASK(uint32_t priMask);
+void     __WFI(void);
+
+/* Normally defined by system_S32K144.c; reset to the FIRC clock */
+extern uint32_t SystemCoreClock;
+
+#define __NOP()                 do { } while (0)
+#define __DSB()                 __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __ISB()                 __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __DMB()                 __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __COMPILER_BARRIER()    __asm volatile ("" ::: "memory")
+
+/* === Model control === */
+int      SIM_Init(void);
+void     SIM_Deinit(void);
+void     SIM_SetHooks(bool enable);
+void     SIM_SetAccessTime(uint32_t ns);
+uint64_t SIM_Now(void);
+void     SIM_Advance(uint64_t ns);
+uint32_t SIM_GetAccessCount(void);
+void    *SIM_SramAlloc(uint32_t size);
+/* The RAM vector table, after SIM_Init(): handler NULL restores the xxx_IRQHandler symbol */
+void     SIM_SetVector(IRQn_Type irq, void (*handler)(void));
+void   (*SIM_GetVector(IRQn_Type irq))(void);
+
+/* === Stimulus / observation === */
+/* port: 0 = PORTA .. 4 = PORTE */
+void     SIM_SetPinInput(uint32_t port, uint32_t pin, uint32_t level);
+/* Bytes that have left the LPUART TX line since the last call */
+uint32_t SIM_LPUART_ReadTx(uint32_t instance, uint8_t *buf, uint32_t max);
+/* Bytes arriving on the LPUART RX line, one frame time apart */
+void     SIM_LPUART_WriteRx(uint32_t instance, const uint8_t *data, uint32_t len);
+/* Raw result the ADC0 returns for a channel (12-bit scale) */
+void     SIM_ADC_SetInput(uint32_t channel, uint16_t raw);
+void     SIM_ADC_SetConversionTime(uint32_t ns);
+/* Conversions completed since reset, including those the compare function dropped */
+uint32_t SIM_ADC_GetConversionCount(void);
+/* false: SOSC never becomes valid, as with a missing crystal */
+void     SIM_SCG_SetCrystalPresent(bool present);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* HOST_SIM_H_ */
@@ -117,6 +117,38 @@
  */
 void init_data_bss(void);
 
+/*!
+ * @brief Copy [src, src_end) to dst, 16 bytes per LDM/STM when source and
+ * destination have the same alignment, bytewise otherwise.
+ */
+void init_copy(uint8_t * dst, const uint8_t * src, const uint8_t * src_end);
+
+/*!
+ * @brief Clear [dst, dst_end), 16 bytes per STM once word aligned.
+ */
+void init_zero(uint8_t * dst, const uint8_t * dst_end);
+
+/*
+ * Packed init image (STARTUP_PACKED_DATA, built by pack_data.py): a list of
+ * runs, each starting with a token byte.
+ *   bits 7..6  kind: 0 literal (len bytes follow), 1 zero run,
+ *              2 repeated byte (the value follows), 3 end of image (0xC0)
+ *   bits 5..0  len - 1; 0x3F means extension bytes follow, each added to len,
+ *              until one is below 0xFF
+ */
+#define INIT_PACK_LITERAL       0U
+#define INIT_PACK_ZERO          1U
+#define INIT_PACK_FILL          2U
+#define INIT_PACK_END           3U
+#define INIT_PACK_LEN_MASK      0x3FU
+
+/*!
+ * @brief Expand a packed init image to dst.
+ *
+ * @return First byte after the expanded data.
+ */
+uint8_t * init_unpack(uint8_t * dst, const uint8_t * src);
+
 #endif /* STARTUP_H*/
 /*******************************************************************************
  * EOF
@@ -1,5 +1,18 @@
 #include "clocks_and_modes.h"
 
+/* Polls of a status flag before giving up (> 5 ms on FIRC). These helpers
+ * return without the clock when it never comes; driver_clock reports why. */
+#define SCG_POLL_LIMIT  100000UL
+
+/* Wait until (*reg & mask) == value, at most SCG_POLL_LIMIT reads */
+static void scg_wait(const volatile uint32_t *reg, uint32_t mask, uint32_t value)
+{
+    for (uint32_t n = 0U; (n < SCG_POLL_LIMIT) && ((*reg & mask) != value); n++)
+    {
+        /* Do nothing */
+    }
+}
+
 void SOSC_init_8MHz(void) 
 {
     /* SOSCDIV1 & SOSCDIV2 = 1: divide by 1 */
@@ -9,7 +22,7 @@ void SOSC_init_8MHz(void)
     /* EREFS=1: Input is external XTAL */
     IP_SCG->SOSCCFG = 0x00000024;
     /* Ensure SOSCCSR unlocked */
-    while(IP_SCG->SOSCCSR & SCG_SOSCCSR_LK_MASK);
+    scg_wait(&IP_SCG->SOSCCSR, SCG_SOSCCSR_LK_MASK, 0U);
     /* LK=0: SOSCCSR can be written */
     /* SOSCCMRE=0: OSC CLK monitor IRQ if enabled */
     /* SOSCCM=0: OSC CLK monitor disabled */
@@ -19,13 +32,13 @@ void SOSC_init_8MHz(void)
     /* SOSCEN=1: Enable oscillator */
     IP_SCG->SOSCCSR = 0x00000001;
     /* Wait for sys OSC clk valid */
-    while(!(IP_SCG->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK)); 
+    scg_wait(&IP_SCG->SOSCCSR, SCG_SOSCCSR_SOSCVLD_MASK, SCG_SOSCCSR_SOSCVLD_MASK);
 }
 
 void SPLL_init_160MHz(void)
 {
     /* Ensure SPLLCSR unlocked */
-    while(IP_SCG->SPLLCSR & SCG_SPLLCSR_LK_MASK);
+    scg_wait(&IP_SCG->SPLLCSR, SCG_SPLLCSR_LK_MASK, 0U);
     /* SPLLEN=0: SPLL is disabled (default) */
     IP_SCG->SPLLCSR = 0x00;
     /* SPLLDIV1 divide by 2; SPLLDIV2 divide by 4 */
@@ -35,7 +48,7 @@ void SPLL_init_160MHz(void)
     /* SPLL_CLK = 8MHz / 1 * 40 / 2 = 160 MHz */
     IP_SCG->SPLLCFG = 0x00180000;
     /*Ensure SPLLCSR unlocked */
-    while(IP_SCG->SPLLCSR & SCG_SPLLCSR_LK_MASK);
+    scg_wait(&IP_SCG->SPLLCSR, SCG_SPLLCSR_LK_MASK, 0U);
     /* LK=0: SPLLCSR can be written */
     /* SPLLCMRE=0: SPLL CLK monitor IRQ if enabled */
     /* SPLLCM=0: SPLL CLK monitor disabled */
@@ -43,7 +56,7 @@ void SPLL_init_160MHz(void)
     /* SPLLEN=1: Enable SPLL */
     IP_SCG->SPLLCSR = 0x00000001;
     /* Wait for SPLL valid */
-    while(!(IP_SCG->SPLLCSR & SCG_SPLLCSR_SPLLVLD_MASK)); 
+    scg_wait(&IP_SCG->SPLLCSR, SCG_SPLLCSR_SPLLVLD_MASK, SCG_SPLLCSR_SPLLVLD_MASK);
 }
 
 /* Change to normal RUN mode with 8MHz SOSC, 80 MHz PLL*/
@@ -53,6 +66,82 @@ void NormalRUNmode_80MHz (void) {
     |SCG_RCCR_DIVCORE(0b01) /* DIVCORE=1, div. by 2: Core clock = 160/2 MHz = 80 MHz*/
     |SCG_RCCR_DIVBUS(0b01) /* DIVBUS=1, div. by 2: bus clock = 40 MHz*/
     |SCG_RCCR_DIVSLOW(0b10); /* DIVSLOW=2, div. by 3: SCG slow, flash clock= 26 2/3 MHz*/
-while (((IP_SCG->CSR & SCG_CSR_SCS_MASK) >> SCG_CSR_SCS_SHIFT ) != 6) {}
-/* Wait for sys clk src = SPLL */
-}
\ No newline at end of file
+    /* Wait for sys clk src = SPLL; it stays FIRC if the SPLL is not valid */
+    scg_wait(&IP_SCG->CSR, SCG_CSR_SCS_MASK, SCG_CSR_SCS(6));
+}
+
+/* Output of a SCG asynchronous divider field: 0 = disabled, n = divide by 2^(n-1) */
+static uint32_t div_field_to_freq(uint32_t src_hz, uint32_t div)
+{
+    return (div == 0U) ? 0U : (src_hz >> (div - 1U));
+}
+
+/**
+ * @brief Frequency of the DIV2 clock selected by a PCC PCS value
+ * 
+ * @param pcs PCC_PCCn[PCS]: 1 = SOSCDIV2, 2 = SIRCDIV2, 3 = FIRCDIV2, 6 = SPLLDIV2
+ * @return uint32_t frequency in Hz, 0 if the source is not valid or not enabled
+ */
+uint32_t SCG_GetDiv2Freq(uint32_t pcs)
+{
+    uint32_t freq = 0U;
+
+    switch (pcs)
+    {
+        case 1U:
+            if (IP_SCG->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK)
+            {
+                freq = div_field_to_freq(SOSC_FREQ_HZ,
+                        (IP_SCG->SOSCDIV & SCG_SOSCDIV_SOSCDIV2_MASK) >> SCG_SOSCDIV_SOSCDIV2_SHIFT);
+            }
+            break;
+        case 2U:
+            if (IP_SCG->SIRCCSR & SCG_SIRCCSR_SIRCVLD_MASK)
+            {
+                freq = div_field_to_freq(SIRC_FREQ_HZ,
+                        (IP_SCG->SIRCDIV & SCG_SIRCDIV_SIRCDIV2_MASK) >> SCG_SIRCDIV_SIRCDIV2_SHIFT);
+            }
+            break;
+        case 3U:
+            if (IP_SCG->FIRCCSR & SCG_FIRCCSR_FIRCVLD_MASK)
+            {
+                freq = div_field_to_freq(FIRC_FREQ_HZ,
+                        (IP_SCG->FIRCDIV & SCG_FIRCDIV_FIRCDIV2_MASK) >> SCG_FIRCDIV_FIRCDIV2_SHIFT);
+            }
+            break;
+        case 6U:
+            if (IP_SCG->SPLLCSR & SCG_SPLLCSR_SPLLVLD_MASK)
+            {
+                /* SPLL_CLK = SOSC / (PREDIV + 1) * (MULT + 16) / 2 */
+                uint32_t prediv = ((IP_SCG->SPLLCFG & SCG_SPLLCFG_PREDIV_MASK) >> SCG_SPLLCFG_PREDIV_SHIFT) + 1U;
+                uint32_t mult   = ((IP_SCG->SPLLCFG & SCG_SPLLCFG_MULT_MASK) >> SCG_SPLLCFG_MULT_SHIFT) + 16U;
+                uint32_t spll   = ((SOSC_FREQ_HZ / prediv) * mult) / 2U;
+
+                freq = div_field_to_freq(spll,
+                        (IP_SCG->SPLLDIV & SCG_SPLLDIV_SPLLDIV2_MASK) >> SCG_SPLLDIV_SPLLDIV2_SHIFT);
+            }
+            break;
+        default:
+            break;
+    }
+
+    return freq;
+}
+
+/**
+ * @brief Functional clock of a peripheral, from its PCC source selection
+ * 
+ * @param pcc_index PCC_xxx_INDEX of the peripheral
+ * @return uint32_t frequency in Hz, 0 if gated or the source is off
+ */
+uint32_t PCC_GetFunctionalClockFreq(uint32_t pcc_index)
+{
+    uint32_t pccn = IP_PCC->PCCn[pcc_index];
+
+    if ((pccn & PCC_PCCn_CGC_MASK) == 0U)
+    {
+        return 0U;
+    }
+
+    return SCG_GetDiv2Freq((pccn & PCC_PCCn_PCS_MASK) >> PCC_PCCn_PCS_SHIFT);
+}
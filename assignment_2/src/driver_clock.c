@@ -0,0 +1,657 @@
+#include "driver_clock.h"
+#include "clocks_and_modes.h"
+#ifndef HOST_SIM
+#include "system_S32K144.h"
+#endif
+
+/* Longest waits for a status flag, in microseconds */
+#define CLOCK_SOSC_TIMEOUT_US   5000U       /* crystal start-up */
+#define CLOCK_SPLL_TIMEOUT_US   1000U       /* SPLL lock */
+#define CLOCK_SWITCH_TIMEOUT_US 100U        /* FIRC start, clock and mode switches */
+
+/* SCG system clock sources (xCCR[SCS]) and PCC_PCCn[PCS] values */
+#define CLOCK_SCS_SIRC          2U
+#define CLOCK_SCS_FIRC          3U
+#define CLOCK_SCS_SPLL          6U
+#define CLOCK_PCS_SIRC          2U
+#define CLOCK_PCS_FIRC          3U
+#define CLOCK_PCS_SPLL          6U
+
+/* SMC_PMSTAT values */
+#define CLOCK_PMSTAT_RUN        0x01U
+#define CLOCK_PMSTAT_VLPR       0x04U
+#define CLOCK_PMSTAT_HSRUN      0x80U
+
+/* SPLL VCO range, SPLL_CLK = VCO / 2 */
+#define CLOCK_VCO_MIN_HZ        180000000UL
+#define CLOCK_VCO_MAX_HZ        320000000UL
+
+typedef struct
+{
+	uint32_t core_hz;
+	uint32_t bus_hz;
+	uint32_t slow_hz;
+	uint32_t div1_hz;
+	uint32_t div2_hz;
+} clock_limits_t;
+
+/* Indexed by Clock_Mode_t */
+static const clock_limits_t limits[] = {
+	{  80000000UL, 40000000UL, 26666667UL, 80000000UL, 40000000UL },   /* RUN */
+	{ 112000000UL, 56000000UL, 28000000UL, 80000000UL, 40000000UL },   /* HSRUN */
+	{   4000000UL,  4000000UL,  1000000UL,  4000000UL,  4000000UL },   /* VLPR */
+};
+
+static Clock_Notifier_t* notifiers = NULL;
+static Clock_Config_t current;
+static bool have_current = false;
+/* Original PCS of the PCC slots moved to SIRC for VLPR, 0 if not moved */
+static uint8_t pcc_moved[PCC_PCCn_COUNT];
+
+/* Boot bring-up */
+static Clock_Config_t boot_cfg;
+static Clock_BootReport_t boot;
+static uint32_t boot_start;         /* cycles at CLOCK_BootStart */
+static uint32_t stage_start;        /* cycles at the start of the current stage */
+
+/* === Solver: pure functions === */
+static inline uint32_t clock_min(uint32_t a, uint32_t b)
+{
+	return (a < b) ? a : b;
+}
+
+/* Smallest divider 1..max with src_hz / div (truncated, as reported) at most target_hz, 0 if none */
+static uint32_t clock_divider(uint32_t src_hz, uint32_t target_hz, uint32_t max)
+{
+	uint32_t div;
+
+	if (target_hz == 0U)
+	{
+		return 0U;
+	}
+	div = (uint32_t)((uint64_t)src_hz / ((uint64_t)target_hz + 1U)) + 1U;
+	return (div <= max) ? div : 0U;
+}
+
+/* Async divider field for at most target_hz: 0 = off, n = divide by 2^(n-1); 8 if out of reach */
+static uint32_t clock_async_field(uint32_t src_hz, uint32_t target_hz)
+{
+	uint32_t n;
+
+	if (target_hz == 0U)
+	{
+		return 0U;
+	}
+	for (n = 1U; n <= 7U; n++)
+	{
+		if ((src_hz >> (n - 1U)) <= target_hz)
+		{
+			break;
+		}
+	}
+	return n;
+}
+
+static inline uint32_t clock_async_freq(uint32_t src_hz, uint32_t field)
+{
+	return (field == 0U) ? 0U : (src_hz >> (field - 1U));
+}
+
+/*
+ * Dividers for one source frequency, or false if a target is out of reach.
+ * The core divider is the smallest that stays at or below the core target;
+ * bus and slow then divide the core clock.
+ */
+static bool clock_fit(uint32_t src_hz, const clock_limits_t* want, Clock_Config_t* c)
+{
+	uint32_t divcore = clock_divider(src_hz, want->core_hz, 16U);
+	uint32_t core, divbus, divslow, div1, div2;
+
+	if (divcore == 0U)
+	{
+		return false;
+	}
+	core = src_hz / divcore;
+	divbus = clock_divider(core, want->bus_hz, 16U);
+	divslow = clock_divider(core, want->slow_hz, 8U);
+	div1 = clock_async_field(src_hz, want->div1_hz);
+	div2 = clock_async_field(src_hz, want->div2_hz);
+	if ((divbus == 0U) || (divslow == 0U) || (div1 > 7U) || (div2 > 7U))
+	{
+		return false;
+	}
+
+	c->divcore = (uint8_t)(divcore - 1U);
+	c->divbus  = (uint8_t)(divbus - 1U);
+	c->divslow = (uint8_t)(divslow - 1U);
+	c->div1    = (uint8_t)div1;
+	c->div2    = (uint8_t)div2;
+	c->core_hz = core;
+	c->bus_hz  = core / divbus;
+	c->slow_hz = core / divslow;
+	c->div1_hz = clock_async_freq(src_hz, div1);
+	c->div2_hz = clock_async_freq(src_hz, div2);
+	return true;
+}
+
+/* Ranking of two candidates: core first, then bus, slow, DIV2 and DIV1, all higher is better */
+static bool clock_better(const Clock_Config_t* a, const Clock_Config_t* b)
+{
+	if (a->core_hz != b->core_hz) return a->core_hz > b->core_hz;
+	if (a->bus_hz  != b->bus_hz)  return a->bus_hz  > b->bus_hz;
+	if (a->slow_hz != b->slow_hz) return a->slow_hz > b->slow_hz;
+	if (a->div2_hz != b->div2_hz) return a->div2_hz > b->div2_hz;
+	return a->div1_hz > b->div1_hz;
+}
+
+int32_t CLOCK_Solve(const Clock_Target_t *target, Clock_Config_t *cfg)
+{
+	const clock_limits_t* lim;
+	clock_limits_t want;
+	Clock_Config_t c = { 0 };
+	bool found = false;
+
+	if ((target == NULL) || (cfg == NULL) || ((uint32_t)target->mode > (uint32_t)CLOCK_MODE_VLPR))
+	{
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+	lim = &limits[target->mode];
+	want.core_hz = clock_min(target->core_hz, lim->core_hz);
+	want.bus_hz  = clock_min(target->bus_hz, lim->bus_hz);
+	want.slow_hz = clock_min(target->slow_hz, lim->slow_hz);
+	want.div1_hz = clock_min(target->div1_hz, lim->div1_hz);
+	want.div2_hz = clock_min(target->div2_hz, lim->div2_hz);
+	if ((want.core_hz == 0U) || (want.bus_hz == 0U) || (want.slow_hz == 0U))
+	{
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+
+	c.mode = target->mode;
+	if (target->mode == CLOCK_MODE_VLPR)
+	{
+		c.scs = CLOCK_SCS_SIRC;
+		found = clock_fit(SIRC_FREQ_HZ, &want, &c);
+		*cfg = c;
+	}
+	else
+	{
+		c.scs = CLOCK_SCS_SPLL;
+		/* All 8 x 32 SPLL settings with the VCO in range */
+		for (uint32_t mult = 0U; mult < 32U; mult++)
+		{
+			for (uint32_t prediv = 0U; prediv < 8U; prediv++)
+			{
+				uint32_t vco = (uint32_t)(((uint64_t)SOSC_FREQ_HZ * (mult + 16U)) / (prediv + 1U));
+
+				if ((vco < CLOCK_VCO_MIN_HZ) || (vco > CLOCK_VCO_MAX_HZ))
+				{
+					continue;
+				}
+				c.prediv = (uint8_t)prediv;
+				c.mult = (uint8_t)mult;
+				if (clock_fit(vco / 2U, &want, &c) && (!found || clock_better(&c, cfg)))
+				{
+					*cfg = c;
+					found = true;
+				}
+			}
+		}
+	}
+	return found ? ARM_DRIVER_OK : ARM_DRIVER_ERROR_PARAMETER;
+}
+
+/* === Timebase: core cycles, the DWT counter (virtual time on the host) === */
+#ifdef HOST_SIM
+static inline void clock_cycles_start(void)
+{
+}
+
+static inline uint32_t clock_cycles(void)
+{
+	return (uint32_t)((SIM_Now() * (SystemCoreClock / 1000000U)) / 1000U);
+}
+#else
+static inline void clock_cycles_start(void)
+{
+	/* CYCCNT keeps its value: driver_profile may be using it */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t clock_cycles(void)
+{
+	return DWT->CYCCNT;
+}
+#endif
+
+/* The waits all run on the core clock of their start, FIRC in practice */
+static inline uint32_t clock_elapsed_us(uint32_t since)
+{
+	return (clock_cycles() - since) / (SystemCoreClock / 1000000U);
+}
+
+/* === Apply === */
+static int32_t clock_wait(const volatile uint32_t* reg, uint32_t mask, uint32_t value, uint32_t timeout_us)
+{
+	uint32_t start = clock_cycles();
+
+	while ((*reg & mask) != value)
+	{
+		if (clock_elapsed_us(start) > timeout_us)
+		{
+			return ARM_DRIVER_ERROR_TIMEOUT;
+		}
+	}
+	return ARM_DRIVER_OK;
+}
+
+static void clock_notify(uint32_t event, const Clock_Config_t* cfg)
+{
+	for (Clock_Notifier_t* n = notifiers; n != NULL; n = n->next)
+	{
+		n->cb(event, cfg);
+	}
+}
+
+static inline uint32_t clock_ccr(const Clock_Config_t* cfg)
+{
+	return SCG_RCCR_SCS(cfg->scs) | SCG_RCCR_DIVCORE(cfg->divcore) |
+	       SCG_RCCR_DIVBUS(cfg->divbus) | SCG_RCCR_DIVSLOW(cfg->divslow);
+}
+
+/* Async DIV1/DIV2 register value of a source, for the frequencies of cfg */
+static inline uint32_t clock_async_reg(uint32_t src_hz, const Clock_Config_t* cfg)
+{
+	return SCG_SOSCDIV_SOSCDIV1(clock_async_field(src_hz, cfg->div1_hz)) |
+	       SCG_SOSCDIV_SOSCDIV2(clock_async_field(src_hz, cfg->div2_hz));
+}
+
+/* PCS can only change while CGC = 0 */
+static void clock_pcc_select(uint32_t index, uint32_t pcs)
+{
+	uint32_t pccn = IP_PCC->PCCn[index];
+
+	IP_PCC->PCCn[index] = pccn & ~PCC_PCCn_CGC_MASK;
+	IP_PCC->PCCn[index] = (pccn & ~(PCC_PCCn_PCS_MASK | PCC_PCCn_CGC_MASK)) | PCC_PCCn_PCS(pcs);
+	IP_PCC->PCCn[index] |= pccn & PCC_PCCn_CGC_MASK;
+}
+
+/* VLPR: peripherals on FIRC or SPLL go to SIRC, and back afterwards */
+static void clock_pcc_to_sirc(void)
+{
+	for (uint32_t i = 0U; i < PCC_PCCn_COUNT; i++)
+	{
+		uint32_t pcs = (IP_PCC->PCCn[i] & PCC_PCCn_PCS_MASK) >> PCC_PCCn_PCS_SHIFT;
+
+		if ((pcs == CLOCK_PCS_FIRC) || (pcs == CLOCK_PCS_SPLL))
+		{
+			pcc_moved[i] = (uint8_t)pcs;
+			clock_pcc_select(i, CLOCK_PCS_SIRC);
+		}
+	}
+}
+
+static void clock_pcc_restore(void)
+{
+	for (uint32_t i = 0U; i < PCC_PCCn_COUNT; i++)
+	{
+		if (pcc_moved[i] != 0U)
+		{
+			clock_pcc_select(i, pcc_moved[i]);
+			pcc_moved[i] = 0U;
+		}
+	}
+}
+
+/* RUN on FIRC: 48 MHz core and bus, 24 MHz slow. Valid from any state */
+static int32_t clock_park_on_firc(void)
+{
+	SCG_Type* scg = IP_SCG;
+	SMC_Type* smc = IP_SMC;
+	int32_t result = ARM_DRIVER_OK;
+
+	/* HSRUN and VLPR are left to RUN, which runs from RCCR */
+	if (smc->PMSTAT != CLOCK_PMSTAT_RUN)
+	{
+		smc->PMCTRL = (smc->PMCTRL & ~SMC_PMCTRL_RUNM_MASK) | SMC_PMCTRL_RUNM(0);
+		result = clock_wait(&smc->PMSTAT, 0xFFU, CLOCK_PMSTAT_RUN, CLOCK_SWITCH_TIMEOUT_US);
+	}
+	if ((result == ARM_DRIVER_OK) && ((scg->FIRCCSR & SCG_FIRCCSR_FIRCVLD_MASK) == 0U))
+	{
+		scg->FIRCCSR = SCG_FIRCCSR_FIRCEN_MASK;
+		result = clock_wait(&scg->FIRCCSR, SCG_FIRCCSR_FIRCVLD_MASK, SCG_FIRCCSR_FIRCVLD_MASK, CLOCK_SWITCH_TIMEOUT_US);
+	}
+	if (result == ARM_DRIVER_OK)
+	{
+		scg->RCCR = SCG_RCCR_SCS(CLOCK_SCS_FIRC) | SCG_RCCR_DIVCORE(0) |
+		            SCG_RCCR_DIVBUS(0) | SCG_RCCR_DIVSLOW(1);
+		result = clock_wait(&scg->CSR, SCG_CSR_SCS_MASK, SCG_CSR_SCS(CLOCK_SCS_FIRC), CLOCK_SWITCH_TIMEOUT_US);
+	}
+	return result;
+}
+
+/* Start the 8 MHz crystal (medium range, low power); false if SOSCCSR is locked */
+static bool clock_sosc_kick(const Clock_Config_t* cfg)
+{
+	SCG_Type* scg = IP_SCG;
+
+	if (scg->SOSCCSR & SCG_SOSCCSR_LK_MASK)
+	{
+		return false;
+	}
+	scg->SOSCDIV = clock_async_reg(SOSC_FREQ_HZ, cfg);
+	scg->SOSCCFG = SCG_SOSCCFG_RANGE(2) | SCG_SOSCCFG_EREFS_MASK;
+	scg->SOSCCSR = SCG_SOSCCSR_SOSCEN_MASK;
+	return true;
+}
+
+/* Restart the SPLL with the settings of cfg; false if SPLLCSR is locked */
+static bool clock_spll_kick(const Clock_Config_t* cfg)
+{
+	SCG_Type* scg = IP_SCG;
+
+	if (scg->SPLLCSR & SCG_SPLLCSR_LK_MASK)
+	{
+		return false;
+	}
+	/* Dividers and multiplier only change while the SPLL is off */
+	scg->SPLLCSR = 0U;
+	scg->SPLLDIV = SCG_SPLLDIV_SPLLDIV1(cfg->div1) | SCG_SPLLDIV_SPLLDIV2(cfg->div2);
+	scg->SPLLCFG = SCG_SPLLCFG_PREDIV(cfg->prediv) | SCG_SPLLCFG_MULT(cfg->mult);
+	scg->SPLLCSR = SCG_SPLLCSR_SPLLEN_MASK;
+	return true;
+}
+
+static int32_t clock_start_spll(const Clock_Config_t* cfg)
+{
+	SCG_Type* scg = IP_SCG;
+	int32_t result = ARM_DRIVER_OK;
+
+	if ((scg->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK) == 0U)
+	{
+		result = clock_sosc_kick(cfg) ?
+		         clock_wait(&scg->SOSCCSR, SCG_SOSCCSR_SOSCVLD_MASK, SCG_SOSCCSR_SOSCVLD_MASK, CLOCK_SOSC_TIMEOUT_US) :
+		         ARM_DRIVER_ERROR;
+	}
+	if (result == ARM_DRIVER_OK)
+	{
+		result = clock_spll_kick(cfg) ?
+		         clock_wait(&scg->SPLLCSR, SCG_SPLLCSR_SPLLVLD_MASK, SCG_SPLLCSR_SPLLVLD_MASK, CLOCK_SPLL_TIMEOUT_US) :
+		         ARM_DRIVER_ERROR;
+	}
+	return result;
+}
+
+static int32_t clock_enter_mode(const Clock_Config_t* cfg)
+{
+	SCG_Type* scg = IP_SCG;
+	SMC_Type* smc = IP_SMC;
+	int32_t result;
+
+	switch (cfg->mode)
+	{
+		case CLOCK_MODE_HSRUN:
+			/* RCCR keeps FIRC: the clock used again when HSRUN is left */
+			scg->HCCR = clock_ccr(cfg);
+			smc->PMCTRL = (smc->PMCTRL & ~SMC_PMCTRL_RUNM_MASK) | SMC_PMCTRL_RUNM(3);
+			result = clock_wait(&smc->PMSTAT, 0xFFU, CLOCK_PMSTAT_HSRUN, CLOCK_SWITCH_TIMEOUT_US);
+			break;
+
+		case CLOCK_MODE_VLPR:
+			/* VLPR is entered from RUN on SIRC, with FIRC and SPLL off */
+			clock_pcc_to_sirc();
+			scg->VCCR = clock_ccr(cfg);
+			scg->RCCR = clock_ccr(cfg);
+			result = clock_wait(&scg->CSR, SCG_CSR_SCS_MASK, SCG_CSR_SCS(CLOCK_SCS_SIRC), CLOCK_SWITCH_TIMEOUT_US);
+			if (result == ARM_DRIVER_OK)
+			{
+				scg->FIRCCSR = 0U;
+				smc->PMCTRL = (smc->PMCTRL & ~SMC_PMCTRL_RUNM_MASK) | SMC_PMCTRL_RUNM(2);
+				result = clock_wait(&smc->PMSTAT, 0xFFU, CLOCK_PMSTAT_VLPR, CLOCK_SWITCH_TIMEOUT_US);
+			}
+			break;
+
+		default:
+			scg->RCCR = clock_ccr(cfg);
+			result = ARM_DRIVER_OK;
+			break;
+	}
+	if (result == ARM_DRIVER_OK)
+	{
+		result = clock_wait(&scg->CSR, SCG_CSR_SCS_MASK, SCG_CSR_SCS(cfg->scs), CLOCK_SWITCH_TIMEOUT_US);
+	}
+	return result;
+}
+
+/* What clock_park_on_firc leaves running, reported after a failed change */
+static void clock_firc_config(Clock_Config_t* c)
+{
+	*c = (Clock_Config_t){ 0 };
+	c->mode = CLOCK_MODE_RUN;
+	c->scs = CLOCK_SCS_FIRC;
+	c->divslow = 1U;
+	c->core_hz = FIRC_FREQ_HZ;
+	c->bus_hz = FIRC_FREQ_HZ;
+	c->slow_hz = FIRC_FREQ_HZ / 2U;
+}
+
+/* === Boot bring-up === */
+static void clock_boot_stage(Clock_BootState_t next)
+{
+	uint32_t us = clock_elapsed_us(stage_start);
+
+	switch (boot.state)
+	{
+		case CLOCK_BOOT_SOSC:   boot.sosc_us = us; break;
+		case CLOCK_BOOT_SPLL:   boot.spll_us = us; break;
+		case CLOCK_BOOT_SWITCH: boot.switch_us = us; break;
+		default: break;
+	}
+	stage_start = clock_cycles();
+	boot.state = next;
+}
+
+static void clock_boot_end(Clock_BootState_t failed)
+{
+	if (failed != CLOCK_BOOT_IDLE)
+	{
+		boot.failed_stage = failed;
+		if ((IP_SCG->SPLLCSR & SCG_SPLLCSR_LK_MASK) == 0U)
+		{
+			IP_SCG->SPLLCSR = 0U;
+		}
+		(void)clock_park_on_firc();
+		clock_firc_config(&current);
+		clock_boot_stage(CLOCK_BOOT_FALLBACK);
+	}
+	else
+	{
+		current = boot_cfg;
+		clock_boot_stage(CLOCK_BOOT_DONE);
+	}
+	boot.total_us = clock_elapsed_us(boot_start);
+	have_current = true;
+	SystemCoreClock = current.core_hz;
+	clock_notify(CLOCK_EVENT_POST_CHANGE, &current);
+}
+
+int32_t CLOCK_BootStart(const Clock_Config_t *cfg)
+{
+	if ((cfg == NULL) || (cfg->mode != CLOCK_MODE_RUN) || (cfg->scs != CLOCK_SCS_SPLL))
+	{
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+	clock_cycles_start();
+	boot_cfg = *cfg;
+	boot = (Clock_BootReport_t){ 0 };
+	boot_start = clock_cycles();
+	stage_start = boot_start;
+
+	/* Async dividers of the always-on sources first: FIRC is the fallback */
+	IP_SCG->FIRCDIV = clock_async_reg(FIRC_FREQ_HZ, cfg);
+	IP_SCG->SIRCDIV = clock_async_reg(SIRC_FREQ_HZ, cfg);
+	boot.state = CLOCK_BOOT_SOSC;
+	if ((IP_SCG->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK) == 0U)
+	{
+		if (!clock_sosc_kick(cfg))
+		{
+			clock_boot_end(CLOCK_BOOT_SOSC);
+		}
+	}
+	return ARM_DRIVER_OK;
+}
+
+Clock_BootState_t CLOCK_BootPoll(void)
+{
+	SCG_Type* scg = IP_SCG;
+
+	switch (boot.state)
+	{
+		case CLOCK_BOOT_SOSC:
+			if (scg->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK)
+			{
+				clock_boot_stage(CLOCK_BOOT_SPLL);
+				if (!clock_spll_kick(&boot_cfg))
+				{
+					clock_boot_end(CLOCK_BOOT_SPLL);
+				}
+			}
+			else if (clock_elapsed_us(stage_start) > CLOCK_SOSC_TIMEOUT_US)
+			{
+				clock_boot_end(CLOCK_BOOT_SOSC);
+			}
+			break;
+
+		case CLOCK_BOOT_SPLL:
+			if (scg->SPLLCSR & SCG_SPLLCSR_SPLLVLD_MASK)
+			{
+				clock_boot_stage(CLOCK_BOOT_SWITCH);
+				scg->RCCR = clock_ccr(&boot_cfg);
+			}
+			else if (clock_elapsed_us(stage_start) > CLOCK_SPLL_TIMEOUT_US)
+			{
+				clock_boot_end(CLOCK_BOOT_SPLL);
+			}
+			break;
+
+		case CLOCK_BOOT_SWITCH:
+			if ((scg->CSR & SCG_CSR_SCS_MASK) == SCG_CSR_SCS(boot_cfg.scs))
+			{
+				clock_boot_end(CLOCK_BOOT_IDLE);
+			}
+			else if (clock_elapsed_us(stage_start) > CLOCK_SWITCH_TIMEOUT_US)
+			{
+				clock_boot_end(CLOCK_BOOT_SWITCH);
+			}
+			break;
+
+		default:
+			break;
+	}
+	return boot.state;
+}
+
+const Clock_BootReport_t *CLOCK_GetBootReport(void)
+{
+	return &boot;
+}
+
+int32_t CLOCK_Init(void)
+{
+	clock_cycles_start();
+	/* Write-once: allow both HSRUN and VLPR */
+	IP_SMC->PMPROT = SMC_PMPROT_AHSRUN_MASK | SMC_PMPROT_AVLP_MASK;
+	return ARM_DRIVER_OK;
+}
+
+int32_t CLOCK_Apply(const Clock_Config_t *cfg)
+{
+	SCG_Type* scg = IP_SCG;
+	int32_t result;
+
+	if ((cfg == NULL) || ((uint32_t)cfg->mode > (uint32_t)CLOCK_MODE_VLPR))
+	{
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+	clock_cycles_start();
+	clock_notify(CLOCK_EVENT_PRE_CHANGE, cfg);
+
+	result = clock_park_on_firc();
+	if ((result == ARM_DRIVER_OK) && (cfg->mode == CLOCK_MODE_VLPR))
+	{
+		/* VLPR needs the SPLL off */
+		scg->SPLLCSR = 0U;
+	}
+	if (result == ARM_DRIVER_OK)
+	{
+		scg->FIRCDIV = clock_async_reg(FIRC_FREQ_HZ, cfg);
+		scg->SIRCDIV = clock_async_reg(SIRC_FREQ_HZ, cfg);
+		if (scg->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK)
+		{
+			scg->SOSCDIV = clock_async_reg(SOSC_FREQ_HZ, cfg);
+		}
+		if (cfg->mode != CLOCK_MODE_VLPR)
+		{
+			result = clock_start_spll(cfg);
+			if (result == ARM_DRIVER_OK)
+			{
+				clock_pcc_restore();
+			}
+		}
+	}
+	if (result == ARM_DRIVER_OK)
+	{
+		result = clock_enter_mode(cfg);
+	}
+
+	if (result == ARM_DRIVER_OK)
+	{
+		current = *cfg;
+	}
+	else
+	{
+		/* Back to a clock that is known to run; peripherals moved to SIRC stay there */
+		(void)clock_park_on_firc();
+		clock_firc_config(&current);
+	}
+	have_current = true;
+	SystemCoreClock = current.core_hz;
+	clock_notify(CLOCK_EVENT_POST_CHANGE, &current);
+	return result;
+}
+
+int32_t CLOCK_SetTarget(const Clock_Target_t *target)
+{
+	Clock_Config_t cfg;
+	int32_t result = CLOCK_Solve(target, &cfg);
+
+	if (result == ARM_DRIVER_OK)
+	{
+		result = CLOCK_Apply(&cfg);
+	}
+	return result;
+}
+
+const Clock_Config_t *CLOCK_GetConfig(void)
+{
+	return have_current ? &current : NULL;
+}
+
+void CLOCK_RegisterNotifier(Clock_Notifier_t *notifier, Clock_Notify_t cb)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	notifier->cb = cb;
+	for (Clock_Notifier_t* n = notifiers; n != NULL; n = n->next)
+	{
+		if (n == notifier)
+		{
+			__set_PRIMASK(primask);
+			return;
+		}
+	}
+	notifier->next = notifiers;
+	notifiers = notifier;
+	__set_PRIMASK(primask);
+}
@@ -0,0 +1,304 @@
+#include "driver_debounce.h"
+#include "driver_clock.h"
+#include "clocks_and_modes.h"
+#include "S32K144_features.h"
+
+extern ARM_DRIVER_GPIO Driver_GPIO0;
+
+/* Same priority as the PORT interrupts (see DRIVER_PORT_PinInterruptConfig):
+ * the tick and the pin handlers never preempt each other. */
+#define DEBOUNCE_IRQ_PRIORITY   2U
+#define DEBOUNCE_TICKS(us)      (((us) + DEBOUNCE_TICK_US - 1U) / DEBOUNCE_TICK_US)
+
+typedef struct
+{
+	ARM_GPIO_Pin_t id;
+	uint8_t        port;
+	uint8_t        pin;
+	uint8_t        active_low;
+	uint8_t        filtered;     /* debounced by the PORT digital filter */
+	uint8_t        pressed;      /* debounced state */
+	uint8_t        long_sent;
+	uint16_t       count;        /* consecutive samples differing from pressed */
+	uint16_t       same;         /* consecutive samples matching pressed */
+	uint16_t       stable_ticks;
+	uint32_t       held;         /* ticks since the press was accepted */
+	uint32_t       long_ticks;
+} debounce_pin_t;
+
+static PORT_Type* const port_base[] = IP_PORT_BASE_PTRS;
+static GPIO_Type* const gpio_base[] = IP_GPIO_BASE_PTRS;
+
+static debounce_pin_t pins[DEBOUNCE_MAX_PINS];
+static uint32_t pin_count = 0;
+/* Pins the tick has to look at, one bit per entry of pins[] */
+static uint32_t sampling = 0;
+static ARM_GPIO_SignalEvent_t callback = NULL;
+static Clock_Notifier_t clock_notifier;
+
+static inline void debounce_timer_start(void)
+{
+	IP_LPIT0->TMR[DEBOUNCE_LPIT_CHANNEL].TCTRL |= LPIT_TMR_TCTRL_T_EN_MASK;
+}
+
+static inline void debounce_timer_stop(void)
+{
+	IP_LPIT0->TMR[DEBOUNCE_LPIT_CHANNEL].TCTRL &= ~LPIT_TMR_TCTRL_T_EN_MASK;
+	IP_LPIT0->MSR = (1UL << DEBOUNCE_LPIT_CHANNEL);
+}
+
+/* Interrupt that starts debouncing: either edge for filtered pins; for sampled
+ * pins the level opposite to the debounced state, so a change that happened
+ * before arming still fires at once. */
+static void debounce_arm(const debounce_pin_t* e)
+{
+	Driver_PortIrqConfig mode;
+
+	if (e->filtered)
+	{
+		mode = DRIVER_PORT_IRQ_EITHER_EDGE;
+	}
+	else
+	{
+		mode = (e->pressed ^ e->active_low) ? DRIVER_PORT_IRQ_LOGIC_ZERO : DRIVER_PORT_IRQ_LOGIC_ONE;
+	}
+	DRIVER_PORT_ClearInterruptFlag((Driver_PortInstance)e->port, e->pin);
+	DRIVER_PORT_PinInterruptConfig((Driver_PortInstance)e->port, e->pin, mode);
+}
+
+static void debounce_sample(uint32_t idx)
+{
+	if (sampling == 0U)
+	{
+		debounce_timer_start();
+	}
+	sampling |= (1UL << idx);
+}
+
+static void debounce_emit(const debounce_pin_t* e, uint32_t event)
+{
+	if (callback)
+	{
+		callback(e->id, event);
+	}
+}
+
+/* Feed one observation of the raw level, accept it after stable_ticks in a row */
+static void debounce_observe(debounce_pin_t* e, uint32_t level)
+{
+	uint8_t pressed = (uint8_t)((level ^ e->active_low) & 1U);
+
+	if (pressed == e->pressed)
+	{
+		e->count = 0;
+		if (e->same < e->stable_ticks)
+		{
+			e->same++;
+		}
+		return;
+	}
+	e->same = 0;
+	if (++e->count >= e->stable_ticks)
+	{
+		e->pressed = pressed;
+		e->count = 0;
+		e->same = e->stable_ticks;
+		e->held = 0;
+		e->long_sent = 0;
+		debounce_emit(e, pressed ? DEBOUNCE_EVENT_PRESS : DEBOUNCE_EVENT_RELEASE);
+	}
+}
+
+/* Called by the PORT dispatcher, level = PDIR at ISR time */
+static void debounce_pin_event(uint32_t idx, uint32_t level)
+{
+	debounce_pin_t* e = &pins[idx];
+
+	if (e->filtered)
+	{
+		/* Already clean: each edge is an event, the tick only times long presses */
+		debounce_observe(e, level);
+		if (e->pressed && (e->long_ticks != 0U))
+		{
+			debounce_sample(idx);
+		}
+	}
+	else
+	{
+		/* Mute the pin for the rest of the bounce, the tick takes over. The
+		 * level was still active when the dispatcher cleared ISF: clear again. */
+		DRIVER_PORT_PinInterruptConfig((Driver_PortInstance)e->port, e->pin, DRIVER_PORT_IRQ_DISABLED);
+		DRIVER_PORT_ClearInterruptFlag((Driver_PortInstance)e->port, e->pin);
+		e->same = 0;
+		debounce_sample(idx);
+	}
+}
+
+void LPIT0_Ch1_IRQHandler(void)
+{
+	uint32_t level[GPIO_PORT_COUNT];
+	uint32_t ports = 0;
+	uint32_t todo;
+
+	IP_LPIT0->MSR = (1UL << DEBOUNCE_LPIT_CHANNEL);
+
+	/* One PDIR read per port for all pins being sampled */
+	for (todo = sampling; todo != 0U; todo &= todo - 1U)
+	{
+		ports |= (1UL << pins[__builtin_ctz(todo)].port);
+	}
+	for (uint32_t port = 0; port < GPIO_PORT_COUNT; port++)
+	{
+		if (ports & (1UL << port))
+		{
+			level[port] = gpio_base[port]->PDIR;
+		}
+	}
+
+	for (todo = sampling; todo != 0U; todo &= todo - 1U)
+	{
+		uint32_t idx = (uint32_t)__builtin_ctz(todo);
+		debounce_pin_t* e = &pins[idx];
+
+		debounce_observe(e, level[e->port] >> e->pin);
+		if (e->pressed && !e->long_sent && (e->long_ticks != 0U) && (++e->held >= e->long_ticks))
+		{
+			e->long_sent = 1;
+			debounce_emit(e, DEBOUNCE_EVENT_LONG_PRESS);
+		}
+
+		/* Done once the level is stable and no long press is being timed */
+		if ((e->same >= e->stable_ticks) && (!e->pressed || e->long_sent || (e->long_ticks == 0U)))
+		{
+			sampling &= ~(1UL << idx);
+			if (!e->filtered)
+			{
+				debounce_arm(e);
+			}
+		}
+	}
+
+	if (sampling == 0U)
+	{
+		debounce_timer_stop();
+	}
+}
+
+/* Tick period from the LPIT0 clock; TVAL is loaded on the next reload */
+static void debounce_set_tick(uint32_t freq)
+{
+	IP_LPIT0->TMR[DEBOUNCE_LPIT_CHANNEL].TVAL = ((freq / 1000000U) * DEBOUNCE_TICK_US) - 1U;
+}
+
+static void debounce_clock_changed(uint32_t event, const Clock_Config_t *cfg)
+{
+	uint32_t freq = PCC_GetFunctionalClockFreq(PCC_LPIT_INDEX);
+
+	(void)cfg;
+	if ((event == CLOCK_EVENT_POST_CHANGE) && (freq >= 1000000U))
+	{
+		debounce_set_tick(freq);
+	}
+}
+
+int32_t DEBOUNCE_Init(ARM_GPIO_SignalEvent_t cb_event)
+{
+	LPIT_Type* lpit = IP_LPIT0;
+	uint32_t freq;
+
+	if ((IP_PCC->PCCn[PCC_LPIT_INDEX] & PCC_PCCn_CGC_MASK) == 0U)
+	{
+		/* Clock Src = SPLL2_DIV2_CLK, as in LPIT0_init */
+		IP_PCC->PCCn[PCC_LPIT_INDEX] = PCC_PCCn_PCS(6);
+		IP_PCC->PCCn[PCC_LPIT_INDEX] |= PCC_PCCn_CGC_MASK;
+	}
+	freq = PCC_GetFunctionalClockFreq(PCC_LPIT_INDEX);
+	if (freq < 1000000U)
+	{
+		return ARM_DRIVER_ERROR;
+	}
+
+	callback = cb_event;
+	pin_count = 0;
+	sampling = 0;
+
+	/* M_CEN=1, other channels keep running */
+	lpit->MCR |= LPIT_MCR_M_CEN_MASK;
+	/* Stopped, 32-bit periodic counter; started on the first bounce */
+	lpit->TMR[DEBOUNCE_LPIT_CHANNEL].TCTRL = 0U;
+	debounce_set_tick(freq);
+	lpit->MSR = (1UL << DEBOUNCE_LPIT_CHANNEL);
+	lpit->MIER |= (1UL << DEBOUNCE_LPIT_CHANNEL);
+
+	NVIC_SetPriority((IRQn_Type)(LPIT0_Ch0_IRQn + DEBOUNCE_LPIT_CHANNEL), DEBOUNCE_IRQ_PRIORITY);
+	NVIC_EnableIRQ((IRQn_Type)(LPIT0_Ch0_IRQn + DEBOUNCE_LPIT_CHANNEL));
+	CLOCK_RegisterNotifier(&clock_notifier, debounce_clock_changed);
+	return ARM_DRIVER_OK;
+}
+
+int32_t DEBOUNCE_AddPin(const Debounce_PinConfig_t *cfg)
+{
+	debounce_pin_t* e;
+	int32_t result;
+
+	if (pin_count == DEBOUNCE_MAX_PINS)
+	{
+		return ARM_DRIVER_ERROR;
+	}
+	result = Driver_GPIO0.Setup(cfg->pin, NULL);
+	if (result == ARM_DRIVER_OK)
+	{
+		result = Driver_GPIO0.SetDirection(cfg->pin, ARM_GPIO_INPUT);
+	}
+	if (result != ARM_DRIVER_OK)
+	{
+		return result;
+	}
+
+	e = &pins[pin_count];
+	e->id = cfg->pin;
+	e->port = (uint8_t)pin_table[cfg->pin].port;
+	e->pin = pin_table[cfg->pin].pin;
+	e->active_low = cfg->active_low ? 1U : 0U;
+	e->count = 0;
+	e->same = 0;
+	e->held = 0;
+	e->long_sent = 0;
+	e->stable_ticks = (uint16_t)((cfg->stable_us > DEBOUNCE_TICK_US) ? DEBOUNCE_TICKS(cfg->stable_us) : 1U);
+	e->long_ticks = DEBOUNCE_TICKS(cfg->long_press_ms * 1000U);
+	e->pressed = (uint8_t)(((gpio_base[e->port]->PDIR >> e->pin) ^ e->active_low) & 1U);
+#if FEATURE_PORT_HAS_DIGITAL_FILTER
+	e->filtered = (cfg->stable_us <= DEBOUNCE_FILTER_MAX_US) ? 1U : 0U;
+	if (e->filtered)
+	{
+		PORT_Type* p = port_base[e->port];
+
+		/* DFCR/DFWR may only change while no pin of the port is filtered */
+		if (p->DFER == 0U)
+		{
+			p->DFCR = PORT_DFCR_CS(1);
+			p->DFWR = PORT_DFWR_FILT(DEBOUNCE_FILTER_WIDTH);
+		}
+		p->DFER |= (1UL << e->pin);
+	}
+#else
+	e->filtered = 0U;
+#endif
+
+	DRIVER_PORT_RegisterPinCallback((Driver_PortInstance)e->port, e->pin, debounce_pin_event, pin_count);
+	pin_count++;
+	debounce_arm(e);
+	return ARM_DRIVER_OK;
+}
+
+uint32_t DEBOUNCE_IsPressed(ARM_GPIO_Pin_t pin)
+{
+	for (uint32_t i = 0; i < pin_count; i++)
+	{
+		if (pins[i].id == pin)
+		{
+			return pins[i].pressed;
+		}
+	}
+	return 0U;
+}
@@ -1,11 +1,9 @@
 #include "driver_gpio.h"
+#include "driver_debounce.h"
+#include "driver_profile.h"
 
 
-const pin_desp_t pin_table[] = {
-    [LED_BLUE]  = {DRIVER_PORTD, 0U},  
-    [LED_RED]   = {DRIVER_PORTD, 15U},
-    [LED_GREEN] = {DRIVER_PORTD, 16U}
-};
+const pin_desp_t pin_table[] = GPIO_PIN_TABLE_INIT;
 
 // Pin mapping
 #define GPIO_MAX_PINS           32U
@@ -22,37 +20,48 @@ static inline GPIO_Type* get_gpio_base(Driver_PortInstance port) {
 	}
 }
 
-/* Event callback table per port*/
-static ARM_GPIO_SignalEvent_t gpio_callbacks[5] = {0};
+#define GPIO_PIN_COUNT          (sizeof(pin_table) / sizeof(pin_table[0]))
 
-/* Forward ISR notification from PORT driver */
-static void gpio_port_callback(uint8_t pin) {
- //Find which port triggerd (search callbacks[])
- //This assumes you register callbacks during Setup()
-	for (int port = DRIVER_PORTA; port <= DRIVER_PORTE; port++)
-	{
-		if(gpio_callbacks[port])
-		{
-			gpio_callbacks[port](((port << 16) | pin), ARM_GPIO_EVENT_EITHER_EDGE);
-		}
+/* Event callback and configured trigger per GPIO pin */
+static ARM_GPIO_SignalEvent_t gpio_callbacks[GPIO_PIN_COUNT] = {0};
+static ARM_GPIO_EVENT_TRIGGER gpio_triggers[GPIO_PIN_COUNT] = {0};
+
+/* Called by the PORT dispatcher for this pin only, level = PDIR at ISR time */
+static void gpio_pin_event(uint32_t pin, uint32_t level) {
+	uint32_t event;
+
+	switch (gpio_triggers[pin]) {
+		case ARM_GPIO_TRIGGER_RISING_EDGE:
+			event = ARM_GPIO_EVENT_RISING_EDGE;
+			break;
+		case ARM_GPIO_TRIGGER_FALLING_EDGE:
+			event = ARM_GPIO_EVENT_FALLING_EDGE;
+			break;
+		default:
+			/* Either edge: the level after the edge tells which one it was */
+			event = level ? ARM_GPIO_EVENT_RISING_EDGE : ARM_GPIO_EVENT_FALLING_EDGE;
+			break;
+	}
+	if (gpio_callbacks[pin]) {
+		gpio_callbacks[pin](pin, event);
 	}
 }
 
 /* ======================== Driver Functions =======================*/
 // Setup GPIO Interface
 static int32_t ARM_GPIO_Setup (ARM_GPIO_Pin_t pin, ARM_GPIO_SignalEvent_t cb_event) {
+  PROFILE_DRIVER_SCOPE("gpio_setup");
   int32_t result = ARM_DRIVER_OK;
-  if (PIN_IS_AVAILABLE(pin_table[pin].pin)) {
+  if ((pin < GPIO_PIN_COUNT) && PIN_IS_AVAILABLE(pin_table[pin].pin)) {
 	  //Enable clock for PORT & GPIO
 	  DRIVER_PORT_EnableClock(pin_table[pin].port);
 	  //Default mux to GPIO
 	  DRIVER_PORT_PinMux(pin_table[pin].port, pin_table[pin].pin, DRIVER_PORT_MUX_GPIO);
 
-	  //Save callback
-	  if(cb_event) {
-		  gpio_callbacks[pin_table[pin].port] = cb_event;
-		  DRIVER_PORT_RegisterCallback(pin_table[pin].port, gpio_port_callback);
-	  }
+	  //Save callback, the PORT ISR calls straight into this pin's entry
+	  gpio_callbacks[pin] = cb_event;
+	  DRIVER_PORT_RegisterPinCallback(pin_table[pin].port, pin_table[pin].pin,
+			  (cb_event != NULL) ? gpio_pin_event : NULL, pin);
   } else {
     result = ARM_GPIO_ERROR_PIN;
   }
@@ -62,6 +71,7 @@ static int32_t ARM_GPIO_Setup (ARM_GPIO_Pin_t pin, ARM_GPIO_SignalEvent_t cb_eve
 
 // Set GPIO Direction
 static int32_t ARM_GPIO_SetDirection (ARM_GPIO_Pin_t pin, ARM_GPIO_DIRECTION direction) {
+  PROFILE_DRIVER_SCOPE("gpio_set_direction");
   int32_t result = ARM_DRIVER_OK;
 
   if (PIN_IS_AVAILABLE(pin_table[pin].pin)) {
@@ -88,12 +98,17 @@ static int32_t ARM_GPIO_SetDirection (ARM_GPIO_Pin_t pin, ARM_GPIO_DIRECTION dir
 //Set GPIO output mode
 static int32_t ARM_GPIO_SetOutputMode(ARM_GPIO_Pin_t pin, ARM_GPIO_OUTPUT_MODE mode)
 {
+	PROFILE_DRIVER_SCOPE("gpio_set_output_mode");
+	(void)pin;
+	(void)mode;
 	//Do nothing
+	return ARM_DRIVER_OK;
 }
 
 //Set GPIO Pull register
 static int32_t ARM_GPIO_SetPullResistor(ARM_GPIO_Pin_t pin, ARM_GPIO_PULL_RESISTOR resistor)
 {
+	PROFILE_DRIVER_SCOPE("gpio_set_pull_resistor");
 	int32_t result = ARM_DRIVER_OK;
 	if(PIN_IS_AVAILABLE(pin_table[pin].pin))
 	{
@@ -114,9 +129,10 @@ static int32_t ARM_GPIO_SetPullResistor(ARM_GPIO_Pin_t pin, ARM_GPIO_PULL_RESIST
 
 // Set GPIO Event Trigger
 static int32_t ARM_GPIO_SetEventTrigger (ARM_GPIO_Pin_t pin, ARM_GPIO_EVENT_TRIGGER trigger) {
+  PROFILE_DRIVER_SCOPE("gpio_set_event_trigger");
   int32_t result = ARM_DRIVER_OK;
 
-  if (PIN_IS_AVAILABLE(pin_table[pin].pin))
+  if ((pin < GPIO_PIN_COUNT) && PIN_IS_AVAILABLE(pin_table[pin].pin))
   {
 	 Driver_PortIrqConfig irqMode;
 
@@ -137,7 +153,10 @@ static int32_t ARM_GPIO_SetEventTrigger (ARM_GPIO_Pin_t pin, ARM_GPIO_EVENT_TRIG
         result = ARM_DRIVER_ERROR_PARAMETER;
         break;
     }
-    DRIVER_PORT_PinInterruptConfig(pin_table[pin].port, pin_table[pin].pin, irqMode);
+    if (result == ARM_DRIVER_OK) {
+      gpio_triggers[pin] = trigger;
+      DRIVER_PORT_PinInterruptConfig(pin_table[pin].port, pin_table[pin].pin, irqMode);
+    }
   }
   else
   {
@@ -149,6 +168,7 @@ static int32_t ARM_GPIO_SetEventTrigger (ARM_GPIO_Pin_t pin, ARM_GPIO_EVENT_TRIG
 
 // Set GPIO Output Level
 static void ARM_GPIO_SetOutput (ARM_GPIO_Pin_t pin, uint32_t val) {
+  PROFILE_DRIVER_SCOPE("gpio_set_output");
 
   if (PIN_IS_AVAILABLE(pin_table[pin].pin))
   {
@@ -167,6 +187,7 @@ static void ARM_GPIO_SetOutput (ARM_GPIO_Pin_t pin, uint32_t val) {
 
 // Get GPIO Input Level
 static uint32_t ARM_GPIO_GetInput (ARM_GPIO_Pin_t pin) {
+  PROFILE_DRIVER_SCOPE("gpio_get_input");
   uint32_t val = 0U;
 
   if (PIN_IS_AVAILABLE(pin_table[pin].pin))
@@ -182,9 +203,58 @@ static uint32_t ARM_GPIO_GetInput (ARM_GPIO_Pin_t pin) {
   return val;
 }
 
+/* ======================== Pin sets =======================*/
+int32_t GPIO_PinSetInit(GPIO_PinSet_t *set, const ARM_GPIO_Pin_t *pins, uint32_t count)
+{
+	for (uint32_t port = 0; port < GPIO_PORT_COUNT; port++)
+	{
+		set->mask[port] = 0U;
+	}
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if ((pins[i] >= GPIO_PIN_COUNT) || !PIN_IS_AVAILABLE(pin_table[pins[i]].pin))
+		{
+			return ARM_GPIO_ERROR_PIN;
+		}
+		set->mask[pin_table[pins[i]].port] |= (1UL << pin_table[pins[i]].pin);
+	}
+	return ARM_DRIVER_OK;
+}
+
+void GPIO_SetOutputs(const GPIO_PinSet_t *set, const GPIO_PinSet_t *values)
+{
+	for (uint32_t port = 0; port < GPIO_PORT_COUNT; port++)
+	{
+		uint32_t mask = set->mask[port];
+
+		if (mask != 0U)
+		{
+			GPIO_Type* gpio = get_gpio_base((Driver_PortInstance)port);
+			uint32_t primask = __get_PRIMASK();
+
+			/* One PDOR store: the pins of the port change together. PRIMASK
+			 * keeps an ISR from writing other pins of the port in between */
+			__disable_irq();
+			gpio->PDOR = (gpio->PDOR & ~mask) | (mask & values->mask[port]);
+			__set_PRIMASK(primask);
+		}
+	}
+}
+
+void GPIO_GetInputs(const GPIO_PinSet_t *set, GPIO_PinSet_t *values)
+{
+	for (uint32_t port = 0; port < GPIO_PORT_COUNT; port++)
+	{
+		values->mask[port] = (set->mask[port] != 0U) ?
+				(get_gpio_base((Driver_PortInstance)port)->PDIR & set->mask[port]) : 0U;
+	}
+}
+
+/* Registered with DEBOUNCE_Init it toggles once per press; as a raw GPIO
+ * callback every bounce of the contact is a falling edge. */
 void Button_Event (ARM_GPIO_Pin_t pin, uint32_t event)
 {
-    if (event & ARM_GPIO_TRIGGER_FALLING_EDGE)
+    if (event & (ARM_GPIO_EVENT_FALLING_EDGE | DEBOUNCE_EVENT_PRESS))
     {
         /* Detect which button triggered the interrupt */
         if (pin == BUTTON1)
@@ -0,0 +1,116 @@
+#include "driver_irq.h"
+#include <stdbool.h>
+
+/* Exceptions before IRQ 0 in the table */
+#define IRQ_VECTOR_OFFSET   16U
+#define IRQ_COUNT           (NUMBER_OF_INT_VECTORS - IRQ_VECTOR_OFFSET)
+
+static inline bool irq_valid(IRQn_Type irq)
+{
+	return (irq >= 0) && ((uint32_t)irq < IRQ_COUNT);
+}
+
+#ifdef HOST_SIM
+int32_t IRQ_Install(IRQn_Type irq, IRQ_Handler_t handler)
+{
+	if (!irq_valid(irq) || (handler == NULL))
+	{
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+	SIM_SetVector(irq, handler);
+	return ARM_DRIVER_OK;
+}
+
+int32_t IRQ_Restore(IRQn_Type irq)
+{
+	if (!irq_valid(irq))
+	{
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+	SIM_SetVector(irq, NULL);
+	return ARM_DRIVER_OK;
+}
+
+IRQ_Handler_t IRQ_GetHandler(IRQn_Type irq)
+{
+	return irq_valid(irq) ? SIM_GetVector(irq) : NULL;
+}
+#else
+/* SRAM_L and SRAM_U: a table there is writable */
+#define IRQ_SRAM_START      0x1FFF8000UL
+#define IRQ_SRAM_END        0x20007000UL
+
+/* Both from the linker file: the linked table, and where startup copied it */
+extern uint32_t __VECTOR_TABLE[];
+extern uint32_t __VECTOR_RAM[];
+
+static inline volatile uint32_t *irq_ram_table(void)
+{
+	uint32_t vtor = SCB->VTOR;
+
+	return ((vtor >= IRQ_SRAM_START) && (vtor < IRQ_SRAM_END)) ? (volatile uint32_t *)vtor : NULL;
+}
+
+/**
+ * @brief Make handler the vector of irq
+ *
+ * @param irq
+ * @param handler
+ * @return int32_t
+ */
+int32_t IRQ_Install(IRQn_Type irq, IRQ_Handler_t handler)
+{
+	volatile uint32_t *table = irq_ram_table();
+
+	if (!irq_valid(irq) || (handler == NULL))
+	{
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+	if (table == NULL)
+	{
+		return ARM_DRIVER_ERROR_UNSUPPORTED;
+	}
+	table[IRQ_VECTOR_OFFSET + (uint32_t)irq] = (uint32_t)handler;
+	/* The next exception entry fetches the new vector */
+	__DSB();
+	return ARM_DRIVER_OK;
+}
+
+/**
+ * @brief Put the linked vector of irq back
+ *
+ * @param irq
+ * @return int32_t
+ */
+int32_t IRQ_Restore(IRQn_Type irq)
+{
+	volatile uint32_t *table = irq_ram_table();
+
+	if (!irq_valid(irq))
+	{
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+	if ((table == NULL) || ((uintptr_t)__VECTOR_RAM == (uintptr_t)__VECTOR_TABLE))
+	{
+		return ARM_DRIVER_ERROR_UNSUPPORTED;
+	}
+	table[IRQ_VECTOR_OFFSET + (uint32_t)irq] = __VECTOR_TABLE[IRQ_VECTOR_OFFSET + (uint32_t)irq];
+	__DSB();
+	return ARM_DRIVER_OK;
+}
+
+/**
+ * @brief Current vector of irq
+ *
+ * @param irq
+ * @return IRQ_Handler_t
+ */
+IRQ_Handler_t IRQ_GetHandler(IRQn_Type irq)
+{
+	if (!irq_valid(irq))
+	{
+		return NULL;
+	}
+	return (IRQ_Handler_t)((const volatile uint32_t *)SCB->VTOR)[IRQ_VECTOR_OFFSET + (uint32_t)irq];
+}
+#endif
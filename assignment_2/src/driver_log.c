@@ -0,0 +1,124 @@
+#include "driver_log.h"
+#include "driver_profile.h"
+#include "driver_usart.h"
+#include <stdbool.h>
+
+#define LOG_MASK            (LOG_BUFFER_WORDS - 1U)
+
+/* Word indices run freely; the writers own head, LOG_Drain() owns tail */
+static uint32_t log_buf[LOG_BUFFER_WORDS];
+static volatile uint32_t log_head = 0;
+static volatile uint32_t log_tail = 0;
+static volatile uint32_t log_drops = 0;
+/* Bytes of the word at log_tail already handed to the USART */
+static uint32_t log_sent = 0;
+
+/**
+ * @brief Empty the buffer and clear the drop count
+ *
+ */
+void LOG_Init(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	log_head = 0U;
+	log_tail = 0U;
+	log_drops = 0U;
+	log_sent = 0U;
+	__set_PRIMASK(primask);
+}
+
+/* Whole record or nothing, so the stream stays aligned on records. PRIMASK set */
+static inline bool log_put(uint32_t header, const uint32_t *args)
+{
+	uint32_t nargs = (header >> 4) & 0xFU;
+	uint32_t head = log_head;
+
+	if ((LOG_BUFFER_WORDS - (head - log_tail)) < (nargs + 2U))
+	{
+		return false;
+	}
+	log_buf[head & LOG_MASK] = header;
+	log_buf[(head + 1U) & LOG_MASK] = PROFILE_Cycles32();
+	head += 2U;
+	for (uint32_t i = 0U; i < nargs; i++)
+	{
+		log_buf[head & LOG_MASK] = args[i];
+		head++;
+	}
+	log_head = head;
+	return true;
+}
+
+/**
+ * @brief Store one record, or count it as dropped
+ *
+ * @param header from LOG_HEADER()
+ * @param args (header >> 4) & 0xF words
+ */
+void LOG_Write(uint32_t header, const uint32_t *args)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (!log_put(header, args))
+	{
+		log_drops++;
+	}
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief Move buffered records to the USART tx ring
+ *
+ * Pending drops are reported first, as soon as a drop record fits. Words
+ * go out in contiguous runs; a run the tx ring takes only in part resumes
+ * at the same byte on the next call.
+ *
+ * @return uint32_t words still buffered
+ */
+uint32_t LOG_Drain(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (log_drops != 0U)
+	{
+		uint32_t drops = log_drops;
+
+		if (log_put((LOG_ID_DROPS << 8) | (1UL << 4) | LOG_SYNC, &drops))
+		{
+			log_drops = 0U;
+		}
+	}
+	__set_PRIMASK(primask);
+
+	for (;;)
+	{
+		uint32_t tail = log_tail;
+		uint32_t slot = tail & LOG_MASK;
+		uint32_t words = log_head - tail;
+		uint32_t bytes;
+		uint32_t n;
+
+		if (words == 0U)
+		{
+			break;
+		}
+		if (words > (LOG_BUFFER_WORDS - slot))
+		{
+			words = LOG_BUFFER_WORDS - slot;
+		}
+		bytes = (words * 4U) - log_sent;
+		n = USART_Write((const uint8_t *)&log_buf[slot] + log_sent, bytes);
+		log_sent += n;
+		log_tail = tail + (log_sent / 4U);
+		log_sent %= 4U;
+		if (n < bytes)
+		{
+			break;
+		}
+	}
+	return log_head - log_tail;
+}
@@ -1,4 +1,5 @@
 #include "driver_port.h"
+#include "driver_log.h"
 
 /* Lookup helpers */
 static inline uint32_t get_pcc_index(Driver_PortInstance port)
@@ -30,7 +31,7 @@ static inline PORT_Type* get_port_base (Driver_PortInstance port)
 void DRIVER_PORT_EnableClock(Driver_PortInstance port)
 {
 	uint32_t idx = get_pcc_index(port);
-	printf("IDx: %d", idx);
+	LOG("PORT clock on, PCC index %u", idx);
 	IP_PCC->PCCn[idx] &= ~PCC_PCCn_CGC_MASK;
 	IP_PCC->PCCn[idx] |= PCC_PCCn_CGC_MASK;
 }
@@ -62,11 +63,56 @@ void DRIVER_PORT_PullConfig(Driver_PortInstance port,
 /* === Interrupts === */
 static Driver_PortCallback callbacks[5] = {0};
 
+/* Per-(port, pin) dispatch table, filled at setup time */
+typedef struct
+{
+	Driver_PortPinCallback cb;
+	uint32_t               ref;
+} pin_callback_t;
+
+static pin_callback_t pin_callbacks[5][32];
+/* Pins of each port with an entry in pin_callbacks */
+static uint32_t pin_callback_mask[5];
+
+static Ring_t* event_ring = NULL;
+static volatile uint32_t event_drops = 0;
+
 void DRIVER_PORT_RegisterCallback(Driver_PortInstance port, Driver_PortCallback cb)
 {
 	callbacks[port] = cb;
 }
 
+void DRIVER_PORT_RegisterPinCallback(Driver_PortInstance port,
+									 uint8_t pin,
+									 Driver_PortPinCallback cb,
+									 uint32_t ref)
+{
+	pin_callbacks[port][pin].ref = ref;
+	pin_callbacks[port][pin].cb = cb;
+	if (cb != NULL)
+	{
+		pin_callback_mask[port] |= (1UL << pin);
+	}
+	else
+	{
+		pin_callback_mask[port] &= ~(1UL << pin);
+	}
+}
+
+void DRIVER_PORT_SetEventRing(Ring_t* ring)
+{
+	if ((ring != NULL) && (ring->elem_size != sizeof(Driver_PortEvent)))
+	{
+		return;
+	}
+	event_ring = ring;
+}
+
+uint32_t DRIVER_PORT_GetEventDrops(void)
+{
+	return event_drops;
+}
+
 void DRIVER_PORT_PinInterruptConfig(Driver_PortInstance port,
 									uint8_t pin,
 									Driver_PortIrqConfig irqMode)
@@ -97,87 +143,142 @@ void DRIVER_PORT_ClearInterruptFlag(Driver_PortInstance port, uint8_t pin)
 }
 
 /* === Default ISR handlers ===
- * Each ISR checks ISFR to find active pins and calls user callback
+ * All five ISRs share one dispatcher: it reads and clears ISFR once, samples
+ * PDIR once, and visits only the pins that fired (count trailing zeros). Past
+ * PORT_DISPATCH_SPARSE pins the rest of the mask is scanned bit by bit, as
+ * before the per-pin table: with most pins flagged the scan is cheaper than a
+ * ctz and a clear per pin. A port with only the per-port callback, or with a
+ * per-pin callback on every pin left, skips the lookup chain of
+ * port_pin_event.
  */
+#ifndef PORT_DISPATCH_SPARSE
+#define PORT_DISPATCH_SPARSE    4U
+#endif
+
+static inline void port_pin_event(Driver_PortInstance port, uint32_t pin, uint32_t level)
+{
+	const pin_callback_t* entry = &pin_callbacks[port][pin];
+
+	if (entry->cb)
+	{
+		entry->cb(entry->ref, (level >> pin) & 1UL);
+	}
+	else if (event_ring)
+	{
+		Driver_PortEvent ev = { (uint8_t)port, (uint8_t)pin, (uint8_t)((level >> pin) & 1UL), 0U };
+
+		if (RING_Push(event_ring, &ev, 1U) == 0U)
+		{
+			event_drops++;
+		}
+	}
+	else if (callbacks[port])
+	{
+		callbacks[port]((uint8_t)pin);
+	}
+}
+
+/* A port with only the per-port callback: no PDIR sample, no per-pin lookup */
+static inline void port_dispatch_port(Driver_PortCallback cb, uint32_t flags)
+{
+	uint32_t pin;
+
+	for (uint32_t n = 0U; (flags != 0U) && (n < PORT_DISPATCH_SPARSE); n++)
+	{
+		pin = (uint32_t)__builtin_ctz(flags);
+		flags &= flags - 1U;
+		cb((uint8_t)pin);
+	}
+	if (flags == 0U)
+	{
+		return;
+	}
+	/* Dense: one pass from the lowest pin left */
+	pin = (uint32_t)__builtin_ctz(flags);
+	for (flags >>= pin; flags != 0U; pin++, flags >>= 1)
+	{
+		if (flags & 1U)
+		{
+			cb((uint8_t)pin);
+		}
+	}
+}
+
+static inline void port_dispatch(Driver_PortInstance port, PORT_Type* p, const GPIO_Type* gpio)
+{
+	uint32_t flags = p->ISFR;
+	uint32_t level;
+	uint32_t pin;
+
+	p->ISFR = flags;
+	if ((pin_callback_mask[port] == 0U) && (event_ring == NULL))
+	{
+		if (callbacks[port] != NULL)
+		{
+			port_dispatch_port(callbacks[port], flags);
+		}
+		return;
+	}
+
+	level = gpio->PDIR;
+	for (uint32_t n = 0U; (flags != 0U) && (n < PORT_DISPATCH_SPARSE); n++)
+	{
+		pin = (uint32_t)__builtin_ctz(flags);
+		flags &= flags - 1U;
+		port_pin_event(port, pin, level);
+	}
+	if (flags == 0U)
+	{
+		return;
+	}
+	/* Dense: one pass from the lowest pin left */
+	pin = (uint32_t)__builtin_ctz(flags);
+	if ((flags & ~pin_callback_mask[port]) == 0U)
+	{
+		const pin_callback_t* entry = &pin_callbacks[port][pin];
+
+		for (flags >>= pin, level >>= pin; flags != 0U; entry++, flags >>= 1, level >>= 1)
+		{
+			/* Re-checked: a callback may have removed a later pin's entry */
+			if ((flags & 1U) && (entry->cb != NULL))
+			{
+				entry->cb(entry->ref, level & 1UL);
+			}
+		}
+		return;
+	}
+	for (flags >>= pin; flags != 0U; pin++, flags >>= 1)
+	{
+		if (flags & 1U)
+		{
+			port_pin_event(port, pin, level);
+		}
+	}
+}
 
 void PORTA_IRQHandler(void)
 {
-    uint32_t flags = IP_PORTA->ISFR;
-    IP_PORTA->ISFR = flags;
-    if (callbacks[DRIVER_PORTA])
-    {
-        for (uint8_t i = 0; i < 32; ++i)
-        {
-        	if (flags & (1UL << i))
-        		{
-        			callbacks[DRIVER_PORTA](i);
-        		}
-        }
-    }
+	port_dispatch(DRIVER_PORTA, IP_PORTA, IP_PTA);
 }
 
 void PORTB_IRQHandler(void)
 {
-    uint32_t flags = IP_PORTB->ISFR;
-    IP_PORTB->ISFR = flags;
-    if (callbacks[DRIVER_PORTB]) {
-        for (uint8_t i = 0; i < 32; ++i)
-        {
-            if (flags & (1UL << i))
-            	{
-                    callbacks[DRIVER_PORTB](i);
-                }
-        }
-
-    }
+	port_dispatch(DRIVER_PORTB, IP_PORTB, IP_PTB);
 }
 
 void PORTC_IRQHandler(void)
 {
-    uint32_t flags = IP_PORTC->ISFR;
-    IP_PORTC->ISFR = flags;
-    if (callbacks[DRIVER_PORTC])
-    {
-        for (uint8_t i = 0; i < 32; ++i)
-        {
-        	 if (flags & (1UL << i))
-        		 {
-        		 	 callbacks[DRIVER_PORTC](i);
-        		 }
-        }
-    }
+	port_dispatch(DRIVER_PORTC, IP_PORTC, IP_PTC);
 }
 
 void PORTD_IRQHandler(void)
 {
-    uint32_t flags = IP_PORTD->ISFR;
-    IP_PORTD->ISFR = flags;
-    if (callbacks[DRIVER_PORTD])
-    {
-        for (uint8_t i = 0; i < 32; ++i)
-        {
-        	if (flags & (1UL << i))
-        		{
-        			callbacks[DRIVER_PORTD](i);
-        		}
-        }
-    }
+	port_dispatch(DRIVER_PORTD, IP_PORTD, IP_PTD);
 }
 
 void PORTE_IRQHandler(void)
 {
-    uint32_t flags = IP_PORTE->ISFR;
-    IP_PORTE->ISFR = flags;
-    if (callbacks[DRIVER_PORTE])
-    {
-        for (uint8_t i = 0; i < 32; ++i)
-        {
-        	 if (flags & (1UL << i))
-        		 {
-        		 	 callbacks[DRIVER_PORTE](i);
-        		 }
-        }
-    }
+	port_dispatch(DRIVER_PORTE, IP_PORTE, IP_PTE);
 }
 
 
@@ -0,0 +1,229 @@
+#include "driver_profile.h"
+#include <stdio.h>
+#ifdef HOST_SIM
+#include <time.h>
+#else
+#include "system_S32K144.h"
+#endif
+
+#define PROFILE_LINE_SIZE       256U
+#define PROFILE_CALIBRATE_RUNS  16U
+
+static Profile_Probe_t* probes = NULL;
+/* Cost of an empty scope, subtracted from every measurement */
+static uint32_t overhead = 0;
+
+static inline uint32_t profile_lock(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+
+static inline void profile_unlock(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+#ifdef HOST_SIM
+/* One host "cycle" is one nanosecond of CLOCK_MONOTONIC */
+static uint64_t host_start;
+
+static uint64_t host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint32_t profile_core_clock(void)
+{
+	return 1000000000UL;
+}
+
+uint32_t PROFILE_Cycles32(void)
+{
+	return (uint32_t)(host_ns() - host_start);
+}
+
+static void profile_counter_start(void)
+{
+	host_start = host_ns();
+}
+
+uint64_t PROFILE_NowCycles(void)
+{
+	return host_ns() - host_start;
+}
+#else
+/* High half of the timebase and the last CYCCNT seen, to catch the wrap */
+static uint32_t cycles_high = 0;
+static uint32_t cycles_last = 0;
+
+static inline uint32_t profile_core_clock(void)
+{
+	return SystemCoreClock;
+}
+
+static void profile_counter_start(void)
+{
+	/* TRCENA powers the DWT, then clear and start CYCCNT */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0U;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	cycles_high = 0U;
+	cycles_last = 0U;
+}
+
+uint64_t PROFILE_NowCycles(void)
+{
+	uint32_t primask = profile_lock();
+	uint32_t now = DWT->CYCCNT;
+	uint32_t high;
+
+	if (now < cycles_last)
+	{
+		cycles_high++;
+	}
+	cycles_last = now;
+	high = cycles_high;
+	profile_unlock(primask);
+
+	return ((uint64_t)high << 32) | now;
+}
+#endif
+
+void PROFILE_Init(void)
+{
+	uint32_t best = 0xFFFFFFFFUL;
+
+	profile_counter_start();
+
+	/* Back-to-back reads: what a scope costs when it measures nothing */
+	overhead = 0U;
+	for (uint32_t i = 0; i < PROFILE_CALIBRATE_RUNS; i++)
+	{
+		uint32_t start = PROFILE_Cycles32();
+		uint32_t cost = PROFILE_Cycles32() - start;
+
+		if (cost < best)
+		{
+			best = cost;
+		}
+	}
+	overhead = best;
+}
+
+uint64_t PROFILE_NowUs(void)
+{
+	return PROFILE_NowCycles() / (profile_core_clock() / 1000000UL);
+}
+
+uint32_t PROFILE_CyclesToUs(uint32_t cycles)
+{
+	return cycles / (profile_core_clock() / 1000000UL);
+}
+
+void PROFILE_Record(Profile_Probe_t *probe, uint32_t cycles)
+{
+	uint32_t primask = profile_lock();
+	uint32_t bin = (cycles > 1U) ? (31U - (uint32_t)__builtin_clz(cycles)) : 0U;
+
+	if (!probe->registered)
+	{
+		probe->registered = 1U;
+		probe->next = probes;
+		probes = probe;
+	}
+	probe->count++;
+	probe->total += cycles;
+	if (cycles < probe->min)
+	{
+		probe->min = cycles;
+	}
+	if (cycles > probe->max)
+	{
+		probe->max = cycles;
+	}
+	probe->hist[(bin < PROFILE_HIST_BINS) ? bin : (PROFILE_HIST_BINS - 1U)]++;
+	profile_unlock(primask);
+}
+
+void PROFILE_ScopeEnd(Profile_Scope_t *scope)
+{
+	uint32_t cycles = PROFILE_Cycles32() - scope->start;
+
+	PROFILE_Record(scope->probe, (cycles > overhead) ? (cycles - overhead) : 0U);
+}
+
+void PROFILE_Reset(void)
+{
+	uint32_t primask = profile_lock();
+
+	for (Profile_Probe_t* p = probes; p != NULL; p = p->next)
+	{
+		p->count = 0U;
+		p->min = 0xFFFFFFFFUL;
+		p->max = 0U;
+		p->total = 0U;
+		for (uint32_t i = 0; i < PROFILE_HIST_BINS; i++)
+		{
+			p->hist[i] = 0U;
+		}
+	}
+	profile_unlock(primask);
+}
+
+static int32_t profile_send(ARM_DRIVER_USART *usart, const char *line, uint32_t len)
+{
+	int32_t result = usart->Send(line, len);
+
+	/* The buffer is referenced until the transfer ends */
+	while ((result == ARM_DRIVER_OK) && usart->GetStatus().tx_busy)
+	{
+		__WFI();
+	}
+	return result;
+}
+
+int32_t PROFILE_Dump(ARM_DRIVER_USART *usart)
+{
+	static char line[PROFILE_LINE_SIZE];
+	int32_t result = ARM_DRIVER_OK;
+
+	for (Profile_Probe_t* p = probes; (p != NULL) && (result == ARM_DRIVER_OK); p = p->next)
+	{
+		Profile_Probe_t s;
+		uint32_t primask = profile_lock();
+		int len;
+
+		/* Consistent copy: probes may be updated from interrupts */
+		s = *p;
+		profile_unlock(primask);
+
+		if (s.count == 0U)
+		{
+			continue;
+		}
+		len = snprintf(line, sizeof(line), "%-20s n=%lu min=%lu max=%lu mean=%lu cyc |",
+				s.name, (unsigned long)s.count, (unsigned long)s.min, (unsigned long)s.max,
+				(unsigned long)(s.total / s.count));
+		for (uint32_t i = 0; (i < PROFILE_HIST_BINS) && (len < (int)(sizeof(line) - 16U)); i++)
+		{
+			if (s.hist[i] != 0U)
+			{
+				len += snprintf(&line[len], sizeof(line) - (size_t)len, " %lu:%lu",
+						(unsigned long)(1UL << i), (unsigned long)s.hist[i]);
+			}
+		}
+		len += snprintf(&line[len], sizeof(line) - (size_t)len, "\r\n");
+		if (len >= (int)sizeof(line))
+		{
+			len = (int)sizeof(line) - 1;
+		}
+		result = profile_send(usart, line, (uint32_t)len);
+	}
+	return result;
+}
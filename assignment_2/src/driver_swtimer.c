@@ -0,0 +1,428 @@
+#include "driver_swtimer.h"
+#include "driver_clock.h"
+#include "clocks_and_modes.h"
+
+#define SWTIMER_IRQ_PRIORITY    2U
+/* Shortest load of the deadline channel, so a deadline already due still fires */
+#define SWTIMER_MIN_TICKS       2U
+
+/* Driver-owned flags, above the SWTIMER_FLAG_xxx bits */
+#define SWTIMER_QUEUED          (1UL << 30)     /* linked in the deferred queue */
+#define SWTIMER_PENDING         (1UL << 31)     /* deferred callback due */
+
+static SWTimer_t* heap[SWTIMER_MAX_TIMERS];
+static uint32_t heap_size = 0;
+/* LPIT clock, and its ticks per microsecond in Q16 rounded up: 26.67 MHz is
+ * 26.667 ticks, not 26, and a delay never comes out short */
+static uint32_t tick_hz = 1000000U;
+static uint32_t ticks_per_us_q16 = 1UL << 16;
+/* Tick count and time at the last clock change: SWTIMER_NowUs() spans changes */
+static uint64_t epoch_ticks = 0;
+static uint64_t epoch_us = 0;
+static Clock_Notifier_t clock_notifier;
+
+/* Deferred callbacks, in expiry order */
+static SWTimer_t* queue_head = NULL;
+static SWTimer_t* queue_tail = NULL;
+
+/* === Critical sections: main context against the deadline ISR === */
+static inline uint32_t swtimer_lock(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+
+static inline void swtimer_unlock(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+/* === Time scale === */
+static void swtimer_set_rate(uint32_t freq)
+{
+	tick_hz = freq;
+	ticks_per_us_q16 = (uint32_t)((((uint64_t)freq << 16) + 999999U) / 1000000U);
+}
+
+/* delay_us * 112 MHz in Q16 stays below 2^56: one 32x32 multiply, no division */
+static inline uint64_t swtimer_us_to_ticks(uint32_t us)
+{
+	return (((uint64_t)us * ticks_per_us_q16) + 0xFFFFU) >> 16;
+}
+
+/* x * mul / div for any 64-bit x, rounded up or down */
+static uint64_t swtimer_scale(uint64_t x, uint32_t mul, uint32_t div, bool up)
+{
+	uint64_t rem = ((x % div) * mul) + (up ? (div - 1U) : 0U);
+
+	return ((x / div) * mul) + (rem / div);
+}
+
+/* === Min-heap on deadline, each timer knows its own slot === */
+static inline void heap_place(SWTimer_t* t, uint32_t i)
+{
+	heap[i] = t;
+	t->index = i;
+}
+
+static void heap_sift_up(uint32_t i)
+{
+	SWTimer_t* t = heap[i];
+
+	while (i > 0U)
+	{
+		uint32_t parent = (i - 1U) / 2U;
+
+		if (heap[parent]->deadline <= t->deadline)
+		{
+			break;
+		}
+		heap_place(heap[parent], i);
+		i = parent;
+	}
+	heap_place(t, i);
+}
+
+static void heap_sift_down(uint32_t i)
+{
+	SWTimer_t* t = heap[i];
+
+	for (;;)
+	{
+		uint32_t child = (2U * i) + 1U;
+
+		if (child >= heap_size)
+		{
+			break;
+		}
+		if (((child + 1U) < heap_size) && (heap[child + 1U]->deadline < heap[child]->deadline))
+		{
+			child++;
+		}
+		if (t->deadline <= heap[child]->deadline)
+		{
+			break;
+		}
+		heap_place(heap[child], i);
+		i = child;
+	}
+	heap_place(t, i);
+}
+
+static void heap_remove(SWTimer_t* t)
+{
+	uint32_t i = t->index;
+	SWTimer_t* last = heap[--heap_size];
+
+	t->index = SWTIMER_IDLE;
+	if (last != t)
+	{
+		heap_place(last, i);
+		if ((i > 0U) && (last->deadline < heap[(i - 1U) / 2U]->deadline))
+		{
+			heap_sift_up(i);
+		}
+		else
+		{
+			heap_sift_down(i);
+		}
+	}
+}
+
+/* === LPIT0 === */
+static inline uint64_t swtimer_ticks(void)
+{
+	const LPIT_Type* lpit = IP_LPIT0;
+	uint32_t hi, lo;
+
+	/* Both count down; re-read if the low half wrapped in between */
+	do
+	{
+		hi = lpit->TMR[SWTIMER_TIMEBASE_CHANNEL + 1U].CVAL;
+		lo = lpit->TMR[SWTIMER_TIMEBASE_CHANNEL].CVAL;
+	} while (hi != lpit->TMR[SWTIMER_TIMEBASE_CHANNEL + 1U].CVAL);
+
+	return ((uint64_t)~hi << 32) | (uint32_t)~lo;
+}
+
+/* Load the deadline channel with the time left to the earliest timer, or stop it */
+static void swtimer_program(uint64_t now)
+{
+	LPIT_Type* lpit = IP_LPIT0;
+	uint64_t left;
+
+	lpit->TMR[SWTIMER_DEADLINE_CHANNEL].TCTRL &= ~LPIT_TMR_TCTRL_T_EN_MASK;
+	lpit->MSR = (1UL << SWTIMER_DEADLINE_CHANNEL);
+	if (heap_size == 0U)
+	{
+		return;
+	}
+
+	left = (heap[0]->deadline > now) ? (heap[0]->deadline - now) : 0U;
+	if (left < SWTIMER_MIN_TICKS)
+	{
+		left = SWTIMER_MIN_TICKS;
+	}
+	else if (left > 0xFFFFFFFFULL)
+	{
+		/* Further than one load: wake up on the way and load the rest */
+		left = 0xFFFFFFFFULL;
+	}
+	lpit->TMR[SWTIMER_DEADLINE_CHANNEL].TVAL = (uint32_t)left - 1U;
+	/* Enabling loads TVAL */
+	lpit->TMR[SWTIMER_DEADLINE_CHANNEL].TCTRL |= LPIT_TMR_TCTRL_T_EN_MASK;
+}
+
+static void swtimer_expire(SWTimer_t* t)
+{
+	if ((t->flags & SWTIMER_FLAG_DEFERRED) == 0U)
+	{
+		t->cb(t->arg);
+		return;
+	}
+	/* A periodic timer expiring again before SWTIMER_Process() ran is coalesced */
+	t->flags |= SWTIMER_PENDING;
+	if ((t->flags & SWTIMER_QUEUED) == 0U)
+	{
+		t->flags |= SWTIMER_QUEUED;
+		t->next = NULL;
+		if (queue_tail != NULL)
+		{
+			queue_tail->next = t;
+		}
+		else
+		{
+			queue_head = t;
+		}
+		queue_tail = t;
+	}
+}
+
+void LPIT0_Ch0_IRQHandler(void)
+{
+	uint64_t now = swtimer_ticks();
+
+	IP_LPIT0->MSR = (1UL << SWTIMER_DEADLINE_CHANNEL);
+
+	while ((heap_size != 0U) && (heap[0]->deadline <= now))
+	{
+		SWTimer_t* t = heap[0];
+
+		if (t->period != 0U)
+		{
+			/* Next slot from the deadline: no drift; stays at the top if still due */
+			t->deadline += t->period;
+			heap_sift_down(0);
+		}
+		else
+		{
+			heap_remove(t);
+		}
+		swtimer_expire(t);
+		/* Callbacks may have run for a while */
+		now = swtimer_ticks();
+	}
+	swtimer_program(now);
+}
+
+/* === Clock changes: deadlines kept in time, not in ticks === */
+static void swtimer_clock_changed(uint32_t event, const Clock_Config_t *cfg)
+{
+	static uint64_t changed_at;
+	uint32_t primask = swtimer_lock();
+	uint64_t now = swtimer_ticks();
+
+	(void)cfg;
+	if (event == CLOCK_EVENT_PRE_CHANGE)
+	{
+		/* Deadlines become ticks left, in the old clock */
+		epoch_us += swtimer_scale(now - epoch_ticks, 1000000U, tick_hz, false);
+		changed_at = now;
+		for (uint32_t i = 0; i < heap_size; i++)
+		{
+			heap[i]->deadline = (heap[i]->deadline > now) ? (heap[i]->deadline - now) : 0U;
+		}
+		/* No expiry may be handled on the converted deadlines */
+		IP_LPIT0->TMR[SWTIMER_DEADLINE_CHANNEL].TCTRL &= ~LPIT_TMR_TCTRL_T_EN_MASK;
+		IP_LPIT0->MSR = (1UL << SWTIMER_DEADLINE_CHANNEL);
+	}
+	else
+	{
+		uint32_t old_hz = tick_hz;
+		uint32_t freq = PCC_GetFunctionalClockFreq(PCC_LPIT_INDEX);
+
+		/* Ticks counted during the change are taken at the old rate */
+		epoch_us += swtimer_scale(now - changed_at, 1000000U, old_hz, false);
+		epoch_ticks = now;
+		swtimer_set_rate((freq >= 1000000U) ? freq : 1000000U);
+		/* Same scale for all: the heap order holds */
+		for (uint32_t i = 0; i < heap_size; i++)
+		{
+			heap[i]->deadline = now + swtimer_scale(heap[i]->deadline, tick_hz, old_hz, true);
+			heap[i]->period = swtimer_scale(heap[i]->period, tick_hz, old_hz, true);
+		}
+		swtimer_program(now);
+	}
+	swtimer_unlock(primask);
+}
+
+/* === API === */
+int32_t SWTIMER_Init(void)
+{
+	LPIT_Type* lpit = IP_LPIT0;
+	uint32_t freq;
+
+	if ((IP_PCC->PCCn[PCC_LPIT_INDEX] & PCC_PCCn_CGC_MASK) == 0U)
+	{
+		/* Clock Src = SPLL2_DIV2_CLK, as in LPIT0_init */
+		IP_PCC->PCCn[PCC_LPIT_INDEX] = PCC_PCCn_PCS(6);
+		IP_PCC->PCCn[PCC_LPIT_INDEX] |= PCC_PCCn_CGC_MASK;
+	}
+	freq = PCC_GetFunctionalClockFreq(PCC_LPIT_INDEX);
+	if (freq < 1000000U)
+	{
+		return ARM_DRIVER_ERROR;
+	}
+	swtimer_set_rate(freq);
+	epoch_ticks = 0;
+	epoch_us = 0;
+	heap_size = 0;
+	queue_head = NULL;
+	queue_tail = NULL;
+
+	/* M_CEN=1, other channels keep running */
+	lpit->MCR |= LPIT_MCR_M_CEN_MASK;
+
+	/* Timebase: high half first, so it sees the first wrap of the low half */
+	lpit->TMR[SWTIMER_TIMEBASE_CHANNEL + 1U].TCTRL = 0U;
+	lpit->TMR[SWTIMER_TIMEBASE_CHANNEL].TCTRL = 0U;
+	lpit->TMR[SWTIMER_TIMEBASE_CHANNEL + 1U].TVAL = 0xFFFFFFFFUL;
+	lpit->TMR[SWTIMER_TIMEBASE_CHANNEL].TVAL = 0xFFFFFFFFUL;
+	lpit->TMR[SWTIMER_TIMEBASE_CHANNEL + 1U].TCTRL = LPIT_TMR_TCTRL_CHAIN_MASK | LPIT_TMR_TCTRL_T_EN_MASK;
+	lpit->TMR[SWTIMER_TIMEBASE_CHANNEL].TCTRL = LPIT_TMR_TCTRL_T_EN_MASK;
+
+	/* Deadline: stopped until a timer starts */
+	lpit->TMR[SWTIMER_DEADLINE_CHANNEL].TCTRL = 0U;
+	lpit->MSR = (1UL << SWTIMER_DEADLINE_CHANNEL);
+	lpit->MIER |= (1UL << SWTIMER_DEADLINE_CHANNEL);
+
+	NVIC_SetPriority((IRQn_Type)(LPIT0_Ch0_IRQn + SWTIMER_DEADLINE_CHANNEL), SWTIMER_IRQ_PRIORITY);
+	NVIC_EnableIRQ((IRQn_Type)(LPIT0_Ch0_IRQn + SWTIMER_DEADLINE_CHANNEL));
+	CLOCK_RegisterNotifier(&clock_notifier, swtimer_clock_changed);
+	return ARM_DRIVER_OK;
+}
+
+void SWTIMER_Setup(SWTimer_t *timer, SWTimer_Callback_t cb, void *arg, uint32_t flags)
+{
+	timer->deadline = 0;
+	timer->period = 0;
+	timer->cb = cb;
+	timer->arg = arg;
+	timer->index = SWTIMER_IDLE;
+	timer->flags = flags & SWTIMER_FLAG_DEFERRED;
+	timer->next = NULL;
+}
+
+int32_t SWTIMER_Start(SWTimer_t *timer, uint32_t delay_us, uint32_t period_us)
+{
+	uint32_t primask = swtimer_lock();
+	uint64_t now = swtimer_ticks();
+	bool was_first;
+
+	if (timer->index == SWTIMER_IDLE)
+	{
+		if (heap_size == SWTIMER_MAX_TIMERS)
+		{
+			swtimer_unlock(primask);
+			return ARM_DRIVER_ERROR;
+		}
+		heap_place(timer, heap_size++);
+	}
+	was_first = (heap[0] == timer);
+	timer->flags &= ~SWTIMER_PENDING;
+	timer->deadline = now + swtimer_us_to_ticks(delay_us);
+	timer->period = swtimer_us_to_ticks(period_us);
+	heap_sift_up(timer->index);
+	heap_sift_down(timer->index);
+
+	/* Only a change of the earliest deadline touches the hardware */
+	if (was_first || (heap[0] == timer))
+	{
+		swtimer_program(now);
+	}
+	swtimer_unlock(primask);
+	return ARM_DRIVER_OK;
+}
+
+void SWTIMER_Stop(SWTimer_t *timer)
+{
+	uint32_t primask = swtimer_lock();
+
+	timer->flags &= ~SWTIMER_PENDING;
+	if (timer->index != SWTIMER_IDLE)
+	{
+		bool was_first = (timer->index == 0U);
+
+		heap_remove(timer);
+		if (was_first)
+		{
+			swtimer_program(swtimer_ticks());
+		}
+	}
+	swtimer_unlock(primask);
+}
+
+uint32_t SWTIMER_IsRunning(const SWTimer_t *timer)
+{
+	return (timer->index != SWTIMER_IDLE) ? 1U : 0U;
+}
+
+uint64_t SWTIMER_Now(void)
+{
+	return swtimer_ticks();
+}
+
+uint64_t SWTIMER_NowUs(void)
+{
+	uint32_t primask = swtimer_lock();
+	uint64_t us = epoch_us + swtimer_scale(swtimer_ticks() - epoch_ticks, 1000000U, tick_hz, false);
+
+	swtimer_unlock(primask);
+	return us;
+}
+
+uint32_t SWTIMER_Process(void)
+{
+	uint32_t count = 0;
+
+	for (;;)
+	{
+		uint32_t primask = swtimer_lock();
+		SWTimer_t* t = queue_head;
+		bool run;
+
+		if (t == NULL)
+		{
+			swtimer_unlock(primask);
+			break;
+		}
+		queue_head = t->next;
+		if (queue_head == NULL)
+		{
+			queue_tail = NULL;
+		}
+		/* Stopped or restarted since it expired: dropped */
+		run = (t->flags & SWTIMER_PENDING) != 0U;
+		t->flags &= ~(SWTIMER_QUEUED | SWTIMER_PENDING);
+		swtimer_unlock(primask);
+
+		if (run)
+		{
+			t->cb(t->arg);
+			count++;
+		}
+	}
+	return count;
+}
@@ -1,9 +1,19 @@
 #include "driver_usart.h"
+#include "driver_port.h"
+#include "driver_clock.h"
+#include "clocks_and_modes.h"
+#include "driver_profile.h"
+#include "driver_ring.h"
+#include "driver_irq.h"
 #include "S32K144.h"
 #include <stdint.h>
+#ifdef HOST_SIM
+#include "host_sim.h"
+#else
 #include "../Core/Include/core_cm4.h"
+#endif
 
-#define ARM_USART_DRV_VERSION    ARM_DRIVER_VERSION_MAJOR_MINOR(1, 0)  /* driver version */
+#define ARM_USART_DRV_VERSION    ARM_DRIVER_VERSION_MAJOR_MINOR(1, 5)  /* driver version */
 
 /* Driver Version */
 static const ARM_DRIVER_VERSION DriverVersion = { 
@@ -22,8 +32,8 @@ static const ARM_USART_CAPABILITIES DriverCapabilities = {
     0, /* Smart Card Clock generator available */
     0, /* RTS Flow Control available */
     0, /* CTS Flow Control available */
-    0, /* Transmit completed event: \ref ARM_USART_EVENT_TX_COMPLETE */
-    0, /* Signal receive character timeout event: \ref ARM_USART_EVENT_RX_TIMEOUT */
+    1, /* Transmit completed event: \ref ARM_USART_EVENT_TX_COMPLETE */
+    1, /* Signal receive character timeout event: \ref ARM_USART_EVENT_RX_TIMEOUT */
     0, /* RTS Line: 0=not available, 1=available */
     0, /* CTS Line: 0=not available, 1=available */
     0, /* DTR Line: 0=not available, 1=available */
@@ -37,10 +47,220 @@ static const ARM_USART_CAPABILITIES DriverCapabilities = {
     0  /* Reserved (must be zero) */
 };
 
+/* STAT flags that are cleared by writing 1 */
+#define LPUART_STAT_W1C_MASK    (LPUART_STAT_LBKDIF_MASK | LPUART_STAT_RXEDGIF_MASK | \
+                                 LPUART_STAT_IDLE_MASK | LPUART_STAT_OR_MASK | LPUART_STAT_NF_MASK | \
+                                 LPUART_STAT_FE_MASK | LPUART_STAT_PF_MASK | \
+                                 LPUART_STAT_MA1F_MASK | LPUART_STAT_MA2F_MASK)
+
+/* BAUD fields written by the baud rate calculator */
+#define LPUART_BAUD_DIVISOR_MASK    (LPUART_BAUD_OSR_MASK | LPUART_BAUD_SBR_MASK | LPUART_BAUD_BOTHEDGE_MASK)
+
+/* CTRL fields written by the frame format mapping */
+#define USART_CTRL_FRAME_MASK       (LPUART_CTRL_M7_MASK | LPUART_CTRL_M_MASK | LPUART_CTRL_PE_MASK | LPUART_CTRL_PT_MASK)
+
+/* Driver run-time information */
+typedef struct {
+    LPUART_Type            *base;       /* LPUART register block */
+    IRQn_Type               irq;        /* RxTx interrupt line */
+    uint32_t                pcc_index;  /* PCC slot of the LPUART */
+    Driver_PortInstance     port;       /* PORT carrying RX/TX */
+    uint8_t                 rx_pin;
+    uint8_t                 tx_pin;
+    uint8_t                 dma_ch;     /* eDMA channel used for DMA receive */
+    uint8_t                 dma_req;    /* DMAMUX request source of the LPUART receiver */
+    ARM_USART_SignalEvent_t cb_event;   /* Registered event callback */
+    const uint8_t          *tx_buf;     /* Send buffer, referenced until SEND_COMPLETE */
+    uint32_t                tx_num;     /* Number of bytes requested by Send */
+    volatile uint32_t       tx_cnt;     /* Number of bytes handed to the transmitter */
+    volatile uint8_t        tx_busy;    /* Cleared on TX_COMPLETE */
+    uint8_t                *rx_buf;
+    uint32_t                rx_num;
+    volatile uint32_t       rx_cnt;
+    volatile uint8_t        rx_busy;
+    uint8_t                 rx_mode;    /* ARM_USART_RX_DMA_xxx */
+    uint32_t                baudrate;   /* Last rate set, kept across clock changes */
+    Ring_t                 *rx_ring;    /* Interrupt-driven receive queue, bytes */
+    Ring_t                 *tx_ring;    /* USART_Write queue, bytes */
+} usart_resources_t;
+
+/* LPUART1 is routed to the OpenSDA virtual COM port on the EVB (PTC6 = RX, PTC7 = TX) */
+static usart_resources_t uart_instance = {
+    .base      = IP_LPUART1,
+    .irq       = LPUART1_RxTx_IRQn,
+    .pcc_index = PCC_LPUART1_INDEX,
+    .port      = DRIVER_PORTC,
+    .rx_pin    = 6U,
+    .tx_pin    = 7U,
+    .dma_ch    = 0U,
+    .dma_req   = 4U,    /* EDMA_REQ_LPUART1_RX */
+};
+
+static Clock_Notifier_t clock_notifier;
+
+static int32_t ARM_USART_Control(uint32_t control, uint32_t arg);
+static void usart_isr(void);
+
+/* === Critical sections: CTRL read-modify-write against the RxTx ISR === */
+static inline uint32_t usart_lock(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+
+static inline void usart_unlock(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
 //
 //   Functions
 //
 
+/**
+ * @brief Search OSR 4..32 x SBR for the divisor closest to the requested baud rate
+ * 
+ * baud = clk / (OSR * SBR). For each OSR the best SBR is the rounded quotient,
+ * so only 29 candidates are compared. On equal error the higher OSR wins
+ * (more samples per bit). BOTHEDGE is required for OSR 4..7.
+ * Pure function: touches no registers.
+ * 
+ * @param clk_hz 
+ * @param baudrate 
+ * @param baud_reg 
+ * @return int32_t 
+ */
+int32_t USART_CalcBaudReg(uint32_t clk_hz, uint32_t baudrate, uint32_t *baud_reg)
+{
+    uint32_t best_osr = 0U;
+    uint32_t best_sbr = 0U;
+    /* Best error so far as the fraction best_num / best_den (in baud); 0/0 before the first candidate */
+    uint64_t best_num = 0U;
+    uint64_t best_den = 0U;
+
+    if ((baud_reg == NULL) || (clk_hz == 0U) || (baudrate == 0U)) {
+        return ARM_USART_ERROR_BAUDRATE;
+    }
+
+    for (uint32_t osr = 4U; osr <= 32U; osr++)
+    {
+        uint64_t div = (uint64_t)baudrate * osr;
+        uint64_t sbr = (clk_hz + (div / 2U)) / div;
+        uint64_t num;
+
+        if (sbr == 0U) {
+            sbr = 1U;
+        } else if (sbr > LPUART_BAUD_SBR_MASK) {
+            sbr = LPUART_BAUD_SBR_MASK;
+        }
+
+        /* |clk / (OSR * SBR) - baud| = |clk - baud * OSR * SBR| / (OSR * SBR) */
+        num = (clk_hz > (div * sbr)) ? (clk_hz - (div * sbr)) : ((div * sbr) - clk_hz);
+
+        if ((best_den == 0U) || ((num * best_den) <= (best_num * (osr * sbr))))
+        {
+            best_num = num;
+            best_den = osr * sbr;
+            best_osr = osr;
+            best_sbr = (uint32_t)sbr;
+        }
+    }
+
+    if ((best_num * 1000U) > ((uint64_t)baudrate * ARM_USART_BAUD_TOLERANCE_PERMILLE * best_den)) {
+        return ARM_USART_ERROR_BAUDRATE;
+    }
+
+    *baud_reg = LPUART_BAUD_OSR(best_osr - 1U) | LPUART_BAUD_SBR(best_sbr);
+    if (best_osr < 8U) {
+        *baud_reg |= LPUART_BAUD_BOTHEDGE_MASK;
+    }
+
+    return ARM_DRIVER_OK;
+}
+
+/**
+ * @brief Map the CMSIS data bits, parity and stop bits fields to LPUART CTRL and BAUD
+ *
+ * The LPUART character length counts the parity bit: 7 data bits + parity
+ * is an 8-bit character, 8 + parity a 9-bit one. 5, 6 and 9 data bits are
+ * refused (transfers are byte arrays), as are 0.5 and 1.5 stop bits and
+ * flow control (no RTS/CTS pins are routed).
+ *
+ * @param control ARM_USART_MODE_ASYNCHRONOUS | ARM_USART_DATA_BITS_x | ...
+ * @param ctrl M7, M, PE and PT bits for CTRL
+ * @param baud SBNS bit for BAUD
+ * @return int32_t ARM_DRIVER_OK or ARM_USART_ERROR_xxx
+ */
+static int32_t USART_CalcFrame(uint32_t control, uint32_t *ctrl, uint32_t *baud)
+{
+	uint32_t parity = control & ARM_USART_PARITY_Msk;
+
+	switch (parity)
+	{
+		case ARM_USART_PARITY_NONE: *ctrl = 0U; break;
+		case ARM_USART_PARITY_EVEN: *ctrl = LPUART_CTRL_PE_MASK; break;
+		case ARM_USART_PARITY_ODD:  *ctrl = LPUART_CTRL_PE_MASK | LPUART_CTRL_PT_MASK; break;
+		default: return ARM_USART_ERROR_PARITY;
+	}
+
+	switch (control & ARM_USART_DATA_BITS_Msk)
+	{
+		case ARM_USART_DATA_BITS_7:
+			if (parity == ARM_USART_PARITY_NONE) *ctrl |= LPUART_CTRL_M7_MASK;
+			break;
+		case ARM_USART_DATA_BITS_8:
+			if (parity != ARM_USART_PARITY_NONE) *ctrl |= LPUART_CTRL_M_MASK;
+			break;
+		default:
+			return ARM_USART_ERROR_DATA_BITS;
+	}
+
+	switch (control & ARM_USART_STOP_BITS_Msk)
+	{
+		case ARM_USART_STOP_BITS_1: *baud = 0U; break;
+		case ARM_USART_STOP_BITS_2: *baud = LPUART_BAUD_SBNS_MASK; break;
+		default: return ARM_USART_ERROR_STOP_BITS;
+	}
+
+	if ((control & ARM_USART_FLOW_CONTROL_Msk) != ARM_USART_FLOW_CONTROL_NONE) {
+		return ARM_USART_ERROR_FLOW_CONTROL;
+	}
+
+	return ARM_DRIVER_OK;
+}
+
+/**
+ * @brief Clock change notifier: keep the baud rate on the new functional clock
+ *
+ * Characters in flight during the change may be lost. If the new clock
+ * cannot give the rate within tolerance, the old divisor is kept.
+ *
+ * @param event CLOCK_EVENT_xxx
+ * @param cfg new configuration
+ */
+static void USART_ClockChanged(uint32_t event, const Clock_Config_t *cfg)
+{
+	LPUART_Type *base = uart_instance.base;
+	uint32_t baud_reg;
+	uint32_t ctrl;
+	uint32_t primask;
+
+	(void)cfg;
+	if ((event != CLOCK_EVENT_POST_CHANGE) ||
+	    (USART_CalcBaudReg(PCC_GetFunctionalClockFreq(uart_instance.pcc_index), uart_instance.baudrate, &baud_reg) != ARM_DRIVER_OK)) {
+		return;
+	}
+	/* BAUD may only change while the transmitter and receiver are off */
+	primask = usart_lock();
+	ctrl = base->CTRL;
+	base->CTRL = ctrl & ~(LPUART_CTRL_TE_MASK | LPUART_CTRL_RE_MASK);
+	base->BAUD = (base->BAUD & ~LPUART_BAUD_DIVISOR_MASK) | baud_reg;
+	base->CTRL = ctrl;
+	usart_unlock(primask);
+}
+
 /**
  * @brief Get USART driver's version
  * 
@@ -48,6 +268,7 @@ static const ARM_USART_CAPABILITIES DriverCapabilities = {
  */
 static ARM_DRIVER_VERSION ARM_USART_GetVersion(void)
 {
+  PROFILE_DRIVER_SCOPE("usart_get_version");
   return DriverVersion;
 }
 
@@ -58,6 +279,7 @@ static ARM_DRIVER_VERSION ARM_USART_GetVersion(void)
  */
 static ARM_USART_CAPABILITIES ARM_USART_GetCapabilities(void)
 {
+  PROFILE_DRIVER_SCOPE("usart_get_capabilities");
   return DriverCapabilities;
 }
 
@@ -69,16 +291,30 @@ static ARM_USART_CAPABILITIES ARM_USART_GetCapabilities(void)
  */
 static int32_t ARM_USART_Initialize(ARM_USART_SignalEvent_t cb_event)
 {
-	/* Config port and enable clock for UART */
-	DRIVER_PORT_EnableClock(uart_instance.pcc_index);
-	/* Choose clock source */
-	IP_PCC->PCCn[uart_instance.pcc_index] |= PCC_PCCn_PCS;
-	/* Config pin mux */
-	DRIVER_PORT_PinMux(uart_instance.port, uart_instance.pin, DRIVER_PORT_MUX_ALT2);
+	PROFILE_DRIVER_SCOPE("usart_initialize");
+	uart_instance.cb_event = cb_event;
+	uart_instance.tx_busy = 0U;
+	uart_instance.rx_busy = 0U;
+
+	/* Enable clock for the port and route RX/TX to the LPUART */
+	DRIVER_PORT_EnableClock(uart_instance.port);
+	DRIVER_PORT_PinMux(uart_instance.port, uart_instance.rx_pin, DRIVER_PORT_MUX_ALT2);
+	DRIVER_PORT_PinMux(uart_instance.port, uart_instance.tx_pin, DRIVER_PORT_MUX_ALT2);
+	/* Choose clock source: PCS = 1, SOSCDIV2_CLK (PCS can only change while CGC = 0) */
+	IP_PCC->PCCn[uart_instance.pcc_index] &= ~PCC_PCCn_CGC_MASK;
+	IP_PCC->PCCn[uart_instance.pcc_index] = PCC_PCCn_PCS(1) | PCC_PCCn_CGC_MASK;
 	/* Set baud rate and other settings */
-	ARM_USART_Control(ARM_USART_MODE_ASYNCHRONOUS, 9600);
-	NVIC_ClearPendingIRQ(uart_instance.get_IRQ);
-	NVIC_EnableIRQ(uart_instance.get_IRQ)
+	if (ARM_USART_Control(ARM_USART_MODE_ASYNCHRONOUS, 9600) != ARM_DRIVER_OK) {
+		return ARM_DRIVER_ERROR;
+	}
+	CLOCK_RegisterNotifier(&clock_notifier, USART_ClockChanged);
+	/* Straight to this instance on entry; the LPUARTn_RxTx_IRQHandler symbols
+	   remain for a vector table in flash */
+	(void)IRQ_Install(uart_instance.irq, usart_isr);
+	NVIC_ClearPendingIRQ(uart_instance.irq);
+	NVIC_EnableIRQ(uart_instance.irq);
+
+	return ARM_DRIVER_OK;
 }
 
 /**
@@ -88,7 +324,19 @@ static int32_t ARM_USART_Initialize(ARM_USART_SignalEvent_t cb_event)
  */
 static int32_t ARM_USART_Uninitialize(void)
 {
+	PROFILE_DRIVER_SCOPE("usart_uninitialize");
 	/* Reverse the Initialization */
+	NVIC_DisableIRQ(uart_instance.irq);
+	(void)IRQ_Restore(uart_instance.irq);
+	uart_instance.base->CTRL = 0U;
+	IP_PCC->PCCn[uart_instance.pcc_index] &= ~PCC_PCCn_CGC_MASK;
+	uart_instance.cb_event = NULL;
+	uart_instance.tx_busy = 0U;
+	uart_instance.rx_busy = 0U;
+	uart_instance.rx_ring = NULL;
+	uart_instance.tx_ring = NULL;
+
+	return ARM_DRIVER_OK;
 }
 
 /**
@@ -99,6 +347,7 @@ static int32_t ARM_USART_Uninitialize(void)
  */
 static int32_t ARM_USART_PowerControl(ARM_POWER_STATE state)
 {
+    PROFILE_DRIVER_SCOPE("usart_power_control");
     switch (state)
     {
     case ARM_POWER_OFF:
@@ -114,7 +363,11 @@ static int32_t ARM_USART_PowerControl(ARM_POWER_STATE state)
 }
 
 /**
- * @brief Send the data through UART peripheral
+ * @brief Start sending data through UART peripheral
+ * 
+ * The buffer is referenced, not copied: it must stay valid until
+ * ARM_USART_EVENT_SEND_COMPLETE. The bytes are pushed from the RxTx ISR,
+ * so the call returns as soon as the transmitter interrupt is armed.
  * 
  * @param data 
  * @param num 
@@ -122,49 +375,147 @@ static int32_t ARM_USART_PowerControl(ARM_POWER_STATE state)
  */
 static int32_t ARM_USART_Send(const void *data, uint32_t num)
 {
+	PROFILE_DRIVER_SCOPE("usart_send");
+	uint32_t primask;
+
 	if ((data == NULL) || (num == 0U)) {
         return ARM_DRIVER_ERROR_PARAMETER;
     }
 
-    uart_instance.tx_buf = (const uint8_t *)data;
+    if (uart_instance.tx_busy) {
+        return ARM_DRIVER_ERROR_BUSY;
+    }
 
-    for (uint32_t i = 0; i < num; i++) {
-        /* Wait until Transmit Data Register Empty (TDRE) flag is set */
-        while (!(uart_instance.get_ip->STAT & LPUART_STAT_TDRE_MASK)) {
-            /* Wait for transmitter to be ready */
-        }
+    uart_instance.tx_buf  = (const uint8_t *)data;
+    uart_instance.tx_num  = num;
+    uart_instance.tx_cnt  = 0U;
+    uart_instance.tx_busy = 1U;
+
+    /* TDRE is already set while the transmitter is idle, so arming TIE starts the transfer */
+    primask = usart_lock();
+    uart_instance.base->CTRL |= LPUART_CTRL_TIE_MASK;
+    usart_unlock(primask);
+
+    return ARM_DRIVER_OK;
+}
+
+/**
+ * @brief Arm eDMA to move received bytes straight into rx_buf
+ * 
+ * One byte per minor loop from DATA, rx_num minor loops per major loop.
+ * Single mode sets DREQ so the channel stops after the buffer is full;
+ * ping-pong mode keeps running, wrapping through DLASTSGA, and interrupts
+ * at the half and at the end of the buffer. The idle-line interrupt closes
+ * variable-length frames with ARM_USART_EVENT_RX_TIMEOUT.
+ * 
+ * @param usart 
+ * @return int32_t 
+ */
+static int32_t USART_ReceiveDMA(usart_resources_t *usart)
+{
+    uint8_t  ch  = usart->dma_ch;
+    uint16_t csr = DMA_TCD_CSR_INTMAJOR_MASK;
+    uint32_t primask;
+
+    if (usart->rx_num > DMA_TCD_CITER_ELINKNO_CITER_MASK) {
+        return ARM_DRIVER_ERROR_PARAMETER;
+    }
 
-        /* Write the next byte to DATA register */
-        uart_instance.get_ip->DATA = uart_instance.tx_buf[i];
+    if (usart->rx_mode == ARM_USART_RX_DMA_PINGPONG) {
+        /* Both halves must be the same size */
+        if ((usart->rx_num < 2U) || ((usart->rx_num & 1U) != 0U)) {
+            return ARM_DRIVER_ERROR_PARAMETER;
+        }
+        csr |= DMA_TCD_CSR_INTHALF_MASK;
+    } else {
+        csr |= DMA_TCD_CSR_DREQ_MASK;
     }
 
-    /* Wait for the Transmission Complete (TC) flag to ensure last bit sent */
-    while (!(uart_instance.get_ip->STAT & LPUART_STAT_TC_MASK));
+    IP_DMA->CERQ = ch;
+    IP_DMA->TCD[ch].SADDR          = (uint32_t)(uintptr_t)&usart->base->DATA;
+    IP_DMA->TCD[ch].SOFF           = 0U;
+    IP_DMA->TCD[ch].ATTR           = DMA_TCD_ATTR_SSIZE(0) | DMA_TCD_ATTR_DSIZE(0);
+    IP_DMA->TCD[ch].NBYTES.MLNO    = DMA_TCD_NBYTES_MLNO_NBYTES(1);
+    IP_DMA->TCD[ch].SLAST          = 0U;
+    IP_DMA->TCD[ch].DADDR          = (uint32_t)(uintptr_t)usart->rx_buf;
+    IP_DMA->TCD[ch].DOFF           = 1U;
+    IP_DMA->TCD[ch].CITER.ELINKNO  = (uint16_t)usart->rx_num;
+    IP_DMA->TCD[ch].BITER.ELINKNO  = (uint16_t)usart->rx_num;
+    IP_DMA->TCD[ch].DLASTSGA       = (uint32_t)(-(int32_t)usart->rx_num);
+    IP_DMA->TCD[ch].CSR            = csr;
+
+    usart->rx_busy = 1U;
+
+    /* Drop a stale idle/overrun flag so the first event belongs to this receive */
+    usart->base->STAT = (usart->base->STAT & ~LPUART_STAT_W1C_MASK) | LPUART_STAT_IDLE_MASK | LPUART_STAT_OR_MASK;
+    usart->base->BAUD |= LPUART_BAUD_RDMAE_MASK;
+    primask = usart_lock();
+    usart->base->CTRL |= LPUART_CTRL_ILIE_MASK;
+    usart_unlock(primask);
+    IP_DMA->SERQ = ch;
 
     return ARM_DRIVER_OK;
 }
 
+/**
+ * @brief Stop the receive DMA and latch the number of bytes written so far
+ * 
+ * @param usart 
+ */
+static void USART_StopReceiveDMA(usart_resources_t *usart)
+{
+    uint32_t primask;
+
+    IP_DMA->CERQ = usart->dma_ch;
+    usart->base->BAUD &= ~LPUART_BAUD_RDMAE_MASK;
+    primask = usart_lock();
+    usart->base->CTRL &= ~LPUART_CTRL_ILIE_MASK;
+    usart_unlock(primask);
+    usart->rx_cnt = usart->rx_num - (IP_DMA->TCD[usart->dma_ch].CITER.ELINKNO & DMA_TCD_CITER_ELINKNO_CITER_MASK);
+    usart->rx_busy = 0U;
+}
+
 /**
  * @brief Receive the data through peripheral
  * 
+ * In DMA mode the call returns immediately; completion is signalled by
+ * ARM_USART_EVENT_RECEIVE_COMPLETE (buffer or half-buffer full) or
+ * ARM_USART_EVENT_RX_TIMEOUT (line idle after a shorter frame).
+ * 
  * @param data 
  * @param num 
  * @return int32_t 
  */
 static int32_t ARM_USART_Receive(void *data, uint32_t num)
 {
+	PROFILE_DRIVER_SCOPE("usart_receive");
+	if ((data == NULL) || (num == 0U)) {
+        return ARM_DRIVER_ERROR_PARAMETER;
+    }
+
+    if (uart_instance.rx_busy || (uart_instance.rx_ring != NULL)) {
+        return ARM_DRIVER_ERROR_BUSY;
+    }
+
 	uart_instance.rx_buf = (uint8_t *)data;
+	uart_instance.rx_num = num;
+	uart_instance.rx_cnt = 0U;
+
+	if (uart_instance.rx_mode != ARM_USART_RX_DMA_DISABLED) {
+        return USART_ReceiveDMA(&uart_instance);
+    }
 
     for (uint32_t i = 0; i < num; i++)
     {
         /* Wait until Receive Data Register Full (RDRF = 1) */
-        while ((uart_instance.get_ip->STAT & LPUART_STAT_RDRF_MASK) == 0U)
+        while ((uart_instance.base->STAT & LPUART_STAT_RDRF_MASK) == 0U)
         {
             /* wait for data */
         }
 
         /* Read the received byte */
-        uart_insance.rx_buf[i] = (uint8_t)(uart_instance.get_ip->DATA & 0xFFU);
+        uart_instance.rx_buf[i] = (uint8_t)(uart_instance.base->DATA & 0xFFU);
+        uart_instance.rx_cnt++;
     }
 
     return ARM_DRIVER_OK;
@@ -180,27 +531,42 @@ static int32_t ARM_USART_Receive(void *data, uint32_t num)
  */
 static int32_t ARM_USART_Transfer(const void *data_out, void *data_in, uint32_t num)
 {
-	/* Do nothing */
+	PROFILE_DRIVER_SCOPE("usart_transfer");
+	/* Synchronous mode is not supported */
+	return ARM_DRIVER_ERROR_UNSUPPORTED;
 }
 
 /**
- * @brief Get transmit's data size 
+ * @brief Get number of bytes handed to the transmitter by the current Send
  * 
  * @return uint32_t 
  */
 static uint32_t ARM_USART_GetTxCount(void)
 {
-	/* Do nothing */
+	PROFILE_DRIVER_SCOPE("usart_get_tx_count");
+	return uart_instance.tx_cnt;
 }
 
 /**
  * @brief Get receive's data size
  * 
+ * While a DMA receive is running the count is read live from the channel's
+ * major loop counter. In ping-pong mode it is the write offset in the buffer:
+ * below rx_num / 2 the second half is the one that just completed.
+ * 
  * @return uint32_t 
  */
 static uint32_t ARM_USART_GetRxCount(void)
 {
-	/* Do nothing */
+	PROFILE_DRIVER_SCOPE("usart_get_rx_count");
+	if ((uart_instance.rx_mode != ARM_USART_RX_DMA_DISABLED) && uart_instance.rx_busy)
+	{
+		uint32_t citer = IP_DMA->TCD[uart_instance.dma_ch].CITER.ELINKNO & DMA_TCD_CITER_ELINKNO_CITER_MASK;
+
+		return (citer == uart_instance.rx_num) ? 0U : (uart_instance.rx_num - citer);
+	}
+
+	return uart_instance.rx_cnt;
 }
 
 /**
@@ -212,17 +578,109 @@ static uint32_t ARM_USART_GetRxCount(void)
  */
 static int32_t ARM_USART_Control(uint32_t control, uint32_t arg)
 {
-	/* For now there in this version, there is only a mode config
-	This asynchronous mode is setting as 9600 baud, 1 stop bit, 8-bit format, no parity
-	*/
-	uint32_t mode = control & ARM_USART_MODE_ASYNCHRONOUS;
-	switch(mode)
+	PROFILE_DRIVER_SCOPE("usart_control");
+	LPUART_Type *base = uart_instance.base;
+	uint32_t primask;
+
+	switch (control & ARM_USART_CONTROL_Msk)
 	{
 		case ARM_USART_MODE_ASYNCHRONOUS:
-		uart_instance.get_IP->BAUD = 0x0F000034;
-		uart_instance.get_IP->CTRL = 0x000C0000;
+		{
+			uint32_t baud_reg;
+			uint32_t frame;
+			uint32_t sbns;
+			uint32_t ctrl;
+			int32_t status;
+
+			if (uart_instance.tx_busy || uart_instance.rx_busy) {
+				return ARM_DRIVER_ERROR_BUSY;
+			}
+			status = USART_CalcFrame(control, &frame, &sbns);
+			if (status != ARM_DRIVER_OK) {
+				return status;
+			}
+			/* arg = baud rate, derived from the live LPUART functional clock */
+			if (USART_CalcBaudReg(PCC_GetFunctionalClockFreq(uart_instance.pcc_index), arg, &baud_reg) != ARM_DRIVER_OK) {
+				return ARM_USART_ERROR_BAUDRATE;
+			}
+			/* BAUD and the frame format may only change while the transmitter
+			   and receiver are off; the interrupt enables and idle setup stay */
+			primask = usart_lock();
+			ctrl = base->CTRL;
+			base->CTRL = ctrl & ~(LPUART_CTRL_TE_MASK | LPUART_CTRL_RE_MASK);
+			base->BAUD = (base->BAUD & ~(LPUART_BAUD_DIVISOR_MASK | LPUART_BAUD_SBNS_MASK | LPUART_BAUD_M10_MASK)) | baud_reg | sbns;
+			base->CTRL = (ctrl & ~USART_CTRL_FRAME_MASK) | frame | LPUART_CTRL_TE_MASK | LPUART_CTRL_RE_MASK;
+			usart_unlock(primask);
+			uart_instance.baudrate = arg;
+			break;
+		}
+
+		case ARM_USART_CONTROL_TX:
+			primask = usart_lock();
+			if (arg) base->CTRL |= LPUART_CTRL_TE_MASK;
+			else     base->CTRL &= ~LPUART_CTRL_TE_MASK;
+			usart_unlock(primask);
+			break;
+
+		case ARM_USART_CONTROL_RX:
+			primask = usart_lock();
+			if (arg) base->CTRL |= LPUART_CTRL_RE_MASK;
+			else     base->CTRL &= ~LPUART_CTRL_RE_MASK;
+			usart_unlock(primask);
+			break;
+
+		case ARM_USART_CONTROL_RX_DMA:
+			if (uart_instance.rx_busy || ((arg != ARM_USART_RX_DMA_DISABLED) && (uart_instance.rx_ring != NULL))) {
+				return ARM_DRIVER_ERROR_BUSY;
+			}
+			if (arg > ARM_USART_RX_DMA_PINGPONG) {
+				return ARM_DRIVER_ERROR_PARAMETER;
+			}
+			if (arg != ARM_USART_RX_DMA_DISABLED)
+			{
+				uint8_t ch = uart_instance.dma_ch;
+				uint32_t ctrl;
+
+				/* Route the LPUART receive request to the channel */
+				IP_PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;
+				IP_DMAMUX->CHCFG[ch] = 0U;
+				IP_DMAMUX->CHCFG[ch] = DMAMUX_CHCFG_SOURCE(uart_instance.dma_req) | DMAMUX_CHCFG_ENBL_MASK;
+				NVIC_ClearPendingIRQ((IRQn_Type)(DMA0_IRQn + ch));
+				NVIC_EnableIRQ((IRQn_Type)(DMA0_IRQn + ch));
+
+				/* ILT = 1: count idle after the stop bit; IDLECFG = 1: 2 idle characters.
+				   Both may only change while the transmitter and receiver are off */
+				primask = usart_lock();
+				ctrl = base->CTRL;
+				base->CTRL = ctrl & ~(LPUART_CTRL_TE_MASK | LPUART_CTRL_RE_MASK);
+				base->CTRL = (ctrl & ~LPUART_CTRL_IDLECFG_MASK) | LPUART_CTRL_ILT_MASK | LPUART_CTRL_IDLECFG(1);
+				usart_unlock(primask);
+			}
+			uart_instance.rx_mode = (uint8_t)arg;
+			break;
+
+		case ARM_USART_ABORT_RECEIVE:
+			if (uart_instance.rx_busy && (uart_instance.rx_mode != ARM_USART_RX_DMA_DISABLED)) {
+				USART_StopReceiveDMA(&uart_instance);
+			}
+			uart_instance.rx_busy = 0U;
+			break;
+
+		case ARM_USART_ABORT_SEND:
+			/* Stop feeding the transmitter; bytes already in the shifter still go out */
+			primask = usart_lock();
+			base->CTRL &= ~(LPUART_CTRL_TIE_MASK | LPUART_CTRL_TCIE_MASK);
+			usart_unlock(primask);
+			uart_instance.tx_num  = 0U;
+			uart_instance.tx_cnt  = 0U;
+			uart_instance.tx_busy = 0U;
+			break;
+
+		default:
+			return ARM_DRIVER_ERROR_UNSUPPORTED;
 	}
-	/*Set baud rate*/
+
+	return ARM_DRIVER_OK;
 }
 
 /**
@@ -232,7 +690,13 @@ static int32_t ARM_USART_Control(uint32_t control, uint32_t arg)
  */
 static ARM_USART_STATUS ARM_USART_GetStatus(void)
 {
-	/* Do nothing */
+	PROFILE_DRIVER_SCOPE("usart_get_status");
+	ARM_USART_STATUS status = {0};
+
+	status.tx_busy = uart_instance.tx_busy;
+	status.rx_busy = uart_instance.rx_busy;
+
+	return status;
 }
 
 /**
@@ -243,7 +707,9 @@ static ARM_USART_STATUS ARM_USART_GetStatus(void)
  */
 static int32_t ARM_USART_SetModemControl(ARM_USART_MODEM_CONTROL control)
 {
-	/* Do nothing */
+	PROFILE_DRIVER_SCOPE("usart_set_modem_control");
+	/* No modem lines on this instance */
+	return ARM_DRIVER_ERROR_UNSUPPORTED;
 }
 
 /**
@@ -253,6 +719,10 @@ static int32_t ARM_USART_SetModemControl(ARM_USART_MODEM_CONTROL control)
  */
 static ARM_USART_MODEM_STATUS ARM_USART_GetModemStatus(void)
 {
+	PROFILE_DRIVER_SCOPE("usart_get_modem_status");
+	ARM_USART_MODEM_STATUS modem_status = {0};
+
+	return modem_status;
 }
 
 /**
@@ -262,9 +732,83 @@ static ARM_USART_MODEM_STATUS ARM_USART_GetModemStatus(void)
  */
 static void ARM_USART_SignalEvent(uint32_t event)
 {
+    PROFILE_DRIVER_SCOPE("usart_signal_event");
     // function body
 }
 
+/**
+ * @brief Attach receive and transmit queues (byte rings), NULL detaches
+ *
+ * rx: every received byte is pushed by the RxTx ISR (RIE); a full ring drops
+ * the byte and signals ARM_USART_EVENT_RX_OVERFLOW. Receive is refused while
+ * attached, and the ring cannot be combined with DMA receive.
+ * tx: USART_Write() queues bytes; the ISR drains them whenever no Send is in
+ * progress. Use an MPSC ring when several contexts write.
+ *
+ * @param rx
+ * @param tx
+ * @return int32_t
+ */
+int32_t USART_SetRings(Ring_t *rx, Ring_t *tx)
+{
+	LPUART_Type *base = uart_instance.base;
+	uint32_t primask;
+
+	if (((rx != NULL) && (rx->elem_size != 1U)) || ((tx != NULL) && (tx->elem_size != 1U))) {
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+	if (uart_instance.rx_busy || uart_instance.tx_busy) {
+		return ARM_DRIVER_ERROR_BUSY;
+	}
+	if ((rx != NULL) && (uart_instance.rx_mode != ARM_USART_RX_DMA_DISABLED)) {
+		return ARM_DRIVER_ERROR_BUSY;
+	}
+
+	primask = usart_lock();
+	uart_instance.rx_ring = rx;
+	uart_instance.tx_ring = tx;
+	if (rx != NULL) {
+		base->CTRL |= LPUART_CTRL_RIE_MASK;
+	} else {
+		base->CTRL &= ~LPUART_CTRL_RIE_MASK;
+	}
+	if ((tx != NULL) && (RING_Count(tx) != 0U)) {
+		base->CTRL |= LPUART_CTRL_TIE_MASK;
+	} else {
+		base->CTRL &= ~LPUART_CTRL_TIE_MASK;
+	}
+	usart_unlock(primask);
+
+	return ARM_DRIVER_OK;
+}
+
+/**
+ * @brief Queue bytes on the transmit ring and start the transmitter
+ *
+ * Returns at once. The data is copied, so the buffer may be reused.
+ *
+ * @param data
+ * @param num
+ * @return uint32_t bytes queued, less than num when the ring is full
+ */
+uint32_t USART_Write(const void *data, uint32_t num)
+{
+	Ring_t *ring = uart_instance.tx_ring;
+	uint32_t n;
+	uint32_t primask;
+
+	if ((ring == NULL) || (data == NULL)) {
+		return 0U;
+	}
+	n = RING_Push(ring, data, num);
+	if (n != 0U) {
+		primask = usart_lock();
+		uart_instance.base->CTRL |= LPUART_CTRL_TIE_MASK;
+		usart_unlock(primask);
+	}
+	return n;
+}
+
 // End USART Interface
 
 ARM_DRIVER_USART Driver_USART0 = {
@@ -284,18 +828,184 @@ ARM_DRIVER_USART Driver_USART0 = {
     ARM_USART_GetModemStatus
 };
 
+/**
+ * @brief Feed the transmitter from the transmit ring, straight from its spans
+ *
+ * TIE is dropped once the ring is empty, then the ring is checked again: a
+ * higher priority writer may have queued bytes in between.
+ */
+static void USART_DrainTxRing(usart_resources_t *usart)
+{
+    LPUART_Type *base = usart->base;
+    const void *span;
+    uint32_t n;
+
+    while ((n = RING_ReadSpan(usart->tx_ring, &span)) != 0U)
+    {
+        const uint8_t *bytes = (const uint8_t *)span;
+        uint32_t i = 0U;
+
+        while ((i < n) && (base->STAT & LPUART_STAT_TDRE_MASK))
+        {
+            base->DATA = bytes[i];
+            i++;
+        }
+        RING_ReadRelease(usart->tx_ring, i);
+        if (i < n)
+        {
+            return;
+        }
+    }
+    base->CTRL &= ~LPUART_CTRL_TIE_MASK;
+    if (RING_Count(usart->tx_ring) != 0U)
+    {
+        base->CTRL |= LPUART_CTRL_TIE_MASK;
+    }
+}
+
+/**
+ * @brief Shared RxTx interrupt service for the driver instance
+ * 
+ * TDRE: refill DATA from the Send buffer; once the last byte is queued, swap TIE
+ * for TCIE and signal SEND_COMPLETE. With no Send bytes left, drain the
+ * transmit ring; TC then waits for the ring bytes too.
+ * TC: the line is idle again; signal TX_COMPLETE and release the transmitter,
+ * then go back to the transmit ring if it filled meanwhile.
+ * RDRF (receive ring): push the byte; RX_OVERFLOW when the ring is full.
+ * IDLE/OR (DMA receive): signal RX_TIMEOUT / RX_OVERFLOW.
+ */
+static void USART_IRQHandler(usart_resources_t *usart)
+{
+    LPUART_Type *base = usart->base;
+    uint32_t ctrl = base->CTRL;
+    uint32_t stat = base->STAT;
+    uint32_t event = 0U;
+
+    if ((ctrl & LPUART_CTRL_RIE_MASK) && (usart->rx_ring != NULL))
+    {
+        while (base->STAT & LPUART_STAT_RDRF_MASK)
+        {
+            uint8_t byte = (uint8_t)(base->DATA & 0xFFU);
+
+            if (RING_Push(usart->rx_ring, &byte, 1U) == 0U)
+            {
+                event |= ARM_USART_EVENT_RX_OVERFLOW;
+            }
+        }
+        /* OR blocks further receives until cleared */
+        if ((stat & LPUART_STAT_OR_MASK) && !(ctrl & LPUART_CTRL_ILIE_MASK))
+        {
+            base->STAT = (stat & ~LPUART_STAT_W1C_MASK) | LPUART_STAT_OR_MASK;
+            event |= ARM_USART_EVENT_RX_OVERFLOW;
+        }
+    }
+
+    if ((ctrl & LPUART_CTRL_TIE_MASK) && (base->STAT & LPUART_STAT_TDRE_MASK))
+    {
+        /* Once the Send buffer is handed over, TDRE only serves the ring: a
+           USART_Write before TC re-arms TIE, and must not end the Send again */
+        if (usart->tx_busy && (usart->tx_cnt < usart->tx_num))
+        {
+            while ((usart->tx_cnt < usart->tx_num) && (base->STAT & LPUART_STAT_TDRE_MASK))
+            {
+                base->DATA = usart->tx_buf[usart->tx_cnt];
+                usart->tx_cnt++;
+            }
+
+            if (usart->tx_cnt == usart->tx_num)
+            {
+                base->CTRL = (base->CTRL & ~LPUART_CTRL_TIE_MASK) | LPUART_CTRL_TCIE_MASK;
+                event |= ARM_USART_EVENT_SEND_COMPLETE;
+            }
+        }
+        else if (usart->tx_ring != NULL)
+        {
+            USART_DrainTxRing(usart);
+        }
+        else
+        {
+            base->CTRL &= ~LPUART_CTRL_TIE_MASK;
+        }
+    }
+    else if ((ctrl & LPUART_CTRL_TCIE_MASK) && (base->STAT & LPUART_STAT_TC_MASK))
+    {
+        base->CTRL &= ~LPUART_CTRL_TCIE_MASK;
+        usart->tx_busy = 0U;
+        event |= ARM_USART_EVENT_TX_COMPLETE;
+        if ((usart->tx_ring != NULL) && (RING_Count(usart->tx_ring) != 0U))
+        {
+            base->CTRL |= LPUART_CTRL_TIE_MASK;
+        }
+    }
+
+    if ((ctrl & LPUART_CTRL_ILIE_MASK) && (stat & (LPUART_STAT_IDLE_MASK | LPUART_STAT_OR_MASK)))
+    {
+        base->STAT = (stat & ~LPUART_STAT_W1C_MASK) | (stat & (LPUART_STAT_IDLE_MASK | LPUART_STAT_OR_MASK));
+
+        if (usart->rx_busy)
+        {
+            if (stat & LPUART_STAT_IDLE_MASK) event |= ARM_USART_EVENT_RX_TIMEOUT;
+            if (stat & LPUART_STAT_OR_MASK)   event |= ARM_USART_EVENT_RX_OVERFLOW;
+        }
+    }
+
+    if ((event != 0U) && (usart->cb_event != NULL))
+    {
+        usart->cb_event(event);
+    }
+}
+
+/* Installed by Initialize: the instance is known, no base check */
+static void usart_isr(void)
+{
+    USART_IRQHandler(&uart_instance);
+}
+
 void LPUART0_RxTx_IRQHandler(void)
 {
-    uart_instance.cb;
+    if (uart_instance.base == IP_LPUART0)
+    {
+        USART_IRQHandler(&uart_instance);
+    }
 }
 void LPUART1_RxTx_IRQHandler(void)
 {
-    uart_instance.cb;
+    if (uart_instance.base == IP_LPUART1)
+    {
+        USART_IRQHandler(&uart_instance);
+    }
 }
 void LPUART2_RxTx_IRQHandler(void)
 {
-    uart_instance.cb;
+    if (uart_instance.base == IP_LPUART2)
+    {
+        USART_IRQHandler(&uart_instance);
+    }
 }
 
+/**
+ * @brief Receive DMA major/half loop interrupt
+ *
+ * Serves channel 0 only, the dma_ch of uart_instance; another channel needs
+ * its own DMAn_IRQHandler. In ping-pong mode both the half and the major
+ * loop raise RECEIVE_COMPLETE: GetRxCount() tells them apart (see
+ * driver_usart.h).
+ */
+void DMA0_IRQHandler(void)
+{
+    usart_resources_t *usart = &uart_instance;
+
+    IP_DMA->CINT = usart->dma_ch;
 
+    if (usart->rx_mode == ARM_USART_RX_DMA_SINGLE)
+    {
+        /* CITER has already been reloaded from BITER: the whole buffer is filled */
+        USART_StopReceiveDMA(usart);
+        usart->rx_cnt = usart->rx_num;
+    }
 
+    if (usart->cb_event != NULL)
+    {
+        usart->cb_event(ARM_USART_EVENT_RECEIVE_COMPLETE);
+    }
+}
@@ -0,0 +1,1774 @@
+/**
+ * @file    host_sim.c
+ * @brief   Host-side S32K144 peripheral model.
+ * @details Only compiled with -DHOST_SIM; empty for the target build. See host_sim.h.
+ */
+#ifdef HOST_SIM
+
+#define _GNU_SOURCE
+#include "host_sim.h"
+#include <signal.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#if !defined(__linux__) || !defined(__x86_64__)
+#error "host_sim needs Linux on x86-64 (page traps and single-stepping)"
+#endif
+
+#define SIM_PERIPH_BASE     0x40000000UL
+#define SIM_PERIPH_SIZE     0x00100000UL
+#define SIM_SRAM_BASE       0x1FFF8000UL
+#define SIM_SRAM_SIZE       0x00010000UL
+#define SIM_PAGE_SIZE       0x1000UL
+#define SIM_PAGE(a)         ((uintptr_t)(a) & ~(SIM_PAGE_SIZE - 1U))
+#define SIM_IN_WINDOW(a)    (((uintptr_t)(a) - SIM_PERIPH_BASE) < SIM_PERIPH_SIZE)
+
+#define SIM_GPIO_STRIDE     0x40UL   /* PTA..PTE register blocks */
+#define SIM_IRQ_COUNT       128U
+#define SIM_EFLAGS_TF       0x100
+#define SIM_WIRE_SIZE       4096U
+#define SIM_RX_QUEUE_SIZE   4096U
+
+#define SIM_SOSC_HZ         8000000ULL
+#define SIM_SIRC_HZ         8000000ULL
+#define SIM_FIRC_HZ         48000000ULL
+#define SIM_SOSC_STARTUP_NS 1000000ULL
+#define SIM_SPLL_LOCK_NS    200000ULL
+#define SIM_ADC_CAL_NS      100000ULL
+#define SIM_NEVER           UINT64_MAX
+
+/* Always-writable view of a register (also drops __I const) */
+#define REG(p)              (*(volatile uint32_t *)&(p))
+/* Model-side alias of a peripheral pointer: never traps */
+#define ALIAS(p)            ((__typeof__(p))(void *)(s_alias + ((uintptr_t)(p) - SIM_PERIPH_BASE)))
+
+/* LPUART STAT flags that are cleared by writing 1 */
+#define SIM_LPUART_STAT_W1C (LPUART_STAT_LBKDIF_MASK | LPUART_STAT_RXEDGIF_MASK | LPUART_STAT_IDLE_MASK | \
+                             LPUART_STAT_OR_MASK | LPUART_STAT_NF_MASK | LPUART_STAT_FE_MASK | \
+                             LPUART_STAT_PF_MASK | LPUART_STAT_MA1F_MASK | LPUART_STAT_MA2F_MASK)
+#define SIM_LPUART_STAT_RO  (LPUART_STAT_TDRE_MASK | LPUART_STAT_TC_MASK | LPUART_STAT_RDRF_MASK | LPUART_STAT_RAF_MASK)
+
+/* ======================== Instance tables =======================*/
+static GPIO_Type * const s_gpio[5]   = { IP_PTA, IP_PTB, IP_PTC, IP_PTD, IP_PTE };
+static PORT_Type * const s_port[5]   = { IP_PORTA, IP_PORTB, IP_PORTC, IP_PORTD, IP_PORTE };
+static const IRQn_Type   s_port_irq[5] = { PORTA_IRQn, PORTB_IRQn, PORTC_IRQn, PORTD_IRQn, PORTE_IRQn };
+
+static LPUART_Type * const s_lpuart[3] = { IP_LPUART0, IP_LPUART1, IP_LPUART2 };
+static const IRQn_Type     s_lpuart_irq[3] = { LPUART0_RxTx_IRQn, LPUART1_RxTx_IRQn, LPUART2_RxTx_IRQn };
+static const uint32_t      s_lpuart_pcc[3] = { PCC_LPUART0_INDEX, PCC_LPUART1_INDEX, PCC_LPUART2_INDEX };
+/* DMAMUX sources: EDMA_REQ_LPUARTn_RX / _TX */
+static const uint8_t       s_lpuart_rx_req[3] = { 2U, 4U, 6U };
+static const uint8_t       s_lpuart_tx_req[3] = { 3U, 5U, 7U };
+#define SIM_REQ_ADC0        42U     /* EDMA_REQ_ADC0 */
+
+/* ======================== Model state =======================*/
+typedef struct {
+    bool     tx_full;               /* transmit data buffer holds a byte */
+    uint8_t  tx_data;
+    bool     shift_busy;            /* transmit shifter is sending shift_data */
+    uint8_t  shift_data;
+    uint64_t shift_end;
+    uint8_t  wire[SIM_WIRE_SIZE];   /* bytes that left the TX pin */
+    uint32_t wire_head;
+    uint32_t wire_tail;
+    uint8_t  rx_q[SIM_RX_QUEUE_SIZE];
+    uint64_t rx_end[SIM_RX_QUEUE_SIZE];
+    uint32_t rx_head;
+    uint32_t rx_tail;
+    uint64_t rx_line_free;          /* end of the last scheduled RX frame */
+    bool     rx_full;               /* receive data buffer holds a byte (RDRF) */
+    bool     idle_armed;
+    uint64_t idle_at;
+} sim_lpuart_t;
+
+typedef struct {
+    bool     running;
+    uint64_t next_expiry;           /* time-based channels */
+    uint64_t period_ns;
+    uint32_t count;                 /* chained channels: remaining expiries of ch-1 */
+    uint64_t left;                  /* ticks to expiry while the LPIT clock is off */
+} sim_lpit_ch_t;
+
+typedef struct {
+    bool     busy;
+    uint64_t done_at;
+    uint32_t channel;
+    uint32_t slot;                  /* SC1[n] / R[n] of the conversion */
+    bool     hw;                    /* started by a PDB pre-trigger */
+    uint32_t conversions;           /* completed, compare passed or not */
+    bool     cal_busy;
+    uint64_t cal_done_at;
+    uint16_t input[32];
+} sim_adc_t;
+
+typedef struct {
+    bool     running;               /* counter started by a trigger */
+    uint64_t cycle_start;
+    bool     pre_pending;           /* pre-trigger 0 not yet asserted this cycle */
+} sim_pdb_t;
+
+static uint8_t     *s_alias;
+static int          s_memfd = -1;
+static bool         s_ready;
+static bool         s_hooks;
+static uint64_t     s_now;
+static uint32_t     s_access_ns = 25U;
+static uint32_t     s_access_count;
+static uint32_t     s_sram_used;
+
+static uint32_t     s_pin_in[5];
+static uint32_t     s_pin_level[5];
+static sim_lpuart_t s_uart[3];
+static sim_lpit_ch_t s_lpit[LPIT_TMR_COUNT];
+static uint64_t     s_lpit_hz;      /* functional clock the expiry times were computed with */
+static sim_adc_t    s_adc;
+static uint32_t     s_adc_conv_ns = 4000U;
+static sim_pdb_t    s_pdb;
+static bool         s_sosc_present = true;
+static uint64_t     s_sosc_valid_at = SIM_NEVER;
+static uint64_t     s_spll_valid_at = SIM_NEVER;
+static bool         s_pmprot_written;
+
+uint32_t SystemCoreClock = SIM_FIRC_HZ;
+
+static uint8_t      s_nvic_enabled[SIM_IRQ_COUNT];
+static uint8_t      s_nvic_pending[SIM_IRQ_COUNT];   /* software pended */
+static uint8_t      s_irq_line[SIM_IRQ_COUNT];       /* peripheral request levels */
+static uint8_t      s_nvic_prio[SIM_IRQ_COUNT];
+static bool         s_primask;
+static bool         s_in_isr;
+
+static struct {
+    bool      active;
+    bool      write;
+    uintptr_t addr;
+    uint32_t  old;                  /* aligned word at addr before the access */
+} s_access;
+
+/* ======================== Vector table =======================*/
+#define SIM_HANDLER(name)   void name(void) __attribute__((weak));
+SIM_HANDLER(DMA0_IRQHandler)  SIM_HANDLER(DMA1_IRQHandler)  SIM_HANDLER(DMA2_IRQHandler)  SIM_HANDLER(DMA3_IRQHandler)
+SIM_HANDLER(DMA4_IRQHandler)  SIM_HANDLER(DMA5_IRQHandler)  SIM_HANDLER(DMA6_IRQHandler)  SIM_HANDLER(DMA7_IRQHandler)
+SIM_HANDLER(DMA8_IRQHandler)  SIM_HANDLER(DMA9_IRQHandler)  SIM_HANDLER(DMA10_IRQHandler) SIM_HANDLER(DMA11_IRQHandler)
+SIM_HANDLER(DMA12_IRQHandler) SIM_HANDLER(DMA13_IRQHandler) SIM_HANDLER(DMA14_IRQHandler) SIM_HANDLER(DMA15_IRQHandler)
+SIM_HANDLER(LPUART0_RxTx_IRQHandler) SIM_HANDLER(LPUART1_RxTx_IRQHandler) SIM_HANDLER(LPUART2_RxTx_IRQHandler)
+SIM_HANDLER(ADC0_IRQHandler)
+SIM_HANDLER(LPIT0_Ch0_IRQHandler) SIM_HANDLER(LPIT0_Ch1_IRQHandler) SIM_HANDLER(LPIT0_Ch2_IRQHandler) SIM_HANDLER(LPIT0_Ch3_IRQHandler)
+SIM_HANDLER(PORTA_IRQHandler) SIM_HANDLER(PORTB_IRQHandler) SIM_HANDLER(PORTC_IRQHandler)
+SIM_HANDLER(PORTD_IRQHandler) SIM_HANDLER(PORTE_IRQHandler)
+
+/* s_vectors stands for the RAM vector table, s_vector_defaults for the flash one */
+static void (*s_vectors[SIM_IRQ_COUNT])(void);
+static void (*s_vector_defaults[SIM_IRQ_COUNT])(void);
+
+static void sim_init_vectors(void)
+{
+    s_vectors[DMA0_IRQn]  = DMA0_IRQHandler;  s_vectors[DMA1_IRQn]  = DMA1_IRQHandler;
+    s_vectors[DMA2_IRQn]  = DMA2_IRQHandler;  s_vectors[DMA3_IRQn]  = DMA3_IRQHandler;
+    s_vectors[DMA4_IRQn]  = DMA4_IRQHandler;  s_vectors[DMA5_IRQn]  = DMA5_IRQHandler;
+    s_vectors[DMA6_IRQn]  = DMA6_IRQHandler;  s_vectors[DMA7_IRQn]  = DMA7_IRQHandler;
+    s_vectors[DMA8_IRQn]  = DMA8_IRQHandler;  s_vectors[DMA9_IRQn]  = DMA9_IRQHandler;
+    s_vectors[DMA10_IRQn] = DMA10_IRQHandler; s_vectors[DMA11_IRQn] = DMA11_IRQHandler;
+    s_vectors[DMA12_IRQn] = DMA12_IRQHandler; s_vectors[DMA13_IRQn] = DMA13_IRQHandler;
+    s_vectors[DMA14_IRQn] = DMA14_IRQHandler; s_vectors[DMA15_IRQn] = DMA15_IRQHandler;
+    s_vectors[LPUART0_RxTx_IRQn] = LPUART0_RxTx_IRQHandler;
+    s_vectors[LPUART1_RxTx_IRQn] = LPUART1_RxTx_IRQHandler;
+    s_vectors[LPUART2_RxTx_IRQn] = LPUART2_RxTx_IRQHandler;
+    s_vectors[ADC0_IRQn] = ADC0_IRQHandler;
+    s_vectors[LPIT0_Ch0_IRQn] = LPIT0_Ch0_IRQHandler; s_vectors[LPIT0_Ch1_IRQn] = LPIT0_Ch1_IRQHandler;
+    s_vectors[LPIT0_Ch2_IRQn] = LPIT0_Ch2_IRQHandler; s_vectors[LPIT0_Ch3_IRQn] = LPIT0_Ch3_IRQHandler;
+    s_vectors[PORTA_IRQn] = PORTA_IRQHandler; s_vectors[PORTB_IRQn] = PORTB_IRQHandler;
+    s_vectors[PORTC_IRQn] = PORTC_IRQHandler; s_vectors[PORTD_IRQn] = PORTD_IRQHandler;
+    s_vectors[PORTE_IRQn] = PORTE_IRQHandler;
+    memcpy(s_vector_defaults, s_vectors, sizeof(s_vectors));
+}
+
+/* Pages whose registers have side effects */
+static uintptr_t s_hook_pages[20];
+static uint32_t  s_hook_page_count;
+
+/* ======================== Clocks =======================*/
+/* DIV1/DIV2 field: 0 = disabled, n = divide by 2^(n-1) */
+static uint64_t sim_div(uint64_t hz, uint32_t field)
+{
+    return (field == 0U) ? 0U : (hz >> (field - 1U));
+}
+
+/* Functional clock of a peripheral from its PCC PCS (DIV2 outputs) */
+static uint64_t sim_pcc_clock(uint32_t pcc_index)
+{
+    SCG_Type *scg = ALIAS(IP_SCG);
+    uint32_t pccn = ALIAS(IP_PCC)->PCCn[pcc_index];
+
+    if ((pccn & PCC_PCCn_CGC_MASK) == 0U) {
+        return 0U;
+    }
+
+    switch ((pccn & PCC_PCCn_PCS_MASK) >> PCC_PCCn_PCS_SHIFT)
+    {
+        case 1U:
+            return (scg->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK) ? sim_div(SIM_SOSC_HZ, (scg->SOSCDIV >> 8) & 7U) : 0U;
+        case 2U:
+            return (scg->SIRCCSR & SCG_SIRCCSR_SIRCVLD_MASK) ? sim_div(SIM_SIRC_HZ, (scg->SIRCDIV >> 8) & 7U) : 0U;
+        case 3U:
+            return (scg->FIRCCSR & SCG_FIRCCSR_FIRCVLD_MASK) ? sim_div(SIM_FIRC_HZ, (scg->FIRCDIV >> 8) & 7U) : 0U;
+        case 6U:
+            if (scg->SPLLCSR & SCG_SPLLCSR_SPLLVLD_MASK)
+            {
+                uint64_t prediv = ((scg->SPLLCFG & SCG_SPLLCFG_PREDIV_MASK) >> SCG_SPLLCFG_PREDIV_SHIFT) + 1U;
+                uint64_t mult   = ((scg->SPLLCFG & SCG_SPLLCFG_MULT_MASK) >> SCG_SPLLCFG_MULT_SHIFT) + 16U;
+                return sim_div(SIM_SOSC_HZ / prediv * mult / 2U, (scg->SPLLDIV >> 8) & 7U);
+            }
+            return 0U;
+        default:
+            return 0U;
+    }
+}
+
+static uint64_t sim_ticks_to_ns(uint64_t ticks, uint64_t hz)
+{
+    return (hz == 0U) ? SIM_NEVER : ((ticks * 1000000000ULL) + (hz / 2U)) / hz;
+}
+
+/* ======================== Bus access (used by DMA) =======================*/
+static void sim_periph_read(uintptr_t addr);
+static void sim_periph_write(uintptr_t addr, uint32_t old);
+
+static uint32_t sim_bus_read(uint32_t addr, uint32_t size)
+{
+    uint32_t val = 0U;
+    uint8_t *p = SIM_IN_WINDOW(addr) ? (s_alias + (addr - SIM_PERIPH_BASE)) : (uint8_t *)(uintptr_t)addr;
+
+    memcpy(&val, p, size);
+    if (SIM_IN_WINDOW(addr)) {
+        sim_periph_read(addr);
+    }
+    return val;
+}
+
+static void sim_bus_write(uint32_t addr, uint32_t val, uint32_t size)
+{
+    if (SIM_IN_WINDOW(addr))
+    {
+        uint32_t old = *(uint32_t *)(void *)(s_alias + ((addr & ~3U) - SIM_PERIPH_BASE));
+        memcpy(s_alias + (addr - SIM_PERIPH_BASE), &val, size);
+        sim_periph_write(addr, old);
+    }
+    else
+    {
+        memcpy((void *)(uintptr_t)addr, &val, size);
+    }
+}
+
+/* ======================== eDMA =======================*/
+static void sim_dma_minor_loop(uint32_t ch)
+{
+    DMA_Type *dma = ALIAS(IP_DMA);
+    uint32_t ssize = 1U << ((dma->TCD[ch].ATTR & DMA_TCD_ATTR_SSIZE_MASK) >> DMA_TCD_ATTR_SSIZE_SHIFT);
+    uint32_t dsize = 1U << ((dma->TCD[ch].ATTR & DMA_TCD_ATTR_DSIZE_MASK) >> DMA_TCD_ATTR_DSIZE_SHIFT);
+    uint32_t nbytes = dma->TCD[ch].NBYTES.MLNO;
+    uint16_t citer;
+    uint16_t biter;
+
+    for (uint32_t n = 0U; n < nbytes; n += ssize)
+    {
+        uint32_t val = sim_bus_read(dma->TCD[ch].SADDR, ssize);
+        sim_bus_write(dma->TCD[ch].DADDR, val, (dsize < ssize) ? dsize : ssize);
+        dma->TCD[ch].SADDR += (uint32_t)(int32_t)(int16_t)dma->TCD[ch].SOFF;
+        dma->TCD[ch].DADDR += (uint32_t)(int32_t)(int16_t)dma->TCD[ch].DOFF;
+    }
+
+    citer = (uint16_t)((dma->TCD[ch].CITER.ELINKNO & DMA_TCD_CITER_ELINKNO_CITER_MASK) - 1U);
+    biter = dma->TCD[ch].BITER.ELINKNO & DMA_TCD_BITER_ELINKNO_BITER_MASK;
+
+    if (citer == 0U)
+    {
+        uint16_t csr = dma->TCD[ch].CSR;
+
+        dma->TCD[ch].SADDR += dma->TCD[ch].SLAST;
+        if (csr & DMA_TCD_CSR_INTMAJOR_MASK) {
+            dma->INT |= (1UL << ch);
+        }
+        if (csr & DMA_TCD_CSR_DREQ_MASK) {
+            dma->ERQ &= ~(1UL << ch);
+        }
+        if (csr & DMA_TCD_CSR_ESG_MASK)
+        {
+            /* Scatter/gather: load the next TCD image from DLASTSGA */
+            memcpy((void *)&dma->TCD[ch], (const void *)(uintptr_t)dma->TCD[ch].DLASTSGA, 32U);
+        }
+        else
+        {
+            dma->TCD[ch].DADDR += dma->TCD[ch].DLASTSGA;
+            dma->TCD[ch].CITER.ELINKNO = biter;
+        }
+        dma->TCD[ch].CSR |= DMA_TCD_CSR_DONE_MASK;
+    }
+    else
+    {
+        dma->TCD[ch].CITER.ELINKNO = citer;
+        if ((dma->TCD[ch].CSR & DMA_TCD_CSR_INTHALF_MASK) && (citer == (biter / 2U))) {
+            dma->INT |= (1UL << ch);
+        }
+    }
+}
+
+/* Serve a peripheral request; false if no enabled channel takes it */
+static bool sim_dma_request(uint8_t source)
+{
+    DMA_Type *dma = ALIAS(IP_DMA);
+    DMAMUX_Type *mux = ALIAS(IP_DMAMUX);
+
+    for (uint32_t ch = 0U; ch < DMA_TCD_COUNT; ch++)
+    {
+        if ((mux->CHCFG[ch] == (DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(source))) && (dma->ERQ & (1UL << ch)))
+        {
+            sim_dma_minor_loop(ch);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sim_dma_write(uintptr_t addr, uint32_t old)
+{
+    DMA_Type *dma = ALIAS(IP_DMA);
+    uintptr_t off = addr - (uintptr_t)IP_DMA;
+    uint8_t v = s_alias[addr - SIM_PERIPH_BASE];
+
+    switch (off)
+    {
+        case offsetof(DMA_Type, CERQ):
+            dma->ERQ = (v & 0x40U) ? 0U : (dma->ERQ & ~(1UL << (v & 0xFU)));
+            break;
+        case offsetof(DMA_Type, SERQ):
+            dma->ERQ = (v & 0x40U) ? 0xFFFFU : (dma->ERQ | (1UL << (v & 0xFU)));
+            break;
+        case offsetof(DMA_Type, CINT):
+            dma->INT = (v & 0x40U) ? 0U : (dma->INT & ~(1UL << (v & 0xFU)));
+            break;
+        case offsetof(DMA_Type, CDNE):
+            dma->TCD[v & 0xFU].CSR &= (uint16_t)~DMA_TCD_CSR_DONE_MASK;
+            break;
+        case offsetof(DMA_Type, SSRT):
+            sim_dma_minor_loop(v & 0xFU);
+            break;
+        case offsetof(DMA_Type, INT):
+            dma->INT = old & ~dma->INT;
+            return;
+        case offsetof(DMA_Type, ERR):
+            dma->ERR = old & ~dma->ERR;
+            return;
+        default:
+            return;
+    }
+    /* The byte-wide command registers read as zero */
+    s_alias[addr - SIM_PERIPH_BASE] = 0U;
+}
+
+/* ======================== GPIO / PORT =======================*/
+static void sim_port_flag(uint32_t n, uint32_t pin)
+{
+    PORT_Type *port = ALIAS(s_port[n]);
+
+    port->ISFR |= (1UL << pin);
+    port->PCR[pin] |= PORT_PCR_ISF_MASK;
+}
+
+/* Recompute pin levels and latch PORT interrupt flags on edges/levels */
+static void sim_gpio_update(uint32_t n)
+{
+    GPIO_Type *gpio = ALIAS(s_gpio[n]);
+    PORT_Type *port = ALIAS(s_port[n]);
+    uint32_t level = (gpio->PDOR & gpio->PDDR) | (s_pin_in[n] & ~gpio->PDDR);
+    uint32_t changed = level ^ s_pin_level[n];
+
+    s_pin_level[n] = level;
+    REG(gpio->PDIR) = level & ~gpio->PIDR;
+
+    for (uint32_t pin = 0U; pin < 32U; pin++)
+    {
+        uint32_t irqc = (port->PCR[pin] & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT;
+        uint32_t bit = 1UL << pin;
+        bool rising = (changed & bit) && (level & bit);
+        bool falling = (changed & bit) && !(level & bit);
+
+        if (((irqc == 9U) && rising) || ((irqc == 10U) && falling) || ((irqc == 11U) && (changed & bit)) ||
+            ((irqc == 8U) && !(level & bit)) || ((irqc == 12U) && (level & bit)))
+        {
+            sim_port_flag(n, pin);
+        }
+    }
+}
+
+static void sim_gpio_write(uintptr_t addr, uint32_t old)
+{
+    uint32_t n = (uint32_t)((addr - (uintptr_t)IP_PTA) / SIM_GPIO_STRIDE);
+    GPIO_Type *gpio;
+
+    if (n >= 5U) {
+        return;
+    }
+    gpio = ALIAS(s_gpio[n]);
+
+    switch ((addr & ~3U) - (uintptr_t)s_gpio[n])
+    {
+        case offsetof(GPIO_Type, PSOR): gpio->PDOR |= gpio->PSOR;  REG(gpio->PSOR) = 0U; break;
+        case offsetof(GPIO_Type, PCOR): gpio->PDOR &= ~gpio->PCOR; REG(gpio->PCOR) = 0U; break;
+        case offsetof(GPIO_Type, PTOR): gpio->PDOR ^= gpio->PTOR;  REG(gpio->PTOR) = 0U; break;
+        case offsetof(GPIO_Type, PDIR): REG(gpio->PDIR) = old; break;
+        default: break;
+    }
+    sim_gpio_update(n);
+}
+
+static void sim_port_write(uintptr_t addr, uint32_t old)
+{
+    uint32_t n = (uint32_t)((SIM_PAGE(addr) - (uintptr_t)IP_PORTA) / SIM_PAGE_SIZE);
+    PORT_Type *port = ALIAS(s_port[n]);
+    uintptr_t off = (addr & ~3U) - (uintptr_t)s_port[n];
+    uint32_t val = *(uint32_t *)(void *)(s_alias + ((addr & ~3U) - SIM_PERIPH_BASE));
+
+    if (off < sizeof(port->PCR))
+    {
+        uint32_t pin = (uint32_t)(off / 4U);
+        /* ISF is W1C, the rest is plain R/W */
+        if (val & PORT_PCR_ISF_MASK) {
+            port->ISFR &= ~(1UL << pin);
+        }
+        port->PCR[pin] = (val & ~PORT_PCR_ISF_MASK) | ((port->ISFR & (1UL << pin)) ? PORT_PCR_ISF_MASK : 0U);
+    }
+    else if ((off == offsetof(PORT_Type, GPCLR)) || (off == offsetof(PORT_Type, GPCHR)) ||
+             (off == offsetof(PORT_Type, GICLR)) || (off == offsetof(PORT_Type, GICHR)))
+    {
+        uint32_t first = ((off == offsetof(PORT_Type, GPCHR)) || (off == offsetof(PORT_Type, GICHR))) ? 16U : 0U;
+        uint32_t keep = ((off == offsetof(PORT_Type, GPCLR)) || (off == offsetof(PORT_Type, GPCHR))) ? 0xFFFF0000UL : 0x0000FFFFUL;
+        uint32_t data = (keep == 0xFFFF0000UL) ? (val & 0xFFFFU) : (val << 16);
+
+        for (uint32_t i = 0U; i < 16U; i++)
+        {
+            if (val & (1UL << (16U + i))) {
+                port->PCR[first + i] = (port->PCR[first + i] & keep) | (data & ~keep & ~PORT_PCR_ISF_MASK);
+            }
+        }
+        REG(port->GPCLR) = 0U; REG(port->GPCHR) = 0U; REG(port->GICLR) = 0U; REG(port->GICHR) = 0U;
+    }
+    else if (off == offsetof(PORT_Type, ISFR))
+    {
+        port->ISFR = old & ~val;
+        for (uint32_t pin = 0U; pin < 32U; pin++)
+        {
+            if (!(port->ISFR & (1UL << pin))) {
+                port->PCR[pin] &= ~PORT_PCR_ISF_MASK;
+            }
+        }
+    }
+    sim_gpio_update(n);
+}
+
+static bool sim_port_irq_line(uint32_t n)
+{
+    PORT_Type *port = ALIAS(s_port[n]);
+
+    for (uint32_t pin = 0U; pin < 32U; pin++)
+    {
+        uint32_t irqc = (port->PCR[pin] & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT;
+        if ((port->ISFR & (1UL << pin)) && (irqc >= 8U) && (irqc <= 12U)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ======================== LPUART =======================*/
+static uint64_t sim_lpuart_frame_ns(uint32_t n)
+{
+    LPUART_Type *u = ALIAS(s_lpuart[n]);
+    uint64_t osr = ((u->BAUD & LPUART_BAUD_OSR_MASK) >> LPUART_BAUD_OSR_SHIFT) + 1U;
+    uint64_t sbr = u->BAUD & LPUART_BAUD_SBR_MASK;
+    /* Start + character (parity included: M7 = 7, default 8, M = 9 bits) + stop */
+    uint64_t bits = 10U - ((u->CTRL & LPUART_CTRL_M7_MASK) ? 1U : 0U) + ((u->CTRL & LPUART_CTRL_M_MASK) ? 1U : 0U) +
+                    ((u->BAUD & LPUART_BAUD_SBNS_MASK) ? 1U : 0U);
+
+    if ((osr < 4U) || (sbr == 0U)) {
+        return SIM_NEVER;
+    }
+    return sim_ticks_to_ns(bits * osr * sbr, sim_pcc_clock(s_lpuart_pcc[n]));
+}
+
+static void sim_lpuart_status(uint32_t n)
+{
+    LPUART_Type *u = ALIAS(s_lpuart[n]);
+    sim_lpuart_t *s = &s_uart[n];
+    uint32_t stat = u->STAT & ~SIM_LPUART_STAT_RO;
+
+    if (!s->tx_full)                    stat |= LPUART_STAT_TDRE_MASK;
+    if (!s->tx_full && !s->shift_busy)  stat |= LPUART_STAT_TC_MASK;
+    if (s->rx_full)                     stat |= LPUART_STAT_RDRF_MASK;
+    u->STAT = stat;
+}
+
+static void sim_lpuart_update(uint32_t n)
+{
+    LPUART_Type *u = ALIAS(s_lpuart[n]);
+    sim_lpuart_t *s = &s_uart[n];
+
+    /* Transmitter: shifter completes, buffer moves into the shifter */
+    while (s->shift_busy && (s->shift_end <= s_now))
+    {
+        s->wire[s->wire_head % SIM_WIRE_SIZE] = s->shift_data;
+        s->wire_head++;
+        s->shift_busy = false;
+        if (s->tx_full && (u->CTRL & LPUART_CTRL_TE_MASK))
+        {
+            uint64_t frame = sim_lpuart_frame_ns(n);
+            s->shift_data = s->tx_data;
+            s->tx_full = false;
+            s->shift_busy = true;
+            s->shift_end = (frame == SIM_NEVER) ? SIM_NEVER : (s->shift_end + frame);
+        }
+    }
+    if (!s->shift_busy && s->tx_full && (u->CTRL & LPUART_CTRL_TE_MASK))
+    {
+        uint64_t frame = sim_lpuart_frame_ns(n);
+        s->shift_data = s->tx_data;
+        s->tx_full = false;
+        s->shift_busy = true;
+        s->shift_end = (frame == SIM_NEVER) ? SIM_NEVER : (s_now + frame);
+    }
+    sim_lpuart_status(n);
+
+    /* TX DMA request while the data buffer is empty */
+    if ((u->BAUD & LPUART_BAUD_TDMAE_MASK) && !s->tx_full) {
+        sim_dma_request(s_lpuart_tx_req[n]);
+    }
+
+    /* Receiver: frames that have completed by now */
+    while ((s->rx_tail != s->rx_head) && (s->rx_end[s->rx_tail % SIM_RX_QUEUE_SIZE] <= s_now))
+    {
+        uint32_t i = s->rx_tail % SIM_RX_QUEUE_SIZE;
+        uint32_t idlecfg = (u->CTRL & LPUART_CTRL_IDLECFG_MASK) >> LPUART_CTRL_IDLECFG_SHIFT;
+        uint64_t frame = sim_lpuart_frame_ns(n);
+
+        s->rx_tail++;
+        if (!(u->CTRL & LPUART_CTRL_RE_MASK)) {
+            continue;
+        }
+        if (s->rx_full)
+        {
+            u->STAT |= LPUART_STAT_OR_MASK;
+        }
+        else
+        {
+            REG(u->DATA) = s->rx_q[i];
+            s->rx_full = true;
+            sim_lpuart_status(n);
+            if (u->BAUD & LPUART_BAUD_RDMAE_MASK) {
+                sim_dma_request(s_lpuart_rx_req[n]);
+            }
+        }
+        s->idle_armed = true;
+        s->idle_at = (frame == SIM_NEVER) ? SIM_NEVER : (s->rx_end[i] + (frame << idlecfg));
+    }
+
+    /* Idle line: no new start bit within IDLECFG characters */
+    if (s->idle_armed && (s->idle_at <= s_now))
+    {
+        uint64_t frame = sim_lpuart_frame_ns(n);
+        bool next_started = (s->rx_tail != s->rx_head) &&
+                            ((s->rx_end[s->rx_tail % SIM_RX_QUEUE_SIZE] - frame) < s->idle_at);
+        if (!next_started)
+        {
+            u->STAT |= LPUART_STAT_IDLE_MASK;
+        }
+        s->idle_armed = false;
+    }
+    sim_lpuart_status(n);
+}
+
+static void sim_lpuart_read(uint32_t n, uintptr_t off)
+{
+    if (off == offsetof(LPUART_Type, DATA))
+    {
+        s_uart[n].rx_full = false;
+        sim_lpuart_status(n);
+    }
+}
+
+static void sim_lpuart_write(uint32_t n, uintptr_t off, uint32_t old)
+{
+    LPUART_Type *u = ALIAS(s_lpuart[n]);
+    sim_lpuart_t *s = &s_uart[n];
+
+    switch (off)
+    {
+        case offsetof(LPUART_Type, STAT):
+            u->STAT = (u->STAT & ~(SIM_LPUART_STAT_W1C | SIM_LPUART_STAT_RO)) | ((old & SIM_LPUART_STAT_W1C) & ~u->STAT);
+            sim_lpuart_status(n);
+            break;
+        case offsetof(LPUART_Type, DATA):
+            if ((u->CTRL & LPUART_CTRL_TE_MASK) && !s->tx_full)
+            {
+                s->tx_data = (uint8_t)u->DATA;
+                s->tx_full = true;
+            }
+            /* DATA reads back the receive buffer */
+            REG(u->DATA) = old;
+            break;
+        case offsetof(LPUART_Type, VERID):
+        case offsetof(LPUART_Type, PARAM):
+            REG(*(volatile uint32_t *)(void *)((uint8_t *)u + off)) = old;
+            break;
+        default:
+            break;
+    }
+    sim_lpuart_update(n);
+}
+
+static uint64_t sim_lpuart_next_event(uint32_t n)
+{
+    sim_lpuart_t *s = &s_uart[n];
+    uint64_t next = SIM_NEVER;
+
+    if (s->shift_busy && (s->shift_end < next))                  next = s->shift_end;
+    if ((s->rx_tail != s->rx_head) && (s->rx_end[s->rx_tail % SIM_RX_QUEUE_SIZE] < next))
+                                                                 next = s->rx_end[s->rx_tail % SIM_RX_QUEUE_SIZE];
+    if (s->idle_armed && (s->idle_at < next))                    next = s->idle_at;
+    return next;
+}
+
+static bool sim_lpuart_irq_line(uint32_t n)
+{
+    LPUART_Type *u = ALIAS(s_lpuart[n]);
+    uint32_t ctrl = u->CTRL;
+    uint32_t stat = u->STAT;
+
+    return ((ctrl & LPUART_CTRL_TIE_MASK)  && (stat & LPUART_STAT_TDRE_MASK)) ||
+           ((ctrl & LPUART_CTRL_TCIE_MASK) && (stat & LPUART_STAT_TC_MASK)) ||
+           ((ctrl & LPUART_CTRL_RIE_MASK)  && (stat & LPUART_STAT_RDRF_MASK) && !(u->BAUD & LPUART_BAUD_RDMAE_MASK)) ||
+           ((ctrl & LPUART_CTRL_ILIE_MASK) && (stat & LPUART_STAT_IDLE_MASK)) ||
+           ((ctrl & LPUART_CTRL_ORIE_MASK) && (stat & LPUART_STAT_OR_MASK));
+}
+
+/* ======================== ADC0 =======================*/
+static void sim_adc_start(uint32_t slot, uint32_t ch, bool hw)
+{
+    ADC_Type *adc = ALIAS(IP_ADC0);
+    uint64_t conv = s_adc_conv_ns;
+
+    if (adc->SC3 & ADC_SC3_AVGE_MASK) {
+        conv *= 4ULL << (adc->SC3 & ADC_SC3_AVGS_MASK);
+    }
+    s_adc.busy = true;
+    s_adc.slot = slot;
+    s_adc.channel = ch;
+    s_adc.hw = hw;
+    s_adc.done_at = s_now + conv;
+}
+
+/* PDB0 pre-trigger n: convert SC1[n], or flag a sequence error if the ADC is busy */
+static void sim_adc_pretrigger(uint32_t n)
+{
+    ADC_Type *adc = ALIAS(IP_ADC0);
+    PDB_Type *pdb = ALIAS(IP_PDB0);
+
+    if (!(pdb->CH[0].C1 & PDB_C1_EN(1UL << n)) || !(adc->SC2 & ADC_SC2_ADTRG_MASK)) {
+        return;
+    }
+    if (s_adc.busy || s_adc.cal_busy) {
+        pdb->CH[0].S |= PDB_S_ERR(1UL << n);
+    } else if ((adc->SC1[n] & ADC_SC1_ADCH_MASK) != ADC_SC1_ADCH_MASK) {
+        sim_adc_start(n, adc->SC1[n] & ADC_SC1_ADCH_MASK, true);
+    }
+}
+
+/* SC2 compare function: a result that fails it is discarded (no R, no COCO) */
+static bool sim_adc_compare(uint32_t r)
+{
+    ADC_Type *adc = ALIAS(IP_ADC0);
+    uint32_t sc2 = adc->SC2;
+    uint32_t cv1 = adc->CV[0];
+    uint32_t cv2 = adc->CV[1];
+    bool gt = (sc2 & ADC_SC2_ACFGT_MASK) != 0U;
+
+    if (!(sc2 & ADC_SC2_ACFE_MASK)) {
+        return true;
+    }
+    if (!(sc2 & ADC_SC2_ACREN_MASK)) {
+        return gt ? (r >= cv1) : (r < cv1);
+    }
+    if (cv1 <= cv2) {
+        return gt ? ((r >= cv1) && (r <= cv2)) : ((r < cv1) || (r > cv2));
+    }
+    return gt ? ((r >= cv1) || (r <= cv2)) : ((r < cv1) && (r > cv2));
+}
+
+static void sim_adc_update(void)
+{
+    ADC_Type *adc = ALIAS(IP_ADC0);
+
+    if (s_adc.cal_busy && (s_adc.cal_done_at <= s_now))
+    {
+        s_adc.cal_busy = false;
+        adc->SC3 &= ~ADC_SC3_CAL_MASK;
+        adc->SC1[0] |= ADC_SC1_COCO_MASK;
+    }
+    if (s_adc.busy && (s_adc.done_at <= s_now))
+    {
+        uint32_t mode = (adc->CFG1 & ADC_CFG1_MODE_MASK) >> ADC_CFG1_MODE_SHIFT;
+        uint32_t raw = s_adc.input[s_adc.channel];
+
+        /* 12-bit model value scaled to the configured resolution */
+        raw = (mode == 0U) ? (raw >> 4) : ((mode == 2U) ? (raw >> 2) : raw);
+        s_adc.busy = false;
+        s_adc.conversions++;
+        if (sim_adc_compare(raw))
+        {
+            REG(adc->R[s_adc.slot]) = raw;
+            adc->SC1[s_adc.slot] |= ADC_SC1_COCO_MASK;
+            if (adc->SC2 & ADC_SC2_DMAEN_MASK) {
+                sim_dma_request(SIM_REQ_ADC0);
+            }
+        }
+        if (s_adc.hw)
+        {
+            uint32_t next = s_adc.slot + 1U;
+
+            ALIAS(IP_PDB0)->CH[0].S |= PDB_S_CF(1UL << s_adc.slot);
+            /* Back-to-back: the next pre-trigger follows this conversion */
+            if ((next < PDB_DLY_COUNT) && (ALIAS(IP_PDB0)->CH[0].C1 & PDB_C1_BB(1UL << next))) {
+                sim_adc_pretrigger(next);
+            }
+        }
+        else if (adc->SC3 & ADC_SC3_ADCO_MASK) {
+            sim_adc_start(0U, s_adc.channel, false);
+        }
+    }
+}
+
+static void sim_adc_read(uintptr_t off)
+{
+    ADC_Type *adc = ALIAS(IP_ADC0);
+
+    if ((off >= offsetof(ADC_Type, R)) && (off < (offsetof(ADC_Type, R) + sizeof(adc->R))))
+    {
+        adc->SC1[(off - offsetof(ADC_Type, R)) / 4U] &= ~ADC_SC1_COCO_MASK;
+    }
+}
+
+static void sim_adc_write(uintptr_t off, uint32_t old)
+{
+    ADC_Type *adc = ALIAS(IP_ADC0);
+
+    if ((off >= offsetof(ADC_Type, R)) && (off < (offsetof(ADC_Type, R) + sizeof(adc->R))))
+    {
+        REG(*(volatile uint32_t *)(void *)((uint8_t *)adc + off)) = old;
+    }
+    else if (off == offsetof(ADC_Type, SC1[0]))
+    {
+        uint32_t ch = adc->SC1[0] & ADC_SC1_ADCH_MASK;
+
+        /* COCO is read-only and cleared by the write; SC1[0] is the software trigger */
+        adc->SC1[0] &= ~ADC_SC1_COCO_MASK;
+        s_adc.busy = false;
+        if ((ch != ADC_SC1_ADCH_MASK) && !(adc->SC2 & ADC_SC2_ADTRG_MASK)) {
+            sim_adc_start(0U, ch, false);
+        }
+    }
+    else if (off == offsetof(ADC_Type, SC3))
+    {
+        if ((adc->SC3 & ADC_SC3_CAL_MASK) && !(old & ADC_SC3_CAL_MASK))
+        {
+            s_adc.cal_busy = true;
+            s_adc.cal_done_at = s_now + SIM_ADC_CAL_NS;
+        }
+    }
+    sim_adc_update();
+}
+
+/* ======================== PDB0 =======================*/
+/* SYS_CLK: the running system clock source divided by DIVCORE */
+static uint64_t sim_sys_clock(void)
+{
+    SCG_Type *scg = ALIAS(IP_SCG);
+    uint32_t csr = scg->CSR;
+    uint64_t hz;
+
+    switch ((csr & SCG_CSR_SCS_MASK) >> SCG_CSR_SCS_SHIFT)
+    {
+        case 1U: hz = SIM_SOSC_HZ; break;
+        case 2U: hz = SIM_SIRC_HZ; break;
+        case 3U: hz = SIM_FIRC_HZ; break;
+        case 6U:
+        {
+            uint64_t prediv = ((scg->SPLLCFG & SCG_SPLLCFG_PREDIV_MASK) >> SCG_SPLLCFG_PREDIV_SHIFT) + 1U;
+            uint64_t mult   = ((scg->SPLLCFG & SCG_SPLLCFG_MULT_MASK) >> SCG_SPLLCFG_MULT_SHIFT) + 16U;
+            hz = SIM_SOSC_HZ / prediv * mult / 2U;
+            break;
+        }
+        default: return 0U;
+    }
+    return hz / (((csr & SCG_CSR_DIVCORE_MASK) >> SCG_CSR_DIVCORE_SHIFT) + 1U);
+}
+
+/* PDB counter clocks: PRESCALER (2^n) times MULT (1, 10, 20, 40) */
+static uint64_t sim_pdb_ns(uint64_t counts)
+{
+    static const uint32_t mult[4] = { 1U, 10U, 20U, 40U };
+    uint32_t sc = ALIAS(IP_PDB0)->SC;
+    uint64_t div = (1ULL << ((sc & PDB_SC_PRESCALER_MASK) >> PDB_SC_PRESCALER_SHIFT)) *
+                   mult[(sc & PDB_SC_MULT_MASK) >> PDB_SC_MULT_SHIFT];
+
+    return sim_ticks_to_ns(counts * div, sim_sys_clock());
+}
+
+/* Only pre-trigger 0 is timed (DLY[0], or at once with TOS clear); the others
+ * follow it back-to-back */
+static uint64_t sim_pdb_pretrigger_at(void)
+{
+    PDB_Type *pdb = ALIAS(IP_PDB0);
+
+    return s_pdb.cycle_start + ((pdb->CH[0].C1 & PDB_C1_TOS(1U)) ? sim_pdb_ns(pdb->CH[0].DLY[0]) : 0U);
+}
+
+/* CNT, refreshed before every access like the LPIT CVALs */
+static void sim_pdb_count(void)
+{
+    PDB_Type *pdb = ALIAS(IP_PDB0);
+    uint64_t per_ms = sim_pdb_ns(1000000U);     /* ns per 10^6 counts, for resolution */
+    uint64_t cnt = 0U;
+
+    if (s_pdb.running && (per_ms != 0U) && (per_ms != SIM_NEVER)) {
+        cnt = ((s_now - s_pdb.cycle_start) * 1000000U) / per_ms;
+    }
+    REG(pdb->CNT) = (cnt > pdb->MOD) ? pdb->MOD : (uint32_t)cnt;
+}
+
+static void sim_pdb_update(void)
+{
+    PDB_Type *pdb = ALIAS(IP_PDB0);
+
+    if (!s_pdb.running || !(pdb->SC & PDB_SC_PDBEN_MASK)) {
+        s_pdb.running = false;
+        sim_pdb_count();
+        return;
+    }
+    for (uint32_t guard = 0U; guard < 1000U; guard++)
+    {
+        uint64_t period = sim_pdb_ns((uint64_t)pdb->MOD + 1U);
+
+        if (s_pdb.pre_pending && (sim_pdb_pretrigger_at() <= s_now))
+        {
+            s_pdb.pre_pending = false;
+            sim_adc_pretrigger(0U);
+            continue;
+        }
+        if (!(pdb->SC & PDB_SC_CONT_MASK)) {
+            s_pdb.running = s_pdb.pre_pending;
+            break;
+        }
+        if ((s_pdb.cycle_start + period) > s_now) {
+            break;
+        }
+        s_pdb.cycle_start += period;
+        s_pdb.pre_pending = true;
+    }
+    sim_pdb_count();
+}
+
+static uint64_t sim_pdb_next_event(void)
+{
+    PDB_Type *pdb = ALIAS(IP_PDB0);
+
+    if (!s_pdb.running) {
+        return SIM_NEVER;
+    }
+    if (s_pdb.pre_pending) {
+        return sim_pdb_pretrigger_at();
+    }
+    return (pdb->SC & PDB_SC_CONT_MASK) ? (s_pdb.cycle_start + sim_pdb_ns((uint64_t)pdb->MOD + 1U)) : SIM_NEVER;
+}
+
+static void sim_pdb_write(uintptr_t off, uint32_t old)
+{
+    PDB_Type *pdb = ALIAS(IP_PDB0);
+
+    if (off == offsetof(PDB_Type, SC))
+    {
+        /* LDOK and SWTRIG read back as 0; MOD/DLY take effect at once */
+        if ((pdb->SC & PDB_SC_SWTRIG_MASK) && (pdb->SC & PDB_SC_PDBEN_MASK) &&
+            (((pdb->SC & PDB_SC_TRGSEL_MASK) >> PDB_SC_TRGSEL_SHIFT) == 15U))
+        {
+            s_pdb.running = true;
+            s_pdb.cycle_start = s_now;
+            s_pdb.pre_pending = true;
+        }
+        pdb->SC &= ~(PDB_SC_SWTRIG_MASK | PDB_SC_LDOK_MASK);
+        if (!(pdb->SC & PDB_SC_PDBEN_MASK)) {
+            s_pdb.running = false;
+        }
+    }
+    else if (off == offsetof(PDB_Type, CNT))
+    {
+        REG(pdb->CNT) = old;
+    }
+    else if ((off == offsetof(PDB_Type, CH[0].S)) || (off == offsetof(PDB_Type, CH[1].S)))
+    {
+        /* ERR and CF are cleared by writing 0 */
+        *(volatile uint32_t *)(void *)((uint8_t *)pdb + off) &= old;
+    }
+    sim_pdb_update();
+}
+
+/* ======================== LPIT0 =======================*/
+static void sim_lpit_expire(uint32_t ch);
+
+static void sim_lpit_start(uint32_t ch)
+{
+    LPIT_Type *lpit = ALIAS(IP_LPIT0);
+
+    s_lpit[ch].running = true;
+    s_lpit[ch].count = lpit->TMR[ch].TVAL;
+    s_lpit[ch].left = (uint64_t)lpit->TMR[ch].TVAL + 1U;
+    s_lpit[ch].period_ns = sim_ticks_to_ns((uint64_t)lpit->TMR[ch].TVAL + 1U, sim_pcc_clock(PCC_LPIT_INDEX));
+    s_lpit[ch].next_expiry = (s_lpit[ch].period_ns == SIM_NEVER) ? SIM_NEVER : (s_now + s_lpit[ch].period_ns);
+}
+
+static bool sim_lpit_chained(uint32_t ch)
+{
+    return (ch > 0U) && (ALIAS(IP_LPIT0)->TMR[ch].TCTRL & LPIT_TMR_TCTRL_CHAIN_MASK);
+}
+
+static void sim_lpit_expire(uint32_t ch)
+{
+    LPIT_Type *lpit = ALIAS(IP_LPIT0);
+
+    lpit->MSR |= (1UL << ch);
+    /* A chained channel n counts expiries of channel n-1 */
+    if ((ch + 1U < LPIT_TMR_COUNT) && s_lpit[ch + 1U].running && sim_lpit_chained(ch + 1U))
+    {
+        if (s_lpit[ch + 1U].count == 0U)
+        {
+            s_lpit[ch + 1U].count = lpit->TMR[ch + 1U].TVAL;
+            sim_lpit_expire(ch + 1U);
+        }
+        else
+        {
+            s_lpit[ch + 1U].count--;
+        }
+    }
+}
+
+/* The functional clock changed: counters keep their count, at the new rate */
+static void sim_lpit_rescale(uint64_t old_hz, uint64_t hz)
+{
+    for (uint32_t ch = 0U; ch < LPIT_TMR_COUNT; ch++)
+    {
+        uint64_t ticks = s_lpit[ch].left;
+
+        if (!s_lpit[ch].running || sim_lpit_chained(ch)) {
+            continue;
+        }
+        if ((old_hz != 0U) && (s_lpit[ch].next_expiry != SIM_NEVER)) {
+            ticks = (s_lpit[ch].next_expiry > s_now) ?
+                    (((s_lpit[ch].next_expiry - s_now) * old_hz) / 1000000000ULL) : 0U;
+        }
+        s_lpit[ch].left = ticks;
+        s_lpit[ch].next_expiry = (hz == 0U) ? SIM_NEVER : (s_now + sim_ticks_to_ns(ticks, hz));
+    }
+}
+
+static void sim_lpit_update(void)
+{
+    LPIT_Type *lpit = ALIAS(IP_LPIT0);
+    uint64_t hz = sim_pcc_clock(PCC_LPIT_INDEX);
+
+    if (hz != s_lpit_hz) {
+        sim_lpit_rescale(s_lpit_hz, hz);
+        s_lpit_hz = hz;
+    }
+    if (!(lpit->MCR & LPIT_MCR_M_CEN_MASK)) {
+        return;
+    }
+
+    for (uint32_t ch = 0U; ch < LPIT_TMR_COUNT; ch++)
+    {
+        if (!s_lpit[ch].running || sim_lpit_chained(ch)) {
+            continue;
+        }
+        while (s_lpit[ch].next_expiry <= s_now)
+        {
+            sim_lpit_expire(ch);
+            /* TVAL written while running takes effect on reload */
+            s_lpit[ch].period_ns = sim_ticks_to_ns((uint64_t)lpit->TMR[ch].TVAL + 1U, hz);
+            if (s_lpit[ch].period_ns == SIM_NEVER) {
+                s_lpit[ch].next_expiry = SIM_NEVER;
+                break;
+            }
+            s_lpit[ch].next_expiry += s_lpit[ch].period_ns;
+        }
+    }
+
+    for (uint32_t ch = 0U; ch < LPIT_TMR_COUNT; ch++)
+    {
+        uint32_t cval = 0U;
+
+        if (s_lpit[ch].running && sim_lpit_chained(ch))
+        {
+            cval = s_lpit[ch].count;
+        }
+        else if (s_lpit[ch].running && (s_lpit[ch].next_expiry != SIM_NEVER))
+        {
+            cval = (uint32_t)(((s_lpit[ch].next_expiry - s_now) * hz) / 1000000000ULL);
+            if (cval > 0U) cval--;
+        }
+        REG(lpit->TMR[ch].CVAL) = cval;
+    }
+}
+
+static void sim_lpit_write(uintptr_t off, uint32_t old)
+{
+    LPIT_Type *lpit = ALIAS(IP_LPIT0);
+
+    if (off == offsetof(LPIT_Type, MSR))
+    {
+        lpit->MSR = old & ~lpit->MSR;
+    }
+    else if ((off == offsetof(LPIT_Type, SETTEN)) || (off == offsetof(LPIT_Type, CLRTEN)))
+    {
+        uint32_t mask = (off == offsetof(LPIT_Type, SETTEN)) ? lpit->SETTEN : REG(lpit->CLRTEN);
+
+        for (uint32_t ch = 0U; ch < LPIT_TMR_COUNT; ch++)
+        {
+            if (!(mask & (1UL << ch))) {
+                continue;
+            }
+            if (off == offsetof(LPIT_Type, SETTEN)) {
+                lpit->TMR[ch].TCTRL |= LPIT_TMR_TCTRL_T_EN_MASK;
+                sim_lpit_start(ch);
+            } else {
+                lpit->TMR[ch].TCTRL &= ~LPIT_TMR_TCTRL_T_EN_MASK;
+                s_lpit[ch].running = false;
+            }
+        }
+        lpit->SETTEN = 0U;
+        REG(lpit->CLRTEN) = 0U;
+    }
+    else if ((off >= offsetof(LPIT_Type, TMR)) && (off < sizeof(LPIT_Type)))
+    {
+        uint32_t ch = (uint32_t)((off - offsetof(LPIT_Type, TMR)) / sizeof(lpit->TMR[0]));
+        uintptr_t reg = (off - offsetof(LPIT_Type, TMR)) % sizeof(lpit->TMR[0]);
+
+        if (reg == offsetof(__typeof__(lpit->TMR[0]), TCTRL))
+        {
+            bool en = (lpit->TMR[ch].TCTRL & LPIT_TMR_TCTRL_T_EN_MASK) != 0U;
+            if (en && !(old & LPIT_TMR_TCTRL_T_EN_MASK)) {
+                sim_lpit_start(ch);
+            } else if (!en) {
+                s_lpit[ch].running = false;
+            }
+        }
+        else if (reg == offsetof(__typeof__(lpit->TMR[0]), CVAL))
+        {
+            REG(lpit->TMR[ch].CVAL) = old;
+        }
+    }
+    sim_lpit_update();
+}
+
+static uint64_t sim_lpit_next_event(void)
+{
+    uint64_t next = SIM_NEVER;
+
+    for (uint32_t ch = 0U; ch < LPIT_TMR_COUNT; ch++)
+    {
+        if (s_lpit[ch].running && !sim_lpit_chained(ch) && (s_lpit[ch].next_expiry < next)) {
+            next = s_lpit[ch].next_expiry;
+        }
+    }
+    return next;
+}
+
+/* ======================== SCG =======================*/
+static bool sim_scg_source_valid(uint32_t scs)
+{
+    SCG_Type *scg = ALIAS(IP_SCG);
+
+    switch (scs)
+    {
+        case 1U: return (scg->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK) != 0U;
+        case 2U: return (scg->SIRCCSR & SCG_SIRCCSR_SIRCVLD_MASK) != 0U;
+        case 3U: return (scg->FIRCCSR & SCG_FIRCCSR_FIRCVLD_MASK) != 0U;
+        case 6U: return (scg->SPLLCSR & SCG_SPLLCSR_SPLLVLD_MASK) != 0U;
+        default: return false;
+    }
+}
+
+/* Clock control register of the current run mode: RCCR, HCCR (HSRUN) or VCCR (VLPR) */
+static uint32_t sim_scg_ccr(void)
+{
+    SCG_Type *scg = ALIAS(IP_SCG);
+
+    switch (ALIAS(IP_SMC)->PMSTAT)
+    {
+        case 0x80U: return scg->HCCR;
+        case 0x04U: return scg->VCCR;
+        default:    return scg->RCCR;
+    }
+}
+
+/* The switch only happens if the new source is running */
+static void sim_scg_select(void)
+{
+    uint32_t ccr = sim_scg_ccr();
+
+    if (sim_scg_source_valid((ccr & SCG_CSR_SCS_MASK) >> SCG_CSR_SCS_SHIFT)) {
+        REG(ALIAS(IP_SCG)->CSR) = ccr;
+    }
+}
+
+/* SPLL VCO = SOSC / (PREDIV + 1) * (MULT + 16), locks only within 180..320 MHz */
+static bool sim_spll_vco_ok(void)
+{
+    SCG_Type *scg = ALIAS(IP_SCG);
+    uint64_t prediv = ((scg->SPLLCFG & SCG_SPLLCFG_PREDIV_MASK) >> SCG_SPLLCFG_PREDIV_SHIFT) + 1U;
+    uint64_t mult   = ((scg->SPLLCFG & SCG_SPLLCFG_MULT_MASK) >> SCG_SPLLCFG_MULT_SHIFT) + 16U;
+    uint64_t vco    = SIM_SOSC_HZ / prediv * mult;
+
+    return (vco >= 180000000ULL) && (vco <= 320000000ULL);
+}
+
+static void sim_scg_update(void)
+{
+    SCG_Type *scg = ALIAS(IP_SCG);
+
+    if ((scg->SOSCCSR & SCG_SOSCCSR_SOSCEN_MASK) && (s_sosc_valid_at <= s_now)) {
+        scg->SOSCCSR |= SCG_SOSCCSR_SOSCVLD_MASK;
+    }
+    if ((scg->SPLLCSR & SCG_SPLLCSR_SPLLEN_MASK) && (s_spll_valid_at <= s_now) &&
+        (scg->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK) && sim_spll_vco_ok()) {
+        scg->SPLLCSR |= SCG_SPLLCSR_SPLLVLD_MASK;
+    }
+}
+
+/* Writes that would stop the system clock source are ignored */
+static bool sim_scg_in_use(uint32_t scs)
+{
+    return ((ALIAS(IP_SCG)->CSR & SCG_CSR_SCS_MASK) >> SCG_CSR_SCS_SHIFT) == scs;
+}
+
+static void sim_scg_write(uintptr_t off, uint32_t old)
+{
+    SCG_Type *scg = ALIAS(IP_SCG);
+
+    switch (off)
+    {
+        case offsetof(SCG_Type, SOSCCSR):
+            if (sim_scg_in_use(1U)) {
+                scg->SOSCCSR = old;
+                break;
+            }
+            scg->SOSCCSR = (scg->SOSCCSR & ~SCG_SOSCCSR_SOSCVLD_MASK) | (old & SCG_SOSCCSR_SOSCVLD_MASK);
+            if (!(scg->SOSCCSR & SCG_SOSCCSR_SOSCEN_MASK)) {
+                scg->SOSCCSR &= ~SCG_SOSCCSR_SOSCVLD_MASK;
+                s_sosc_valid_at = SIM_NEVER;
+            } else if (!(old & SCG_SOSCCSR_SOSCEN_MASK)) {
+                s_sosc_valid_at = s_sosc_present ? (s_now + SIM_SOSC_STARTUP_NS) : SIM_NEVER;
+            }
+            break;
+        case offsetof(SCG_Type, SPLLCSR):
+            if (sim_scg_in_use(6U)) {
+                scg->SPLLCSR = old;
+                break;
+            }
+            scg->SPLLCSR = (scg->SPLLCSR & ~SCG_SPLLCSR_SPLLVLD_MASK) | (old & SCG_SPLLCSR_SPLLVLD_MASK);
+            if (!(scg->SPLLCSR & SCG_SPLLCSR_SPLLEN_MASK)) {
+                scg->SPLLCSR &= ~SCG_SPLLCSR_SPLLVLD_MASK;
+                s_spll_valid_at = SIM_NEVER;
+            } else if (!(old & SCG_SPLLCSR_SPLLEN_MASK)) {
+                s_spll_valid_at = s_now + SIM_SPLL_LOCK_NS;
+            }
+            break;
+        case offsetof(SCG_Type, FIRCCSR):
+            if (sim_scg_in_use(3U)) {
+                scg->FIRCCSR = old;
+            } else if (scg->FIRCCSR & SCG_FIRCCSR_FIRCEN_MASK) {
+                scg->FIRCCSR |= SCG_FIRCCSR_FIRCVLD_MASK;
+            } else {
+                scg->FIRCCSR &= ~SCG_FIRCCSR_FIRCVLD_MASK;
+            }
+            break;
+        case offsetof(SCG_Type, RCCR):
+        case offsetof(SCG_Type, VCCR):
+        case offsetof(SCG_Type, HCCR):
+            sim_scg_select();
+            break;
+        case offsetof(SCG_Type, CSR):
+            REG(scg->CSR) = old;
+            break;
+        default:
+            break;
+    }
+    sim_scg_update();
+}
+
+static uint64_t sim_scg_next_event(void)
+{
+    SCG_Type *scg = ALIAS(IP_SCG);
+    uint64_t next = SIM_NEVER;
+
+    if ((scg->SOSCCSR & SCG_SOSCCSR_SOSCEN_MASK) && !(scg->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK)) next = s_sosc_valid_at;
+    if ((scg->SPLLCSR & SCG_SPLLCSR_SPLLEN_MASK) && !(scg->SPLLCSR & SCG_SPLLCSR_SPLLVLD_MASK) &&
+        (s_spll_valid_at < next)) next = s_spll_valid_at;
+    return next;
+}
+
+/* ======================== SMC =======================*/
+static void sim_smc_write(uintptr_t off, uint32_t old)
+{
+    SMC_Type *smc = ALIAS(IP_SMC);
+
+    if (off == offsetof(SMC_Type, PMPROT))
+    {
+        /* Write-once after reset */
+        if (s_pmprot_written) {
+            smc->PMPROT = old;
+        }
+        s_pmprot_written = true;
+    }
+    else if (off == offsetof(SMC_Type, PMCTRL))
+    {
+        uint32_t runm = (smc->PMCTRL & SMC_PMCTRL_RUNM_MASK) >> SMC_PMCTRL_RUNM_SHIFT;
+        uint32_t vccr_scs = (ALIAS(IP_SCG)->VCCR & SCG_VCCR_SCS_MASK) >> SCG_VCCR_SCS_SHIFT;
+
+        /* HSRUN and VLPR are entered from RUN only, when allowed by PMPROT */
+        if ((runm == 0U) && (smc->PMSTAT != 0x01U)) {
+            REG(smc->PMSTAT) = 0x01U;
+        } else if ((runm == 3U) && (smc->PMSTAT == 0x01U) && (smc->PMPROT & SMC_PMPROT_AHSRUN_MASK)) {
+            REG(smc->PMSTAT) = 0x80U;
+        } else if ((runm == 2U) && (smc->PMSTAT == 0x01U) && (smc->PMPROT & SMC_PMPROT_AVLP_MASK) &&
+                   (vccr_scs == 2U) && !(ALIAS(IP_SCG)->SPLLCSR & SCG_SPLLCSR_SPLLEN_MASK) &&
+                   !(ALIAS(IP_SCG)->FIRCCSR & SCG_FIRCCSR_FIRCEN_MASK)) {
+            REG(smc->PMSTAT) = 0x04U;
+        }
+        sim_scg_select();
+    }
+    else if (off == offsetof(SMC_Type, PMSTAT))
+    {
+        REG(smc->PMSTAT) = old;
+    }
+}
+
+/* ======================== Dispatch =======================*/
+static void sim_periph_read(uintptr_t addr)
+{
+    uintptr_t page = SIM_PAGE(addr);
+
+    for (uint32_t n = 0U; n < 3U; n++)
+    {
+        if (page == (uintptr_t)s_lpuart[n]) {
+            sim_lpuart_read(n, (addr & ~3U) - page);
+        }
+    }
+    if (page == (uintptr_t)IP_ADC0) {
+        sim_adc_read((addr & ~3U) - page);
+    }
+}
+
+static void sim_periph_write(uintptr_t addr, uint32_t old)
+{
+    uintptr_t page = SIM_PAGE(addr);
+
+    if (page == SIM_PAGE(IP_PTA)) {
+        sim_gpio_write(addr, old);
+    } else if ((page >= (uintptr_t)IP_PORTA) && (page <= (uintptr_t)IP_PORTE)) {
+        sim_port_write(addr, old);
+    } else if (page == (uintptr_t)IP_ADC0) {
+        sim_adc_write((addr & ~3U) - page, old);
+    } else if (page == (uintptr_t)IP_PDB0) {
+        sim_pdb_write((addr & ~3U) - page, old);
+    } else if (page == (uintptr_t)IP_LPIT0) {
+        sim_lpit_write((addr & ~3U) - page, old);
+    } else if (page == (uintptr_t)IP_SCG) {
+        sim_scg_write((addr & ~3U) - page, old);
+    } else if (page == (uintptr_t)IP_SMC) {
+        sim_smc_write((addr & ~3U) - page, old);
+    } else if (page == (uintptr_t)IP_DMA) {
+        sim_dma_write(addr, old);
+    } else {
+        for (uint32_t n = 0U; n < 3U; n++)
+        {
+            if (page == (uintptr_t)s_lpuart[n]) {
+                sim_lpuart_write(n, (addr & ~3U) - page, old);
+            }
+        }
+    }
+}
+
+/* Evaluate all peripheral interrupt lines (level-sensitive) */
+static void sim_irq_lines(void)
+{
+    LPIT_Type *lpit = ALIAS(IP_LPIT0);
+    ADC_Type *adc = ALIAS(IP_ADC0);
+    DMA_Type *dma = ALIAS(IP_DMA);
+
+    memset(s_irq_line, 0, sizeof(s_irq_line));
+    for (uint32_t n = 0U; n < 5U; n++) {
+        if (sim_port_irq_line(n)) s_irq_line[s_port_irq[n]] = 1U;
+    }
+    for (uint32_t n = 0U; n < 3U; n++) {
+        if (sim_lpuart_irq_line(n)) s_irq_line[s_lpuart_irq[n]] = 1U;
+    }
+    for (uint32_t ch = 0U; ch < LPIT_TMR_COUNT; ch++) {
+        if (lpit->MSR & lpit->MIER & (1UL << ch)) s_irq_line[LPIT0_Ch0_IRQn + ch] = 1U;
+    }
+    if ((adc->SC1[0] & ADC_SC1_COCO_MASK) && (adc->SC1[0] & ADC_SC1_AIEN_MASK)) {
+        s_irq_line[ADC0_IRQn] = 1U;
+    }
+    for (uint32_t ch = 0U; ch < DMA_TCD_COUNT; ch++) {
+        if (dma->INT & (1UL << ch)) s_irq_line[DMA0_IRQn + ch] = 1U;
+    }
+}
+
+static void sim_update(void)
+{
+    sim_scg_update();
+    for (uint32_t n = 0U; n < 5U; n++) {
+        sim_gpio_update(n);
+    }
+    for (uint32_t n = 0U; n < 3U; n++) {
+        sim_lpuart_update(n);
+    }
+    sim_adc_update();
+    sim_pdb_update();
+    sim_lpit_update();
+    sim_irq_lines();
+}
+
+static uint64_t sim_next_event(void)
+{
+    uint64_t next = sim_scg_next_event();
+    uint64_t t;
+
+    for (uint32_t n = 0U; n < 3U; n++) {
+        t = sim_lpuart_next_event(n);
+        if (t < next) next = t;
+    }
+    if (s_adc.busy && (s_adc.done_at < next))         next = s_adc.done_at;
+    if (s_adc.cal_busy && (s_adc.cal_done_at < next)) next = s_adc.cal_done_at;
+    t = sim_pdb_next_event();
+    if (t < next) next = t;
+    t = sim_lpit_next_event();
+    return (t < next) ? t : next;
+}
+
+static void sim_dispatch(void)
+{
+    /* Bounded so an ISR that never clears its source cannot hang the host */
+    for (uint32_t guard = 0U; guard < 10000U; guard++)
+    {
+        int32_t best = -1;
+
+        if (s_in_isr || s_primask) {
+            return;
+        }
+        for (uint32_t irq = 0U; irq < SIM_IRQ_COUNT; irq++)
+        {
+            if (s_nvic_enabled[irq] && (s_nvic_pending[irq] || s_irq_line[irq]) && (s_vectors[irq] != NULL) &&
+                ((best < 0) || (s_nvic_prio[irq] < s_nvic_prio[best]))) {
+                best = (int32_t)irq;
+            }
+        }
+        if (best < 0) {
+            return;
+        }
+        s_nvic_pending[best] = 0U;
+        s_in_isr = true;
+        s_vectors[best]();
+        s_in_isr = false;
+        sim_update();
+    }
+}
+
+/* ======================== Page traps =======================*/
+static void sim_protect(uintptr_t page, bool trap)
+{
+    mprotect((void *)page, SIM_PAGE_SIZE, trap ? PROT_NONE : (PROT_READ | PROT_WRITE));
+}
+
+static void sim_segv(int sig, siginfo_t *si, void *ctx)
+{
+    ucontext_t *uc = (ucontext_t *)ctx;
+    uintptr_t addr = (uintptr_t)si->si_addr;
+
+    (void)sig;
+    if (!s_hooks || s_access.active || !SIM_IN_WINDOW(addr))
+    {
+        /* Not a register access: let the fault take its default action */
+        signal(SIGSEGV, SIG_DFL);
+        return;
+    }
+
+    sim_protect(SIM_PAGE(addr), false);
+    s_access_count++;
+    s_now += s_access_ns;
+    sim_update();
+
+    s_access.active = true;
+    s_access.write = (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+    s_access.addr = addr;
+    s_access.old = *(uint32_t *)(void *)(s_alias + ((addr & ~3U) - SIM_PERIPH_BASE));
+    /* Single-step the faulting instruction, finish in sim_trap */
+    uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFLAGS_TF;
+}
+
+static void sim_trap(int sig, siginfo_t *si, void *ctx)
+{
+    ucontext_t *uc = (ucontext_t *)ctx;
+
+    (void)sig;
+    (void)si;
+    uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFLAGS_TF;
+    if (!s_access.active) {
+        return;
+    }
+    s_access.active = false;
+    sim_protect(SIM_PAGE(s_access.addr), s_hooks);
+
+    if (s_access.write) {
+        sim_periph_write(s_access.addr, s_access.old);
+    } else {
+        sim_periph_read(s_access.addr);
+    }
+    sim_irq_lines();
+}
+
+/* ======================== Reset =======================*/
+static void sim_reset(void)
+{
+    memset(s_alias, 0, SIM_PERIPH_SIZE);
+    memset(s_uart, 0, sizeof(s_uart));
+    memset(s_lpit, 0, sizeof(s_lpit));
+    memset(&s_adc, 0, sizeof(s_adc));
+    memset(&s_pdb, 0, sizeof(s_pdb));
+    memset(s_pin_in, 0, sizeof(s_pin_in));
+    memset(s_pin_level, 0, sizeof(s_pin_level));
+    memset(s_nvic_enabled, 0, sizeof(s_nvic_enabled));
+    memset(s_nvic_pending, 0, sizeof(s_nvic_pending));
+    memset(s_irq_line, 0, sizeof(s_irq_line));
+    memset(s_nvic_prio, 0, sizeof(s_nvic_prio));
+    s_now = 0U;
+    s_access_count = 0U;
+    s_primask = false;
+    s_sosc_valid_at = SIM_NEVER;
+    s_spll_valid_at = SIM_NEVER;
+    s_pmprot_written = false;
+    s_lpit_hz = 0U;
+    SystemCoreClock = SIM_FIRC_HZ;
+
+    for (uint32_t n = 0U; n < 3U; n++)
+    {
+        LPUART_Type *u = ALIAS(s_lpuart[n]);
+        REG(u->VERID) = 0x04010003U;
+        REG(u->PARAM) = 0x00000202U;
+        u->BAUD = 0x0F000004U;
+        u->STAT = LPUART_STAT_TDRE_MASK | LPUART_STAT_TC_MASK;
+    }
+    /* Out of reset the core runs from FIRC, SIRC is on as well */
+    REG(ALIAS(IP_SCG)->CSR) = 0x03000001U;
+    ALIAS(IP_SCG)->RCCR     = 0x03000001U;
+    ALIAS(IP_SCG)->VCCR     = 0x02000001U;
+    ALIAS(IP_SCG)->HCCR     = 0x03000001U;
+    ALIAS(IP_SCG)->FIRCCSR  = SCG_FIRCCSR_FIRCVLD_MASK | SCG_FIRCCSR_FIRCEN_MASK;
+    ALIAS(IP_SCG)->SIRCCSR  = SCG_SIRCCSR_SIRCVLD_MASK | SCG_SIRCCSR_SIRCEN_MASK;
+    ALIAS(IP_SCG)->SIRCCFG  = SCG_SIRCCFG_RANGE_MASK;
+    ALIAS(IP_ADC0)->SC1[0]  = ADC_SC1_ADCH_MASK;
+    REG(ALIAS(IP_SMC)->PMSTAT) = 0x01U;
+}
+
+/* ======================== Public API =======================*/
+int SIM_Init(void)
+{
+    struct sigaction sa;
+    void *p;
+
+    if (s_ready) {
+        return 0;
+    }
+
+    s_memfd = memfd_create("s32k144_periph", 0);
+    if ((s_memfd < 0) || (ftruncate(s_memfd, (off_t)SIM_PERIPH_SIZE) != 0)) {
+        return -1;
+    }
+    p = mmap((void *)SIM_PERIPH_BASE, SIM_PERIPH_SIZE, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_FIXED_NOREPLACE, s_memfd, 0);
+    if (p != (void *)SIM_PERIPH_BASE) {
+        return -1;
+    }
+    p = mmap(NULL, SIM_PERIPH_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, s_memfd, 0);
+    if (p == MAP_FAILED) {
+        return -1;
+    }
+    s_alias = (uint8_t *)p;
+    p = mmap((void *)SIM_SRAM_BASE, SIM_SRAM_SIZE, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (p != (void *)SIM_SRAM_BASE) {
+        return -1;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_flags = SA_SIGINFO;
+    sa.sa_sigaction = sim_segv;
+    sigaction(SIGSEGV, &sa, NULL);
+    sa.sa_sigaction = sim_trap;
+    sigaction(SIGTRAP, &sa, NULL);
+
+    s_hook_page_count = 0U;
+    s_hook_pages[s_hook_page_count++] = SIM_PAGE(IP_PTA);
+    for (uint32_t n = 0U; n < 5U; n++) {
+        s_hook_pages[s_hook_page_count++] = (uintptr_t)s_port[n];
+    }
+    for (uint32_t n = 0U; n < 3U; n++) {
+        s_hook_pages[s_hook_page_count++] = (uintptr_t)s_lpuart[n];
+    }
+    s_hook_pages[s_hook_page_count++] = (uintptr_t)IP_ADC0;
+    s_hook_pages[s_hook_page_count++] = (uintptr_t)IP_PDB0;
+    s_hook_pages[s_hook_page_count++] = (uintptr_t)IP_LPIT0;
+    s_hook_pages[s_hook_page_count++] = (uintptr_t)IP_SCG;
+    s_hook_pages[s_hook_page_count++] = (uintptr_t)IP_SMC;
+    s_hook_pages[s_hook_page_count++] = (uintptr_t)IP_DMA;
+
+    sim_init_vectors();
+    sim_reset();
+    s_sram_used = 0U;
+    s_ready = true;
+    SIM_SetHooks(true);
+
+    return 0;
+}
+
+void SIM_Deinit(void)
+{
+    if (!s_ready) {
+        return;
+    }
+    SIM_SetHooks(false);
+    signal(SIGSEGV, SIG_DFL);
+    signal(SIGTRAP, SIG_DFL);
+    munmap((void *)SIM_PERIPH_BASE, SIM_PERIPH_SIZE);
+    munmap(s_alias, SIM_PERIPH_SIZE);
+    munmap((void *)SIM_SRAM_BASE, SIM_SRAM_SIZE);
+    close(s_memfd);
+    s_memfd = -1;
+    s_alias = NULL;
+    s_ready = false;
+}
+
+void SIM_SetHooks(bool enable)
+{
+    s_hooks = enable;
+    for (uint32_t i = 0U; i < s_hook_page_count; i++) {
+        sim_protect(s_hook_pages[i], enable);
+    }
+}
+
+void SIM_SetAccessTime(uint32_t ns)
+{
+    s_access_ns = ns;
+}
+
+uint64_t SIM_Now(void)
+{
+    return s_now;
+}
+
+uint32_t SIM_GetAccessCount(void)
+{
+    return s_access_count;
+}
+
+/* NULL puts the xxx_IRQHandler symbol back */
+void SIM_SetVector(IRQn_Type irq, void (*handler)(void))
+{
+    if ((irq >= 0) && ((uint32_t)irq < SIM_IRQ_COUNT)) {
+        s_vectors[irq] = (handler != NULL) ? handler : s_vector_defaults[irq];
+    }
+}
+
+void (*SIM_GetVector(IRQn_Type irq))(void)
+{
+    return ((irq >= 0) && ((uint32_t)irq < SIM_IRQ_COUNT)) ? s_vectors[irq] : NULL;
+}
+
+void SIM_Advance(uint64_t ns)
+{
+    uint64_t end = s_now + ns;
+
+    sim_update();
+    sim_dispatch();
+    while (s_now < end)
+    {
+        uint64_t next = sim_next_event();
+
+        s_now = (next > end) ? end : ((next <= s_now) ? (s_now + 1U) : next);
+        sim_update();
+        sim_dispatch();
+    }
+}
+
+void *SIM_SramAlloc(uint32_t size)
+{
+    void *p;
+
+    size = (size + 31U) & ~31U;
+    if ((s_sram_used + size) > SIM_SRAM_SIZE) {
+        return NULL;
+    }
+    p = (void *)(SIM_SRAM_BASE + s_sram_used);
+    s_sram_used += size;
+    return p;
+}
+
+void SIM_SetPinInput(uint32_t port, uint32_t pin, uint32_t level)
+{
+    if ((port >= 5U) || (pin >= 32U)) {
+        return;
+    }
+    if (level) s_pin_in[port] |= (1UL << pin);
+    else       s_pin_in[port] &= ~(1UL << pin);
+    sim_gpio_update(port);
+    sim_irq_lines();
+}
+
+uint32_t SIM_LPUART_ReadTx(uint32_t instance, uint8_t *buf, uint32_t max)
+{
+    sim_lpuart_t *s = &s_uart[instance];
+    uint32_t n = 0U;
+
+    while ((n < max) && (s->wire_tail != s->wire_head))
+    {
+        buf[n++] = s->wire[s->wire_tail % SIM_WIRE_SIZE];
+        s->wire_tail++;
+    }
+    return n;
+}
+
+void SIM_LPUART_WriteRx(uint32_t instance, const uint8_t *data, uint32_t len)
+{
+    sim_lpuart_t *s = &s_uart[instance];
+    uint64_t frame = sim_lpuart_frame_ns(instance);
+    uint64_t t = (s->rx_line_free > s_now) ? s->rx_line_free : s_now;
+
+    for (uint32_t i = 0U; (i < len) && ((s->rx_head - s->rx_tail) < SIM_RX_QUEUE_SIZE); i++)
+    {
+        t = (frame == SIM_NEVER) ? SIM_NEVER : (t + frame);
+        s->rx_q[s->rx_head % SIM_RX_QUEUE_SIZE] = data[i];
+        s->rx_end[s->rx_head % SIM_RX_QUEUE_SIZE] = t;
+        s->rx_head++;
+    }
+    s->rx_line_free = t;
+}
+
+void SIM_ADC_SetInput(uint32_t channel, uint16_t raw)
+{
+    if (channel < 32U) {
+        s_adc.input[channel] = raw & 0xFFFU;
+    }
+}
+
+void SIM_ADC_SetConversionTime(uint32_t ns)
+{
+    s_adc_conv_ns = ns;
+}
+
+uint32_t SIM_ADC_GetConversionCount(void)
+{
+    return s_adc.conversions;
+}
+
+void SIM_SCG_SetCrystalPresent(bool present)
+{
+    s_sosc_present = present;
+}
+
+/* ======================== CMSIS-Core subset =======================*/
+void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    if ((IRQn >= 0) && ((uint32_t)IRQn < SIM_IRQ_COUNT)) s_nvic_enabled[IRQn] = 1U;
+}
+
+void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    if ((IRQn >= 0) && ((uint32_t)IRQn < SIM_IRQ_COUNT)) s_nvic_enabled[IRQn] = 0U;
+}
+
+uint32_t NVIC_GetEnableIRQ(IRQn_Type IRQn)
+{
+    return ((IRQn >= 0) && ((uint32_t)IRQn < SIM_IRQ_COUNT)) ? s_nvic_enabled[IRQn] : 0U;
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+    if ((IRQn >= 0) && ((uint32_t)IRQn < SIM_IRQ_COUNT)) s_nvic_pending[IRQn] = 1U;
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    if ((IRQn >= 0) && ((uint32_t)IRQn < SIM_IRQ_COUNT)) s_nvic_pending[IRQn] = 0U;
+}
+
+uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn)
+{
+    return ((IRQn >= 0) && ((uint32_t)IRQn < SIM_IRQ_COUNT)) ? (s_nvic_pending[IRQn] | s_irq_line[IRQn]) : 0U;
+}
+
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+    if ((IRQn >= 0) && ((uint32_t)IRQn < SIM_IRQ_COUNT)) s_nvic_prio[IRQn] = (uint8_t)priority;
+}
+
+uint32_t NVIC_GetPriority(IRQn_Type IRQn)
+{
+    return ((IRQn >= 0) && ((uint32_t)IRQn < SIM_IRQ_COUNT)) ? s_nvic_prio[IRQn] : 0U;
+}
+
+void __enable_irq(void)
+{
+    s_primask = false;
+    sim_dispatch();
+}
+
+void __disable_irq(void)
+{
+    s_primask = true;
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return s_primask ? 1U : 0U;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+    if (priMask & 1U) {
+        __disable_irq();
+    } else {
+        __enable_irq();
+    }
+}
+
+/* Sleep until the next peripheral event, then take the interrupt */
+void __WFI(void)
+{
+    uint64_t next = sim_next_event();
+
+    if (s_in_isr) {
+        return;
+    }
+    SIM_Advance((next == SIM_NEVER) ? 0U : ((next > s_now) ? (next - s_now) : 0U));
+}
+
+#endif /* HOST_SIM */
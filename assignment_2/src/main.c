@@ -3,63 +3,156 @@
  * @author  Vo Ba Thong
  * @brief   Application entry point.
  * @details Write USART driver for S32K144 using CMSIS, write test application for drivers by sending command
+ *
+ * Commands are text lines on the USART (9600 baud, '\r' or '\n' ends a line):
+ * LED_STATUS, RED_ON, RED_OFF, GREEN_ON, GREEN_OFF, BLUE_ON, BLUE_OFF.
+ * Received bytes queue on an rx ring from the RxTx interrupt; the main loop
+ * takes whole lines from it, answers with LOG records and sleeps in between.
  */
 
 #include "driver_gpio.h"
 #include "driver_usart.h"
-#include "clocks_and_modes.h"
-#include <stdio.h>
+#include "driver_debounce.h"
+#include "driver_clock.h"
+#include "driver_profile.h"
+#include "driver_log.h"
+#include <string.h>
+
+#define CMD_LINE_MAX        16U
+
+/* The LEDs on the board light with the pin low */
+#define LED_ON              0U
+#define LED_OFF             1U
+
+typedef struct {
+    const char     *name;
+    ARM_GPIO_Pin_t  pin;
+    uint32_t        level;
+} led_command_t;
 
 extern ARM_DRIVER_GPIO Driver_GPIO0;
 extern ARM_DRIVER_USART Driver_USART0;
-void UART_Callback()
+
+static const led_command_t led_commands[] = {
+    { "RED_ON",    LED_RED,   LED_ON  },
+    { "RED_OFF",   LED_RED,   LED_OFF },
+    { "GREEN_ON",  LED_GREEN, LED_ON  },
+    { "GREEN_OFF", LED_GREEN, LED_OFF },
+    { "BLUE_ON",   LED_BLUE,  LED_ON  },
+    { "BLUE_OFF",  LED_BLUE,  LED_OFF },
+};
+
+/* Log records leave through this ring, decoded on the host by tools/log_decode.py */
+static uint8_t log_tx_storage[512];
+static Ring_t log_tx;
+
+/* Command bytes, filled by the USART interrupt */
+static uint8_t cmd_rx_storage[64];
+static Ring_t cmd_rx;
+
+static char cmd_line[CMD_LINE_MAX];
+static uint32_t cmd_len;
+static bool cmd_overlong;
+
+/* Interrupt context: with the rx ring attached only errors are signalled */
+static void UART_Callback(uint32_t event)
 {
-	/*Parse data to get the complete command*/
-	ProcessCommand;
+    if (event & ARM_USART_EVENT_RX_OVERFLOW)
+    {
+        LOG("USART rx overflow, event 0x%x", event);
+    }
 }
 
-void ProcessCommand(string cmd)
+static uint32_t LED_IsOn(ARM_GPIO_Pin_t pin)
 {
-	switch(cmd)
-	{
-		case LED_STATUS:
-		    /* Get LED information */
-		    Driver_USART0.Send(led_status);
-		    break;
-		case RED_ON:
-		    /* Turn on red led */
-		    Driver_GPIO0.SetOutput(LED_RED, 1);
-		    break;
-		case RED_OFF:
-		    /* Turn off red led */
-			Driver_GPIO0.SetOutput(LED_RED, 0);
-			break;
-		case GREEN_ON:
-		    /* Turn on green led */
-			Driver_GPIO0.SetOutput(LED_GREEN, 1);
-			break;
-	    case GREEN_OFF:
-		    /* Turn off green led */
-			Driver_GPIO0.SetOutput(LED_GREEN, 0);
-			break;
-		case BLUE_ON:
-		    /* Turn on blue led */
-			Driver_GPIO0.SetOutput(LED_BLUE, 1);
-			break;
-		case BLUE_OFF:
-		    /* Turn off blue led */
-			Driver_GPIO0.SetOutput(LED_BLUE, 0);
-			break;
-		default:
-		    printf("\nCommand not available\n");
-			break;
-	}
+    return (Driver_GPIO0.GetInput(pin) == LED_ON) ? 1U : 0U;
+}
 
+static void ProcessCommand(const char *cmd)
+{
+    if (strcmp(cmd, "LED_STATUS") == 0)
+    {
+        LOG("LED red %u green %u blue %u", LED_IsOn(LED_RED), LED_IsOn(LED_GREEN), LED_IsOn(LED_BLUE));
+        return;
+    }
+    for (uint32_t i = 0U; i < (sizeof(led_commands) / sizeof(led_commands[0])); i++)
+    {
+        if (strcmp(cmd, led_commands[i].name) == 0)
+        {
+            Driver_GPIO0.SetOutput(led_commands[i].pin, led_commands[i].level);
+            LOG("LED %u set to %u", led_commands[i].pin, led_commands[i].level);
+            return;
+        }
+    }
+    LOG("Command not available");
+}
+
+/* Assemble lines from the rx ring; a line longer than the buffer is dropped whole */
+static void PollCommands(void)
+{
+    uint8_t byte;
+
+    while (RING_Pop(&cmd_rx, &byte, 1U) != 0U)
+    {
+        if ((byte == '\r') || (byte == '\n'))
+        {
+            if (cmd_overlong)
+            {
+                LOG("Command longer than %u characters", CMD_LINE_MAX - 1U);
+            }
+            else if (cmd_len != 0U)
+            {
+                cmd_line[cmd_len] = '\0';
+                ProcessCommand(cmd_line);
+                LOG("Enter user's command");
+            }
+            cmd_len = 0U;
+            cmd_overlong = false;
+        }
+        else if (cmd_len < (CMD_LINE_MAX - 1U))
+        {
+            cmd_line[cmd_len] = (char)byte;
+            cmd_len++;
+        }
+        else
+        {
+            cmd_overlong = true;
+        }
+    }
+}
+
+/* The drain and the rx check run with PRIMASK set up to the WFI: a LOG or a
+ * byte from an interrupt in between leaves that interrupt pending, and WFI
+ * returns at once. Records the full tx ring cannot take wait for its
+ * transmit interrupt, which wakes the loop too. */
+static void Idle(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    (void)LOG_Drain();
+    if (RING_Count(&cmd_rx) == 0U)
+    {
+        __DSB();
+        __WFI();
+    }
+    __set_PRIMASK(primask);
 }
 
 int main(void) {
 	/* Program's data */
-	char command[100];
+	Clock_Config_t clocks;
+
+	/* Log timestamps: records queue in RAM from here, and leave once the USART is up */
+    PROFILE_Init();
+    LOG_Init();
+
+	/* Clocks: 80 MHz core, 40 MHz bus, 26.67 MHz flash, async DIV1 80 MHz, DIV2 40 MHz.
+	   The crystal and the SPLL start while the pins are set up below */
+    CLOCK_Init();
+    CLOCK_Solve(&(Clock_Target_t){ CLOCK_MODE_RUN, 80000000U, 40000000U, 26666667U, 80000000U, 40000000U }, &clocks);
+    CLOCK_BootStart(&clocks);
+
 	/* LED Setup */
     Driver_GPIO0.Setup(LED_BLUE, NULL);
     Driver_GPIO0.SetDirection(LED_BLUE, ARM_GPIO_OUTPUT);
@@ -76,17 +169,31 @@ int main(void) {
     Driver_GPIO0.SetOutput(LED_GREEN, 0);
     Driver_GPIO0.SetOutput(LED_GREEN, 1);
 
-	/* USART Setup */
+    /* Bounded: on a clock failure the board runs from FIRC with the red LED on */
+    while (CLOCK_BootPoll() < CLOCK_BOOT_DONE)
+    {
+        /* Do nothing */
+    }
+    if (CLOCK_GetBootReport()->state == CLOCK_BOOT_FALLBACK)
+    {
+        Driver_GPIO0.SetOutput(LED_RED, 0);
+    }
+
+    /* Buttons: debounced on LPIT0 channel 1, one Button_Event per press */
+    DEBOUNCE_Init(Button_Event);
+    DEBOUNCE_AddPin(&(Debounce_PinConfig_t){ BUTTON1, 0U, 20000U, 0U });
+    DEBOUNCE_AddPin(&(Debounce_PinConfig_t){ BUTTON2, 0U, 20000U, 0U });
+
+	/* USART Setup: the baud rate is derived from the clocks above */
     Driver_USART0.Initialize(UART_Callback);
+    RING_Init(&log_tx, log_tx_storage, sizeof(log_tx_storage), 1U, RING_SPSC);
+    RING_Init(&cmd_rx, cmd_rx_storage, sizeof(cmd_rx_storage), 1U, RING_SPSC);
+    USART_SetRings(&cmd_rx, &log_tx);
 
-	SOSC_init_8MHz(); /* Initialize system oscillator for 8 MHz xtal */
-    SPLL_init_160MHz(); /* Initialize SPLL to 160 MHz with 8 MHz SOSC */
-    NormalRUNmode_80MHz(); /* Init clocks: 80 MHz SPLL & core, 40 MHz bus, 20 MHz flash */
-	while(1)
+    LOG("Enter user's command");
+	while (1)
 	{
-		printf("Enter user's command: ");
-		fgets(command, sizeof(command), stdin);
-		Driver_USART0.Send(command);
+		PollCommands();
+		Idle();
 	}
-    return 0;
 }
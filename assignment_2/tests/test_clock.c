@@ -0,0 +1,236 @@
+/*
+ * Host test of the clock tree engine.
+ *
+ *  - CLOCK_Solve() on the configurations the projects use, then on a sweep
+ *    of RUN and HSRUN targets against an exhaustive search of every SPLL
+ *    PREDIV/MULT and DIVCORE/DIVBUS/DIVSLOW setting: the same core, bus and
+ *    slow frequencies, fields that give the reported frequencies, every
+ *    frequency at or below its target and the mode limit.
+ *  - CLOCK_SetTarget() through RUN -> HSRUN -> VLPR -> RUN on the model,
+ *    with the notifiers called around each change.
+ *
+ *   gcc -O2 -Wall -Wextra -DHOST_SIM -Iinclude -I../common/include tests/test_clock.c \
+ *       src/host_sim.c src/driver_clock.c src/clocks_and_modes.c -o test_clock && ./test_clock
+ */
+#include "driver_clock.h"
+#include "clocks_and_modes.h"
+#include <stdio.h>
+
+#define MHZ                 1000000UL
+
+typedef struct {
+    uint32_t core;
+    uint32_t bus;
+    uint32_t slow;
+} freqs_t;
+
+/* Mode limits from the reference manual, RUN and HSRUN */
+static const freqs_t limit[] = {
+    { 80U * MHZ, 40U * MHZ, 26666667UL },
+    { 112U * MHZ, 56U * MHZ, 28U * MHZ },
+};
+
+static uint32_t notified[2];
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static uint32_t min_u32(uint32_t a, uint32_t b)
+{
+    return (a < b) ? a : b;
+}
+
+static int32_t solve(Clock_Mode_t mode, uint32_t core, uint32_t bus, uint32_t slow, Clock_Config_t *cfg)
+{
+    Clock_Target_t t = { mode, core, bus, slow, 80U * MHZ, 40U * MHZ };
+
+    return CLOCK_Solve(&t, cfg);
+}
+
+/* Best (core, bus, slow) at or below want, over every SPLL and divider setting */
+static freqs_t exhaustive(const freqs_t *want)
+{
+    freqs_t best = { 0U, 0U, 0U };
+
+    for (uint32_t prediv = 0U; prediv < 8U; prediv++)
+    {
+        for (uint32_t mult = 0U; mult < 32U; mult++)
+        {
+            uint32_t vco = (uint32_t)(((uint64_t)SOSC_FREQ_HZ * (mult + 16U)) / (prediv + 1U));
+
+            if ((vco < 180U * MHZ) || (vco > 320U * MHZ))
+            {
+                continue;
+            }
+            for (uint32_t dc = 1U; dc <= 16U; dc++)
+            {
+                freqs_t f;
+
+                f.core = (vco / 2U) / dc;
+                if ((f.core > want->core) || (f.core < best.core))
+                {
+                    continue;
+                }
+                for (uint32_t db = 1U; db <= 16U; db++)
+                {
+                    f.bus = f.core / db;
+                    if (f.bus > want->bus)
+                    {
+                        continue;
+                    }
+                    for (uint32_t ds = 1U; ds <= 8U; ds++)
+                    {
+                        f.slow = f.core / ds;
+                        if ((f.slow <= want->slow) &&
+                            ((f.core > best.core) || ((f.core == best.core) &&
+                             ((f.bus > best.bus) || ((f.bus == best.bus) && (f.slow > best.slow))))))
+                        {
+                            best = f;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+/* The fields give the reported frequencies */
+static void check_fields(const Clock_Config_t *c)
+{
+    uint32_t src = (c->mode == CLOCK_MODE_VLPR) ? SIRC_FREQ_HZ :
+                   (uint32_t)((((uint64_t)SOSC_FREQ_HZ * (c->mult + 16U)) / (c->prediv + 1U)) / 2U);
+    uint32_t core = src / (c->divcore + 1U);
+
+    CHECK(c->core_hz == core);
+    CHECK(c->bus_hz == (core / (c->divbus + 1U)));
+    CHECK(c->slow_hz == (core / (c->divslow + 1U)));
+    CHECK(c->div1_hz == ((c->div1 == 0U) ? 0U : (src >> (c->div1 - 1U))));
+    CHECK(c->div2_hz == ((c->div2 == 0U) ? 0U : (src >> (c->div2 - 1U))));
+}
+
+static void test_known(void)
+{
+    Clock_Config_t c;
+
+    /* The former fixed 80 MHz setup: SPLL 160 MHz, MULT 24 */
+    CHECK(solve(CLOCK_MODE_RUN, 80U * MHZ, 40U * MHZ, 26666667UL, &c) == ARM_DRIVER_OK);
+    CHECK((c.core_hz == 80U * MHZ) && (c.bus_hz == 40U * MHZ) && (c.slow_hz == 26666666UL));
+    CHECK((c.prediv == 0U) && (c.mult == 24U) && (c.divcore == 1U) && (c.divbus == 1U) && (c.divslow == 2U));
+    CHECK(c.scs == 6U);
+
+    CHECK(solve(CLOCK_MODE_HSRUN, 112U * MHZ, 56U * MHZ, 28U * MHZ, &c) == ARM_DRIVER_OK);
+    CHECK((c.core_hz == 112U * MHZ) && (c.bus_hz == 56U * MHZ) && (c.slow_hz == 28U * MHZ));
+
+    CHECK(solve(CLOCK_MODE_RUN, 72U * MHZ, 36U * MHZ, 24U * MHZ, &c) == ARM_DRIVER_OK);
+    CHECK((c.core_hz == 72U * MHZ) && (c.bus_hz == 36U * MHZ) && (c.slow_hz == 24U * MHZ));
+
+    CHECK(solve(CLOCK_MODE_RUN, 50U * MHZ, 25U * MHZ, 12500000UL, &c) == ARM_DRIVER_OK);
+    CHECK((c.core_hz == 50U * MHZ) && (c.bus_hz == 25U * MHZ) && (c.slow_hz == 12500000UL));
+
+    /* Truncated targets: SPLL 100 MHz / 3, not 33 MHz */
+    CHECK(solve(CLOCK_MODE_RUN, 33333333UL, 33333333UL, 16666666UL, &c) == ARM_DRIVER_OK);
+    CHECK((c.core_hz == 33333333UL) && (c.slow_hz == 16666666UL));
+
+    /* Not reachable exactly: the closest from below */
+    CHECK(solve(CLOCK_MODE_RUN, 77777U * 1000U, 40U * MHZ, 20U * MHZ, &c) == ARM_DRIVER_OK);
+    CHECK((c.core_hz == 76U * MHZ) && (c.bus_hz == 38U * MHZ) && (c.slow_hz == 19U * MHZ));
+
+    /* Above the mode limits: clamped */
+    CHECK(solve(CLOCK_MODE_RUN, 200U * MHZ, 200U * MHZ, 200U * MHZ, &c) == ARM_DRIVER_OK);
+    CHECK((c.core_hz == 80U * MHZ) && (c.bus_hz == 40U * MHZ) && (c.slow_hz <= 26666667UL));
+
+    CHECK(solve(CLOCK_MODE_VLPR, 4U * MHZ, 4U * MHZ, 1U * MHZ, &c) == ARM_DRIVER_OK);
+    CHECK((c.core_hz == 4U * MHZ) && (c.bus_hz == 4U * MHZ) && (c.slow_hz == 1U * MHZ) && (c.scs == 2U));
+    check_fields(&c);
+
+    /* Below the slowest SPLL setting (90 MHz / 16), a zero target, bad arguments */
+    CHECK(solve(CLOCK_MODE_RUN, 3U * MHZ, 3U * MHZ, 1U * MHZ, &c) == ARM_DRIVER_ERROR_PARAMETER);
+    CHECK(solve(CLOCK_MODE_RUN, 80U * MHZ, 0U, 1U * MHZ, &c) == ARM_DRIVER_ERROR_PARAMETER);
+    CHECK(solve((Clock_Mode_t)3, 80U * MHZ, 40U * MHZ, 20U * MHZ, &c) == ARM_DRIVER_ERROR_PARAMETER);
+    CHECK(CLOCK_Solve(NULL, &c) == ARM_DRIVER_ERROR_PARAMETER);
+}
+
+static void test_sweep(void)
+{
+    uint32_t cases = 0U;
+
+    for (uint32_t m = 0U; m < 2U; m++)
+    {
+        for (uint32_t core = 6U * MHZ; core <= limit[m].core + (4U * MHZ); core += 250000U)
+        {
+            for (uint32_t ratio = 1U; ratio <= 4U; ratio++)
+            {
+                Clock_Config_t c;
+                freqs_t want;
+                freqs_t ref;
+
+                want.core = min_u32(core, limit[m].core);
+                want.bus = min_u32(core / ratio, limit[m].bus);
+                want.slow = min_u32(core / (ratio + 2U), limit[m].slow);
+                ref = exhaustive(&want);
+
+                CHECK(solve((Clock_Mode_t)m, core, core / ratio, core / (ratio + 2U), &c) == ARM_DRIVER_OK);
+                CHECK((c.core_hz == ref.core) && (c.bus_hz == ref.bus) && (c.slow_hz == ref.slow));
+                if ((c.core_hz != ref.core) || (c.bus_hz != ref.bus) || (c.slow_hz != ref.slow))
+                {
+                    printf("  mode %u target %u/%u/%u: %u/%u/%u, exhaustive %u/%u/%u\n", m,
+                           want.core, want.bus, want.slow, c.core_hz, c.bus_hz, c.slow_hz,
+                           ref.core, ref.bus, ref.slow);
+                }
+                CHECK((c.div1_hz <= 80U * MHZ) && (c.div2_hz <= 40U * MHZ));
+                check_fields(&c);
+                cases++;
+            }
+        }
+    }
+    printf("%u RUN/HSRUN targets match the exhaustive search\n", cases);
+}
+
+static void on_change(uint32_t event, const Clock_Config_t *cfg)
+{
+    (void)cfg;
+    notified[(event == CLOCK_EVENT_PRE_CHANGE) ? 0U : 1U]++;
+}
+
+static void test_apply(void)
+{
+    static Clock_Notifier_t notifier;
+    static const Clock_Target_t steps[] = {
+        { CLOCK_MODE_RUN,   80U * MHZ,  40U * MHZ, 26666667UL, 80U * MHZ, 40U * MHZ },
+        { CLOCK_MODE_HSRUN, 112U * MHZ, 56U * MHZ, 28U * MHZ,  80U * MHZ, 40U * MHZ },
+        { CLOCK_MODE_VLPR,  4U * MHZ,   4U * MHZ,  1U * MHZ,   4U * MHZ,  4U * MHZ },
+        { CLOCK_MODE_RUN,   80U * MHZ,  40U * MHZ, 26666667UL, 80U * MHZ, 40U * MHZ },
+    };
+
+    CHECK(CLOCK_Init() == ARM_DRIVER_OK);
+    CLOCK_RegisterNotifier(&notifier, on_change);
+    for (uint32_t i = 0U; i < (sizeof(steps) / sizeof(steps[0])); i++)
+    {
+        CHECK(CLOCK_SetTarget(&steps[i]) == ARM_DRIVER_OK);
+        CHECK(SystemCoreClock == steps[i].core_hz);
+        CHECK((CLOCK_GetConfig() != NULL) && (CLOCK_GetConfig()->mode == steps[i].mode));
+    }
+    CHECK((notified[0] == 4U) && (notified[1] == 4U));
+    printf("RUN 80 -> HSRUN 112 -> VLPR 4 -> RUN 80 MHz applied, %u/%u notifications\n",
+           notified[0], notified[1]);
+}
+
+int main(void)
+{
+    test_known();
+    test_sweep();
+
+    SIM_Init();
+    SIM_SCG_SetCrystalPresent(true);
+    test_apply();
+
+    printf("%s\n", (failures == 0) ? "PASS" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/*
+ * Host test of the non-blocking clock bring-up on the simulated SCG.
+ *
+ *  - CLOCK_BootStart() and CLOCK_BootPoll() to RUN 80 MHz: DONE once the
+ *    crystal (1 ms) and the SPLL (200 us) are up, on SPLL.
+ *  - No crystal, an SPLL that never locks, SOSCCSR locked: FALLBACK to FIRC
+ *    48 MHz with the failed stage named, after that stage's timeout.
+ *  - The blocking SOSC/SPLL/RUN init without a crystal returns, on FIRC.
+ *
+ *   gcc -O2 -Wall -Wextra -DHOST_SIM -Iinclude -I../common/include tests/test_clock_boot.c \
+ *       src/host_sim.c src/driver_clock.c src/clocks_and_modes.c -o test_clock_boot && ./test_clock_boot
+ */
+#include "driver_clock.h"
+#include "clocks_and_modes.h"
+#include <stdio.h>
+
+#define SCS_FIRC            3U
+#define SCS_SPLL            6U
+
+static const char *const stage_names[] = { "IDLE", "SOSC", "SPLL", "SWITCH", "DONE", "FALLBACK" };
+
+static Clock_Config_t run80;
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static uint32_t scs(void)
+{
+    return (IP_SCG->CSR & SCG_CSR_SCS_MASK) >> SCG_CSR_SCS_SHIFT;
+}
+
+/* Start, poll to the end and return the report; the model is left up for checks */
+static const Clock_BootReport_t *boot(const char *name, const Clock_Config_t *cfg)
+{
+    const Clock_BootReport_t *report;
+
+    CHECK(CLOCK_BootStart(cfg) == ARM_DRIVER_OK);
+    while (CLOCK_BootPoll() < CLOCK_BOOT_DONE)
+    {
+        /* Do nothing */
+    }
+    report = CLOCK_GetBootReport();
+    printf("%-18s %-8s failed %-4s sosc %4u spll %4u switch %3u total %5u us, core %u Hz\n",
+           name, stage_names[report->state], stage_names[report->failed_stage],
+           report->sosc_us, report->spll_us, report->switch_us, report->total_us, SystemCoreClock);
+    return report;
+}
+
+static void test_normal(void)
+{
+    const Clock_BootReport_t *report;
+
+    SIM_Init();
+    SIM_SCG_SetCrystalPresent(true);
+    report = boot("crystal present", &run80);
+    CHECK((report->state == CLOCK_BOOT_DONE) && (report->failed_stage == CLOCK_BOOT_IDLE));
+    CHECK((report->sosc_us >= 1000U) && (report->sosc_us <= 1010U));
+    CHECK((report->spll_us >= 200U) && (report->spll_us <= 210U));
+    CHECK(report->total_us <= 1250U);
+    CHECK((scs() == SCS_SPLL) && (SystemCoreClock == 80000000U));
+    SIM_Deinit();
+}
+
+static void check_fallback(const Clock_BootReport_t *report, Clock_BootState_t stage,
+                           uint32_t min_us, uint32_t max_us)
+{
+    CHECK((report->state == CLOCK_BOOT_FALLBACK) && (report->failed_stage == stage));
+    CHECK((report->total_us >= min_us) && (report->total_us <= max_us));
+    CHECK((scs() == SCS_FIRC) && (SystemCoreClock == 48000000U));
+}
+
+static void test_no_crystal(void)
+{
+    SIM_Init();
+    SIM_SCG_SetCrystalPresent(false);
+    check_fallback(boot("no crystal", &run80), CLOCK_BOOT_SOSC, 5000U, 5100U);
+    SIM_Deinit();
+}
+
+static void test_spll_no_lock(void)
+{
+    Clock_Config_t cfg = run80;
+
+    /* MULT out of range: the model never sets SPLLVLD */
+    cfg.mult = 31U;
+    SIM_Init();
+    SIM_SCG_SetCrystalPresent(true);
+    check_fallback(boot("SPLL never locks", &cfg), CLOCK_BOOT_SPLL, 2000U, 2100U);
+    SIM_Deinit();
+}
+
+static void test_sosc_locked(void)
+{
+    SIM_Init();
+    SIM_SCG_SetCrystalPresent(true);
+    IP_SCG->SOSCCSR = SCG_SOSCCSR_LK_MASK;
+    check_fallback(boot("SOSCCSR locked", &run80), CLOCK_BOOT_SOSC, 0U, 10U);
+    SIM_Deinit();
+}
+
+static void test_legacy_no_crystal(void)
+{
+    uint64_t t0;
+    uint64_t us;
+
+    SIM_Init();
+    SIM_SCG_SetCrystalPresent(false);
+    t0 = SIM_Now();
+    SOSC_init_8MHz();
+    SPLL_init_160MHz();
+    NormalRUNmode_80MHz();
+    us = (SIM_Now() - t0) / 1000U;
+    printf("blocking init, no crystal: returns after %u us\n", (uint32_t)us);
+    CHECK(us < 10000U);
+    CHECK(scs() == SCS_FIRC);
+    SIM_Deinit();
+}
+
+int main(void)
+{
+    CHECK(CLOCK_Solve(&(Clock_Target_t){ CLOCK_MODE_RUN, 80000000U, 40000000U, 26666667U, 80000000U, 40000000U },
+                      &run80) == ARM_DRIVER_OK);
+
+    test_normal();
+    test_no_crystal();
+    test_spll_no_lock();
+    test_sosc_locked();
+    test_legacy_no_crystal();
+
+    printf("%s\n", (failures == 0) ? "PASS" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+/*
+ * Host test of driver_debounce on the simulated PORTC and LPIT0.
+ *
+ *  - Five presses of BUTTON1, each edge a storm of 31 random bounces 20 to
+ *    300 us apart. As a raw falling-edge GPIO callback every bounce is an
+ *    interrupt; sampled on LPIT0 channel 1 it is one PORT interrupt per
+ *    transition and one PRESS and one RELEASE per press: no sooner than the
+ *    stable time after the first bounce, within a tick of it after the last.
+ *  - BUTTON2 with a stable time inside the PORT digital filter: DFER set,
+ *    one interrupt per edge, PRESS/RELEASE at once, LONG_PRESS on a hold.
+ *    The model does not filter glitches, so the edges are clean.
+ *
+ *   gcc -O2 -Wall -Wextra -DHOST_SIM -Iinclude -I../common/include tests/test_debounce.c \
+ *       src/host_sim.c src/driver_debounce.c src/driver_gpio.c src/driver_port.c src/driver_log.c \
+ *       src/driver_usart.c src/driver_profile.c src/driver_clock.c src/driver_irq.c \
+ *       src/clocks_and_modes.c ../common/src/driver_ring.c -o test_debounce && ./test_debounce
+ */
+#include "driver_debounce.h"
+#include "driver_irq.h"
+#include "clocks_and_modes.h"
+#include <stdio.h>
+
+#define PRESSES             5U
+#define BOUNCES             31U
+#define STABLE_US           20000U
+#define FILTER_STABLE_US    200U
+#define FILTER_LONG_MS      300U
+#define MS                  1000000ULL
+
+void PORTC_IRQHandler(void);
+void LPIT0_Ch1_IRQHandler(void);
+
+extern ARM_DRIVER_GPIO Driver_GPIO0;
+
+typedef struct {
+    uint32_t port_irqs;
+    uint32_t ticks;
+    uint32_t press;
+    uint32_t release;
+    uint32_t long_press;
+    uint32_t raw;
+    uint64_t last_ns;       /* Time of the last debounced event */
+} counts_t;
+
+static counts_t counts;
+static uint32_t seed = 1U;
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static void counting_port(void)
+{
+    counts.port_irqs++;
+    PORTC_IRQHandler();
+}
+
+static void counting_tick(void)
+{
+    counts.ticks++;
+    LPIT0_Ch1_IRQHandler();
+}
+
+static void on_event(ARM_GPIO_Pin_t pin, uint32_t event)
+{
+    (void)pin;
+    if (event & ARM_GPIO_EVENT_FALLING_EDGE)
+    {
+        counts.raw++;
+    }
+    if (event & DEBOUNCE_EVENT_PRESS)
+    {
+        counts.press++;
+    }
+    if (event & DEBOUNCE_EVENT_RELEASE)
+    {
+        counts.release++;
+    }
+    if (event & DEBOUNCE_EVENT_LONG_PRESS)
+    {
+        counts.long_press++;
+    }
+    counts.last_ns = SIM_Now();
+}
+
+static uint32_t rnd(void)
+{
+    seed = (seed * 1103515245U) + 12345U;
+    return (seed >> 16) & 0x7FFFU;
+}
+
+/* BOUNCES random toggles from first, then the pin settles at level; returns the settle time */
+static uint64_t bounce(uint32_t pin, uint32_t level, uint64_t *first)
+{
+    *first = SIM_Now();
+    for (uint32_t i = 0U; i < BOUNCES; i++)
+    {
+        SIM_SetPinInput(2U, pin, ((i & 1U) != 0U) ? !level : level);
+        SIM_Advance((20U + (rnd() % 280U)) * 1000ULL);
+    }
+    SIM_SetPinInput(2U, pin, level);
+    return SIM_Now();
+}
+
+/* The event no sooner than the stable time after the first edge, within a tick after the last */
+static void check_timing(uint64_t first, uint64_t settled)
+{
+    CHECK(counts.last_ns >= (first + (STABLE_US * 1000ULL)));
+    CHECK(counts.last_ns <= (settled + ((STABLE_US + DEBOUNCE_TICK_US) * 1000ULL)));
+}
+
+/* Five bouncy presses of BUTTON1 (PTC12), held 100 ms each */
+static void press_storm(bool debounced)
+{
+    for (uint32_t k = 0U; k < PRESSES; k++)
+    {
+        uint32_t press = counts.press;
+        uint32_t release = counts.release;
+        uint64_t first;
+        uint64_t settled;
+
+        settled = bounce(12U, 1U, &first);
+        SIM_Advance(100U * MS);
+        if (debounced)
+        {
+            CHECK(counts.press == (press + 1U));
+            check_timing(first, settled);
+        }
+
+        settled = bounce(12U, 0U, &first);
+        SIM_Advance(100U * MS);
+        if (debounced)
+        {
+            CHECK(counts.release == (release + 1U));
+            check_timing(first, settled);
+        }
+    }
+}
+
+static void test_raw(void)
+{
+    counts = (counts_t){ 0U };
+    CHECK(Driver_GPIO0.Setup(BUTTON1, on_event) == ARM_DRIVER_OK);
+    CHECK(Driver_GPIO0.SetDirection(BUTTON1, ARM_GPIO_INPUT) == ARM_DRIVER_OK);
+    CHECK(Driver_GPIO0.SetEventTrigger(BUTTON1, ARM_GPIO_TRIGGER_FALLING_EDGE) == ARM_DRIVER_OK);
+
+    press_storm(false);
+    printf("raw edge callback: %u PORT interrupts, %u callbacks for %u presses\n",
+           counts.port_irqs, counts.raw, PRESSES);
+    /* Every bounce a falling edge: one callback per interrupt */
+    CHECK(counts.raw == counts.port_irqs);
+    CHECK(counts.raw > (4U * PRESSES));
+
+    CHECK(Driver_GPIO0.SetEventTrigger(BUTTON1, ARM_GPIO_TRIGGER_NONE) == ARM_DRIVER_OK);
+    CHECK(Driver_GPIO0.Setup(BUTTON1, NULL) == ARM_DRIVER_OK);
+}
+
+static void test_sampled(void)
+{
+    counts = (counts_t){ 0U };
+    CHECK(DEBOUNCE_AddPin(&(Debounce_PinConfig_t){ BUTTON1, 0U, STABLE_US, 0U }) == ARM_DRIVER_OK);
+    CHECK((IP_PORTC->DFER & (1UL << 12)) == 0U);
+
+    press_storm(true);
+    printf("sampled: %u PORT interrupts, %u ticks, press %u release %u long %u\n",
+           counts.port_irqs, counts.ticks, counts.press, counts.release, counts.long_press);
+    /* One interrupt per transition, the rest is ticks */
+    CHECK(counts.port_irqs == (2U * PRESSES));
+    CHECK((counts.press == PRESSES) && (counts.release == PRESSES) && (counts.long_press == 0U));
+    CHECK(counts.raw == 0U);
+    /* The channel stops between edges: about the bounce plus the stable time each */
+    CHECK(counts.ticks <= (2U * PRESSES * ((STABLE_US / DEBOUNCE_TICK_US) + 6U)));
+    CHECK(DEBOUNCE_IsPressed(BUTTON1) == 0U);
+}
+
+static void test_filtered(void)
+{
+    uint64_t t0;
+
+    counts = (counts_t){ 0U };
+    CHECK(DEBOUNCE_AddPin(&(Debounce_PinConfig_t){ BUTTON2, 0U, FILTER_STABLE_US, FILTER_LONG_MS }) == ARM_DRIVER_OK);
+    CHECK((IP_PORTC->DFER & (1UL << 13)) != 0U);
+    CHECK(IP_PORTC->DFWR == DEBOUNCE_FILTER_WIDTH);
+
+    /* Held past the long press time */
+    SIM_SetPinInput(2U, 13U, 1U);
+    t0 = SIM_Now();
+    SIM_Advance(1U * MS);
+    CHECK((counts.press == 1U) && (DEBOUNCE_IsPressed(BUTTON2) == 1U));
+    SIM_Advance(400U * MS);
+    CHECK(counts.long_press == 1U);
+    CHECK((counts.last_ns >= (t0 + (FILTER_LONG_MS * MS))) && (counts.last_ns <= (t0 + ((FILTER_LONG_MS + 2U) * MS))));
+    SIM_SetPinInput(2U, 13U, 0U);
+    SIM_Advance(50U * MS);
+
+    /* A short press: no long press */
+    SIM_SetPinInput(2U, 13U, 1U);
+    SIM_Advance(100U * MS);
+    SIM_SetPinInput(2U, 13U, 0U);
+    SIM_Advance(50U * MS);
+
+    printf("filtered: %u PORT interrupts, press %u release %u long %u\n",
+           counts.port_irqs, counts.press, counts.release, counts.long_press);
+    CHECK(counts.port_irqs == 4U);
+    CHECK((counts.press == 2U) && (counts.release == 2U) && (counts.long_press == 1U));
+    CHECK(DEBOUNCE_IsPressed(BUTTON2) == 0U);
+}
+
+int main(void)
+{
+    SIM_Init();
+    __enable_irq();
+    SIM_SCG_SetCrystalPresent(true);
+    SOSC_init_8MHz();
+    SPLL_init_160MHz();
+    NormalRUNmode_80MHz();
+    SIM_SetPinInput(2U, 12U, 0U);
+    SIM_SetPinInput(2U, 13U, 0U);
+    CHECK(IRQ_Install(PORTC_IRQn, counting_port) == ARM_DRIVER_OK);
+    CHECK(IRQ_Install(LPIT0_Ch1_IRQn, counting_tick) == ARM_DRIVER_OK);
+
+    test_raw();
+    CHECK(DEBOUNCE_Init(on_event) == ARM_DRIVER_OK);
+    test_sampled();
+    test_filtered();
+
+    printf("%s\n", (failures == 0) ? "PASS" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
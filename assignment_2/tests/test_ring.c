@@ -0,0 +1,207 @@
+/*
+ * Host stress test and throughput benchmark of driver_ring: producer and
+ * consumer threads check that every element arrives once, in order per
+ * producer, through Push/Pop and through the spans.
+ *
+ *   gcc -O2 -Wall -Wextra -DHOST_SIM -pthread -Iinclude -I../common/include \
+ *       tests/test_ring.c ../common/src/driver_ring.c src/host_sim.c -o test_ring && ./test_ring
+ *
+ * On a single core the threads take turns: the sched_yield() calls on a
+ * full or empty ring keep that from turning into spinning for a time slice.
+ */
+#include "driver_ring.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+
+#define TEST_COUNT          1024U
+#define TEST_ITEMS          2000000UL
+#define TEST_PRODUCERS      4U
+#define TEST_BATCH          7U      /* odd on purpose: pushes straddle the wrap */
+
+static uint32_t storage[TEST_COUNT];
+static Ring_t ring;
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static double now_s(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + ((double)t.tv_nsec * 1e-9);
+}
+
+/* Element: producer << 24 | sequence */
+static void *producer_push(void *arg)
+{
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+    uint32_t items = TEST_ITEMS / ((ring.mode == RING_MPSC) ? TEST_PRODUCERS : 1U);
+    uint32_t batch[TEST_BATCH];
+    uint32_t seq = 0U;
+
+    while (seq < items)
+    {
+        uint32_t n = ((items - seq) < TEST_BATCH) ? (items - seq) : TEST_BATCH;
+        uint32_t done;
+
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            batch[i] = (id << 24) | (seq + i);
+        }
+        done = RING_Push(&ring, batch, n);
+        /* Re-sent from the first element that did not fit */
+        seq += done;
+        if (done < n)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *producer_span(void *arg)
+{
+    uint32_t seq = 0U;
+
+    (void)arg;
+    while (seq < TEST_ITEMS)
+    {
+        void *span;
+        uint32_t n = RING_WriteSpan(&ring, &span);
+
+        if (n == 0U)
+        {
+            sched_yield();
+            continue;
+        }
+        if (n > (TEST_ITEMS - seq))
+        {
+            n = TEST_ITEMS - seq;
+        }
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            ((uint32_t *)span)[i] = seq + i;
+        }
+        RING_WriteCommit(&ring, n);
+        seq += n;
+    }
+    return NULL;
+}
+
+/* Consumer: next expected sequence per producer */
+static void consume(uint32_t producers, int spans)
+{
+    uint32_t next[TEST_PRODUCERS] = { 0U };
+    uint32_t total = 0U;
+    uint32_t buf[TEST_BATCH];
+
+    while (total < TEST_ITEMS)
+    {
+        const void *span;
+        const uint32_t *p = buf;
+        uint32_t n;
+
+        if (spans)
+        {
+            n = RING_ReadSpan(&ring, &span);
+            p = span;
+        }
+        else
+        {
+            n = RING_Pop(&ring, buf, TEST_BATCH);
+        }
+        if (n == 0U)
+        {
+            sched_yield();
+            continue;
+        }
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            uint32_t id = p[i] >> 24;
+
+            if ((id >= producers) || ((p[i] & 0xFFFFFFU) != next[id]))
+            {
+                printf("FAIL: element %lu is 0x%08x, producer %u expected %u\n",
+                       (unsigned long)total + i, p[i], id, (id < producers) ? next[id] : 0U);
+                failures++;
+                return;
+            }
+            next[id]++;
+        }
+        if (spans)
+        {
+            RING_ReadRelease(&ring, n);
+        }
+        total += n;
+    }
+    CHECK(RING_Count(&ring) == 0U);
+}
+
+static void run(const char *name, Ring_Mode_t mode, uint32_t producers, void *(*fn)(void *), int spans)
+{
+    pthread_t th[TEST_PRODUCERS];
+    double t0;
+    double t1;
+
+    CHECK(RING_Init(&ring, storage, TEST_COUNT, sizeof(uint32_t), mode) == ARM_DRIVER_OK);
+    t0 = now_s();
+    for (uint32_t i = 0U; i < producers; i++)
+    {
+        pthread_create(&th[i], NULL, fn, (void *)(uintptr_t)i);
+    }
+    consume(producers, spans);
+    for (uint32_t i = 0U; i < producers; i++)
+    {
+        pthread_join(th[i], NULL);
+    }
+    t1 = now_s();
+    printf("%-26s %8.1f Melem/s\n", name, ((double)TEST_ITEMS / (t1 - t0)) * 1e-6);
+}
+
+/* One thread, no contention: the cost of the calls themselves */
+static void bench_single(const char *name, Ring_Mode_t mode, uint32_t batch)
+{
+    static uint32_t buf[64];
+    uint32_t rounds = 20000000U / batch;
+    uint64_t sum = 0U;
+    double t0;
+    double t1;
+
+    RING_Init(&ring, storage, TEST_COUNT, sizeof(uint32_t), mode);
+    t0 = now_s();
+    for (uint32_t r = 0U; r < rounds; r++)
+    {
+        buf[0] = r;
+        RING_Push(&ring, buf, batch);
+        RING_Pop(&ring, buf, batch);
+        sum += buf[0];
+    }
+    t1 = now_s();
+    CHECK(sum == (((uint64_t)rounds * (rounds - 1U)) / 2U));
+    printf("%-26s %8.2f ns/elem\n", name, ((t1 - t0) * 1e9) / ((double)rounds * batch));
+}
+
+int main(void)
+{
+    run("SPSC push/pop", RING_SPSC, 1U, producer_push, 0);
+    run("SPSC spans", RING_SPSC, 1U, producer_span, 1);
+    run("MPSC 4 producers", RING_MPSC, TEST_PRODUCERS, producer_push, 0);
+    run("MPSC 4 producers, spans", RING_MPSC, TEST_PRODUCERS, producer_push, 1);
+
+    bench_single("SPSC 1 elem, 1 thread", RING_SPSC, 1U);
+    bench_single("SPSC 64 elem, 1 thread", RING_SPSC, 64U);
+    bench_single("MPSC 1 elem, 1 thread", RING_MPSC, 1U);
+    bench_single("MPSC 64 elem, 1 thread", RING_MPSC, 64U);
+
+    printf("%s\n", (failures == 0) ? "PASS" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+/*
+ * Host test and benchmark of driver_swtimer on the simulated LPIT0.
+ *
+ *  - 250 random one-shot and periodic timers, some deferred, some cancelled,
+ *    run for 1 s: every callback on time, none early, none for a cancelled
+ *    timer, one deadline interrupt per expiry.
+ *  - A 1 s timer and SWTIMER_NowUs() on a 22.5 MHz LPIT clock: a whole
+ *    number of ticks per microsecond would make it 2.2 % short.
+ *  - Start, stop and expiry cost in host cycles (rdtsc) for 10 to 10k running
+ *    timers, with the register traps off: O(log n) shows as a slow climb.
+ *
+ *   gcc -O2 -Wall -Wextra -DHOST_SIM -DSWTIMER_MAX_TIMERS=10000 -Iinclude -I../common/include \
+ *       tests/test_swtimer.c src/host_sim.c src/driver_swtimer.c src/driver_clock.c \
+ *       src/driver_irq.c src/clocks_and_modes.c -o test_swtimer && ./test_swtimer
+ */
+#include "driver_swtimer.h"
+#include "driver_irq.h"
+#include "driver_clock.h"
+#include "clocks_and_modes.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_TIMERS         250U
+#define BENCH_TIMERS        10000U
+#define BENCH_ROUNDS        20U
+#define MHZ                 1000000UL
+
+void LPIT0_Ch0_IRQHandler(void);
+
+static SWTimer_t timers[BENCH_TIMERS];
+static uint64_t due[TEST_TIMERS];
+static uint32_t period[TEST_TIMERS];
+static uint32_t fired[TEST_TIMERS];
+static uint32_t early;
+static uint32_t deadline_isrs;
+static uint32_t bench_fired;
+static uint64_t rate_fired_ns;
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static inline uint64_t tsc(void)
+{
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static void counting_isr(void)
+{
+    deadline_isrs++;
+    LPIT0_Ch0_IRQHandler();
+}
+
+static void on_expiry(void *arg)
+{
+    uint32_t i = (uint32_t)(uintptr_t)arg;
+
+    if (SWTIMER_NowUs() < (due[i] + ((uint64_t)period[i] * fired[i])))
+    {
+        early++;
+    }
+    fired[i]++;
+}
+
+static void test_random(void)
+{
+    uint32_t expected = 0U;
+    uint32_t got = 0U;
+    uint32_t deferred = 0U;
+    uint64_t t0;
+    uint64_t end;
+
+    IRQ_Install(LPIT0_Ch0_IRQn, counting_isr);
+    srand(1);
+    t0 = SWTIMER_NowUs();
+    for (uint32_t i = 0U; i < TEST_TIMERS; i++)
+    {
+        uint32_t delay = 1000U + ((uint32_t)rand() % 500000U);
+
+        period[i] = ((i % 3U) == 0U) ? (5000U + ((uint32_t)rand() % 100000U)) : 0U;
+        due[i] = t0 + delay;
+        SWTIMER_Setup(&timers[i], on_expiry, (void *)(uintptr_t)i, ((i % 5U) == 0U) ? SWTIMER_FLAG_DEFERRED : 0U);
+        CHECK(SWTIMER_Start(&timers[i], delay, period[i]) == ARM_DRIVER_OK);
+    }
+    /* Cancel every 7th one-shot */
+    for (uint32_t i = 1U; i < TEST_TIMERS; i += 7U)
+    {
+        if (period[i] == 0U)
+        {
+            SWTIMER_Stop(&timers[i]);
+        }
+    }
+
+    for (uint32_t ms = 0U; ms < 1000U; ms++)
+    {
+        SIM_Advance(1000000ULL);
+        deferred += SWTIMER_Process();
+    }
+    end = SWTIMER_NowUs();
+
+    for (uint32_t i = 0U; i < TEST_TIMERS; i++)
+    {
+        bool cancelled = ((i % 7U) == 1U) && (period[i] == 0U);
+        /* A deferred callback may still be waiting for the next SWTIMER_Process() */
+        uint32_t e = cancelled ? 0U : ((period[i] != 0U) ? (uint32_t)(((end - due[i]) / period[i]) + 1U) : 1U);
+
+        CHECK((fired[i] == e) || ((fired[i] + 1U) == e));
+        expected += e;
+        got += fired[i];
+        SWTIMER_Stop(&timers[i]);
+    }
+    CHECK(early == 0U);
+    printf("%u timers, 1 s: %u callbacks (%u expected, %u deferred), %u early, %u deadline interrupts\n",
+           TEST_TIMERS, got, expected, deferred, early, deadline_isrs);
+    CHECK(deadline_isrs <= got);
+    IRQ_Restore(LPIT0_Ch0_IRQn);
+}
+
+static void on_rate(void *arg)
+{
+    (void)arg;
+    rate_fired_ns = SIM_Now();
+}
+
+static void test_rate(void)
+{
+    /* SPLL 90 MHz, SPLLDIV2 /4 feeds the LPIT */
+    static const Clock_Target_t fractional = { CLOCK_MODE_RUN, 45U * MHZ, 22500000UL, 15U * MHZ, 45U * MHZ, 22500000UL };
+    static const Clock_Target_t run80 = { CLOCK_MODE_RUN, 80U * MHZ, 40U * MHZ, 26666667UL, 80U * MHZ, 40U * MHZ };
+    SWTimer_t timer;
+    uint64_t t0;
+    uint64_t us0;
+    uint64_t late;
+    int64_t drift;
+    uint32_t freq;
+
+    CHECK(CLOCK_SetTarget(&fractional) == ARM_DRIVER_OK);
+    freq = PCC_GetFunctionalClockFreq(PCC_LPIT_INDEX);
+    CHECK((freq % MHZ) != 0U);
+
+    SWTIMER_Setup(&timer, on_rate, NULL, 0U);
+    t0 = SIM_Now();
+    us0 = SWTIMER_NowUs();
+    CHECK(SWTIMER_Start(&timer, 1000000U, 0U) == ARM_DRIVER_OK);
+    for (uint32_t step = 0U; (step < 11000U) && (rate_fired_ns == 0U); step++)
+    {
+        SIM_Advance(100000ULL);
+    }
+    late = rate_fired_ns - t0 - 1000000000ULL;
+    drift = (int64_t)(SWTIMER_NowUs() - us0) - (int64_t)((SIM_Now() - t0) / 1000U);
+
+    /* Not early, and late by no more than one 100 us step */
+    CHECK((rate_fired_ns >= (t0 + 1000000000ULL)) && (late <= 100000U));
+    CHECK((drift >= -1) && (drift <= 1));
+    printf("LPIT %u Hz: 1 s timer fired %llu ns late, SWTIMER_NowUs() off by %lld us\n",
+           freq, (unsigned long long)late, (long long)drift);
+    CHECK(CLOCK_SetTarget(&run80) == ARM_DRIVER_OK);
+}
+
+static void on_bench(void *arg)
+{
+    (void)arg;
+    bench_fired++;
+}
+
+/* The timebase counts down from 0xFFFFFFFF: CVAL holds ~ticks. Hooks off, so plain memory */
+static void set_ticks(uint64_t ticks)
+{
+    *(volatile uint32_t *)&IP_LPIT0->TMR[SWTIMER_TIMEBASE_CHANNEL + 1U].CVAL = ~(uint32_t)(ticks >> 32);
+    *(volatile uint32_t *)&IP_LPIT0->TMR[SWTIMER_TIMEBASE_CHANNEL].CVAL = ~(uint32_t)ticks;
+}
+
+static void bench(uint32_t n)
+{
+    static uint32_t delay[BENCH_TIMERS];
+    double start = 0.0;
+    double stop = 0.0;
+    double expire = 0.0;
+
+    srand(n);
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        delay[i] = 1U + ((uint32_t)rand() % 1000000U);
+        SWTIMER_Setup(&timers[i], on_bench, NULL, 0U);
+    }
+    for (uint32_t r = 0U; r < BENCH_ROUNDS; r++)
+    {
+        uint64_t t;
+
+        set_ticks(0U);
+        t = tsc();
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            SWTIMER_Start(&timers[i], delay[i], 0U);
+        }
+        start += (double)(tsc() - t) / n;
+
+        /* Every other timer, in scattered heap positions */
+        t = tsc();
+        for (uint32_t i = 0U; i < n; i += 2U)
+        {
+            SWTIMER_Stop(&timers[(i * 7919U) % n]);
+        }
+        stop += (double)(tsc() - t) / ((n + 1U) / 2U);
+
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            if (!SWTIMER_IsRunning(&timers[i]))
+            {
+                SWTIMER_Start(&timers[i], delay[i], 0U);
+            }
+        }
+        /* Past every deadline: one interrupt expires them all */
+        bench_fired = 0U;
+        set_ticks(2000000ULL * 40U);
+        t = tsc();
+        LPIT0_Ch0_IRQHandler();
+        expire += (double)(tsc() - t) / n;
+        CHECK(bench_fired == n);
+    }
+    printf("%6u timers: start %6.1f  stop %6.1f  expire %6.1f  cycles/op\n",
+           n, start / BENCH_ROUNDS, stop / BENCH_ROUNDS, expire / BENCH_ROUNDS);
+}
+
+int main(void)
+{
+    SIM_Init();
+    __enable_irq();
+    SIM_SCG_SetCrystalPresent(true);
+    SOSC_init_8MHz();
+    SPLL_init_160MHz();
+    NormalRUNmode_80MHz();
+    CHECK(SWTIMER_Init() == ARM_DRIVER_OK);
+
+    test_random();
+    test_rate();
+
+    SIM_SetHooks(false);
+    bench(10U);
+    bench(100U);
+    bench(1000U);
+    bench(BENCH_TIMERS);
+
+    printf("%s\n", (failures == 0) ? "PASS" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
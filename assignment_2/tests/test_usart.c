@@ -0,0 +1,288 @@
+/*
+ * Host test of the interrupt-driven LPUART transmit path against the
+ * simulated LPUART1: byte order, events, progress counters, and the CPU
+ * time the caller and the ISR spend per byte. Then the eDMA receive path:
+ * single buffer, ping-pong halves and wrap, and a short frame closed by
+ * the idle line.
+ *
+ *   gcc -O2 -Wall -Wextra -DHOST_SIM -Iinclude -I../common/include tests/test_usart.c src/host_sim.c \
+ *       src/driver_usart.c src/driver_port.c src/driver_log.c src/driver_clock.c \
+ *       src/driver_profile.c ../common/src/driver_ring.c src/driver_irq.c src/clocks_and_modes.c \
+ *       -o test_usart && ./test_usart
+ *
+ * CPU time is virtual: every trapped register access costs
+ * SIM_SetAccessTime() ns, so a driver that polls TDRE/TC for the whole frame
+ * shows up as the frame time, not as a handful of accesses.
+ */
+#include "driver_usart.h"
+#include "clocks_and_modes.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_ACCESS_NS      10U
+#define TEST_FRAME_NS       (10ULL * 1000000000ULL / 9600U)     /* 8N1 at 9600 baud */
+
+extern ARM_DRIVER_USART Driver_USART0;
+
+static uint32_t events[2];      /* SEND_COMPLETE, TX_COMPLETE */
+static uint32_t event_order;    /* 1 if SEND_COMPLETE came first */
+static uint32_t rx_events[2];   /* RECEIVE_COMPLETE, RX_TIMEOUT */
+static uint32_t rx_count_at[2]; /* GetRxCount() in the last of each */
+static uint8_t *rx_buf;         /* DMA target, SIM_SramAlloc(): DMA addresses are 32-bit */
+static uint32_t isr_accesses;
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static void on_event(uint32_t event)
+{
+    if (event & ARM_USART_EVENT_SEND_COMPLETE)
+    {
+        events[0]++;
+    }
+    if (event & ARM_USART_EVENT_TX_COMPLETE)
+    {
+        event_order = (events[0] != 0U) ? 1U : 0U;
+        events[1]++;
+    }
+    if (event & ARM_USART_EVENT_RECEIVE_COMPLETE)
+    {
+        rx_count_at[0] = Driver_USART0.GetRxCount();
+        rx_events[0]++;
+    }
+    if (event & ARM_USART_EVENT_RX_TIMEOUT)
+    {
+        rx_count_at[1] = Driver_USART0.GetRxCount();
+        rx_events[1]++;
+    }
+}
+
+/* Advance until the line has carried n bytes, into out */
+static uint32_t collect(uint8_t *out, uint32_t n)
+{
+    uint32_t got = 0U;
+
+    for (uint32_t i = 0U; (i < (4U * n) + 4U) && (got < n); i++)
+    {
+        SIM_Advance(TEST_FRAME_NS);
+        got += SIM_LPUART_ReadTx(1, &out[got], n - got);
+    }
+    return got;
+}
+
+static void test_send(void)
+{
+    static uint8_t tx[256];
+    static uint8_t rx[256];
+    uint64_t t0;
+    uint32_t a0;
+    uint32_t got;
+
+    for (uint32_t i = 0U; i < sizeof(tx); i++)
+    {
+        tx[i] = (uint8_t)(i * 7U);
+    }
+    memset(events, 0, sizeof(events));
+
+    /* The call only arms the transmitter */
+    t0 = SIM_Now();
+    a0 = SIM_GetAccessCount();
+    CHECK(Driver_USART0.Send(tx, sizeof(tx)) == ARM_DRIVER_OK);
+    printf("Send(256): %llu ns, %u register accesses in the call (frame: %llu ns)\n",
+           (unsigned long long)(SIM_Now() - t0), SIM_GetAccessCount() - a0,
+           (unsigned long long)TEST_FRAME_NS);
+    CHECK((SIM_Now() - t0) < TEST_FRAME_NS);
+    CHECK(Driver_USART0.GetStatus().tx_busy == 1U);
+    CHECK(Driver_USART0.Send(tx, 1U) == ARM_DRIVER_ERROR_BUSY);
+
+    /* Progress while the ISR drains */
+    SIM_Advance(TEST_FRAME_NS * 10U);
+    CHECK((Driver_USART0.GetTxCount() > 0U) && (Driver_USART0.GetTxCount() < sizeof(tx)));
+
+    a0 = SIM_GetAccessCount();
+    got = SIM_LPUART_ReadTx(1, rx, sizeof(rx));
+    got += collect(&rx[got], sizeof(rx) - got);
+    isr_accesses = SIM_GetAccessCount() - a0;
+    SIM_Advance(TEST_FRAME_NS * 2U);
+
+    CHECK(got == sizeof(tx));
+    CHECK(memcmp(rx, tx, sizeof(tx)) == 0);
+    CHECK(Driver_USART0.GetTxCount() == sizeof(tx));
+    CHECK(Driver_USART0.GetStatus().tx_busy == 0U);
+    CHECK((events[0] == 1U) && (events[1] == 1U) && (event_order == 1U));
+    printf("ISR: %.1f register accesses per byte\n", (double)isr_accesses / (double)sizeof(tx));
+    /* TDRE check + DATA write per byte, plus entry overhead: no polling */
+    CHECK(isr_accesses < (8U * sizeof(tx)));
+}
+
+/* Send followed by queued USART_Write bytes: the queue goes out after the Send */
+static void test_ring_order(void)
+{
+    static uint8_t storage[64];
+    static Ring_t ring;
+    static const uint8_t first[] = "send:";
+    static const uint8_t queued[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    uint8_t rx[64];
+    uint32_t got;
+
+    CHECK(RING_Init(&ring, storage, sizeof(storage), 1U, RING_MPSC) == ARM_DRIVER_OK);
+    CHECK(USART_SetRings(NULL, &ring) == ARM_DRIVER_OK);
+
+    CHECK(Driver_USART0.Send(first, sizeof(first) - 1U) == ARM_DRIVER_OK);
+    CHECK(USART_Write(queued, 10U) == 10U);
+    SIM_Advance(TEST_FRAME_NS * 3U);
+    CHECK(USART_Write(&queued[10], sizeof(queued) - 11U) == (sizeof(queued) - 11U));
+
+    got = collect(rx, sizeof(first) + sizeof(queued) - 2U);
+    CHECK(got == (sizeof(first) + sizeof(queued) - 2U));
+    CHECK(memcmp(rx, first, sizeof(first) - 1U) == 0);
+    CHECK(memcmp(&rx[sizeof(first) - 1U], queued, sizeof(queued) - 1U) == 0);
+    CHECK(USART_SetRings(NULL, NULL) == ARM_DRIVER_OK);
+}
+
+/* USART_Write after SEND_COMPLETE but before TC: the Send ends once, the ring still drains */
+static void test_write_before_tc(void)
+{
+    static uint8_t storage[64];
+    static Ring_t ring;
+    static const uint8_t first[] = "send:";
+    static const uint8_t queued[] = "queued";
+    uint8_t rx[32];
+    uint32_t got;
+
+    CHECK(RING_Init(&ring, storage, sizeof(storage), 1U, RING_MPSC) == ARM_DRIVER_OK);
+    CHECK(USART_SetRings(NULL, &ring) == ARM_DRIVER_OK);
+    memset(events, 0, sizeof(events));
+
+    CHECK(Driver_USART0.Send(first, sizeof(first) - 1U) == ARM_DRIVER_OK);
+    for (uint32_t i = 0U; (i < 200U) && (events[0] == 0U); i++)
+    {
+        SIM_Advance(TEST_FRAME_NS / 10U);
+    }
+    CHECK((events[0] == 1U) && (Driver_USART0.GetStatus().tx_busy == 1U));
+    CHECK(USART_Write(queued, sizeof(queued) - 1U) == (sizeof(queued) - 1U));
+
+    got = collect(rx, sizeof(first) + sizeof(queued) - 2U);
+    SIM_Advance(TEST_FRAME_NS * 2U);
+    CHECK(got == (sizeof(first) + sizeof(queued) - 2U));
+    CHECK(memcmp(rx, first, sizeof(first) - 1U) == 0);
+    CHECK(memcmp(&rx[sizeof(first) - 1U], queued, sizeof(queued) - 1U) == 0);
+    CHECK((events[0] == 1U) && (events[1] == 1U));
+    CHECK(Driver_USART0.GetStatus().tx_busy == 0U);
+    CHECK(USART_SetRings(NULL, NULL) == ARM_DRIVER_OK);
+}
+
+/* Feed n bytes to the receiver and let the line go idle */
+static void receive_bytes(const uint8_t *data, uint32_t n)
+{
+    memset(rx_events, 0, sizeof(rx_events));
+    SIM_LPUART_WriteRx(1, data, n);
+    SIM_Advance(TEST_FRAME_NS * (n + 4U));
+}
+
+/* Single-buffer DMA: RECEIVE_COMPLETE once the buffer is full, then the channel stops */
+static void test_receive_dma(void)
+{
+    static const uint8_t frame[] = "0123456789abcdef";
+    uint8_t *buf = rx_buf;
+
+    memset(buf, 0, 16U);
+    CHECK(Driver_USART0.Control(ARM_USART_CONTROL_RX_DMA, ARM_USART_RX_DMA_SINGLE) == ARM_DRIVER_OK);
+    CHECK(Driver_USART0.Receive(buf, 16U) == ARM_DRIVER_OK);
+    CHECK(Driver_USART0.GetStatus().rx_busy == 1U);
+    CHECK(Driver_USART0.Receive(buf, 16U) == ARM_DRIVER_ERROR_BUSY);
+
+    receive_bytes(frame, 16U);
+    CHECK((rx_events[0] == 1U) && (rx_events[1] == 0U));
+    CHECK(rx_count_at[0] == 16U);
+    CHECK(Driver_USART0.GetRxCount() == 16U);
+    CHECK(Driver_USART0.GetStatus().rx_busy == 0U);
+    CHECK(memcmp(buf, frame, 16U) == 0);
+}
+
+/* Ping-pong: RECEIVE_COMPLETE at each half, GetRxCount() in the callback tells which */
+static void test_receive_pingpong(void)
+{
+    static const uint8_t frame[] = "0123456789abcdefghijklmnopqrst";
+    uint8_t *buf = rx_buf;
+
+    memset(buf, 0, 16U);
+    CHECK(Driver_USART0.Control(ARM_USART_CONTROL_RX_DMA, ARM_USART_RX_DMA_PINGPONG) == ARM_DRIVER_OK);
+    CHECK(Driver_USART0.Receive(buf, 15U) == ARM_DRIVER_ERROR_PARAMETER);
+    CHECK(Driver_USART0.Receive(buf, 16U) == ARM_DRIVER_OK);
+
+    /* First half */
+    receive_bytes(frame, 8U);
+    CHECK(rx_events[0] == 1U);
+    CHECK(rx_count_at[0] >= 8U);
+    CHECK(memcmp(buf, frame, 8U) == 0);
+
+    /* Second half: CITER reloads, the count drops below the half */
+    receive_bytes(&frame[8], 8U);
+    CHECK(rx_events[0] == 1U);
+    CHECK(rx_count_at[0] < 8U);
+    CHECK(memcmp(&buf[8], &frame[8], 8U) == 0);
+    CHECK(Driver_USART0.GetStatus().rx_busy == 1U);
+
+    /* The channel wraps to the start of the buffer */
+    receive_bytes(&frame[16], 4U);
+    CHECK(rx_events[0] == 0U);
+    CHECK(Driver_USART0.GetRxCount() == 4U);
+    CHECK(memcmp(buf, &frame[16], 4U) == 0);
+    CHECK(memcmp(&buf[4], &frame[4], 12U) == 0);
+
+    CHECK(Driver_USART0.Control(ARM_USART_ABORT_RECEIVE, 0U) == ARM_DRIVER_OK);
+    CHECK(Driver_USART0.GetStatus().rx_busy == 0U);
+}
+
+/* A frame shorter than the buffer: the idle line ends it with RX_TIMEOUT */
+static void test_receive_timeout(void)
+{
+    static const uint8_t frame[] = "short";
+    uint8_t *buf = rx_buf;
+
+    memset(buf, 0, 16U);
+    CHECK(Driver_USART0.Control(ARM_USART_CONTROL_RX_DMA, ARM_USART_RX_DMA_SINGLE) == ARM_DRIVER_OK);
+    CHECK(Driver_USART0.Receive(buf, 16U) == ARM_DRIVER_OK);
+
+    receive_bytes(frame, sizeof(frame) - 1U);
+    CHECK((rx_events[0] == 0U) && (rx_events[1] == 1U));
+    CHECK(rx_count_at[1] == (sizeof(frame) - 1U));
+    CHECK(memcmp(buf, frame, sizeof(frame) - 1U) == 0);
+
+    /* Abort latches the partial count */
+    CHECK(Driver_USART0.Control(ARM_USART_ABORT_RECEIVE, 0U) == ARM_DRIVER_OK);
+    CHECK(Driver_USART0.GetRxCount() == (sizeof(frame) - 1U));
+    CHECK(Driver_USART0.Control(ARM_USART_CONTROL_RX_DMA, ARM_USART_RX_DMA_DISABLED) == ARM_DRIVER_OK);
+}
+
+int main(void)
+{
+    SIM_Init();
+    SIM_SetAccessTime(TEST_ACCESS_NS);
+    SIM_SCG_SetCrystalPresent(true);
+    SOSC_init_8MHz();
+
+    CHECK(Driver_USART0.Initialize(on_event) == ARM_DRIVER_OK);
+    CHECK(Driver_USART0.PowerControl(ARM_POWER_FULL) == ARM_DRIVER_OK);
+    CHECK(Driver_USART0.Control(ARM_USART_MODE_ASYNCHRONOUS, 9600U) == ARM_DRIVER_OK);
+    CHECK(Driver_USART0.Control(ARM_USART_CONTROL_TX, 1U) == ARM_DRIVER_OK);
+
+    test_send();
+    test_ring_order();
+    test_write_before_tc();
+    rx_buf = SIM_SramAlloc(16U);
+    test_receive_dma();
+    test_receive_pingpong();
+    test_receive_timeout();
+
+    Driver_USART0.Uninitialize();
+    printf("%s\n", (failures == 0) ? "PASS" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/*
+ * Host unit test of USART_CalcBaudReg() over every LPUART functional clock
+ * the SCG DIV2 outputs can give (SIRC 2/8 MHz, SOSC 8 MHz, FIRC 48 MHz,
+ * SPLL 112/160 MHz, each divided by 1..64) and the standard rates up to
+ * 2 Mbaud, against an exhaustive search of OSR 4..32 x SBR 1..8191.
+ *
+ *   gcc -O2 -Wall -Wextra -DHOST_SIM -Iinclude -I../common/include tests/test_usart_baud.c src/host_sim.c \
+ *       src/driver_usart.c src/driver_port.c src/driver_log.c src/driver_clock.c \
+ *       src/driver_profile.c ../common/src/driver_ring.c src/driver_irq.c src/clocks_and_modes.c \
+ *       -o test_usart_baud && ./test_usart_baud
+ */
+#include "driver_usart.h"
+#include <stdio.h>
+
+static const uint32_t sources[] = { 2000000U, 8000000U, 48000000U, 112000000U, 160000000U };
+static const uint32_t rates[] = {
+    300U, 600U, 1200U, 2400U, 4800U, 9600U, 14400U, 19200U, 38400U, 57600U,
+    115200U, 230400U, 460800U, 500000U, 921600U, 1000000U, 1500000U, 2000000U
+};
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+/* |clk / (osr * sbr) - baud| as num / den */
+static void baud_error(uint32_t clk, uint32_t baud, uint64_t osr, uint64_t sbr, uint64_t *num, uint64_t *den)
+{
+    uint64_t div = (uint64_t)baud * osr * sbr;
+
+    *num = (clk > div) ? (clk - div) : (div - clk);
+    *den = osr * sbr;
+}
+
+/* Smallest error over every divisor */
+static void best_error(uint32_t clk, uint32_t baud, uint64_t *best_num, uint64_t *best_den)
+{
+    *best_num = UINT64_MAX;
+    *best_den = 1U;
+    for (uint64_t osr = 4U; osr <= 32U; osr++)
+    {
+        for (uint64_t sbr = 1U; sbr <= LPUART_BAUD_SBR_MASK; sbr++)
+        {
+            uint64_t num;
+            uint64_t den;
+
+            baud_error(clk, baud, osr, sbr, &num, &den);
+            if ((*best_num == UINT64_MAX) || ((num * *best_den) < (*best_num * den)))
+            {
+                *best_num = num;
+                *best_den = den;
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    uint32_t pairs = 0U;
+    uint32_t supported = 0U;
+    double worst = 0.0;
+
+    for (uint32_t s = 0U; s < (sizeof(sources) / sizeof(sources[0])); s++)
+    {
+        for (uint32_t div = 1U; div <= 64U; div <<= 1)
+        {
+            uint32_t clk = sources[s] / div;
+
+            for (uint32_t r = 0U; r < (sizeof(rates) / sizeof(rates[0])); r++)
+            {
+                uint32_t baud = rates[r];
+                uint32_t reg = 0xDEADBEEFU;
+                uint64_t ref_num, ref_den, num, den;
+                int32_t status = USART_CalcBaudReg(clk, baud, &reg);
+                bool in_tol;
+
+                best_error(clk, baud, &ref_num, &ref_den);
+                in_tol = (ref_num * 1000U) <= ((uint64_t)baud * ARM_USART_BAUD_TOLERANCE_PERMILLE * ref_den);
+                pairs++;
+
+                if (!in_tol)
+                {
+                    CHECK(status == ARM_USART_ERROR_BAUDRATE);
+                    continue;
+                }
+                CHECK(status == ARM_DRIVER_OK);
+                if (status != ARM_DRIVER_OK)
+                {
+                    printf("  clk %u baud %u\n", clk, baud);
+                    continue;
+                }
+                supported++;
+
+                uint32_t osr = ((reg & LPUART_BAUD_OSR_MASK) >> LPUART_BAUD_OSR_SHIFT) + 1U;
+                uint32_t sbr = reg & LPUART_BAUD_SBR_MASK;
+
+                /* Only the divisor fields, a legal OSR, BOTHEDGE below 8 */
+                CHECK((reg & ~(LPUART_BAUD_OSR_MASK | LPUART_BAUD_SBR_MASK | LPUART_BAUD_BOTHEDGE_MASK)) == 0U);
+                CHECK((osr >= 4U) && (sbr >= 1U));
+                CHECK(((reg & LPUART_BAUD_BOTHEDGE_MASK) != 0U) == (osr < 8U));
+
+                /* As close as the exhaustive search gets */
+                baud_error(clk, baud, osr, sbr, &num, &den);
+                CHECK((num * ref_den) == (ref_num * den));
+                if ((num * ref_den) != (ref_num * den))
+                {
+                    printf("  clk %u baud %u: OSR %u SBR %u\n", clk, baud, osr, sbr);
+                }
+                if (((double)num / (double)den / baud) > worst)
+                {
+                    worst = (double)num / (double)den / baud;
+                }
+            }
+        }
+    }
+
+    /* Degenerate arguments */
+    {
+        uint32_t reg;
+
+        CHECK(USART_CalcBaudReg(0U, 9600U, &reg) == ARM_USART_ERROR_BAUDRATE);
+        CHECK(USART_CalcBaudReg(8000000U, 0U, &reg) == ARM_USART_ERROR_BAUDRATE);
+        CHECK(USART_CalcBaudReg(8000000U, 9600U, NULL) == ARM_USART_ERROR_BAUDRATE);
+        /* Exact divisor: no error, highest OSR among the exact ones */
+        CHECK(USART_CalcBaudReg(8000000U, 250000U, &reg) == ARM_DRIVER_OK);
+        CHECK(reg == (LPUART_BAUD_OSR(31U) | LPUART_BAUD_SBR(1U)));
+    }
+
+    printf("%u clock/baud pairs, %u within %u permille, worst accepted error %.3f %%\n",
+           pairs, supported, ARM_USART_BAUD_TOLERANCE_PERMILLE, worst * 100.0);
+    printf("%s\n", (failures == 0) ? "PASS" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Render a LOG() stream captured from the UART (format in include/driver_log.h).
+
+    python3 log_decode.py Debug_FLASH/Assignment2.elf capture.bin
+    python3 log_decode.py --hz 80000000 Debug_FLASH/Assignment2.elf < capture.bin
+
+The format strings come from the .log_str section of the ELF that produced
+the capture; a rebuilt ELF may move them. Bytes that do not start a known
+record are skipped one at a time until the stream lines up again.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_SYNC = 0x5
+LOG_MAX_ARGS = 8
+LOG_ID_DROPS = 0xFFFFFF
+CONV = re.compile(r"%[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z|t|j)?([diouxXcp%])")
+
+
+def log_strings(path):
+    """{ID: format} from the .log_str section of an ELF32 or ELF64 file."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF":
+        raise ValueError("%s: not an ELF file" % path)
+    is64 = elf[4] == 2
+    end = "<" if elf[5] == 1 else ">"
+    if is64:
+        shoff, = struct.unpack_from(end + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", elf, 0x3A)
+        shdr = end + "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(end + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", elf, 0x2E)
+        shdr = end + "IIIIIIIIII"
+    sections = [struct.unpack_from(shdr, elf, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx]
+    for sec in sections:
+        name, addr, offset, size = sec[0], sec[3], sec[4], sec[5]
+        start = names[4] + name
+        if elf[start:elf.index(b"\0", start)] != b".log_str":
+            continue
+        # IDs are addresses; the target links the section at 0
+        data = elf[offset:offset + size]
+        table = {}
+        pos = 0
+        while pos < len(data):
+            nul = data.index(b"\0", pos)
+            table[addr + pos] = data[pos:nul].decode("utf-8", "replace")
+            pos = nul + 1
+        return table
+    raise ValueError("%s: no .log_str section" % path)
+
+
+def render(fmt, args):
+    """printf-style formatting of raw argument words."""
+    it = iter(args)
+
+    def conv(m):
+        if m.group(1) == "%":
+            return "%"
+        word = next(it, 0)
+        spec = m.group(0)
+        spec = re.sub(r"(hh|h|ll|l|z|t|j)", "", spec)
+        if m.group(1) in "di":
+            word -= (word & 0x80000000) << 1
+        if m.group(1) == "p":
+            return "0x%08x" % word
+        if m.group(1) == "c":
+            return chr(word & 0xFF)
+        return spec % word
+
+    return CONV.sub(conv, fmt)
+
+
+def decode(table, stream):
+    """Yield (cycles, text) for each record; skipped bytes come as (None, text)."""
+    pos = 0
+    skipped = 0
+    while pos + 8 <= len(stream):
+        header, cycles = struct.unpack_from("<II", stream, pos)
+        ident, nargs = header >> 8, (header >> 4) & 0xF
+        if ((header & 0xF) != LOG_SYNC or nargs > LOG_MAX_ARGS or
+                not (ident in table or (ident == LOG_ID_DROPS and nargs == 1))):
+            pos += 1
+            skipped += 1
+            continue
+        if pos + 8 + nargs * 4 > len(stream):
+            break
+        if skipped:
+            yield None, "<%d bytes skipped>" % skipped
+            skipped = 0
+        args = struct.unpack_from("<%dI" % nargs, stream, pos + 8)
+        if ident == LOG_ID_DROPS:
+            text = "<%d records dropped>" % args[0]
+        else:
+            text = render(table[ident], args)
+        yield cycles, text
+        pos += 8 + nargs * 4
+    if skipped or pos < len(stream):
+        yield None, "<%d bytes left over>" % (skipped + len(stream) - pos)
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description="Render a LOG() capture.")
+    parser.add_argument("--hz", type=int, help="core clock: timestamps in microseconds instead of cycles")
+    parser.add_argument("elf")
+    parser.add_argument("capture", nargs="?", help="raw UART bytes (default: stdin)")
+    opts = parser.parse_args(argv[1:])
+
+    table = log_strings(opts.elf)
+    if opts.capture:
+        with open(opts.capture, "rb") as f:
+            stream = f.read()
+    else:
+        stream = sys.stdin.buffer.read()
+
+    for cycles, text in decode(table, stream):
+        if cycles is None:
+            print("%12s  %s" % ("", text))
+        elif opts.hz:
+            print("%12.1f  %s" % (cycles * 1e6 / opts.hz, text))
+        else:
+            print("%12d  %s" % (cycles, text))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -1,6 +1,13 @@
 #ifndef DRIVER_COMMON_H_
 #define DRIVER_COMMON_H_
 
+/*
+ * common/ is shared by the S32K144 projects: common/include goes on the
+ * include path after the project's include and Core/Include, common/src on
+ * its source path. HOST_SIM builds take host_sim.h from the host model in
+ * assignment_2/include.
+ */
+
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
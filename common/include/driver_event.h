@@ -0,0 +1,106 @@
+#ifndef DRIVER_EVENT_H_
+#define DRIVER_EVENT_H_
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#include "S32K144.h"
+#ifdef HOST_SIM
+#include "host_sim.h"
+#else
+#include "core_cm4.h"
+#include "system_S32K144.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver_common.h"
+#include "driver_ring.h"
+
+/*
+ * Run-to-completion event loop: interrupt handlers post, main handles.
+ *
+ *  - Each signal is subscribed once, with a handler and a priority
+ *    (0 = most urgent). EVENT_Post() queues {signal, param} on the MPSC ring
+ *    of that priority and returns; it may be called from any ISR or from a
+ *    handler. A full queue drops the event and counts it.
+ *  - EVENT_Run() never returns: it takes the oldest event of the most urgent
+ *    non-empty queue and calls its handler, which runs to completion; handlers
+ *    are never preempted by other handlers. With every queue empty it sleeps
+ *    in WFI. The check and the WFI run with PRIMASK set, so an event posted
+ *    in between wakes the core at once instead of being slept on.
+ *  - Each event carries its post time: the dispatch latency (post to handler
+ *    start) and the share of time spent in WFI are kept in Event_Stats_t,
+ *    in core cycles (DWT CYCCNT; virtual time on the host). Each busy or idle
+ *    stretch must be shorter than 2^32 cycles (53 s at 80 MHz).
+ */
+
+#ifndef EVENT_MAX_SIGNALS
+#define EVENT_MAX_SIGNALS       32U
+#endif
+#ifndef EVENT_PRIORITIES
+#define EVENT_PRIORITIES        4U
+#endif
+/* Per priority, a power of two */
+#ifndef EVENT_QUEUE_LEN
+#define EVENT_QUEUE_LEN         16U
+#endif
+
+typedef void (*Event_Handler_t)(uint32_t signal, uint32_t param);
+
+/**
+\brief Dispatch statistics since EVENT_Init() or EVENT_ResetStats()
+*/
+typedef struct {
+    uint32_t    dispatched;
+    uint32_t    dropped;        ///< Posts that found their queue full
+    uint32_t    latency_min;    ///< Post to handler start, cycles
+    uint32_t    latency_max;
+    uint32_t    latency_avg;
+    uint32_t    idle_permille;  ///< Time in WFI, per mille
+    uint32_t    tick_hz;        ///< Cycles per second (SystemCoreClock)
+} Event_Stats_t;
+
+/**
+  \fn          int32_t EVENT_Init (void)
+  \brief       Empty the queues, drop the subscriptions, start the cycle counter.
+  \return      \ref execution_status
+
+  \fn          int32_t EVENT_Subscribe (uint32_t signal, uint32_t priority, Event_Handler_t handler)
+  \brief       Handle signal at priority (0 = most urgent). Call before posting it.
+  \return      \ref execution_status
+
+  \fn          int32_t EVENT_Post (uint32_t signal, uint32_t param)
+  \brief       Queue an event. Any context. Never waits.
+  \return      \ref execution_status (ARM_DRIVER_ERROR_BUSY when the queue is full,
+               ARM_DRIVER_ERROR_PARAMETER for a signal without a handler)
+
+  \fn          bool EVENT_Dispatch (void)
+  \brief       Run the handler of the most urgent queued event, if any.
+  \return      true if a handler ran
+
+  \fn          void EVENT_Idle (void)
+  \brief       Sleep in WFI unless an event is queued. Returns after the next
+               interrupt.
+
+  \fn          void EVENT_Run (void)
+  \brief       Dispatch forever, sleeping whenever the queues are empty.
+
+  \fn          void EVENT_GetStats (Event_Stats_t *stats)
+  \fn          void EVENT_ResetStats (void)
+*/
+int32_t EVENT_Init(void);
+int32_t EVENT_Subscribe(uint32_t signal, uint32_t priority, Event_Handler_t handler);
+int32_t EVENT_Post(uint32_t signal, uint32_t param);
+bool    EVENT_Dispatch(void);
+void    EVENT_Idle(void);
+void    EVENT_Run(void);
+void    EVENT_GetStats(Event_Stats_t *stats);
+void    EVENT_ResetStats(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_EVENT_H_ */
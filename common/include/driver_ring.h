@@ -0,0 +1,127 @@
+#ifndef DRIVER_RING_H_
+#define DRIVER_RING_H_
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#include "S32K144.h"
+#ifdef HOST_SIM
+#include "host_sim.h"
+#include <stdatomic.h>
+#else
+#include "core_cm4.h"
+#endif
+#include <stdint.h>
+#include "driver_common.h"
+
+/*
+ * Lock-free ring buffer: the handoff between interrupt handlers and main.
+ *
+ *  - The storage is owned by the caller: count elements of elem_size bytes,
+ *    count a power of two. Indices run freely (modulo 2^24) and are masked
+ *    on access, so all count slots are usable.
+ *  - RING_SPSC: one producer, one consumer. The producer owns head and the
+ *    consumer owns tail; each one only reads the other's index, so plain
+ *    loads and stores ordered by barriers are enough.
+ *  - RING_MPSC: any number of producers, for example ISRs at several
+ *    priorities, that may preempt each other; still one consumer. Producers
+ *    claim slots with a compare-and-swap (LDREX/STREX) on a reserve word
+ *    that also counts writers in progress. The writer that brings the count
+ *    back to 0 publishes everything reserved so far, so the consumer never
+ *    sees a slot before it is written, and a producer never waits for one it
+ *    preempted.
+ *  - RING_Push()/RING_Pop() copy up to n elements and return how many were
+ *    moved: a full ring rejects the excess and never overwrites.
+ *    RING_WriteSpan()/RING_ReadSpan() hand out the contiguous run of free or
+ *    filled slots at the index, for zero-copy producers and consumers (DMA,
+ *    in-place parsing); RING_WriteCommit()/RING_ReadRelease() end them.
+ *    Write spans are SPSC only: MPSC producers go through RING_Push().
+ *
+ * Producer and consumer indices sit on separate cache lines on the host
+ * (C11 atomics, threads on several cores). The S32K144 has no data cache, so
+ * there they stay packed.
+ */
+
+#ifdef HOST_SIM
+#define RING_LINE_SIZE      64U
+typedef _Atomic uint32_t    Ring_Index_t;
+#else
+#define RING_LINE_SIZE      4U
+typedef volatile uint32_t   Ring_Index_t;
+#endif
+
+/* Indices are kept modulo 2^24; the top byte of the MPSC reserve word counts writers */
+#define RING_INDEX_MASK     0x00FFFFFFUL
+#define RING_MAX_COUNT      (1UL << 22)
+
+typedef enum {
+    RING_SPSC = 0,
+    RING_MPSC
+} Ring_Mode_t;
+
+/**
+\brief Ring state, owned by the caller. Fields are private to the driver.
+*/
+typedef struct {
+    uint8_t        *buf;
+    uint32_t        mask;           ///< count - 1
+    uint32_t        elem_size;
+    Ring_Mode_t     mode;
+    Ring_Index_t    head __attribute__((aligned(RING_LINE_SIZE)));     ///< Published write index
+    Ring_Index_t    reserve;        ///< MPSC: reserved index | writers << 24
+    Ring_Index_t    tail __attribute__((aligned(RING_LINE_SIZE)));     ///< Read index
+} Ring_t;
+
+/**
+  \fn          int32_t RING_Init (Ring_t *ring, void *storage, uint32_t count, uint32_t elem_size, Ring_Mode_t mode)
+  \brief       Set up an empty ring over storage (count * elem_size bytes).
+  \return      \ref execution_status (ARM_DRIVER_ERROR_PARAMETER if count is not
+               a power of two up to RING_MAX_COUNT)
+
+  \fn          uint32_t RING_Push (Ring_t *ring, const void *data, uint32_t n)
+  \brief       Producer: copy up to n elements in. Safe from any context in
+               MPSC mode, from one context in SPSC mode.
+  \return      Elements stored, less than n when the ring fills
+
+  \fn          uint32_t RING_Pop (Ring_t *ring, void *data, uint32_t n)
+  \brief       Consumer: copy up to n elements out.
+  \return      Elements read
+
+  \fn          uint32_t RING_WriteSpan (Ring_t *ring, void **span)
+  \brief       SPSC producer: free slots from the head up to the end of the
+               storage or the tail, whichever comes first.
+  \param[out]  span  First free slot
+  \return      Elements that may be written at span, 0 if full or MPSC
+
+  \fn          void RING_WriteCommit (Ring_t *ring, uint32_t n)
+  \brief       SPSC producer: publish n elements written through the span.
+
+  \fn          uint32_t RING_ReadSpan (Ring_t *ring, const void **span)
+  \brief       Consumer: filled slots from the tail up to the end of the
+               storage or the head. Call again after the release for the part
+               that wrapped around.
+  \param[out]  span  Oldest element
+  \return      Elements readable at span, 0 if empty
+
+  \fn          void RING_ReadRelease (Ring_t *ring, uint32_t n)
+  \brief       Consumer: hand n elements from the span back to the producers.
+
+  \fn          uint32_t RING_Count (Ring_t *ring)
+  \return      Published elements waiting for the consumer
+*/
+int32_t  RING_Init(Ring_t *ring, void *storage, uint32_t count, uint32_t elem_size, Ring_Mode_t mode);
+uint32_t RING_Push(Ring_t *ring, const void *data, uint32_t n);
+uint32_t RING_Pop(Ring_t *ring, void *data, uint32_t n);
+uint32_t RING_WriteSpan(Ring_t *ring, void **span);
+void     RING_WriteCommit(Ring_t *ring, uint32_t n);
+uint32_t RING_ReadSpan(Ring_t *ring, const void **span);
+void     RING_ReadRelease(Ring_t *ring, uint32_t n);
+uint32_t RING_Count(Ring_t *ring);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_RING_H_ */
@@ -0,0 +1,252 @@
+#include "driver_event.h"
+
+typedef struct
+{
+	uint16_t signal;
+	uint16_t reserved;
+	uint32_t param;
+	uint32_t stamp;		/* Cycle count at post */
+} event_t;
+
+typedef struct
+{
+	Event_Handler_t handler;
+	uint32_t        priority;
+} event_sub_t;
+
+static event_sub_t subs[EVENT_MAX_SIGNALS];
+static event_t storage[EVENT_PRIORITIES][EVENT_QUEUE_LEN];
+static Ring_t queues[EVENT_PRIORITIES];
+
+/* Statistics, cycles; busy and idle are summed stretch by stretch */
+static volatile uint32_t dropped = 0;
+static uint32_t dispatched = 0;
+static uint32_t latency_min = UINT32_MAX;
+static uint32_t latency_max = 0;
+static uint64_t latency_sum = 0;
+static uint64_t busy = 0;
+static uint64_t idle = 0;
+static uint32_t mark = 0;
+
+/* === Timebase: core cycles, the DWT counter (virtual time on the host) === */
+#ifdef HOST_SIM
+static inline void event_cycles_start(void)
+{
+}
+
+static inline uint32_t event_cycles(void)
+{
+	return (uint32_t)((SIM_Now() * (SystemCoreClock / 1000000U)) / 1000U);
+}
+#else
+static inline void event_cycles_start(void)
+{
+	/* CYCCNT keeps its value: driver_profile may be using it */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t event_cycles(void)
+{
+	return DWT->CYCCNT;
+}
+#endif
+
+static inline bool event_queued(void)
+{
+	for (uint32_t p = 0U; p < EVENT_PRIORITIES; p++)
+	{
+		if (RING_Count(&queues[p]) != 0U)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Empty the queues, drop the subscriptions, start the cycle counter
+ *
+ * @return int32_t
+ */
+int32_t EVENT_Init(void)
+{
+	for (uint32_t p = 0U; p < EVENT_PRIORITIES; p++)
+	{
+		if (RING_Init(&queues[p], storage[p], EVENT_QUEUE_LEN, sizeof(event_t), RING_MPSC) != ARM_DRIVER_OK)
+		{
+			return ARM_DRIVER_ERROR;
+		}
+	}
+	for (uint32_t s = 0U; s < EVENT_MAX_SIGNALS; s++)
+	{
+		subs[s].handler = NULL;
+		subs[s].priority = 0U;
+	}
+	event_cycles_start();
+	EVENT_ResetStats();
+	return ARM_DRIVER_OK;
+}
+
+/**
+ * @brief Handle signal at priority, 0 being the most urgent
+ *
+ * @param signal below EVENT_MAX_SIGNALS
+ * @param priority below EVENT_PRIORITIES
+ * @param handler NULL unsubscribes
+ * @return int32_t
+ */
+int32_t EVENT_Subscribe(uint32_t signal, uint32_t priority, Event_Handler_t handler)
+{
+	if ((signal >= EVENT_MAX_SIGNALS) || (priority >= EVENT_PRIORITIES))
+	{
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+	subs[signal].priority = priority;
+	subs[signal].handler = handler;
+	return ARM_DRIVER_OK;
+}
+
+/**
+ * @brief Queue an event, from any context
+ *
+ * @param signal
+ * @param param passed to the handler
+ * @return int32_t
+ */
+int32_t EVENT_Post(uint32_t signal, uint32_t param)
+{
+	event_t ev;
+
+	if ((signal >= EVENT_MAX_SIGNALS) || (subs[signal].handler == NULL))
+	{
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+	ev.signal = (uint16_t)signal;
+	ev.reserved = 0U;
+	ev.param = param;
+	ev.stamp = event_cycles();
+	if (RING_Push(&queues[subs[signal].priority], &ev, 1U) == 0U)
+	{
+		uint32_t primask = __get_PRIMASK();
+
+		/* Posts from several priorities may collide on the counter */
+		__disable_irq();
+		dropped++;
+		__set_PRIMASK(primask);
+		return ARM_DRIVER_ERROR_BUSY;
+	}
+	return ARM_DRIVER_OK;
+}
+
+/**
+ * @brief Run the handler of the oldest event in the most urgent queue
+ *
+ * @return true a handler ran
+ * @return false all queues empty
+ */
+bool EVENT_Dispatch(void)
+{
+	event_t ev;
+
+	for (uint32_t p = 0U; p < EVENT_PRIORITIES; p++)
+	{
+		if (RING_Pop(&queues[p], &ev, 1U) != 0U)
+		{
+			uint32_t latency = event_cycles() - ev.stamp;
+			Event_Handler_t handler = subs[ev.signal].handler;
+
+			dispatched++;
+			latency_sum += latency;
+			if (latency < latency_min)
+			{
+				latency_min = latency;
+			}
+			if (latency > latency_max)
+			{
+				latency_max = latency;
+			}
+			if (handler != NULL)
+			{
+				handler(ev.signal, ev.param);
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Sleep until the next interrupt unless an event is queued
+ *
+ * PRIMASK stays set from the check to the wake-up: a post in between leaves
+ * its interrupt pending, and WFI returns at once. The handler of the waking
+ * interrupt runs when PRIMASK is restored, on the busy side of the books.
+ */
+void EVENT_Idle(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t now;
+
+	__disable_irq();
+	if (!event_queued())
+	{
+		now = event_cycles();
+		busy += now - mark;
+		__DSB();
+		__WFI();
+		mark = event_cycles();
+		idle += mark - now;
+	}
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief Dispatch forever, sleeping whenever the queues are empty
+ *
+ */
+void EVENT_Run(void)
+{
+	for (;;)
+	{
+		while (EVENT_Dispatch())
+		{
+			/* Run to completion, most urgent first */
+		}
+		EVENT_Idle();
+	}
+}
+
+/**
+ * @brief Copy of the statistics
+ *
+ * @param stats latencies in cycles of tick_hz
+ */
+void EVENT_GetStats(Event_Stats_t *stats)
+{
+	uint64_t total = busy + idle + (uint32_t)(event_cycles() - mark);
+
+	stats->dispatched = dispatched;
+	stats->dropped = dropped;
+	stats->latency_min = (dispatched != 0U) ? latency_min : 0U;
+	stats->latency_max = latency_max;
+	stats->latency_avg = (dispatched != 0U) ? (uint32_t)(latency_sum / dispatched) : 0U;
+	stats->idle_permille = (total != 0U) ? (uint32_t)((idle * 1000U) / total) : 0U;
+	stats->tick_hz = SystemCoreClock;
+}
+
+/**
+ * @brief Start a new statistics window
+ *
+ */
+void EVENT_ResetStats(void)
+{
+	dropped = 0U;
+	dispatched = 0U;
+	latency_min = UINT32_MAX;
+	latency_max = 0U;
+	latency_sum = 0U;
+	busy = 0U;
+	idle = 0U;
+	mark = event_cycles();
+}
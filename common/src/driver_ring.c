@@ -0,0 +1,313 @@
+#include "driver_ring.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define RING_WRITER_SHIFT   24U
+#define RING_WRITER_ONE     (1UL << RING_WRITER_SHIFT)
+#define RING_WRITER_MAX     0xFFUL
+
+/* === Index access: acquire loads, release stores, compare-and-swap === */
+#ifdef HOST_SIM
+static inline uint32_t ring_load(Ring_Index_t *p)
+{
+	return atomic_load_explicit(p, memory_order_acquire);
+}
+
+static inline void ring_store(Ring_Index_t *p, uint32_t value)
+{
+	atomic_store_explicit(p, value, memory_order_release);
+}
+
+static inline bool ring_cas(Ring_Index_t *p, uint32_t *expected, uint32_t value)
+{
+	return atomic_compare_exchange_weak_explicit(p, expected, value,
+	                                             memory_order_acq_rel, memory_order_acquire);
+}
+#else
+static inline uint32_t ring_load(Ring_Index_t *p)
+{
+	uint32_t value = *p;
+
+	/* Slot reads stay after the index read */
+	__DMB();
+	return value;
+}
+
+static inline void ring_store(Ring_Index_t *p, uint32_t value)
+{
+	/* Slot accesses complete before the index moves */
+	__DMB();
+	*p = value;
+}
+
+/* Exception entry and return clear the exclusive monitor: a preempted STREX fails */
+static inline bool ring_cas(Ring_Index_t *p, uint32_t *expected, uint32_t value)
+{
+	uint32_t current;
+
+	__DMB();
+	current = __LDREXW(p);
+
+	if (current != *expected)
+	{
+		__CLREX();
+		*expected = current;
+		return false;
+	}
+	if (__STREXW(value, p) != 0U)
+	{
+		return false;
+	}
+	__DMB();
+	return true;
+}
+#endif
+
+/* === Slot copies, split where the storage wraps === */
+static void ring_copy_in(Ring_t *ring, uint32_t index, const uint8_t *src, uint32_t n)
+{
+	uint32_t slot = index & ring->mask;
+	uint32_t first = ring->mask + 1U - slot;
+
+	if (first > n)
+	{
+		first = n;
+	}
+	memcpy(ring->buf + (slot * ring->elem_size), src, first * ring->elem_size);
+	memcpy(ring->buf, src + (first * ring->elem_size), (n - first) * ring->elem_size);
+}
+
+static void ring_copy_out(Ring_t *ring, uint32_t index, uint8_t *dst, uint32_t n)
+{
+	uint32_t slot = index & ring->mask;
+	uint32_t first = ring->mask + 1U - slot;
+
+	if (first > n)
+	{
+		first = n;
+	}
+	memcpy(dst, ring->buf + (slot * ring->elem_size), first * ring->elem_size);
+	memcpy(dst + (first * ring->elem_size), ring->buf, (n - first) * ring->elem_size);
+}
+
+/**
+ * @brief Make index visible to the consumer unless a later one already is
+ *
+ * Writers that finish out of order may publish out of order; head only
+ * moves forward. Indices less than half the index range ahead count as newer.
+ *
+ * @param ring
+ * @param index
+ */
+static void ring_publish(Ring_t *ring, uint32_t index)
+{
+	uint32_t head = ring_load(&ring->head);
+
+	while ((((index - head) & RING_INDEX_MASK) != 0U) &&
+	       (((index - head) & RING_INDEX_MASK) < ((RING_INDEX_MASK + 1UL) / 2U)))
+	{
+		if (ring_cas(&ring->head, &head, index))
+		{
+			break;
+		}
+	}
+}
+
+/**
+ * @brief Set up an empty ring over caller storage
+ *
+ * @param ring
+ * @param storage count * elem_size bytes
+ * @param count power of two, up to RING_MAX_COUNT
+ * @param elem_size bytes per element
+ * @param mode RING_SPSC or RING_MPSC
+ * @return int32_t
+ */
+int32_t RING_Init(Ring_t *ring, void *storage, uint32_t count, uint32_t elem_size, Ring_Mode_t mode)
+{
+	if ((ring == NULL) || (storage == NULL) || (elem_size == 0U) ||
+	    (count == 0U) || (count > RING_MAX_COUNT) || ((count & (count - 1U)) != 0U))
+	{
+		return ARM_DRIVER_ERROR_PARAMETER;
+	}
+	ring->buf = (uint8_t *)storage;
+	ring->mask = count - 1U;
+	ring->elem_size = elem_size;
+	ring->mode = mode;
+	ring_store(&ring->head, 0U);
+	ring_store(&ring->reserve, 0U);
+	ring_store(&ring->tail, 0U);
+	return ARM_DRIVER_OK;
+}
+
+/**
+ * @brief Copy up to n elements in
+ *
+ * SPSC: the free space cannot shrink under the producer, copy then publish.
+ * MPSC: claim slots and count in as a writer with one CAS on the reserve
+ * word, copy, count out; the last writer out publishes the reserve index.
+ *
+ * @param ring
+ * @param data n elements
+ * @param n
+ * @return uint32_t elements stored
+ */
+uint32_t RING_Push(Ring_t *ring, const void *data, uint32_t n)
+{
+	uint32_t size = ring->mask + 1U;
+	uint32_t index;
+	uint32_t used;
+
+	if (ring->mode == RING_SPSC)
+	{
+		index = ring_load(&ring->head);
+		used = (index - ring_load(&ring->tail)) & RING_INDEX_MASK;
+		if (n > (size - used))
+		{
+			n = size - used;
+		}
+		if (n != 0U)
+		{
+			ring_copy_in(ring, index, (const uint8_t *)data, n);
+			ring_store(&ring->head, (index + n) & RING_INDEX_MASK);
+		}
+		return n;
+	}
+
+	{
+		uint32_t state = ring_load(&ring->reserve);
+		uint32_t next;
+
+		do
+		{
+			index = state & RING_INDEX_MASK;
+			used = (index - ring_load(&ring->tail)) & RING_INDEX_MASK;
+			if (n > (size - used))
+			{
+				n = size - used;
+			}
+			if ((n == 0U) || ((state >> RING_WRITER_SHIFT) == RING_WRITER_MAX))
+			{
+				return 0U;
+			}
+			next = (state & ~RING_INDEX_MASK) + RING_WRITER_ONE + ((index + n) & RING_INDEX_MASK);
+		} while (!ring_cas(&ring->reserve, &state, next));
+
+		ring_copy_in(ring, index, (const uint8_t *)data, n);
+
+		state = ring_load(&ring->reserve);
+		while (!ring_cas(&ring->reserve, &state, state - RING_WRITER_ONE))
+		{
+			/* Another producer moved the reserve word: retry on its value */
+		}
+		if ((state >> RING_WRITER_SHIFT) == 1U)
+		{
+			ring_publish(ring, state & RING_INDEX_MASK);
+		}
+	}
+	return n;
+}
+
+/**
+ * @brief Copy up to n elements out
+ *
+ * @param ring
+ * @param data room for n elements
+ * @param n
+ * @return uint32_t elements read
+ */
+uint32_t RING_Pop(Ring_t *ring, void *data, uint32_t n)
+{
+	uint32_t index = ring_load(&ring->tail);
+	uint32_t count = (ring_load(&ring->head) - index) & RING_INDEX_MASK;
+
+	if (n > count)
+	{
+		n = count;
+	}
+	if (n != 0U)
+	{
+		ring_copy_out(ring, index, (uint8_t *)data, n);
+		ring_store(&ring->tail, (index + n) & RING_INDEX_MASK);
+	}
+	return n;
+}
+
+/**
+ * @brief Contiguous free slots at the head (SPSC only)
+ *
+ * @param ring
+ * @param span first free slot
+ * @return uint32_t
+ */
+uint32_t RING_WriteSpan(Ring_t *ring, void **span)
+{
+	uint32_t index = ring_load(&ring->head);
+	uint32_t slot = index & ring->mask;
+	uint32_t n = ring->mask + 1U - ((index - ring_load(&ring->tail)) & RING_INDEX_MASK);
+
+	if (ring->mode != RING_SPSC)
+	{
+		return 0U;
+	}
+	if (n > (ring->mask + 1U - slot))
+	{
+		n = ring->mask + 1U - slot;
+	}
+	*span = ring->buf + (slot * ring->elem_size);
+	return n;
+}
+
+/**
+ * @brief Publish n elements written through RING_WriteSpan()
+ *
+ * @param ring
+ * @param n
+ */
+void RING_WriteCommit(Ring_t *ring, uint32_t n)
+{
+	ring_store(&ring->head, (ring_load(&ring->head) + n) & RING_INDEX_MASK);
+}
+
+/**
+ * @brief Contiguous filled slots at the tail
+ *
+ * @param ring
+ * @param span oldest element
+ * @return uint32_t
+ */
+uint32_t RING_ReadSpan(Ring_t *ring, const void **span)
+{
+	uint32_t index = ring_load(&ring->tail);
+	uint32_t slot = index & ring->mask;
+	uint32_t n = (ring_load(&ring->head) - index) & RING_INDEX_MASK;
+
+	if (n > (ring->mask + 1U - slot))
+	{
+		n = ring->mask + 1U - slot;
+	}
+	*span = ring->buf + (slot * ring->elem_size);
+	return n;
+}
+
+/**
+ * @brief Release n elements read through RING_ReadSpan()
+ *
+ * @param ring
+ * @param n
+ */
+void RING_ReadRelease(Ring_t *ring, uint32_t n)
+{
+	ring_store(&ring->tail, (ring_load(&ring->tail) + n) & RING_INDEX_MASK);
+}
+
+/**
+ * @brief Published elements waiting for the consumer
+ *
+ * @param ring
+ * @return uint32_t
+ */
+uint32_t RING_Count(Ring_t *ring)
+{
+	return (ring_load(&ring->head) - ring_load(&ring->tail)) & RING_INDEX_MASK;
+}